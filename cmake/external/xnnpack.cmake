@@ -14,6 +14,16 @@ endif()
 
 add_subdirectory(external/FP16)
 add_subdirectory(external/pthreadpool)
+
+# XNNPACK parallelizes its work through the pthreadpool API. Replace the pthreadpool implementation with one that runs
+# the work on the ORT thread pool, so XNNPACK kernels and ORT kernels share the intra-op threads instead of competing
+# for the cores. The pthreadpool target keeps its public headers and dependencies.
+set(onnxruntime_xnnpack_pthreadpool_shim_src "${ONNXRUNTIME_ROOT}/core/providers/xnnpack/detail/pthreadpool_shim.cc")
+set_property(TARGET pthreadpool PROPERTY SOURCES ${onnxruntime_xnnpack_pthreadpool_shim_src})
+target_include_directories(pthreadpool PRIVATE ${ONNXRUNTIME_ROOT} ${ONNXRUNTIME_INCLUDE_DIR})
+onnxruntime_add_include_to_target(pthreadpool onnxruntime_common)
+target_link_libraries(pthreadpool PRIVATE onnxruntime_common)
+
 add_subdirectory(external/XNNPACK)
 
 set_target_properties(fp16 PROPERTIES FOLDER "External/Xnnpack")
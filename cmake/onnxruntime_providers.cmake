@@ -1522,6 +1522,8 @@ if (onnxruntime_USE_XNNPACK)
     "${ONNXRUNTIME_ROOT}/core/providers/shared/node_unit/node_unit.h"
     "${ONNXRUNTIME_ROOT}/core/providers/shared/node_unit/node_unit.cc"
   )
+  # the pthreadpool shim is built as the pthreadpool library. see cmake/external/xnnpack.cmake
+  list(REMOVE_ITEM onnxruntime_providers_xnnpack_cc_srcs ${onnxruntime_xnnpack_pthreadpool_shim_src})
 
   source_group(TREE ${REPO_ROOT} FILES ${onnxruntime_providers_xnnpack_cc_srcs})
   onnxruntime_add_static_library(onnxruntime_providers_xnnpack ${onnxruntime_providers_xnnpack_cc_srcs})
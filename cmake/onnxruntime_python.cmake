@@ -80,6 +80,14 @@ if (onnxruntime_ENABLE_LAZY_TENSOR OR onnxruntime_ENABLE_EAGER_MODE)
   endif()
 endif()
 
+# OrtValue.to_dlpack/from_dlpack are available in every build. The DLPack converter is part of
+# onnxruntime_providers only when ATen fallback is enabled, so add it to the pybind target otherwise.
+if (NOT onnxruntime_ENABLE_ATEN)
+  list(APPEND onnxruntime_pybind_srcs
+              "${ONNXRUNTIME_ROOT}/core/dlpack/dlpack_converter.cc"
+              "${ONNXRUNTIME_ROOT}/core/dlpack/dlpack_converter.h")
+endif()
+
 onnxruntime_add_shared_library_module(onnxruntime_pybind11_state ${onnxruntime_pybind_srcs})
 
 if(MSVC)
@@ -136,9 +144,11 @@ else()
   set(ONNXRUNTIME_SO_LINK_FLAG "-DEF:${ONNXRUNTIME_ROOT}/python/pybind.def")
 endif()
 
+# DLPack is a header-only dependency
+target_include_directories(onnxruntime_pybind11_state PRIVATE ${PROJECT_SOURCE_DIR}/external/dlpack/include)
+
 if (onnxruntime_ENABLE_ATEN)
   target_compile_definitions(onnxruntime_pybind11_state PRIVATE ENABLE_ATEN)
-  target_include_directories(onnxruntime_pybind11_state PRIVATE ${PROJECT_SOURCE_DIR}/external/dlpack/include)
 endif()
 
 if (onnxruntime_ENABLE_TRAINING)
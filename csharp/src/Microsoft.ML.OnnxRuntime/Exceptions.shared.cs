@@ -24,8 +24,13 @@ namespace Microsoft.ML.OnnxRuntime
         ModelLoaded = 8,
         NotImplemented = 9,
         InvalidGraph = 10,
-        ShapeInferenceNotRegistered = 11,
-        RequirementNotRegistered = 12,
+        EpFail = 11,
+        DeadlineExceeded = 12,
+        // former names of 11 and 12, kept as aliases. they share the values, and so the messages, of the new names.
+        [ObsoleteAttribute("ShapeInferenceNotRegistered is obsolete. Use EpFail instead.", false)]
+        ShapeInferenceNotRegistered = EpFail,
+        [ObsoleteAttribute("RequirementNotRegistered is obsolete. Use DeadlineExceeded instead.", false)]
+        RequirementNotRegistered = DeadlineExceeded,
     }
 
     /// <summary>
@@ -46,8 +51,8 @@ namespace Microsoft.ML.OnnxRuntime
             { ErrorCode.ModelLoaded, "ModelLoaded" },
             { ErrorCode.NotImplemented, "NotImplemented" },
             { ErrorCode.InvalidGraph, "InvalidGraph" },
-            { ErrorCode.ShapeInferenceNotRegistered, "ShapeInferenceNotRegistered" },
-            { ErrorCode.RequirementNotRegistered, "RequirementNotRegistered" },
+            { ErrorCode.EpFail, "EpFail" },
+            { ErrorCode.DeadlineExceeded, "DeadlineExceeded" },
         };
 
         internal OnnxRuntimeException(ErrorCode errorCode, string message)
@@ -154,7 +154,7 @@ namespace Microsoft.ML.OnnxRuntime
             var typeInfo = tensorBase.GetTypeInfo();
             if (typeInfo == null)
             {
-                throw new OnnxRuntimeException(ErrorCode.RequirementNotRegistered, "BUG Check");
+                throw new OnnxRuntimeException(ErrorCode.RuntimeException, "BUG Check");
             }
 
             MemoryHandle? memHandle;
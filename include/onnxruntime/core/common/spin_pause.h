@@ -8,9 +8,12 @@
 #endif
 
 #if defined(__x86_64__)
+#include <x86intrin.h>
 #include <xmmintrin.h>
 #endif
 
+#include <cstdint>
+
 namespace onnxruntime {
 
 namespace concurrency {
@@ -23,6 +26,25 @@ inline void SpinPause() {
 #endif
 }
 
+// Idles the core for about tsc_cycles time stamp counter cycles with TPAUSE, in the C0.1 state which wakes up
+// quickly. Unlike a spin on SpinPause, this leaves the execution resources to the other hyper-thread of the core and
+// saves power. Must only be called when CPUIDInfo::HasWaitPkg() is true.
+inline void TimedPause(uint64_t tsc_cycles) {
+#if defined(__x86_64__)
+  const uint64_t deadline = __rdtsc() + tsc_cycles;
+  // tpause ecx, encoded directly so that no -mwaitpkg compiler flag is needed.
+  __asm__ volatile(".byte 0x66, 0x0f, 0xae, 0xf1"
+                   :
+                   : "c"(1), "a"(static_cast<uint32_t>(deadline)), "d"(static_cast<uint32_t>(deadline >> 32))
+                   : "cc");
+#elif defined(_M_AMD64) && _MSC_VER >= 1920
+  _tpause(1, __rdtsc() + tsc_cycles);
+#else
+  (void)tsc_cycles;
+  SpinPause();
+#endif
+}
+
 }  // namespace concurrency
 
 }  // namespace onnxruntime
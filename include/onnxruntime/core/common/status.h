@@ -44,7 +44,8 @@ enum StatusCode {
   MODEL_LOADED = 8,
   NOT_IMPLEMENTED = 9,
   INVALID_GRAPH = 10,
-  EP_FAIL = 11
+  EP_FAIL = 11,
+  DEADLINE_EXCEEDED = 12
 };
 
 constexpr const char* StatusCodeToString(StatusCode status) noexcept {
@@ -73,6 +74,8 @@ constexpr const char* StatusCodeToString(StatusCode status) noexcept {
       return "INVALID_GRAPH";
     case StatusCode::EP_FAIL:
       return "EP_FAIL";
+    case StatusCode::DEADLINE_EXCEEDED:
+      return "DEADLINE_EXCEEDED";
     default:
       return "GENERAL ERROR";
   }
@@ -105,6 +108,8 @@ constexpr HRESULT StatusCodeToHRESULT(StatusCode status) noexcept {
       return HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
     case StatusCode::EP_FAIL:
       return HRESULT_FROM_WIN32(ERROR_INTERNAL_ERROR);
+    case StatusCode::DEADLINE_EXCEEDED:
+      return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
     default:
       return E_FAIL;
   }
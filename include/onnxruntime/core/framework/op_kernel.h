@@ -37,6 +37,9 @@ class OpKernelContext;
 #endif
 
 namespace onnxruntime {
+namespace concurrency {
+class ThreadPool;
+}
 
 std::unique_ptr<OpKernelInfo> CopyOpKernelInfo(const OpKernelInfo& info);
 
@@ -116,6 +119,23 @@ class OpKernel {
     return Status::OK();
   }
 
+  // Override this function to precompute the state that only depends on the shapes of the inputs, such as the
+  // output shapes, broadcast helpers or the partitioning of the work between threads, so that Compute() only has
+  // to do the arithmetic.
+  // It is called once at session initialization, after PrePack(), if the session enables
+  // kOrtSessionOptionsConfigStaticShapeKernels and the shapes of all the inputs of the node are static.
+  // Compute() must check that its inputs have the shapes that were precomputed before using the precomputed state,
+  // and fall back to computing it otherwise.
+  // @param input_shapes: The shape of each input of the node, or nullptr for a missing optional input.
+  // @param thread_pool: The intra-op thread pool that Compute() will be called with.
+  // @param is_precomputed: Set it to true if the kernel precomputed any state.
+  virtual Status PrecomputeForStaticShapes(gsl::span<const TensorShape* const> /*input_shapes*/,
+                                           concurrency::ThreadPool* /*thread_pool*/,
+                                           /*out*/ bool& is_precomputed) {
+    is_precomputed = false;
+    return Status::OK();
+  }
+
   const OrtMemoryInfo& Allocator(int id, OrtMemType mem_type) const;
   const OpKernelInfo& Info() const {
     return *op_kernel_info_;
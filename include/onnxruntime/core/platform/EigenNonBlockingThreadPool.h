@@ -32,6 +32,7 @@
 #pragma warning(disable : 4127)
 #pragma warning(disable : 4805)
 #endif
+#include <chrono>
 #include <memory>
 #include "unsupported/Eigen/CXX11/ThreadPool"
 
@@ -45,6 +46,7 @@
 #include "core/common/spin_pause.h"
 #include "core/platform/ort_mutex.h"
 #include "core/platform/Barrier.h"
+#include "core/platform/threadpool.h"
 
 // ORT thread pool overview
 // ------------------------
@@ -70,6 +72,11 @@
 //
 //   This spin-then-block behavior is configured via a flag provided
 //   when creating the thread pool, and by the constant spin_count.
+//   With ThreadOptions::adaptive_spinning, each worker instead spins
+//   for a duration tuned from the gaps it observed between running out
+//   of work and receiving new work: long enough to catch work arriving
+//   at a high rate without an OS wake-up, and briefly when work arrives
+//   too rarely for spinning to pay off.
 //
 // - Although all tasks are simple void()->void functions,
 //   conceptually there are three different kinds:
@@ -727,12 +734,16 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   typedef std::function<void()> Task;
   typedef RunQueue<Task, Tag, 1024> Queue;
 
+  // use_timed_pause selects TPAUSE over PAUSE in the adaptive spin loop, and must only be set on CPUs with WAITPKG.
   ThreadPoolTempl(const CHAR_TYPE* name, int num_threads, bool allow_spinning, Environment& env,
-                  const ThreadOptions& thread_options)
+                  const ThreadOptions& thread_options, bool use_timed_pause = false)
       : profiler_(num_threads, name),
         env_(env),
         num_threads_(num_threads),
         allow_spinning_(allow_spinning),
+        adaptive_spinning_(allow_spinning && thread_options.adaptive_spinning),
+        use_timed_pause_(use_timed_pause),
+        collect_worker_stats_(thread_options.collect_worker_stats || adaptive_spinning_),
         set_denormal_as_zero_(thread_options.set_denormal_as_zero),
         worker_data_(num_threads),
         all_coprimes_(num_threads),
@@ -1289,6 +1300,23 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     spin_loop_status_ = SpinLoopStatus::kIdle;
   }
 
+  // Returns the counters of each worker thread. They are updated by the workers without synchronization, so the
+  // values of a pool that is running work are only approximately consistent with each other. The counters stay zero
+  // unless ThreadOptions::collect_worker_stats or adaptive spinning is enabled.
+  std::vector<ThreadPoolWorkerStats> GetWorkerStats() const {
+    std::vector<ThreadPoolWorkerStats> stats(num_threads_);
+    for (unsigned i = 0; i < num_threads_; i++) {
+      const WorkerData& td = worker_data_[i];
+      stats[i].tasks = td.tasks.load(std::memory_order_relaxed);
+      stats[i].active_ns = td.active_ns.load(std::memory_order_relaxed);
+      stats[i].spin_ns = td.spin_ns.load(std::memory_order_relaxed);
+      stats[i].spin_hits = td.spin_hits.load(std::memory_order_relaxed);
+      stats[i].blocks = td.blocks.load(std::memory_order_relaxed);
+      stats[i].spin_limit_ns = td.spin_limit_ns.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
  private:
   void ComputeCoprimes(int N, Eigen::MaxSizeVector<unsigned>* coprimes) {
     for (int i = 1; i <= N; i++) {
@@ -1306,6 +1334,15 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     }
   }
 
+  // Bounds of the duration a worker spins with adaptive spinning.  The lower bound covers the short gaps between the
+  // loops of a parallel section or of consecutive operators, the upper bound is the longest gap for which spinning is
+  // considered cheaper than blocking in the OS and being woken up again.
+  static constexpr int64_t kMinAdaptiveSpinNs = 10 * 1000;
+  static constexpr int64_t kMaxAdaptiveSpinNs = 2 * 1000 * 1000;
+
+  // Duration of one TPAUSE in the adaptive spin loop, in time stamp counter cycles (about 1us).
+  static constexpr uint64_t kTimedPauseCycles = 2000;
+
   typedef typename Environment::EnvThread Thread;
   struct WorkerData;
 
@@ -1441,6 +1478,15 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       status.store(ThreadStatus::Spinning, std::memory_order_relaxed);
     }
 
+    // Counters and adaptive spinning state.  They are only written by the worker thread itself, with AddToCounter,
+    // and are atomic so that GetWorkerStats can read them while the pool is running.
+    std::atomic<uint64_t> tasks{0};
+    std::atomic<uint64_t> active_ns{0};
+    std::atomic<uint64_t> spin_ns{0};
+    std::atomic<uint64_t> spin_hits{0};
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<int64_t> spin_limit_ns{kMaxAdaptiveSpinNs};
+
    private:
     std::atomic<ThreadStatus> status{ThreadStatus::Spinning};
     OrtMutex mutex;
@@ -1450,6 +1496,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   Environment& env_;
   const unsigned num_threads_;
   const bool allow_spinning_;
+  const bool adaptive_spinning_;
+  const bool use_timed_pause_;
+  const bool collect_worker_stats_;
   const bool set_denormal_as_zero_;
   Eigen::MaxSizeVector<WorkerData> worker_data_;
   Eigen::MaxSizeVector<Eigen::MaxSizeVector<unsigned>> all_coprimes_;
@@ -1479,6 +1528,63 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     }
   }
 
+  // Counters of a worker have a single writer, so a relaxed load and store avoids the locked read-modify-write of
+  // fetch_add.
+  static void AddToCounter(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  static uint64_t ElapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+  }
+
+  // Spins for at most spin_limit_ns waiting for work pushed to q, occasionally trying to steal work, as the fixed
+  // spin loop of WorkerLoop does.
+  Task AdaptiveSpin(Queue& q, int64_t spin_limit_ns, std::chrono::steady_clock::time_point spin_start) {
+    // Reading the clock costs about as much as a pause, so it is only checked every few iterations.
+    constexpr int kPausesPerClockCheck = 8;
+    constexpr int kPausesPerSteal = 128;
+    for (int i = 1; !done_; i++) {
+      Task t = (i % kPausesPerSteal == 0) ? Steal(StealAttemptKind::TRY_ONE) : q.PopFront();
+      if (t) {
+        return t;
+      }
+      if (spin_loop_status_.load(std::memory_order_relaxed) == SpinLoopStatus::kIdle) {
+        break;
+      }
+      if (i % kPausesPerClockCheck == 0 &&
+          static_cast<int64_t>(ElapsedNs(spin_start, std::chrono::steady_clock::now())) >= spin_limit_ns) {
+        break;
+      }
+      if (use_timed_pause_) {
+        onnxruntime::concurrency::TimedPause(kTimedPauseCycles);
+      } else {
+        onnxruntime::concurrency::SpinPause();
+      }
+    }
+    return Task();
+  }
+
+  // Tunes the spin duration of a worker from the time it waited for its last piece of work.
+  static void UpdateSpinLimit(WorkerData& td, uint64_t idle_ns, bool found_while_spinning) {
+    const int64_t limit = td.spin_limit_ns.load(std::memory_order_relaxed);
+    const int64_t idle = static_cast<int64_t>(std::min<uint64_t>(idle_ns, kMaxAdaptiveSpinNs + 1));
+    int64_t new_limit;
+    if (found_while_spinning) {
+      // Spinning paid off.  Track twice the observed gaps, slowly so that one short gap does not make the worker
+      // block on the next longer one.
+      new_limit = (7 * limit + std::min(2 * idle, kMaxAdaptiveSpinNs)) / 8;
+    } else if (idle <= kMaxAdaptiveSpinNs) {
+      // A longer spin would have avoided blocking and the OS wake-up.
+      new_limit = std::max(limit, std::min(2 * idle, kMaxAdaptiveSpinNs));
+    } else {
+      // Work arrives too rarely for spinning to pay off.
+      new_limit = limit / 2;
+    }
+    td.spin_limit_ns.store(std::max(new_limit, kMinAdaptiveSpinNs), std::memory_order_relaxed);
+  }
+
   // Main worker thread loop.
   void WorkerLoop(int thread_id) {
     PerThread* pt = GetPerThread();
@@ -1500,19 +1606,36 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     while (!should_exit) {
       Task t = q.PopFront();
       if (!t) {
+        // The clock is only read for the counters and adaptive spinning, to keep it off the path of small tasks.
+        std::chrono::steady_clock::time_point idle_start;
+        if (collect_worker_stats_) {
+          idle_start = std::chrono::steady_clock::now();
+        }
+
         // Spin waiting for work.
-        for (int i = 0; i < spin_count && !done_; i++) {
-          if (((i + 1) % steal_count == 0)) {
-            t = Steal(StealAttemptKind::TRY_ONE);
-          } else {
-            t = q.PopFront();
+        if (adaptive_spinning_) {
+          t = AdaptiveSpin(q, td.spin_limit_ns.load(std::memory_order_relaxed), idle_start);
+        } else {
+          for (int i = 0; i < spin_count && !done_; i++) {
+            if (((i + 1) % steal_count == 0)) {
+              t = Steal(StealAttemptKind::TRY_ONE);
+            } else {
+              t = q.PopFront();
+            }
+            if (t) break;
+
+            if (spin_loop_status_.load(std::memory_order_relaxed) == SpinLoopStatus::kIdle) {
+              break;
+            }
+            onnxruntime::concurrency::SpinPause();
           }
-          if (t) break;
-
-          if (spin_loop_status_.load(std::memory_order_relaxed) == SpinLoopStatus::kIdle) {
-            break;
+        }
+        const bool found_while_spinning = static_cast<bool>(t);
+        if (collect_worker_stats_) {
+          AddToCounter(td.spin_ns, ElapsedNs(idle_start, std::chrono::steady_clock::now()));
+          if (found_while_spinning) {
+            AddToCounter(td.spin_hits, 1);
           }
-          onnxruntime::concurrency::SpinPause();
         }
 
         // Attempt to block
@@ -1572,6 +1695,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
               // Post-block update (executed only if we blocked)
               [&]() {
                 blocked_--;
+                if (collect_worker_stats_) {
+                  AddToCounter(td.blocks, 1);
+                }
               });
           // Thread just unblocked.  Unless we picked up work while
           // blocking, or are exiting, then either work was pushed to
@@ -1579,11 +1705,22 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
           if (!t) t = q.PopFront();
           if (!t) t = Steal(StealAttemptKind::TRY_ALL);
         }
+
+        if (adaptive_spinning_ && t) {
+          UpdateSpinLimit(td, ElapsedNs(idle_start, std::chrono::steady_clock::now()), found_while_spinning);
+        }
       }
 
       if (t) {
         td.SetActive();
-        t();
+        if (collect_worker_stats_) {
+          const auto task_start = std::chrono::steady_clock::now();
+          t();
+          AddToCounter(td.active_ns, ElapsedNs(task_start, std::chrono::steady_clock::now()));
+          AddToCounter(td.tasks, 1);
+        } else {
+          t();
+        }
         profiler_.LogRun(thread_id);
         td.SetSpinning();
       }
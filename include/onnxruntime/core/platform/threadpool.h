@@ -16,6 +16,7 @@ limitations under the License.
 /* Modifications Copyright (c) Microsoft. */
 
 #pragma once
+#include <atomic>
 #include <string>
 #include <vector>
 #include <functional>
@@ -137,6 +138,42 @@ class ExtendedThreadPoolInterface;
 class LoopCounter;
 class ThreadPoolParallelSection;
 
+// Scheduling class of the loops a session runs on a shared thread pool.
+enum class ThreadPoolPriority {
+  // Loops that a request is waiting for. They never give up threads.
+  LatencyCritical,
+  // Throughput oriented loops. While a latency critical loop runs on the same pool, the helper threads of a batch
+  // loop stop claiming chunks at the next chunk boundary, leaving the rest of the loop to the thread that entered it.
+  Batch,
+};
+
+// Counters of the parallel loops run through a view of a shared thread pool. Loops that run directly in the calling
+// thread because they are too small to parallelize are not counted.
+struct ThreadPoolShareStats {
+  uint64_t loops{0};
+  uint64_t chunks{0};
+  // Number of times a helper thread of a batch loop yielded to latency critical work.
+  uint64_t yields{0};
+  // Time from the start of the loops to the helper threads picking them up, summed over the helper threads.
+  uint64_t queue_time_ns{0};
+  // Time the threads spent running chunks of the loops, summed over the threads including the calling one.
+  uint64_t cpu_time_ns{0};
+};
+
+// Counters of one worker thread of a thread pool.
+struct ThreadPoolWorkerStats {
+  uint64_t tasks{0};
+  // Time spent running tasks.
+  uint64_t active_ns{0};
+  // Time spent spinning while waiting for work.
+  uint64_t spin_ns{0};
+  // Number of times work arrived while the thread was spinning, and number of times it blocked in the OS instead.
+  uint64_t spin_hits{0};
+  uint64_t blocks{0};
+  // Current spin duration of the thread with adaptive spinning.
+  int64_t spin_limit_ns{0};
+};
+
 class ThreadPool {
  public:
 #ifdef _WIN32
@@ -160,6 +197,13 @@ class ThreadPool {
              bool low_latency_hint,
              bool force_hybrid = false);
 
+  // Constructs a view of the pool "shared" for one of the sessions that use it, e.g. the global intra-op pool of the
+  // Environment. Loops run on the threads of the shared pool, using at most "thread_quota" threads including the
+  // thread entering the loop (0 to use all of them), in the scheduling class "priority". The degree of parallelism
+  // reported for the view is that of the quota, so it is stable for the lifetime of the view. The shared pool must
+  // outlive the view.
+  ThreadPool(ThreadPool* shared, int thread_quota, ThreadPoolPriority priority);
+
   // Waits until all scheduled work has finished and then destroy the
   // set of threads.
   ~ThreadPool();
@@ -367,9 +411,22 @@ class ThreadPool {
   static void StartProfiling(concurrency::ThreadPool* tp);
   static std::string StopProfiling(concurrency::ThreadPool* tp);
 
+  // Returns the counters of a view of a shared pool, or zeros for any other pool.
+  static ThreadPoolShareStats GetShareStats(const concurrency::ThreadPool* tp);
+
+  // Returns the counters of the worker threads of the pool, or of the pool a view shares. Empty for a pool without
+  // worker threads.
+  static std::vector<ThreadPoolWorkerStats> GetWorkerStats(const concurrency::ThreadPool* tp);
+
  private:
   friend class LoopCounter;
 
+  struct ShareCounters;
+
+  // One work item of a parallel loop. Decides at the chunk boundaries whether a helper thread of a batch loop yields
+  // or the loop of a cancelled run stops, and keeps the counters of a view of a shared pool.
+  class LoopWorkItem;
+
   // Returns the number of threads created in the pool.  This may be different from the
   // value returned by DegreeOfParallelism to code using the pool.
   int NumThreads() const;
@@ -429,6 +486,17 @@ class ThreadPool {
 
   // Force the thread pool to run in hybrid mode on a normal cpu.
   bool force_hybrid_ = false;
+
+  // Set for a view of a shared pool: the pool owning the threads, the maximum number of threads including the
+  // caller (0 for no limit), and the scheduling class of the loops.
+  ThreadPool* shared_ = nullptr;
+  int thread_quota_ = 0;
+  ThreadPoolPriority priority_ = ThreadPoolPriority::LatencyCritical;
+  std::unique_ptr<ShareCounters> share_counters_;
+
+  // Number of latency critical loops running on this pool, directly or through views. Only used on pools that own
+  // their threads.
+  std::atomic<int> latency_critical_loops_{0};
 };
 
 }  // namespace concurrency
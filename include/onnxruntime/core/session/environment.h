@@ -13,6 +13,8 @@
 
 struct OrtThreadingOptions;
 namespace onnxruntime {
+class SharedInitializerStore;
+
 /** TODO: remove this class
    Provides the runtime environment for onnxruntime.
    Create one instance for the duration of execution.
@@ -79,6 +81,14 @@ class Environment {
    */
   Status UnregisterAllocator(const OrtMemoryInfo& mem_info);
 
+  /**
+   * Returns the store sessions created with the session.deduplicate_initializers config entry share identical
+   * constant initializers through.
+   */
+  SharedInitializerStore* GetSharedInitializerStore() const {
+    return shared_initializer_store_.get();
+  }
+
   Environment() = default;
 
  private:
@@ -92,5 +102,6 @@ class Environment {
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
   bool create_global_thread_pools_{false};
   std::vector<AllocatorPtr> shared_allocators_;
+  std::shared_ptr<SharedInitializerStore> shared_initializer_store_;
 };
 }  // namespace onnxruntime
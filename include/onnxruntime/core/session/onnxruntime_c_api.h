@@ -225,6 +225,7 @@ typedef enum OrtErrorCode {
   ORT_NOT_IMPLEMENTED,
   ORT_INVALID_GRAPH,
   ORT_EP_FAIL,
+  ORT_DEADLINE_EXCEEDED,
 } OrtErrorCode;
 
 typedef enum OrtOpAttrType {
@@ -25,3 +25,9 @@
 // Example usage: "cpu:0;gpu:0" (or) "gpu:0"
 // By default, the value for this key is empty (i.e.) no memory arenas are shrunk
 static const char* const kOrtRunOptionsConfigEnableMemoryArenaShrinkage = "memory.enable_memory_arena_shrinkage";
+
+// Time budget of the Run() call in milliseconds, counted from the call, e.g. "50". The default is "0" (no deadline).
+// When the deadline passes, the run stops at the next node boundary, or within long running kernels that check for
+// cancellation, and fails with the DEADLINE_EXCEEDED status code. The outputs of a run that failed this way must not
+// be used. This lets an overloaded server shed the requests that would complete too late.
+static const char* const kOrtRunOptionsConfigTimeoutMs = "run.timeout_ms";
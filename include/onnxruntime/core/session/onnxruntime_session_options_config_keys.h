@@ -20,6 +20,21 @@
 // If the config value is set to "1" then the prepacking is disabled, otherwise prepacking is enabled (default value)
 static const char* const kOrtSessionOptionsConfigDisablePrepacking = "session.disable_prepacking";
 
+// Key for enabling kernels to precompute their shape dependent state at session initialization.
+// If the config value is set to "1", kernels of nodes whose input shapes are all static precompute the state that
+// only depends on those shapes (output shapes, broadcast helpers, thread partitioning) once, instead of on every run.
+// Inputs with other shapes are still supported. The default value is "0".
+static const char* const kOrtSessionOptionsConfigStaticShapeKernels = "session.static_shape_kernels";
+
+// Key for sharing identical constant initializers between sessions and subgraphs.
+// If the config value is set to "1", the constant CPU initializers of at least 1 KB of the main graph and of its
+// subgraphs are looked up by content in a store owned by the environment, and sessions holding the same weights keep
+// a single copy of them. The pre-packed forms of those initializers are shared too if the sessions were given the
+// same PrepackedWeightsContainer, and are otherwise kept by each session. The session must not update its
+// initializers in place, so training builds fail session initialization with INVALID_ARGUMENT if this is set.
+// The default value is "0".
+static const char* const kOrtSessionOptionsConfigDeduplicateInitializers = "session.deduplicate_initializers";
+
 // A value of "1" means allocators registered in the env will be used. "0" means the allocators created in the session
 // will be used. Use this to override the usage of env allocators on a per session level.
 static const char* const kOrtSessionOptionsConfigUseEnvAllocators = "session.use_env_allocators";
@@ -142,3 +157,53 @@ static const char* const kOrtSessionOptionsConfigForceSpinningStop = "session.fo
 // "0": in some cases warnings will be logged but processing will continue. The default.
 // May be useful to expose bugs in models.
 static const char* const kOrtSessionOptionsConfigStrictShapeTypeInference = "session.strict_shape_type_inference";
+
+// Binds the session to one NUMA node. The value is the id of the node, e.g. "0". The default is "-1" (not bound).
+// When set, the threads of the per-session thread pools run only on the logical processors of that node, and
+// the memory regions of the CPU arena are preferably placed on that node's memory. This allows running one
+// session replica per socket with node local memory. Not supported with global/env thread pools.
+static const char* const kOrtSessionOptionsConfigNumaNode = "session.numa_node";
+
+// Memory budget in MB for the activations a training graph keeps from the forward to the backward pass, e.g. "512".
+// When set, cheap forward operators (element-wise, Gelu, LayerNormalization) whose outputs the backward pass reads are
+// recomputed in the backward pass until the estimated activation memory fits in the budget. The estimate and the
+// added compute are logged. Only applies to graphs that contain both passes, in training builds.
+// The recompute nodes only run late enough to save memory with ExecutionOrder::PRIORITY_BASED, so setting a budget
+// switches the session to that execution order. A value that is not a non-negative number fails the initialization
+// of the session with INVALID_ARGUMENT.
+static const char* const kOrtSessionOptionsConfigActivationMemoryBudgetMB = "optimization.activation_memory_budget_mb";
+
+// "1": float Conv, FusedConv, pooling and BatchNormalization nodes assigned to the CPU EP run in NHWC layout, with
+// the layout conversions pushed to the boundaries of the NHWC region by the level 3 (layout) optimizations. Replaces
+// the NCHWc layout optimization for such models.
+// "0": float nodes keep the NCHW (or NCHWc) layout. The default.
+static const char* const kOrtSessionOptionsConfigNhwcFloatLayout = "optimization.nhwc_float_layout";
+
+// Maximum number of threads of the global intra-op thread pool the session uses for one parallel loop, including the
+// thread running the session, e.g. "4". The default is "0" (all the threads of the pool). Lets sessions sharing the
+// global pool be given a share of it, and keeps the degree of parallelism the kernels see stable for the lifetime
+// of the session. Only applies with global/env thread pools. A value that is not a non-negative integer fails the
+// initialization of the session with INVALID_ARGUMENT.
+// The loops, chunks and time the session spent on the global pool are available from
+// InferenceSession::GetIntraOpThreadPoolStats only. They are also logged at INFO level when the session is destroyed,
+// and recorded as the "intra_op_thread_pool_share" event of the session profile when profiling is enabled.
+static const char* const kOrtSessionOptionsConfigIntraOpThreadQuota = "session.intra_op_thread_quota";
+
+// Scheduling class of the parallel loops the session runs on the global intra-op thread pool.
+// "latency": the loops keep the threads they were given. The default.
+// "batch": while a "latency" loop runs on the pool, the helper threads of the session's loops stop claiming work at
+// the next chunk boundary and the rest of the loop is run by the thread running the session.
+// Only applies with global/env thread pools. Other values fail the initialization of the session with
+// INVALID_ARGUMENT.
+static const char* const kOrtSessionOptionsConfigIntraOpPriority = "session.intra_op_priority";
+
+// "1": the threads of the per-session thread pools that allow spinning tune how long they spin waiting for work from
+// the gaps they observed between pieces of work: long enough to avoid OS wake-ups when work arrives at a high rate,
+// and briefly when it arrives too rarely for spinning to pay off. Uses TPAUSE to idle while spinning where available.
+// "0": the threads spin for a fixed count. The default.
+static const char* const kOrtSessionOptionsConfigAdaptiveSpinning = "session.adaptive_spinning";
+
+// "1": the threads of the per-session intra-op thread pool count the tasks they run and the time they spend running
+// them, spinning and blocked, and the session logs the totals when it is destroyed.
+// "0": no counters are kept. The default, as they cost two clock reads per task.
+static const char* const kOrtSessionOptionsConfigIntraOpWorkerStats = "session.intra_op_worker_stats";
@@ -13,6 +13,7 @@ import java.nio.FloatBuffer;
 import java.nio.IntBuffer;
 import java.nio.LongBuffer;
 import java.nio.ShortBuffer;
+import java.util.Optional;
 
 /**
  * A Java object wrapping an OnnxTensor. Tensors are the main input to the library, and can also be
@@ -127,6 +128,37 @@ public class OnnxTensor implements OnnxValue {
     close(OnnxRuntime.ortApiHandle, nativeHandle);
   }
 
+  /**
+   * Wraps the native handle of this tensor in a new OnnxTensor which also holds a reference to the
+   * buffer backing {@code owner}. Used for tensors returned by the runtime that share the memory of
+   * {@code owner}, so that the buffer stays reachable for as long as they are. This tensor must not be
+   * used afterwards.
+   *
+   * @param owner The tensor whose buffer is shared.
+   * @return A tensor owning this tensor's native handle.
+   */
+  OnnxTensor withBufferOf(OnnxTensor owner) {
+    return new OnnxTensor(nativeHandle, allocatorHandle, info, owner.buffer);
+  }
+
+  /**
+   * Returns a view of the Java nio buffer backing this tensor, if it was created from one.
+   *
+   * <p>The tensor reads from and writes to this memory directly, so it can be refilled in place to
+   * reuse the tensor as an input across runs, or read after a run when the tensor is bound as a
+   * pre-allocated output of an {@link OrtIoBinding}. The returned buffer is a duplicate, its
+   * position and limit are independent of the buffer the tensor was created from.
+   *
+   * @return The backing buffer, or {@link Optional#empty()} if the tensor's memory is owned by the
+   *     runtime.
+   */
+  public Optional<Buffer> getBufferRef() {
+    if (buffer == null) {
+      return Optional.empty();
+    }
+    return Optional.of(OrtUtil.duplicate(buffer));
+  }
+
   /**
    * Returns a copy of the underlying OnnxTensor as a ByteBuffer.
    *
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates. All rights reserved.
+ * Licensed under the MIT License.
+ */
+package ai.onnxruntime;
+
+import java.io.IOException;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.Set;
+
+/**
+ * Binds inputs and outputs of an {@link OrtSession} to {@link OnnxTensor}s ahead of a run, wrapping
+ * the native OrtIoBinding.
+ *
+ * <p>A binding is created by {@link OrtSession#createIoBinding()} and can be reused across calls to
+ * {@link OrtSession#run(OrtIoBinding)}. Bound tensors are passed to the runtime without being
+ * converted or copied, so tensors created from direct buffers (see {@link
+ * OnnxTensor#createTensor(OrtEnvironment, java.nio.FloatBuffer, long[])}) can be refilled in place
+ * between runs. Outputs bound to such a tensor are written directly into its buffer.
+ *
+ * <p>The binding keeps a reference to each bound tensor, but does not own them. The tensors must
+ * not be closed while they are bound.
+ */
+public class OrtIoBinding implements AutoCloseable {
+
+  static {
+    try {
+      OnnxRuntime.init();
+    } catch (IOException e) {
+      throw new RuntimeException("Failed to load onnx-runtime library", e);
+    }
+  }
+
+  private final long nativeHandle;
+
+  private final OrtSession session;
+
+  private final OrtAllocator allocator;
+
+  private final Map<String, OnnxTensor> boundInputs = new LinkedHashMap<>();
+
+  /**
+   * The bound outputs in binding order, which is the order the native binding returns them in. A
+   * null value is an output bound to the CPU device which is allocated by the runtime.
+   */
+  private final Map<String, OnnxTensor> boundOutputs = new LinkedHashMap<>();
+
+  private boolean closed = false;
+
+  /**
+   * Creates a binding for the supplied session.
+   *
+   * @param session The session to bind to.
+   * @param sessionHandle The native session pointer.
+   * @param allocator The allocator used for runtime allocated outputs.
+   * @throws OrtException If the native binding could not be created.
+   */
+  OrtIoBinding(OrtSession session, long sessionHandle, OrtAllocator allocator) throws OrtException {
+    this.nativeHandle = createIoBinding(OnnxRuntime.ortApiHandle, sessionHandle);
+    this.session = session;
+    this.allocator = allocator;
+  }
+
+  long getNativeHandle() {
+    return nativeHandle;
+  }
+
+  OrtSession getSession() {
+    return session;
+  }
+
+  /**
+   * Binds a tensor to the named input, replacing any tensor already bound to it.
+   *
+   * @param name The input name.
+   * @param tensor The tensor to feed.
+   * @throws OrtException If the name is not an input of the session, or the native call failed.
+   */
+  public void bindInput(String name, OnnxTensor tensor) throws OrtException {
+    checkClosed();
+    if (!session.getInputNames().contains(name)) {
+      throw new OrtException(
+          "Unknown input name " + name + ", expected one of " + session.getInputNames());
+    }
+    bindInput(OnnxRuntime.ortApiHandle, nativeHandle, name, tensor.getNativeHandle());
+    boundInputs.put(name, tensor);
+  }
+
+  /**
+   * Binds a pre-allocated tensor to the named output. The runtime writes the output into the
+   * tensor, so its shape and type must match the output produced by the model.
+   *
+   * @param name The output name.
+   * @param tensor The tensor to write the output into.
+   * @throws OrtException If the name is not an output of the session, or the native call failed.
+   */
+  public void bindOutput(String name, OnnxTensor tensor) throws OrtException {
+    checkClosed();
+    checkOutputName(name);
+    bindOutput(OnnxRuntime.ortApiHandle, nativeHandle, name, tensor.getNativeHandle());
+    boundOutputs.put(name, tensor);
+  }
+
+  /**
+   * Binds the named output to CPU memory allocated by the runtime during the run. Use this for
+   * outputs whose shape is not known ahead of time, and fetch them with {@link #getOutputs()}.
+   *
+   * @param name The output name.
+   * @throws OrtException If the name is not an output of the session, or the native call failed.
+   */
+  public void bindOutput(String name) throws OrtException {
+    checkClosed();
+    checkOutputName(name);
+    bindOutputToCPU(OnnxRuntime.ortApiHandle, nativeHandle, name);
+    boundOutputs.put(name, null);
+  }
+
+  /**
+   * Returns the names of the bound inputs.
+   *
+   * @return The bound input names.
+   */
+  public Set<String> getBoundInputNames() {
+    return Collections.unmodifiableSet(boundInputs.keySet());
+  }
+
+  /**
+   * Returns the names of the bound outputs in the order they were bound.
+   *
+   * @return The bound output names.
+   */
+  public Set<String> getBoundOutputNames() {
+    return Collections.unmodifiableSet(boundOutputs.keySet());
+  }
+
+  /** Unbinds all the inputs. */
+  public void clearBoundInputs() {
+    checkClosed();
+    clearBoundInputs(OnnxRuntime.ortApiHandle, nativeHandle);
+    boundInputs.clear();
+  }
+
+  /** Unbinds all the outputs. */
+  public void clearBoundOutputs() {
+    checkClosed();
+    clearBoundOutputs(OnnxRuntime.ortApiHandle, nativeHandle);
+    boundOutputs.clear();
+  }
+
+  /**
+   * Returns the outputs produced by the last run using this binding, in binding order.
+   *
+   * <p>Outputs bound to a pre-allocated tensor are returned as new {@link OnnxTensor}s sharing that
+   * tensor's memory, which hold a reference to its buffer. It is usually cheaper to read the
+   * pre-allocated tensor's buffer directly. The returned {@link OrtSession.Result} must be closed by
+   * the caller.
+   *
+   * @return The bound outputs.
+   * @throws OrtException If the native call failed, or no run has completed using this binding.
+   */
+  public OrtSession.Result getOutputs() throws OrtException {
+    checkClosed();
+    String[] names = boundOutputs.keySet().toArray(new String[0]);
+    OnnxValue[] values = getOutputValues(OnnxRuntime.ortApiHandle, nativeHandle, allocator.handle);
+    if (values.length != names.length) {
+      for (OnnxValue v : values) {
+        v.close();
+      }
+      throw new OrtException("Expected " + names.length + " bound outputs, found " + values.length);
+    }
+    // The outputs bound to a pre-allocated tensor share its memory, so they keep its buffer alive.
+    for (int i = 0; i < names.length; i++) {
+      OnnxTensor bound = boundOutputs.get(names[i]);
+      if (bound != null && values[i] instanceof OnnxTensor) {
+        values[i] = ((OnnxTensor) values[i]).withBufferOf(bound);
+      }
+    }
+    return new OrtSession.Result(names, values);
+  }
+
+  /**
+   * Checks if the binding is closed.
+   *
+   * @return True if the binding is closed.
+   */
+  public boolean isClosed() {
+    return closed;
+  }
+
+  /**
+   * Closes the binding, releasing its native resources. The bound tensors are not closed.
+   *
+   * @throws OrtException If it failed to close.
+   */
+  @Override
+  public void close() throws OrtException {
+    if (!closed) {
+      boundInputs.clear();
+      boundOutputs.clear();
+      closeIoBinding(OnnxRuntime.ortApiHandle, nativeHandle);
+      closed = true;
+    } else {
+      throw new IllegalStateException("Trying to close an already closed OrtIoBinding.");
+    }
+  }
+
+  @Override
+  public String toString() {
+    return "OrtIoBinding(inputs="
+        + boundInputs.keySet()
+        + ",outputs="
+        + boundOutputs.keySet()
+        + ")";
+  }
+
+  /** Checks if the binding is closed and if so throws {@link IllegalStateException}. */
+  void checkClosed() {
+    if (closed) {
+      throw new IllegalStateException("Trying to use a closed OrtIoBinding");
+    }
+  }
+
+  private void checkOutputName(String name) throws OrtException {
+    if (!session.getOutputNames().contains(name)) {
+      throw new OrtException(
+          "Unknown output name " + name + ", expected one of " + session.getOutputNames());
+    }
+  }
+
+  private static native long createIoBinding(long apiHandle, long sessionHandle)
+      throws OrtException;
+
+  private native void bindInput(long apiHandle, long nativeHandle, String name, long valueHandle)
+      throws OrtException;
+
+  private native void bindOutput(long apiHandle, long nativeHandle, String name, long valueHandle)
+      throws OrtException;
+
+  private native void bindOutputToCPU(long apiHandle, long nativeHandle, String name)
+      throws OrtException;
+
+  private native void clearBoundInputs(long apiHandle, long nativeHandle);
+
+  private native void clearBoundOutputs(long apiHandle, long nativeHandle);
+
+  private native OnnxValue[] getOutputValues(
+      long apiHandle, long nativeHandle, long allocatorHandle) throws OrtException;
+
+  private native void closeIoBinding(long apiHandle, long nativeHandle);
+}
@@ -308,6 +308,64 @@ public class OrtSession implements AutoCloseable {
     }
   }
 
+  /**
+   * Creates an {@link OrtIoBinding} for this session. The binding must be closed before the
+   * session.
+   *
+   * @return A new, empty binding.
+   * @throws OrtException If the native binding could not be created.
+   */
+  public OrtIoBinding createIoBinding() throws OrtException {
+    if (!closed) {
+      return new OrtIoBinding(this, nativeHandle, allocator);
+    } else {
+      throw new IllegalStateException("Trying to create an OrtIoBinding on a closed OrtSession.");
+    }
+  }
+
+  /**
+   * Scores the inputs bound in the supplied binding, writing into its bound outputs.
+   *
+   * <p>Nothing is returned, outputs bound to pre-allocated tensors can be read from those tensors,
+   * and all the bound outputs are available from {@link OrtIoBinding#getOutputs()}.
+   *
+   * @param binding The binding to use.
+   * @throws OrtException If there was an error in native code, or the binding has no inputs or
+   *     outputs.
+   */
+  public void run(OrtIoBinding binding) throws OrtException {
+    run(binding, null);
+  }
+
+  /**
+   * Scores the inputs bound in the supplied binding, writing into its bound outputs.
+   *
+   * <p>Nothing is returned, outputs bound to pre-allocated tensors can be read from those tensors,
+   * and all the bound outputs are available from {@link OrtIoBinding#getOutputs()}.
+   *
+   * @param binding The binding to use.
+   * @param runOptions The RunOptions to control this run.
+   * @throws OrtException If there was an error in native code, or the binding has no inputs or
+   *     outputs.
+   */
+  public void run(OrtIoBinding binding, RunOptions runOptions) throws OrtException {
+    if (!closed) {
+      binding.checkClosed();
+      if (binding.getSession() != this) {
+        throw new IllegalArgumentException("The OrtIoBinding was created by a different session.");
+      }
+      if (binding.getBoundInputNames().isEmpty() || binding.getBoundOutputNames().isEmpty()) {
+        throw new OrtException(
+            "Unexpected binding, expected at least one bound input and output, found " + binding);
+      }
+      long runOptionsHandle = runOptions == null ? 0 : runOptions.nativeHandle;
+      runWithBinding(
+          OnnxRuntime.ortApiHandle, nativeHandle, binding.getNativeHandle(), runOptionsHandle);
+    } else {
+      throw new IllegalStateException("Trying to score a closed OrtSession.");
+    }
+  }
+
   /**
    * Gets the metadata for the currently loaded model.
    *
@@ -430,6 +488,20 @@ public class OrtSession implements AutoCloseable {
       long runOptionsHandle)
       throws OrtException;
 
+  /**
+   * The native run call using an IO binding. runOptionsHandle can be zero (i.e. the null pointer),
+   * but all other handles must be valid pointers.
+   *
+   * @param apiHandle The pointer to the api.
+   * @param nativeHandle The pointer to the session.
+   * @param bindingHandle The pointer to the IO binding.
+   * @param runOptionsHandle The (possibly null) pointer to the run options.
+   * @throws OrtException If the native call failed in some way.
+   */
+  private native void runWithBinding(
+      long apiHandle, long nativeHandle, long bindingHandle, long runOptionsHandle)
+      throws OrtException;
+
   private native long getProfilingStartTimeInNs(long apiHandle, long nativeHandle)
       throws OrtException;
 
@@ -5,6 +5,13 @@
 package ai.onnxruntime;
 
 import java.lang.reflect.Array;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
+import java.nio.LongBuffer;
+import java.nio.ShortBuffer;
 import java.util.ArrayList;
 import java.util.Arrays;
 
@@ -462,6 +469,34 @@ public final class OrtUtil {
     }
   }
 
+  /**
+   * Duplicates a nio buffer, keeping the byte order of a {@link ByteBuffer}.
+   *
+   * <p>{@link Buffer#duplicate()} is only available from Java 9, so this dispatches on the buffer
+   * types used by {@link OnnxTensor}.
+   *
+   * @param buffer The buffer to duplicate.
+   * @return A buffer sharing the same memory with an independent position and limit.
+   */
+  static Buffer duplicate(Buffer buffer) {
+    if (buffer instanceof ByteBuffer) {
+      ByteBuffer byteBuffer = (ByteBuffer) buffer;
+      return byteBuffer.duplicate().order(byteBuffer.order());
+    } else if (buffer instanceof FloatBuffer) {
+      return ((FloatBuffer) buffer).duplicate();
+    } else if (buffer instanceof DoubleBuffer) {
+      return ((DoubleBuffer) buffer).duplicate();
+    } else if (buffer instanceof ShortBuffer) {
+      return ((ShortBuffer) buffer).duplicate();
+    } else if (buffer instanceof IntBuffer) {
+      return ((IntBuffer) buffer).duplicate();
+    } else if (buffer instanceof LongBuffer) {
+      return ((LongBuffer) buffer).duplicate();
+    } else {
+      throw new IllegalArgumentException("Unsupported buffer type " + buffer.getClass());
+    }
+  }
+
   /**
    * Returns expected JDK map capacity for a given size, this factors in the default JDK load factor
    *
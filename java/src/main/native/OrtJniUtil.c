@@ -1074,6 +1074,8 @@ jint convertErrorCode(OrtErrorCode code) {
             return 10;
         case ORT_EP_FAIL:
             return 11;
+        case ORT_DEADLINE_EXCEEDED:
+            return 12;
         default:
             return -1; // Unknown error code
     }
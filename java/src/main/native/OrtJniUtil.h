@@ -11,6 +11,9 @@
 extern "C" {
 #endif
 
+/* Defined in ai_onnxruntime_OrtSession.c */
+extern const char * const ORTJNI_OnnxValueClassName;
+
 typedef struct {
   /* The number of dimensions in the Tensor */
   size_t dimensions;
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates. All rights reserved.
+ * Licensed under the MIT License.
+ */
+#include <jni.h>
+#include <string.h>
+#include "onnxruntime/core/session/onnxruntime_c_api.h"
+#include "OrtJniUtil.h"
+#include "ai_onnxruntime_OrtIoBinding.h"
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    createIoBinding
+ * Signature: (JJ)J
+ */
+JNIEXPORT jlong JNICALL Java_ai_onnxruntime_OrtIoBinding_createIoBinding
+    (JNIEnv * jniEnv, jclass jclazz, jlong apiHandle, jlong sessionHandle) {
+  (void) jclazz; // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  OrtIoBinding* binding = NULL;
+  checkOrtStatus(jniEnv, api, api->CreateIoBinding((OrtSession*) sessionHandle, &binding));
+  return (jlong) binding;
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    bindInput
+ * Signature: (JJLjava/lang/String;J)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_bindInput
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle, jstring name, jlong valueHandle) {
+  (void) jobj; // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  const char* nameStr = (*jniEnv)->GetStringUTFChars(jniEnv, name, NULL);
+  if (nameStr == NULL) {
+    return;  // OutOfMemoryError thrown
+  }
+  checkOrtStatus(jniEnv, api, api->BindInput((OrtIoBinding*) nativeHandle, nameStr, (const OrtValue*) valueHandle));
+  (*jniEnv)->ReleaseStringUTFChars(jniEnv, name, nameStr);
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    bindOutput
+ * Signature: (JJLjava/lang/String;J)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_bindOutput
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle, jstring name, jlong valueHandle) {
+  (void) jobj; // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  const char* nameStr = (*jniEnv)->GetStringUTFChars(jniEnv, name, NULL);
+  if (nameStr == NULL) {
+    return;  // OutOfMemoryError thrown
+  }
+  checkOrtStatus(jniEnv, api, api->BindOutput((OrtIoBinding*) nativeHandle, nameStr, (const OrtValue*) valueHandle));
+  (*jniEnv)->ReleaseStringUTFChars(jniEnv, name, nameStr);
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    bindOutputToCPU
+ * Signature: (JJLjava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_bindOutputToCPU
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle, jstring name) {
+  (void) jobj; // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  OrtMemoryInfo* memoryInfo = NULL;
+  OrtErrorCode code = checkOrtStatus(jniEnv, api, api->CreateCpuMemoryInfo(OrtDeviceAllocator, OrtMemTypeDefault, &memoryInfo));
+  if (code != ORT_OK) {
+    return;
+  }
+  // The binding only keeps the device described by the memory info, so it can be released straight away.
+  const char* nameStr = (*jniEnv)->GetStringUTFChars(jniEnv, name, NULL);
+  if (nameStr != NULL) {
+    checkOrtStatus(jniEnv, api, api->BindOutputToDevice((OrtIoBinding*) nativeHandle, nameStr, memoryInfo));
+    (*jniEnv)->ReleaseStringUTFChars(jniEnv, name, nameStr);
+  }  // else OutOfMemoryError thrown
+  api->ReleaseMemoryInfo(memoryInfo);
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    clearBoundInputs
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_clearBoundInputs
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle) {
+  (void) jniEnv; (void) jobj; // Required JNI parameters not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  api->ClearBoundInputs((OrtIoBinding*) nativeHandle);
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    clearBoundOutputs
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_clearBoundOutputs
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle) {
+  (void) jniEnv; (void) jobj; // Required JNI parameters not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  api->ClearBoundOutputs((OrtIoBinding*) nativeHandle);
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    getOutputValues
+ * Signature: (JJJ)[Lai/onnxruntime/OnnxValue;
+ */
+JNIEXPORT jobjectArray JNICALL Java_ai_onnxruntime_OrtIoBinding_getOutputValues
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle, jlong allocatorHandle) {
+  (void) jobj; // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  OrtAllocator* allocator = (OrtAllocator*) allocatorHandle;
+
+  OrtValue** outputValues = NULL;
+  size_t numOutputs = 0;
+  OrtErrorCode code = checkOrtStatus(jniEnv, api, api->GetBoundOutputValues((const OrtIoBinding*) nativeHandle, allocator, &outputValues, &numOutputs));
+  if (code != ORT_OK) {
+    return NULL;
+  }
+
+  jclass onnxValueClass = (*jniEnv)->FindClass(jniEnv, ORTJNI_OnnxValueClassName);
+  jobjectArray outputArray = NULL;
+  if (onnxValueClass != NULL) {
+    outputArray = (*jniEnv)->NewObjectArray(jniEnv, safecast_size_t_to_jsize(numOutputs), onnxValueClass, NULL);
+  }
+
+  // Convert the outputs into ONNXValues, which take ownership of the OrtValues.
+  size_t i = 0;
+  for (; outputArray != NULL && i < numOutputs; i++) {
+    jobject onnxValue = convertOrtValueToONNXValue(jniEnv, api, allocator, outputValues[i]);
+    if (onnxValue == NULL) {
+      break;  // exception thrown
+    }
+    (*jniEnv)->SetObjectArrayElement(jniEnv, outputArray, (jsize) i, onnxValue);
+  }
+  if (i < numOutputs) {
+    // An exception is pending so the array never reaches Java, release all the values including the
+    // ones already wrapped.
+    for (i = 0; i < numOutputs; i++) {
+      api->ReleaseValue(outputValues[i]);
+    }
+    outputArray = NULL;
+  }
+
+  if (outputValues != NULL) {
+    checkOrtStatus(jniEnv, api, api->AllocatorFree(allocator, outputValues));
+  }
+
+  return outputArray;
+}
+
+/*
+ * Class:     ai_onnxruntime_OrtIoBinding
+ * Method:    closeIoBinding
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtIoBinding_closeIoBinding
+    (JNIEnv * jniEnv, jobject jobj, jlong apiHandle, jlong nativeHandle) {
+  (void) jniEnv; (void) jobj; // Required JNI parameters not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*) apiHandle;
+  api->ReleaseIoBinding((OrtIoBinding*) nativeHandle);
+}
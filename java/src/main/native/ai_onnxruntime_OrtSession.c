@@ -438,6 +438,23 @@ cleanup_input_names:
   return outputArray;
 }
 
+/*
+ * Class:     ai_onnxruntime_OrtSession
+ * Method:    runWithBinding
+ * Signature: (JJJJ)V
+ * private native void runWithBinding(long apiHandle, long nativeHandle, long bindingHandle, long runOptionsHandle)
+ */
+JNIEXPORT void JNICALL Java_ai_onnxruntime_OrtSession_runWithBinding(JNIEnv* jniEnv, jobject jobj, jlong apiHandle,
+                                                                     jlong sessionHandle, jlong bindingHandle,
+                                                                     jlong runOptionsHandle) {
+  (void)jobj;  // Required JNI parameter not needed by functions which don't need to access their host object.
+  const OrtApi* api = (const OrtApi*)apiHandle;
+  OrtSession* session = (OrtSession*)sessionHandle;
+  const OrtIoBinding* binding = (const OrtIoBinding*)bindingHandle;
+  const OrtRunOptions* runOptions = (const OrtRunOptions*)runOptionsHandle;
+  checkOrtStatus(jniEnv, api, api->RunWithBinding(session, runOptions, binding));
+}
+
 /*
  * Class:     ai_onnxruntime_OrtSession
  * Method:    getProfilingStartTimeInNs
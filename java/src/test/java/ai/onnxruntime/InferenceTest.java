@@ -8,6 +8,7 @@ import static org.junit.jupiter.api.Assertions.assertArrayEquals;
 import static org.junit.jupiter.api.Assertions.assertEquals;
 import static org.junit.jupiter.api.Assertions.assertNotNull;
 import static org.junit.jupiter.api.Assertions.assertSame;
+import static org.junit.jupiter.api.Assertions.assertThrows;
 import static org.junit.jupiter.api.Assertions.assertTrue;
 import static org.junit.jupiter.api.Assertions.fail;
 
@@ -905,6 +906,68 @@ public class InferenceTest {
     }
   }
 
+  @Test
+  public void testIoBinding() throws OrtException {
+    // model takes 1x5 input of fixed type, echoes back
+    String modelPath = TestHelpers.getResourcePath("/test_types_FLOAT.pb").toString();
+
+    try (SessionOptions options = new SessionOptions();
+        OrtSession session = env.createSession(modelPath, options)) {
+      String inputName = session.getInputNames().iterator().next();
+      String outputName = session.getOutputNames().iterator().next();
+      long[] shape = new long[] {1, 5};
+      FloatBuffer inputBuffer =
+          ByteBuffer.allocateDirect(5 * 4).order(ByteOrder.nativeOrder()).asFloatBuffer();
+      FloatBuffer outputBuffer =
+          ByteBuffer.allocateDirect(5 * 4).order(ByteOrder.nativeOrder()).asFloatBuffer();
+
+      try (OnnxTensor input = OnnxTensor.createTensor(env, inputBuffer, shape);
+          OnnxTensor output = OnnxTensor.createTensor(env, outputBuffer, shape);
+          OrtIoBinding binding = session.createIoBinding()) {
+        assertTrue(input.getBufferRef().isPresent());
+        binding.bindInput(inputName, input);
+        binding.bindOutput(outputName, output);
+        assertThrows(OrtException.class, () -> binding.bindInput("not-an-input", input));
+
+        // Refill the input buffer in place, the binding is reused across runs.
+        for (int i = 0; i < 3; i++) {
+          float[] expected = new float[5];
+          for (int j = 0; j < expected.length; j++) {
+            expected[j] = i * 10.0f + j;
+          }
+          inputBuffer.clear();
+          inputBuffer.put(expected);
+          session.run(binding);
+
+          float[] actual = new float[5];
+          outputBuffer.clear();
+          outputBuffer.get(actual);
+          assertArrayEquals(expected, actual, 1e-6f);
+        }
+
+        // Outputs bound to a pre-allocated tensor share its buffer.
+        try (OrtSession.Result res = binding.getOutputs()) {
+          OnnxTensor shared = (OnnxTensor) res.get(outputName).get();
+          assertTrue(shared.getBufferRef().isPresent());
+          float[] resultArray = TestHelpers.flattenFloat(shared.getValue());
+          assertArrayEquals(new float[] {20.0f, 21.0f, 22.0f, 23.0f, 24.0f}, resultArray, 1e-6f);
+        }
+
+        // Outputs allocated by the runtime are fetched from the binding.
+        binding.clearBoundOutputs();
+        binding.bindOutput(outputName);
+        inputBuffer.clear();
+        inputBuffer.put(new float[] {1.0f, -2.0f, 3.0f, -4.0f, 5.0f});
+        session.run(binding);
+        try (OrtSession.Result res = binding.getOutputs()) {
+          assertEquals(1, res.size());
+          float[] resultArray = TestHelpers.flattenFloat(res.get(outputName).get().getValue());
+          assertArrayEquals(new float[] {1.0f, -2.0f, 3.0f, -4.0f, 5.0f}, resultArray, 1e-6f);
+        }
+      }
+    }
+  }
+
   @Test
   public void testRunOptions() throws OrtException {
     // model takes 1x5 input of fixed type, echoes back
@@ -0,0 +1,445 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+
+#include "attention_cpu_base.h"
+#include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/math/gemm_matmul_common.h"
+#include "core/util/math.h"
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// One post-LayerNorm transformer encoder layer, i.e. the subgraph
+//   Attention -> MatMul -> SkipLayerNormalization -> MatMul -> BiasGelu/FastGelu -> MatMul -> SkipLayerNormalization
+// that the BERT fusions leave behind, computed by a single kernel.
+//
+// The rows of the layer are processed in blocks sized to keep their intermediate results in the cache. Attention
+// needs the keys and values of all the rows of a sequence, so the layer runs in three stages: the QKV projection of
+// every block, the attention itself, and then everything after the attention in one parallel region, where each block
+// goes through the output projection, the first residual and LayerNorm, the feed forward network and the second
+// residual and LayerNorm before the next block is started. None of the intermediate results of that region is
+// written out as a (batch_size, sequence_length, hidden_size) tensor.
+//
+// With too few rows to give every thread a block of a useful size, the GEMMs of the blocks would degenerate to a
+// handful of rows, down to a single one, each run by one thread. In that case every stage processes all the rows at
+// once instead, with its GEMMs and row-wise steps parallelized over the thread pool as the unfused kernels do.
+class EncoderLayer final : public OpKernel, public AttentionCPUBase {
+ public:
+  explicit EncoderLayer(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                   int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
+ private:
+  enum InputIndex : int {
+    kInput = 0,
+    kQkvWeight = 1,
+    kQkvBias = 2,
+    kMaskIndex = 3,
+    kDenseWeight = 4,
+    kDenseBias = 5,
+    kAttentionGamma = 6,
+    kAttentionBeta = 7,
+    kFfnWeight1 = 8,
+    kFfnBias1 = 9,
+    kFfnWeight2 = 10,
+    kFfnBias2 = 11,
+    kFfnGamma = 12,
+    kFfnBeta = 13,
+  };
+
+  static constexpr int kWeightInputs[] = {kQkvWeight, kDenseWeight, kFfnWeight1, kFfnWeight2};
+  static constexpr size_t kNumWeights = sizeof(kWeightInputs) / sizeof(kWeightInputs[0]);
+
+  static int WeightSlot(int input_idx) {
+    for (size_t i = 0; i < kNumWeights; ++i) {
+      if (kWeightInputs[i] == input_idx) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  // Returns the shape of a weight, which is no longer an input of the kernel once it has been pre-packed.
+  const TensorShape& WeightShape(OpKernelContext* context, int input_idx) const {
+    const int slot = WeightSlot(input_idx);
+    return packed_weights_[slot] ? weight_shapes_[slot] : context->Input<Tensor>(input_idx)->Shape();
+  }
+
+  // C(M, N) = A(M, K) x W(K, N), using the pre-packed form of the weight when there is one. Single threaded if tp is
+  // nullptr.
+  void MatMul(OpKernelContext* context, int input_idx, const float* A, size_t M, size_t K, size_t N,
+              float* C, ThreadPool* tp) const;
+
+  // output = LayerNorm(input + skip + bias), as computed by SkipLayerNormalization. output may alias input.
+  static void SkipLayerNorm(const float* input, const float* skip, const float* bias,
+                            const float* gamma, const float* beta, float epsilon, int64_t hidden_size,
+                            float* output);
+
+  // data = Gelu(data + bias), as computed by BiasGelu or FastGelu. temp holds count elements.
+  void AddBiasGelu(float* data, const float* bias, float* temp, int64_t count) const;
+
+  float attention_epsilon_;
+  float ffn_epsilon_;
+  bool use_fast_gelu_;
+
+  BufferUniquePtr packed_weights_[kNumWeights];
+  TensorShape weight_shapes_[kNumWeights];
+};
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    EncoderLayer,
+    kMSDomain,
+    1,
+    float,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    EncoderLayer);
+
+namespace {
+
+// FastGelu uses approximation for Gelu. The formula is 0.5 * (1 + Tanh(x * (C * x * x + B))) * x.
+constexpr float B = 0.7978845608028654f;    // sqrt(2.0 / M_PI)
+constexpr float C = 0.035677408136300125f;  // 0.044715 * sqrt(2.0 / M_PI)
+
+// Target size of the intermediate results of a block of rows, so that a block stays in the L2 cache while it goes
+// through the stages of the layer.
+constexpr size_t kBlockBytes = 256 * 1024;
+
+// Smallest number of rows per thread for which the layer is processed block by block. Below it the GEMMs of a block
+// are too narrow to keep a core busy, and splitting them over the threads is faster.
+constexpr size_t kMinRowsPerThread = 16;
+
+// Returns whether the blocks of rows are run in parallel, rather than each stage being run over all the rows with
+// parallel GEMMs.
+bool ParallelizeOverBlocks(size_t rows, ThreadPool* tp) {
+  const size_t dop = static_cast<size_t>(ThreadPool::DegreeOfParallelism(tp));
+  return dop == 1 || rows >= dop * kMinRowsPerThread;
+}
+
+size_t RowsPerBlock(size_t rows, size_t row_bytes, ThreadPool* tp) {
+  const size_t dop = static_cast<size_t>(ThreadPool::DegreeOfParallelism(tp));
+  const size_t rows_per_block = std::max<size_t>(kBlockBytes / row_bytes, 1);
+  // Smaller blocks when there are too few rows to give every thread one.
+  return std::max<size_t>(std::min(rows_per_block, (rows + dop - 1) / dop), 1);
+}
+
+Status CheckVector(const Tensor* tensor, int64_t size, const char* name) {
+  if (tensor != nullptr &&
+      (tensor->Shape().NumDimensions() != 1 || tensor->Shape()[0] != size)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input '", name, "' is expected to have shape (", size,
+                           "), got ", tensor->Shape());
+  }
+  return Status::OK();
+}
+
+Status CheckMatrix(const TensorShape& shape, int64_t rows, int64_t cols, const char* name) {
+  if (shape.NumDimensions() != 2 || shape[0] != rows || (cols >= 0 && shape[1] != cols)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input '", name, "' is expected to have shape (", rows,
+                           ", ", cols >= 0 ? std::to_string(cols) : "intermediate_size", "), got ", shape);
+  }
+  return Status::OK();
+}
+
+const float* DataOrNull(const Tensor* tensor) {
+  return tensor != nullptr ? tensor->Data<float>() : nullptr;
+}
+
+}  // namespace
+
+EncoderLayer::EncoderLayer(const OpKernelInfo& info) : OpKernel(info), AttentionCPUBase(info) {
+  ORT_ENFORCE(qkv_hidden_sizes_.empty(), "EncoderLayer does not support qkv_hidden_sizes");
+  ORT_ENFORCE(info.GetAttr<float>("attention_epsilon", &attention_epsilon_).IsOK() && attention_epsilon_ >= 0);
+  ORT_ENFORCE(info.GetAttr<float>("ffn_epsilon", &ffn_epsilon_).IsOK() && ffn_epsilon_ >= 0);
+
+  const std::string activation = info.GetAttrOrDefault<std::string>("activation", "gelu");
+  ORT_ENFORCE(activation == "gelu" || activation == "fast_gelu", "Unsupported activation: ", activation);
+  use_fast_gelu_ = activation == "fast_gelu";
+}
+
+Status EncoderLayer::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                             /*out*/ bool& is_packed,
+                             /*out*/ PrePackedWeights* prepacked_weights) {
+  is_packed = false;
+
+  const int slot = WeightSlot(input_idx);
+  if (slot < 0) {
+    return Status::OK();
+  }
+
+  size_t packed_b_size;
+  is_packed = GemmPackBFp32(alloc, tensor, false, packed_weights_[slot], packed_b_size, weight_shapes_[slot]);
+  if (is_packed && prepacked_weights != nullptr) {
+    prepacked_weights->buffers_.push_back(std::move(packed_weights_[slot]));
+    prepacked_weights->buffer_sizes_.push_back(packed_b_size);
+  }
+  return Status::OK();
+}
+
+Status EncoderLayer::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                               int input_idx,
+                                               /*out*/ bool& used_shared_buffers) {
+  used_shared_buffers = false;
+
+  const int slot = WeightSlot(input_idx);
+  if (slot >= 0) {
+    used_shared_buffers = true;
+    packed_weights_[slot] = std::move(prepacked_buffers[0]);
+  }
+  return Status::OK();
+}
+
+void EncoderLayer::MatMul(OpKernelContext* context, int input_idx, const float* A, size_t M, size_t K, size_t N,
+                          float* C, ThreadPool* tp) const {
+  const auto& packed_weight = packed_weights_[WeightSlot(input_idx)];
+  if (packed_weight) {
+    MlasGemm(CblasNoTrans, M, N, K, 1.0f, A, K, packed_weight.get(), 0.0f, C, N, tp);
+  } else {
+    MlasGemm(CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K,
+             context->Input<Tensor>(input_idx)->Data<float>(), N, 0.0f, C, N, tp);
+  }
+}
+
+void EncoderLayer::SkipLayerNorm(const float* input, const float* skip, const float* bias,
+                                 const float* gamma, const float* beta, float epsilon, int64_t hidden_size,
+                                 float* output) {
+  float mean = 0;
+  float mean_square = 0;
+
+  for (int64_t h = 0; h < hidden_size; h++) {
+    float value = input[h] + skip[h];
+    if (nullptr != bias) {
+      value += bias[h];
+    }
+    output[h] = value;
+    mean += value;
+    mean_square += value * value;
+  }
+
+  mean = mean / hidden_size;
+  mean_square = std::sqrt(mean_square / hidden_size - mean * mean + epsilon);
+
+  for (int64_t h = 0; h < hidden_size; h++) {
+    if (nullptr == beta) {
+      output[h] = (output[h] - mean) / mean_square * gamma[h];
+    } else {
+      output[h] = (output[h] - mean) / mean_square * gamma[h] + beta[h];
+    }
+  }
+}
+
+void EncoderLayer::AddBiasGelu(float* data, const float* bias, float* temp, int64_t count) const {
+  for (int64_t i = 0; i < count; i++) {
+    const float value = bias != nullptr ? data[i] + bias[i] : data[i];
+    data[i] = use_fast_gelu_ ? value * (C * value * value + B) : value * static_cast<float>(M_SQRT1_2);
+    temp[i] = value * 0.5f;
+  }
+
+  if (use_fast_gelu_) {
+    MlasComputeTanh(data, data, count);
+  } else {
+    MlasComputeErf(data, data, count);
+  }
+
+  for (int64_t i = 0; i < count; i++) {
+    data[i] = temp[i] * (data[i] + 1.0f);
+  }
+}
+
+Status EncoderLayer::Compute(OpKernelContext* context) const {
+  const Tensor* input = context->Input<Tensor>(kInput);
+  const Tensor* qkv_bias = context->Input<Tensor>(kQkvBias);
+  const Tensor* mask_index = context->Input<Tensor>(kMaskIndex);
+  const Tensor* dense_bias = context->Input<Tensor>(kDenseBias);
+  const Tensor* attention_gamma = context->Input<Tensor>(kAttentionGamma);
+  const Tensor* attention_beta = context->Input<Tensor>(kAttentionBeta);
+  const Tensor* ffn_bias1 = context->Input<Tensor>(kFfnBias1);
+  const Tensor* ffn_bias2 = context->Input<Tensor>(kFfnBias2);
+  const Tensor* ffn_gamma = context->Input<Tensor>(kFfnGamma);
+  const Tensor* ffn_beta = context->Input<Tensor>(kFfnBeta);
+
+  const TensorShape& qkv_weight_shape = WeightShape(context, kQkvWeight);
+  ORT_RETURN_IF_ERROR(CheckInputs(input->Shape(), qkv_weight_shape, qkv_bias->Shape(), mask_index, nullptr, nullptr));
+
+  const auto& dims = input->Shape().GetDims();
+  const int batch_size = static_cast<int>(dims[0]);
+  const int sequence_length = static_cast<int>(dims[1]);
+  const int64_t hidden_size = qkv_weight_shape[1] / 3;
+  const int head_size = static_cast<int>(hidden_size) / num_heads_;
+  if (dims[2] != hidden_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "Input 'input' dimension 2 should be the hidden size of the attention, got ", dims[2]);
+  }
+
+  const TensorShape& ffn_weight1_shape = WeightShape(context, kFfnWeight1);
+  ORT_RETURN_IF_ERROR(CheckMatrix(WeightShape(context, kDenseWeight), hidden_size, hidden_size, "dense_weight"));
+  ORT_RETURN_IF_ERROR(CheckMatrix(ffn_weight1_shape, hidden_size, -1, "ffn_weight1"));
+  const int64_t intermediate_size = ffn_weight1_shape[1];
+  ORT_RETURN_IF_ERROR(CheckMatrix(WeightShape(context, kFfnWeight2), intermediate_size, hidden_size, "ffn_weight2"));
+  ORT_RETURN_IF_ERROR(CheckVector(dense_bias, hidden_size, "dense_bias"));
+  ORT_RETURN_IF_ERROR(CheckVector(attention_gamma, hidden_size, "attention_gamma"));
+  ORT_RETURN_IF_ERROR(CheckVector(attention_beta, hidden_size, "attention_beta"));
+  ORT_RETURN_IF_ERROR(CheckVector(ffn_bias1, intermediate_size, "ffn_bias1"));
+  ORT_RETURN_IF_ERROR(CheckVector(ffn_bias2, hidden_size, "ffn_bias2"));
+  ORT_RETURN_IF_ERROR(CheckVector(ffn_gamma, hidden_size, "ffn_gamma"));
+  ORT_RETURN_IF_ERROR(CheckVector(ffn_beta, hidden_size, "ffn_beta"));
+
+  Tensor* output = context->Output(0, input->Shape());
+  const size_t rows = SafeInt<size_t>(batch_size) * sequence_length;
+  if (rows == 0) {
+    return Status::OK();
+  }
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+  auto* tp = context->GetOperatorThreadPool();
+
+  const size_t H = static_cast<size_t>(hidden_size);
+  const size_t I = static_cast<size_t>(intermediate_size);
+  const float* input_data = input->Data<float>();
+
+  // Q, K and V with shape (B, N, S, H) each
+  auto qkv_data = allocator->Alloc(SafeInt<size_t>(rows) * 3 * H * sizeof(float));
+  BufferUniquePtr qkv_buffer(qkv_data, BufferDeleter(allocator));
+  float* QKV[3] = {static_cast<float*>(qkv_data),
+                   static_cast<float*>(qkv_data) + rows * H,
+                   static_cast<float*>(qkv_data) + 2 * rows * H};
+
+  // Either the blocks run in parallel, each single threaded, or there is a single block of all the rows whose GEMMs
+  // and row-wise steps run in parallel.
+  const bool over_blocks = ParallelizeOverBlocks(rows, tp);
+  ThreadPool* block_tp = over_blocks ? tp : nullptr;
+  ThreadPool* inner_tp = over_blocks ? nullptr : tp;
+
+  {
+    // Projects a block of rows at once into a scratch buffer, which is then scattered to the heads with the bias.
+    const size_t rows_per_block = over_blocks ? RowsPerBlock(rows, 3 * H * sizeof(float), tp) : rows;
+    const std::ptrdiff_t num_blocks = static_cast<std::ptrdiff_t>((rows + rows_per_block - 1) / rows_per_block);
+    const double cost = static_cast<double>(rows_per_block) * 3 * H * H;
+    const float* bias_data = qkv_bias->Data<float>();
+
+    ThreadPool::TryParallelFor(block_tp, num_blocks, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      auto scratch_data = allocator->Alloc(SafeInt<size_t>(rows_per_block) * 3 * H * sizeof(float));
+      BufferUniquePtr scratch_buffer(scratch_data, BufferDeleter(allocator));
+      float* scratch = static_cast<float*>(scratch_data);
+
+      for (std::ptrdiff_t block = begin; block != end; ++block) {
+        const size_t row_begin = static_cast<size_t>(block) * rows_per_block;
+        const size_t row_count = std::min(rows_per_block, rows - row_begin);
+        MatMul(context, kQkvWeight, input_data + row_begin * H, row_count, H, 3 * H, scratch, inner_tp);
+
+        ThreadPool::TryParallelFor(
+            inner_tp, static_cast<std::ptrdiff_t>(row_count), static_cast<double>(3 * H),
+            [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+              for (size_t r = static_cast<size_t>(first); r < static_cast<size_t>(last); ++r) {
+                const size_t batch_index = (row_begin + r) / sequence_length;
+                const size_t seq_index = (row_begin + r) % sequence_length;
+                for (int qkv_index = 0; qkv_index < 3; ++qkv_index) {
+                  for (int head_index = 0; head_index < num_heads_; ++head_index) {
+                    const size_t column = qkv_index * H + static_cast<size_t>(head_index) * head_size;
+                    const float* src = scratch + r * 3 * H + column;
+                    const float* bias = bias_data + column;
+                    float* dest = QKV[qkv_index] +
+                                  ((batch_index * num_heads_ + head_index) * sequence_length + seq_index) * head_size;
+                    for (int h = 0; h < head_size; ++h) {
+                      dest[h] = src[h] + bias[h];
+                    }
+                  }
+                }
+              }
+            });
+      }
+    });
+  }
+
+  // Attention output with shape (B, S, NH)
+  Tensor attention_output(input->DataType(), input->Shape(), allocator);
+  ORT_RETURN_IF_ERROR(ApplyAttention(QKV[0], QKV[1], QKV[2], mask_index, nullptr, &attention_output,
+                                     batch_size, sequence_length, head_size, head_size, static_cast<int>(H),
+                                     nullptr, context));
+  qkv_buffer.reset();
+
+  {
+    // Each block keeps the output of the first LayerNorm and the hidden layer of the feed forward network. The
+    // projections are accumulated in the rows of the output.
+    const size_t rows_per_block = over_blocks ? RowsPerBlock(rows, (H + I) * sizeof(float), tp) : rows;
+    const std::ptrdiff_t num_blocks = static_cast<std::ptrdiff_t>((rows + rows_per_block - 1) / rows_per_block);
+    const double cost = static_cast<double>(rows_per_block) * (H * H + 2 * H * I);
+
+    const float* attention_data = attention_output.Data<float>();
+    const float* dense_bias_data = DataOrNull(dense_bias);
+    const float* attention_gamma_data = attention_gamma->Data<float>();
+    const float* attention_beta_data = DataOrNull(attention_beta);
+    const float* ffn_bias1_data = DataOrNull(ffn_bias1);
+    const float* ffn_bias2_data = DataOrNull(ffn_bias2);
+    const float* ffn_gamma_data = ffn_gamma->Data<float>();
+    const float* ffn_beta_data = DataOrNull(ffn_beta);
+    float* output_data = output->MutableData<float>();
+
+    ThreadPool::TryParallelFor(block_tp, num_blocks, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      auto scratch_data = allocator->Alloc(SafeInt<size_t>(rows_per_block) * (H + I) * sizeof(float));
+      BufferUniquePtr scratch_buffer(scratch_data, BufferDeleter(allocator));
+      float* normalized = static_cast<float*>(scratch_data);
+      float* hidden = normalized + rows_per_block * H;
+
+      for (std::ptrdiff_t block = begin; block != end; ++block) {
+        const size_t row_begin = static_cast<size_t>(block) * rows_per_block;
+        const size_t row_count = std::min(rows_per_block, rows - row_begin);
+        const std::ptrdiff_t row_total = static_cast<std::ptrdiff_t>(row_count);
+        float* y = output_data + row_begin * H;
+
+        MatMul(context, kDenseWeight, attention_data + row_begin * H, row_count, H, H, y, inner_tp);
+        ThreadPool::TryParallelFor(inner_tp, row_total, static_cast<double>(5 * H),
+                                   [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                     for (size_t r = static_cast<size_t>(first); r < static_cast<size_t>(last); ++r) {
+                                       SkipLayerNorm(y + r * H, input_data + (row_begin + r) * H, dense_bias_data,
+                                                     attention_gamma_data, attention_beta_data, attention_epsilon_,
+                                                     hidden_size, normalized + r * H);
+                                     }
+                                   });
+
+        MatMul(context, kFfnWeight1, normalized, row_count, H, I, hidden, inner_tp);
+        ThreadPool::TryParallelFor(inner_tp, row_total, static_cast<double>(20 * I),
+                                   [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                     // A row of temporaries for the activation.
+                                     auto temp_data = allocator->Alloc(SafeInt<size_t>(I) * sizeof(float));
+                                     BufferUniquePtr temp_buffer(temp_data, BufferDeleter(allocator));
+                                     float* temp = static_cast<float*>(temp_data);
+                                     for (size_t r = static_cast<size_t>(first); r < static_cast<size_t>(last); ++r) {
+                                       AddBiasGelu(hidden + r * I, ffn_bias1_data, temp, intermediate_size);
+                                     }
+                                   });
+
+        MatMul(context, kFfnWeight2, hidden, row_count, I, H, y, inner_tp);
+        ThreadPool::TryParallelFor(inner_tp, row_total, static_cast<double>(5 * H),
+                                   [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                     for (size_t r = static_cast<size_t>(first); r < static_cast<size_t>(last); ++r) {
+                                       SkipLayerNorm(y + r * H, normalized + r * H, ffn_bias2_data,
+                                                     ffn_gamma_data, ffn_beta_data, ffn_epsilon_, hidden_size,
+                                                     y + r * H);
+                                     }
+                                   });
+      }
+    });
+  }
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,362 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/fused_elementwise.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/util/math_cpuonly.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_OPERATOR_KERNEL_EX(
+    FusedElementwise,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", BuildKernelDefConstraints<float, bool>())
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<float>()),
+    FusedElementwise);
+
+namespace {
+
+using OpCode = FusedElementwise::OpCode;
+
+// Number of elements evaluated at a time. The operands and the result of every instruction for a block fit in the
+// L1 cache together.
+constexpr int64_t kBlockSize = 512;
+
+struct OpDesc {
+  const char* name;
+  OpCode op;
+  int arity;
+};
+
+constexpr OpDesc kOpDescs[] = {
+    {"Add", OpCode::Add, 2},
+    {"Sub", OpCode::Sub, 2},
+    {"Mul", OpCode::Mul, 2},
+    {"Div", OpCode::Div, 2},
+    {"Pow", OpCode::Pow, 2},
+    {"Erf", OpCode::Erf, 1},
+    {"Sqrt", OpCode::Sqrt, 1},
+    {"Reciprocal", OpCode::Reciprocal, 1},
+    {"Neg", OpCode::Neg, 1},
+    {"Abs", OpCode::Abs, 1},
+    {"Exp", OpCode::Exp, 1},
+    {"Tanh", OpCode::Tanh, 1},
+    {"Sigmoid", OpCode::Sigmoid, 1},
+    {"Relu", OpCode::Relu, 1},
+    {"Where", OpCode::Where, 3},
+};
+
+const OpDesc* GetOpDesc(const std::string& name) {
+  for (const auto& desc : kOpDescs) {
+    if (name == desc.name) {
+      return &desc;
+    }
+  }
+  return nullptr;
+}
+
+// Computes n elements of one instruction. out may alias an operand, as every output element only depends on the
+// operand elements at the same position. Every operator uses the same Eigen expression or MLAS routine as the float
+// implementation of its standalone kernel (e.g. the float Exp functor calls MlasComputeExp), so fusing operators does
+// not change the results.
+void EvaluateInstruction(OpCode op, const float* a, const float* b, const float* c, bool b_is_uniform,
+                         float* out, size_t n) {
+  const auto N = static_cast<Eigen::Index>(n);
+  EigenVectorArrayMap<float> y(out, N);
+  switch (op) {
+    case OpCode::Add:
+      y = ConstEigenVectorArrayMap<float>(a, N) + ConstEigenVectorArrayMap<float>(b, N);
+      break;
+    case OpCode::Sub:
+      y = ConstEigenVectorArrayMap<float>(a, N) - ConstEigenVectorArrayMap<float>(b, N);
+      break;
+    case OpCode::Mul:
+      y = ConstEigenVectorArrayMap<float>(a, N) * ConstEigenVectorArrayMap<float>(b, N);
+      break;
+    case OpCode::Div:
+      y = ConstEigenVectorArrayMap<float>(a, N) / ConstEigenVectorArrayMap<float>(b, N);
+      break;
+    case OpCode::Pow:
+      // same special cases as the Pow kernel for the common squared and cubed inputs
+      if (b_is_uniform && b[0] == 2.0f) {
+        y = ConstEigenVectorArrayMap<float>(a, N).square();
+      } else if (b_is_uniform && b[0] == 3.0f) {
+        y = ConstEigenVectorArrayMap<float>(a, N).cube();
+      } else {
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = std::pow(a[i], b[i]);
+        }
+      }
+      break;
+    case OpCode::Erf:
+      MlasComputeErf(a, out, n);
+      break;
+    case OpCode::Sqrt:
+      y = ConstEigenVectorArrayMap<float>(a, N).sqrt();
+      break;
+    case OpCode::Reciprocal:
+      y = ConstEigenVectorArrayMap<float>(a, N).inverse();
+      break;
+    case OpCode::Neg:
+      y = -ConstEigenVectorArrayMap<float>(a, N);
+      break;
+    case OpCode::Abs:
+      y = ConstEigenVectorArrayMap<float>(a, N).abs();
+      break;
+    case OpCode::Exp:
+      MlasComputeExp(a, out, n);
+      break;
+    case OpCode::Tanh:
+      MlasComputeTanh(a, out, n);
+      break;
+    case OpCode::Sigmoid:
+      MlasComputeLogistic(a, out, n);
+      break;
+    case OpCode::Relu:
+      y = ConstEigenVectorArrayMap<float>(a, N).cwiseMax(0.0f);
+      break;
+    case OpCode::Where:
+      for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] != 0.0f ? b[i] : c[i];
+      }
+      break;
+  }
+}
+
+}  // namespace
+
+FusedElementwise::FusedElementwise(const OpKernelInfo& info) : OpKernel(info) {
+  input_count_ = static_cast<size_t>(info.GetInputCount());
+
+  std::vector<std::string> ops;
+  std::vector<int64_t> operands;
+  ORT_ENFORCE(info.GetAttrs<std::string>("ops", ops).IsOK(), "FusedElementwise requires the ops attribute.");
+  ORT_ENFORCE(info.GetAttrs<int64_t>("operands", operands).IsOK(), "FusedElementwise requires the operands attribute.");
+  ORT_ENFORCE(!ops.empty() && operands.size() == ops.size() * 3,
+              "FusedElementwise expects three operands for each of its ", ops.size(), " instructions, got ",
+              operands.size());
+
+  const size_t value_count = input_count_ + ops.size();
+  std::vector<size_t> last_use(value_count, 0);
+
+  program_.reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const OpDesc* desc = GetOpDesc(ops[i]);
+    ORT_ENFORCE(desc != nullptr, "FusedElementwise does not support the operator ", ops[i]);
+
+    Instruction instruction{desc->op, {-1, -1, -1}, -1};
+    for (int j = 0; j < 3; ++j) {
+      const int64_t operand = operands[i * 3 + j];
+      if (j < desc->arity) {
+        // an instruction can only use the inputs and the results of the instructions before it
+        ORT_ENFORCE(operand >= 0 && static_cast<size_t>(operand) < input_count_ + i,
+                    "Invalid operand ", operand, " for instruction ", i, " of FusedElementwise.");
+        instruction.operands[j] = static_cast<int>(operand);
+        last_use[static_cast<size_t>(operand)] = i;
+      } else {
+        ORT_ENFORCE(operand == -1, "Instruction ", i, " of FusedElementwise uses too many operands.");
+      }
+    }
+    program_.push_back(instruction);
+  }
+
+  // Assign the scratch buffers. The operands used for the last time are released first, so an instruction can write
+  // its result over one of them.
+  std::vector<int> free_buffers;
+  std::vector<bool> released(value_count, false);
+  int next_buffer = static_cast<int>(input_count_);
+  for (size_t i = 0; i < program_.size(); ++i) {
+    auto& instruction = program_[i];
+    for (int operand : instruction.operands) {
+      if (operand >= static_cast<int>(input_count_) && last_use[operand] == i && !released[operand]) {
+        released[operand] = true;
+        free_buffers.push_back(program_[operand - input_count_].buffer);
+      }
+    }
+
+    if (i + 1 == program_.size()) {
+      instruction.buffer = -1;
+    } else if (!free_buffers.empty()) {
+      instruction.buffer = free_buffers.back();
+      free_buffers.pop_back();
+    } else {
+      instruction.buffer = next_buffer++;
+    }
+  }
+
+  buffer_count_ = static_cast<size_t>(next_buffer);
+}
+
+Status FusedElementwise::Compute(OpKernelContext* context) const {
+  InlinedVector<const Tensor*> inputs(input_count_);
+  size_t rank = 0;
+  for (size_t i = 0; i < input_count_; ++i) {
+    inputs[i] = context->Input<Tensor>(static_cast<int>(i));
+    rank = std::max(rank, inputs[i]->Shape().NumDimensions());
+  }
+
+  // multidirectional broadcast of all the inputs
+  TensorShapeVector output_dims(rank, 1);
+  for (const auto* input : inputs) {
+    const auto input_dims = input->Shape().GetDims();
+    const size_t offset = rank - input_dims.size();
+    for (size_t d = 0; d < input_dims.size(); ++d) {
+      auto& output_dim = output_dims[offset + d];
+      if (input_dims[d] == output_dim || input_dims[d] == 1) {
+        continue;
+      }
+      ORT_RETURN_IF_NOT(output_dim == 1, "FusedElementwise: input shapes ", inputs[0]->Shape(), " and ",
+                        input->Shape(), " can not be broadcast together.");
+      output_dim = input_dims[d];
+    }
+  }
+
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+  const int64_t output_size = Y->Shape().Size();
+  if (output_size == 0) {
+    return Status::OK();
+  }
+
+  // Strides of the inputs over the output dimensions, which are 0 along broadcast dimensions. Adjacent dimensions
+  // are merged when every input is either contiguous or broadcast across both of them, so the innermost dimension
+  // is as long as possible. dims is innermost first, and input_strides holds the strides of the inputs for dims[k]
+  // starting at k * input_count_.
+  InlinedVector<int64_t> dims;
+  InlinedVector<int64_t> input_strides;
+  InlinedVector<int64_t> strides(input_count_, 0);
+  InlinedVector<int64_t> sizes(input_count_, 1);
+  for (size_t d = rank; d-- > 0;) {
+    for (size_t i = 0; i < input_count_; ++i) {
+      const auto input_dims = inputs[i]->Shape().GetDims();
+      const size_t offset = rank - input_dims.size();
+      const int64_t input_dim = d >= offset ? input_dims[d - offset] : 1;
+      strides[i] = input_dim == 1 ? 0 : sizes[i];
+      sizes[i] *= input_dim;
+    }
+
+    if (output_dims[d] == 1) {
+      continue;
+    }
+
+    if (!dims.empty()) {
+      const size_t last = dims.size() - 1;
+      bool can_merge = true;
+      for (size_t i = 0; i < input_count_ && can_merge; ++i) {
+        can_merge = strides[i] == input_strides[last * input_count_ + i] * dims[last];
+      }
+      if (can_merge) {
+        dims[last] *= output_dims[d];
+        continue;
+      }
+    }
+
+    dims.push_back(output_dims[d]);
+    input_strides.insert(input_strides.end(), strides.begin(), strides.end());
+  }
+
+  if (dims.empty()) {
+    dims.push_back(1);
+    input_strides.assign(input_count_, 0);
+  }
+
+  // Every work item is a block of up to kBlockSize elements of one row, a row being the innermost merged dimension.
+  // Along a row an input is either contiguous or a single broadcast value.
+  const int64_t row_size = dims[0];
+  const int64_t blocks_per_row = (row_size + kBlockSize - 1) / kBlockSize;
+  const int64_t block_count = (output_size / row_size) * blocks_per_row;
+
+  float* output_data = Y->MutableData<float>();
+  const size_t value_count = input_count_ + program_.size();
+
+  const double block_elements = static_cast<double>(std::min<int64_t>(row_size, kBlockSize));
+  const TensorOpCost cost{block_elements * sizeof(float) * input_count_,
+                          block_elements * sizeof(float),
+                          block_elements * program_.size() * 4.0};
+
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), block_count, cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        std::vector<float> buffers(buffer_count_ * static_cast<size_t>(kBlockSize));
+        InlinedVector<const float*> values(value_count);
+        InlinedVector<bool> is_uniform(value_count);
+        InlinedVector<int64_t> offsets(input_count_);
+
+        for (std::ptrdiff_t block = first; block < last; ++block) {
+          int64_t row = block / blocks_per_row;
+          const int64_t begin = (block % blocks_per_row) * kBlockSize;
+          const size_t n = static_cast<size_t>(std::min<int64_t>(kBlockSize, row_size - begin));
+          float* output = output_data + (row * row_size + begin);
+
+          for (size_t i = 0; i < input_count_; ++i) {
+            offsets[i] = begin * input_strides[i];
+          }
+          for (size_t k = 1; k < dims.size() && row > 0; ++k) {
+            const int64_t index = row % dims[k];
+            row /= dims[k];
+            for (size_t i = 0; i < input_count_; ++i) {
+              offsets[i] += index * input_strides[k * input_count_ + i];
+            }
+          }
+
+          for (size_t i = 0; i < input_count_; ++i) {
+            float* buffer = buffers.data() + i * static_cast<size_t>(kBlockSize);
+            const bool is_broadcast = input_strides[i] == 0;
+            is_uniform[i] = is_broadcast;
+            if (inputs[i]->IsDataType<bool>()) {
+              const bool* condition = inputs[i]->Data<bool>() + offsets[i];
+              if (is_broadcast) {
+                std::fill_n(buffer, n, *condition ? 1.0f : 0.0f);
+              } else {
+                for (size_t j = 0; j < n; ++j) {
+                  buffer[j] = condition[j] ? 1.0f : 0.0f;
+                }
+              }
+              values[i] = buffer;
+            } else {
+              const float* data = inputs[i]->Data<float>() + offsets[i];
+              if (is_broadcast) {
+                std::fill_n(buffer, n, *data);
+                values[i] = buffer;
+              } else {
+                values[i] = data;
+              }
+            }
+          }
+
+          for (size_t k = 0; k < program_.size(); ++k) {
+            const auto& instruction = program_[k];
+            const auto* operands = instruction.operands;
+            float* result = instruction.buffer < 0
+                                ? output
+                                : buffers.data() + static_cast<size_t>(instruction.buffer) * kBlockSize;
+            EvaluateInstruction(instruction.op,
+                                values[operands[0]],
+                                operands[1] >= 0 ? values[operands[1]] : nullptr,
+                                operands[2] >= 0 ? values[operands[2]] : nullptr,
+                                operands[1] >= 0 && is_uniform[operands[1]],
+                                result, n);
+
+            bool uniform = true;
+            for (int operand : operands) {
+              uniform = uniform && (operand < 0 || is_uniform[operand]);
+            }
+            values[input_count_ + k] = result;
+            is_uniform[input_count_ + k] = uniform;
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Evaluates an expression of element-wise operators in one pass over the output. The output is processed in blocks
+// of elements that stay in the L1 cache, and each block runs the whole expression before moving on, so
+// intermediate results are never written to memory.
+class FusedElementwise final : public OpKernel {
+ public:
+  explicit FusedElementwise(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  enum class OpCode {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Pow,
+    Erf,
+    Sqrt,
+    Reciprocal,
+    Neg,
+    Abs,
+    Exp,
+    Tanh,
+    Sigmoid,
+    Relu,
+    Where,
+  };
+
+  struct Instruction {
+    OpCode op;
+    int operands[3];
+    int buffer;  // scratch buffer the result is written to, -1 for the last instruction which writes the output
+  };
+
+ private:
+  std::vector<Instruction> program_;
+  size_t input_count_;
+
+  // Inputs that are broadcast along a block, or are bool, are expanded into the first input_count_ buffers.
+  // Instruction results use the others, and reuse a buffer once the value in it is dead.
+  size_t buffer_count_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/nearest_neighbors.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/util/math_cpuonly.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+ONNX_OPERATOR_KERNEL_EX(
+    NearestNeighbors,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("T1", BuildKernelDefConstraints<float, MLFloat16, int8_t>())
+        .TypeConstraint("I", DataTypeImpl::GetTensorType<int64_t>()),
+    NearestNeighbors);
+
+namespace {
+
+using Metric = NearestNeighbors::Metric;
+
+// A candidate neighbor is a score and a row index. The score is the distance, or the negated similarity, so a lower
+// score is always a better neighbor and the pair ordering also breaks ties by the lower index.
+using Candidate = std::pair<float, int64_t>;
+
+// Number of queries multiplied with each block of the database.
+constexpr int64_t kQueryBlockSize = 128;
+
+// The database is converted to float and multiplied a block of rows at a time. A block of about 256KB stays in the
+// L2 cache while it is multiplied with every query of a query block.
+constexpr int64_t kDatabaseBlockElements = 65536;
+constexpr int64_t kMinDatabaseBlockSize = 16;
+constexpr int64_t kMaxDatabaseBlockSize = 1024;
+
+// Keeps the best k candidates in a max-heap, so the worst of them is at the front.
+inline void PushCandidate(Candidate* heap, int64_t& heap_size, int64_t k, const Candidate& candidate) {
+  if (heap_size < k) {
+    heap[heap_size++] = candidate;
+    std::push_heap(heap, heap + heap_size);
+  } else if (candidate < heap[0]) {
+    std::pop_heap(heap, heap + k);
+    heap[k - 1] = candidate;
+    std::push_heap(heap, heap + k);
+  }
+}
+
+// Returns rows [start, start + count) of the database as float, converting them into buffer unless they are float.
+const float* GetDatabaseBlock(const Tensor& database, const float* scale, int64_t scale_size,
+                              int64_t start, int64_t count, int64_t dim, float* buffer) {
+  if (database.IsDataType<float>()) {
+    return database.Data<float>() + start * dim;
+  }
+
+  if (database.IsDataType<MLFloat16>()) {
+    const MLFloat16* source = database.Data<MLFloat16>() + start * dim;
+    MlasConvertHalfToFloatBuffer(&source[0].val, buffer, static_cast<size_t>(count * dim));
+    return buffer;
+  }
+
+  const int8_t* source = database.Data<int8_t>() + start * dim;
+  for (int64_t row = 0; row < count; ++row) {
+    const float row_scale = scale_size == 1 ? scale[0] : scale[start + row];
+    EigenVectorMap<float>(buffer + row * dim, dim) =
+        ConstEigenVectorMap<int8_t>(source + row * dim, dim).cast<float>() * row_scale;
+  }
+  return buffer;
+}
+
+}  // namespace
+
+NearestNeighbors::NearestNeighbors(const OpKernelInfo& info) : OpKernel(info) {
+  ORT_ENFORCE(info.GetAttr<int64_t>("k", &k_).IsOK() && k_ >= 0, "NearestNeighbors requires a non-negative k.");
+
+  const std::string metric = info.GetAttrOrDefault<std::string>("metric", "sqeuclidean");
+  if (metric == "sqeuclidean") {
+    metric_ = Metric::SqEuclidean;
+  } else if (metric == "euclidean") {
+    metric_ = Metric::Euclidean;
+  } else if (metric == "inner_product") {
+    metric_ = Metric::InnerProduct;
+  } else if (metric == "cosine") {
+    metric_ = Metric::Cosine;
+  } else {
+    ORT_THROW("Unsupported metric for NearestNeighbors: ", metric);
+  }
+}
+
+Status NearestNeighbors::Compute(OpKernelContext* context) const {
+  const Tensor* queries = context->Input<Tensor>(0);
+  const Tensor* database = context->Input<Tensor>(1);
+  const Tensor* database_scale = context->Input<Tensor>(2);
+
+  const auto& queries_shape = queries->Shape();
+  const auto& database_shape = database->Shape();
+  ORT_RETURN_IF_NOT(queries_shape.NumDimensions() == 2 && database_shape.NumDimensions() == 2,
+                    "NearestNeighbors: Q and X must be 2D matrices");
+  ORT_RETURN_IF_NOT(queries_shape[1] == database_shape[1],
+                    "NearestNeighbors: Q and X must have the same number of columns. Q: ", queries_shape,
+                    " X: ", database_shape);
+
+  const int64_t M = queries_shape[0];
+  const int64_t N = database_shape[0];
+  const int64_t D = queries_shape[1];
+  ORT_RETURN_IF_NOT(k_ <= N, "NearestNeighbors: k (", k_, ") is larger than the number of rows in X (", N, ")");
+
+  const bool is_l2 = metric_ == Metric::SqEuclidean || metric_ == Metric::Euclidean;
+  const float* scale_data = nullptr;
+  int64_t scale_size = 0;
+  if (database->IsDataType<int8_t>()) {
+    ORT_RETURN_IF(database_scale == nullptr, "NearestNeighbors: X_scale is required for an int8 X");
+    scale_size = database_scale->Shape().Size();
+    ORT_RETURN_IF_NOT(scale_size == 1 || (database_scale->Shape().NumDimensions() == 1 && scale_size == N),
+                      "NearestNeighbors: X_scale must be a scalar or have one value per row of X. X_scale: ",
+                      database_scale->Shape());
+    scale_data = database_scale->Data<float>();
+  }
+
+  Tensor* values = context->Output(0, {M, k_});
+  Tensor* indices = context->Output(1, {M, k_});
+  if (M == 0 || k_ == 0) {
+    return Status::OK();
+  }
+
+  // The queries are prepared once: their squared norms are added to the products for the L2 metrics, and they are
+  // normalized for the cosine metric so that only the database rows are scaled per block.
+  const float* query_data = queries->Data<float>();
+  std::vector<float> query_norms;
+  std::vector<float> normalized_queries;
+  if (is_l2) {
+    query_norms.resize(static_cast<size_t>(M));
+    for (int64_t i = 0; i < M; ++i) {
+      query_norms[i] = ConstEigenVectorMap<float>(query_data + i * D, D).squaredNorm();
+    }
+  } else if (metric_ == Metric::Cosine) {
+    normalized_queries.assign(query_data, query_data + M * D);
+    for (int64_t i = 0; i < M; ++i) {
+      auto query = EigenVectorMap<float>(normalized_queries.data() + i * D, D);
+      const float norm = query.norm();
+      if (norm > 0.0f) {
+        query /= norm;
+      }
+    }
+    query_data = normalized_queries.data();
+  }
+
+  concurrency::ThreadPool* tp = context->GetOperatorThreadPool();
+
+  const int64_t query_block_size = std::min(M, kQueryBlockSize);
+  const int64_t query_blocks = (M + query_block_size - 1) / query_block_size;
+  const int64_t database_block_size =
+      std::min(N, std::clamp(kDatabaseBlockElements / std::max<int64_t>(D, 1), kMinDatabaseBlockSize,
+                             kMaxDatabaseBlockSize));
+  const int64_t database_blocks = (N + database_block_size - 1) / database_block_size;
+
+  // The database is also split into partitions when there are fewer query blocks than threads, so a few queries
+  // against a large database still use every thread. Each partition keeps its own heaps, which are merged at the end.
+  const int64_t target_tasks = 2 * static_cast<int64_t>(concurrency::ThreadPool::DegreeOfParallelism(tp));
+  int64_t partitions = std::clamp<int64_t>((target_tasks + query_blocks - 1) / query_blocks, 1, database_blocks);
+  const int64_t blocks_per_partition = (database_blocks + partitions - 1) / partitions;
+  partitions = (database_blocks + blocks_per_partition - 1) / blocks_per_partition;
+
+  // The best k candidates of each partition for each query, stored as [partition][query][k].
+  std::vector<Candidate> candidates(static_cast<size_t>(partitions * M * k_));
+  std::vector<int64_t> candidate_counts(static_cast<size_t>(partitions * M), 0);
+
+  // The products are scaled so that every score is lower for a better neighbor: the L2 distance is
+  // |q|^2 - 2 q.x + |x|^2, and the inner product and cosine similarity are negated.
+  const float alpha = is_l2 ? -2.0f : -1.0f;
+
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, query_blocks * partitions, [&](std::ptrdiff_t task) {
+    const int64_t query_start = (task / partitions) * query_block_size;
+    const int64_t query_count = std::min(query_block_size, M - query_start);
+    const int64_t partition = task % partitions;
+    const int64_t database_begin = partition * blocks_per_partition * database_block_size;
+    const int64_t database_end = std::min(N, database_begin + blocks_per_partition * database_block_size);
+
+    std::vector<float> database_buffer(
+        database->IsDataType<float>() ? 0 : static_cast<size_t>(database_block_size * D));
+    std::vector<float> database_norms(static_cast<size_t>(database_block_size));
+    std::vector<float> scores(static_cast<size_t>(query_count * database_block_size));
+    Candidate* heaps = candidates.data() + (partition * M + query_start) * k_;
+    int64_t* heap_sizes = candidate_counts.data() + partition * M + query_start;
+
+    for (int64_t database_start = database_begin; database_start < database_end;
+         database_start += database_block_size) {
+      const int64_t rows = std::min(database_block_size, database_end - database_start);
+      const float* block = GetDatabaseBlock(*database, scale_data, scale_size, database_start, rows, D,
+                                            database_buffer.data());
+
+      if (is_l2) {
+        for (int64_t j = 0; j < rows; ++j) {
+          database_norms[j] = ConstEigenVectorMap<float>(block + j * D, D).squaredNorm();
+        }
+      } else if (metric_ == Metric::Cosine) {
+        for (int64_t j = 0; j < rows; ++j) {
+          const float norm = ConstEigenVectorMap<float>(block + j * D, D).norm();
+          database_norms[j] = norm > 0.0f ? 1.0f / norm : 0.0f;
+        }
+      }
+
+      MlasGemm(CblasNoTrans, CblasTrans,
+               static_cast<size_t>(query_count), static_cast<size_t>(rows), static_cast<size_t>(D),
+               alpha, query_data + query_start * D, static_cast<size_t>(D),
+               block, static_cast<size_t>(D),
+               0.0f, scores.data(), static_cast<size_t>(rows), nullptr);
+
+      // Fold the tile into the heaps while it is still in the cache.
+      for (int64_t i = 0; i < query_count; ++i) {
+        float* row_scores = scores.data() + i * rows;
+        if (is_l2) {
+          // add the query norm first and the database norm last, as CDist does, and clamp the rounding error
+          const float query_norm = query_norms[query_start + i];
+          for (int64_t j = 0; j < rows; ++j) {
+            row_scores[j] = std::abs((row_scores[j] + query_norm) + database_norms[j]);
+          }
+        } else if (metric_ == Metric::Cosine) {
+          for (int64_t j = 0; j < rows; ++j) {
+            row_scores[j] *= database_norms[j];
+          }
+        }
+
+        Candidate* heap = heaps + i * k_;
+        int64_t& heap_size = heap_sizes[i];
+        for (int64_t j = 0; j < rows; ++j) {
+          // rows are visited in increasing order, so a tie with the worst candidate kept loses
+          if (heap_size == k_ && !(row_scores[j] < heap[0].first)) {
+            continue;
+          }
+          PushCandidate(heap, heap_size, k_, Candidate(row_scores[j], database_start + j));
+        }
+      }
+    }
+  });
+
+  float* values_data = values->MutableData<float>();
+  int64_t* indices_data = indices->MutableData<int64_t>();
+  const double merge_cost = static_cast<double>(partitions * k_);
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(M),
+      TensorOpCost{merge_cost * sizeof(Candidate), static_cast<double>(k_ * (sizeof(float) + sizeof(int64_t))),
+                   merge_cost * 4},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        std::vector<Candidate> merged;
+        merged.reserve(static_cast<size_t>(partitions * k_));
+        for (std::ptrdiff_t q = first; q < last; ++q) {
+          merged.clear();
+          for (int64_t partition = 0; partition < partitions; ++partition) {
+            const Candidate* partition_candidates = candidates.data() + (partition * M + q) * k_;
+            merged.insert(merged.end(), partition_candidates,
+                          partition_candidates + candidate_counts[partition * M + q]);
+          }
+          std::partial_sort(merged.begin(), merged.begin() + k_, merged.end());
+
+          float* query_values = values_data + q * k_;
+          int64_t* query_indices = indices_data + q * k_;
+          for (int64_t r = 0; r < k_; ++r) {
+            const float score = merged[r].first;
+            query_values[r] = metric_ == Metric::Euclidean ? std::sqrt(score) : (is_l2 ? score : -score);
+            query_indices[r] = merged[r].second;
+          }
+        }
+      });
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,34 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "core/framework/op_kernel.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// k nearest neighbor search, equivalent to CDist followed by TopK. The distances are computed with SGEMM over tiles
+// of queries and database rows that stay in the cache, and every tile is folded into bounded per-query heaps before
+// the next one is computed, so the full distance matrix is never materialized.
+class NearestNeighbors final : public OpKernel {
+ public:
+  explicit NearestNeighbors(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+
+  enum class Metric {
+    SqEuclidean,
+    Euclidean,
+    InnerProduct,
+    Cosine,
+  };
+
+ private:
+  int64_t k_;
+  Metric metric_;
+};
+
+}  // namespace contrib
+}  // namespace onnxruntime
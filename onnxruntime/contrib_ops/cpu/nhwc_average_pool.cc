@@ -0,0 +1,200 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/nn/pool_attributes.h"
+#include "core/util/math.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Average pooling with the input and the output in channels last (NHWC) layout. The windows are gathered with the
+// same indirection buffer as NhwcMaxPool and the channels of a pixel are summed contiguously. Padding contributes
+// zeros, and the divisor of every output pixel is derived from its coordinates so that count_include_pad and the
+// windows that ceil_mode extends past the padding are handled like AveragePool.
+class NhwcAveragePool final : public OpKernel {
+ public:
+  explicit NhwcAveragePool(const OpKernelInfo& info) : OpKernel(info),
+                                                       pool_attrs_(info, "AveragePool", info.node().SinceVersion()) {
+  }
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  PoolAttributes pool_attrs_;
+};
+
+Status NhwcAveragePool::Compute(OpKernelContext* context) const {
+  const auto* X = context->Input<Tensor>(0);
+  const TensorShape& input_shape = X->Shape();
+
+  const size_t input_rank = input_shape.NumDimensions();
+  ORT_RETURN_IF_NOT(input_rank >= 3, "Input dimension cannot be less than 3.");
+
+  const int64_t N = input_shape[0];
+  const int64_t C = input_shape[input_rank - 1];
+
+  ORT_ENFORCE(input_shape.Size() > 0 || N == 0, "Invalid input shape. Only N can be zero. Got:", input_shape);
+
+  const size_t spatial_dims = input_rank - 2;
+
+  // Compute the output size and effective padding for this pooling operation.
+  TensorShapeVector output_dims({N});
+  TensorShapeVector pads = pool_attrs_.pads;
+  int64_t kernel_size = 1;
+  int64_t input_image_size = 1;
+  int64_t output_image_size = 1;
+  for (size_t dim = 0; dim < spatial_dims; ++dim) {
+    int64_t kernel = pool_attrs_.kernel_shape[dim];
+    int64_t input_dim = input_shape[dim + 1];
+
+    kernel_size *= kernel;
+    input_image_size *= input_dim;
+
+    int64_t output_dim = 0;
+    pool_attrs_.ComputeSizePadDilations(input_dim,
+                                        pool_attrs_.strides[dim],
+                                        kernel,
+                                        &pads.at(dim),
+                                        &pads.at(spatial_dims + dim),
+                                        pool_attrs_.dilations[dim],
+                                        &output_dim);
+    output_dims.push_back(output_dim);
+
+    output_image_size *= output_dim;
+  }
+  output_dims.push_back(C);
+
+  Tensor* Y = context->Output(0, output_dims);
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  // Number of window elements counted by the divisor for every output coordinate of every spatial dimension.
+  std::vector<std::vector<int64_t>> window_counts(spatial_dims);
+  for (size_t dim = 0; dim < spatial_dims; ++dim) {
+    const int64_t input_dim = input_shape[dim + 1];
+    const int64_t pad_head = pads[dim];
+    const int64_t lower = pool_attrs_.count_include_pad ? -pad_head : 0;
+    const int64_t upper = pool_attrs_.count_include_pad ? input_dim + pads[spatial_dims + dim] : input_dim;
+    window_counts[dim].resize(static_cast<size_t>(output_dims[dim + 1]));
+    for (int64_t o = 0; o < output_dims[dim + 1]; ++o) {
+      const int64_t start = o * pool_attrs_.strides[dim] - pad_head;
+      const int64_t end = start + pool_attrs_.kernel_shape[dim];
+      window_counts[dim][static_cast<size_t>(o)] = std::max<int64_t>(std::min(end, upper) - std::max(start, lower), 0);
+    }
+  }
+
+  // Allocate indirection buffer pointers for the output pixels of an image and
+  // prepare a padding vector for the im2col transform.
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+  auto* indirection_data = alloc->Alloc(SafeInt<size_t>(sizeof(const float*)) * kernel_size * output_image_size);
+  BufferUniquePtr indirection_buffer(indirection_data, BufferDeleter(std::move(alloc)));
+  std::vector<float> padding_data(static_cast<size_t>(C), 0.0f);
+
+  const auto* Xdata = X->Data<float>();
+  auto* Ydata = Y->MutableData<float>();
+
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+
+  // Partition the output pixels of an image into slices large enough to amortize the task dispatch, with a few of
+  // them per thread so that uneven tasks balance out.
+  constexpr int64_t kMinTaskElements = 16 * 1024;
+  const int64_t elements_per_output = std::max<int64_t>(kernel_size * C, 1);
+  const int32_t degree_of_par = concurrency::ThreadPool::DegreeOfParallelism(thread_pool);
+  int64_t stride_m = std::max((kMinTaskElements + elements_per_output - 1) / elements_per_output,
+                              (output_image_size + 4 * degree_of_par - 1) / (4 * degree_of_par));
+  stride_m = std::min(output_image_size, (stride_m + 7) & ~int64_t{7});
+  const int64_t task_count = (output_image_size + stride_m - 1) / stride_m;
+
+  for (int64_t image_id = 0; image_id < N; ++image_id) {
+    const float* input_data = Xdata;
+    float* output_data = Ydata;
+
+    auto pool_worker = [&](ptrdiff_t batch) {
+      const int64_t output_start = batch * stride_m;
+      const int64_t output_count = std::min(stride_m, output_image_size - output_start);
+
+      auto* worker_indirection_buffer =
+          static_cast<float const**>(indirection_buffer.get()) + output_start * kernel_size;
+      math::Im2col<float, StorageOrder::NHWC>()(
+          input_data,
+          C,
+          input_shape.GetDims().data() + 1,
+          output_dims.data() + 1,
+          pool_attrs_.kernel_shape.data(),
+          pool_attrs_.strides.data(),
+          pool_attrs_.dilations.data(),
+          pads.data(),
+          static_cast<ptrdiff_t>(spatial_dims),
+          output_start,
+          output_count,
+          worker_indirection_buffer,
+          padding_data.data());
+
+      // Coordinates of the first output pixel of the slice.
+      std::vector<int64_t> output_coords(spatial_dims);
+      int64_t remaining = output_start;
+      for (size_t dim = spatial_dims; dim-- > 0;) {
+        output_coords[dim] = remaining % output_dims[dim + 1];
+        remaining /= output_dims[dim + 1];
+      }
+
+      const auto* const* input = worker_indirection_buffer;
+      float* output = output_data + output_start * C;
+      for (int64_t i = 0; i < output_count; ++i) {
+        std::copy_n(input[0], C, output);
+        for (int64_t k = 1; k < kernel_size; ++k) {
+          const float* in = input[k];
+          for (int64_t c = 0; c < C; ++c) {
+            output[c] += in[c];
+          }
+        }
+
+        int64_t window_count = 1;
+        for (size_t dim = 0; dim < spatial_dims; ++dim) {
+          window_count *= window_counts[dim][static_cast<size_t>(output_coords[dim])];
+        }
+        const float scale = window_count > 0 ? 1.0f / static_cast<float>(window_count) : 0.0f;
+        for (int64_t c = 0; c < C; ++c) {
+          output[c] *= scale;
+        }
+
+        // Advance to the coordinates of the next output pixel.
+        for (size_t dim = spatial_dims; dim-- > 0;) {
+          if (++output_coords[dim] < output_dims[dim + 1]) {
+            break;
+          }
+          output_coords[dim] = 0;
+        }
+
+        input += kernel_size;
+        output += C;
+      }
+    };
+
+    concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, task_count, pool_worker);
+
+    Xdata += input_image_size * C;
+    Ydata += output_image_size * C;
+  }
+
+  return Status::OK();
+}
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NhwcAveragePool,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcAveragePool);
+
+}  // namespace contrib
+}  // namespace onnxruntime
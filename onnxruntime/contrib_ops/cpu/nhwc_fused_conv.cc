@@ -0,0 +1,530 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "core/common/common.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "core/providers/cpu/nn/conv_attributes.h"
+#include "core/util/math.h"
+#include "contrib_ops/cpu/fused_activation.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Convolution with the input and the output in channels last (NHWC) layout. Every output pixel is a row of the
+// im2col matrix multiplied by the filter reordered from MCK1..Kn to K1..KnCM, so a constant filter is reordered and
+// packed for SGEMM once. Depthwise convolutions accumulate over an indirection buffer instead.
+class NhwcFusedConv final : public OpKernel {
+ public:
+  explicit NhwcFusedConv(const OpKernelInfo& info) : OpKernel(info), conv_attrs_(info) {
+    ORT_ENFORCE(GetFusedActivationAttr(info, activation_).IsOK());
+  }
+
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  Status UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                   int input_idx,
+                                   /*out*/ bool& used_shared_buffers) override;
+
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  enum InputTensors : int {
+    IN_X = 0,
+    IN_W = 1,
+    IN_B = 2,
+    IN_Z = 3
+  };
+
+  // Reorder filter storage format from MCK1..Kn to K1...KnCM
+  static void ReorderFilter(const float* input,
+                            float* output,
+                            size_t output_channels,
+                            size_t input_channels,
+                            size_t kernel_size) {
+    for (size_t k = 0; k < kernel_size; k++) {
+      for (size_t ic = 0; ic < input_channels; ic++) {
+        for (size_t oc = 0; oc < output_channels; oc++) {
+          size_t index = (oc * input_channels * kernel_size) + (ic * kernel_size) + k;
+          *output++ = input[index];
+        }
+      }
+    }
+  }
+
+  // Depthwise convolution over an indirection buffer of kernel_size input pixels per output pixel, with the filter
+  // stored as K1..KnM. The output is accumulated into when it already holds the Z input.
+  static void DepthwiseConv(const float* const* input,
+                            const float* filter,
+                            float* output,
+                            size_t channels,
+                            size_t output_count,
+                            size_t kernel_size,
+                            bool accumulate) {
+    for (size_t i = 0; i < output_count; i++) {
+      if (!accumulate) {
+        std::fill_n(output, channels, 0.0f);
+      }
+      for (size_t k = 0; k < kernel_size; k++) {
+        const float* in = input[k];
+        const float* w = filter + k * channels;
+        for (size_t c = 0; c < channels; c++) {
+          output[c] += in[c] * w[c];
+        }
+      }
+      input += kernel_size;
+      output += channels;
+    }
+  }
+
+  ConvAttributes conv_attrs_;
+  MLAS_ACTIVATION activation_;
+  TensorShape W_shape_;
+  BufferUniquePtr packed_W_buffer_;
+  size_t packed_W_size_{0};
+  BufferUniquePtr reordered_W_buffer_;
+  bool is_W_packed_{false};
+};
+
+Status NhwcFusedConv::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                              /*out*/ bool& is_packed,
+                              /*out*/ PrePackedWeights* prepacked_weights) {
+  is_packed = false;
+
+  // Support packing the weight matrix.
+  if (input_idx != InputTensors::IN_W) {
+    return Status::OK();
+  }
+
+  const auto& shape = tensor.Shape().GetDims();
+  size_t rank = shape.size();
+  if (rank <= 2) {
+    return Status::OK();
+  }
+
+  const int64_t M = shape[0];
+  const int64_t C = shape[1];
+
+  // Verify that the total number of output channels is a multiple of the group count.
+  if (M % conv_attrs_.group != 0) {
+    return Status::OK();
+  }
+
+  // Note: The tensor has already been allocated with this tensor shape, so all
+  // shape indices are guaranteed to fit inside size_t.
+  const size_t output_channels = static_cast<size_t>(M);
+  const size_t group_input_channels = static_cast<size_t>(C);
+  const size_t kernel_size =
+      static_cast<size_t>(std::accumulate(shape.data() + 2, shape.data() + rank, 1LL, std::multiplies<int64_t>()));
+
+  const auto* Wdata = tensor.Data<float>();
+  W_shape_ = shape;
+
+  const size_t group_count = static_cast<size_t>(conv_attrs_.group);
+  const size_t group_output_channels = output_channels / group_count;
+  const size_t kernel_dim = group_input_channels * kernel_size;
+
+  bool share_prepacked_weights = (prepacked_weights != nullptr);
+
+  // Don't pack the filter buffer if the depthwise path is used.
+  if (group_input_channels != 1 || group_output_channels != 1) {
+    packed_W_size_ = MlasGemmPackBSize(group_output_channels, kernel_dim);
+    if (packed_W_size_ != 0) {
+      size_t packed_W_data_size = SafeInt<size_t>(group_count) * packed_W_size_;
+      auto* packed_W = static_cast<uint8_t*>(alloc->Alloc(packed_W_data_size));
+
+      // Initialize memory to 0 as there could be some padding associated with pre-packed
+      // buffer memory and we don not want it uninitialized and generate different hashes
+      // if and when we try to cache this pre-packed buffer for sharing between sessions.
+      memset(packed_W, 0, packed_W_data_size);
+
+      packed_W_buffer_ = BufferUniquePtr(packed_W, BufferDeleter(alloc));
+
+      // Allocate a temporary buffer to hold the reordered filter for a single group.
+      auto* group_reordered_W = static_cast<float*>(
+          alloc->Alloc(SafeInt<size_t>(sizeof(float)) * group_output_channels * kernel_dim));
+      BufferUniquePtr group_reordered_W_buffer(group_reordered_W, BufferDeleter(alloc));
+
+      const size_t W_offset = group_output_channels * kernel_dim;
+
+      for (int64_t group_id = 0; group_id < conv_attrs_.group; ++group_id) {
+        ReorderFilter(Wdata, group_reordered_W, group_output_channels, group_input_channels, kernel_size);
+        MlasGemmPackB(CblasNoTrans,
+                      group_output_channels,
+                      kernel_dim,
+                      group_reordered_W,
+                      group_output_channels,
+                      packed_W);
+        packed_W += packed_W_size_;
+        Wdata += W_offset;
+      }
+
+      if (share_prepacked_weights) {
+        prepacked_weights->buffers_.push_back(std::move(packed_W_buffer_));
+        prepacked_weights->buffer_sizes_.push_back(packed_W_data_size);
+      }
+
+      is_W_packed_ = true;
+      is_packed = true;
+      return Status::OK();
+    }
+  }
+
+  if (share_prepacked_weights) {
+    prepacked_weights->buffers_.push_back(nullptr);  // packed_W_buffer_ is nullptr
+    prepacked_weights->buffer_sizes_.push_back(0);
+  }
+
+  size_t reordered_w_data_size = SafeInt<size_t>(sizeof(float)) * output_channels * kernel_dim;
+  auto* reordered_W = static_cast<float*>(alloc->Alloc(reordered_w_data_size));
+  reordered_W_buffer_ = BufferUniquePtr(reordered_W, BufferDeleter(alloc));
+
+  ReorderFilter(Wdata, reordered_W, output_channels, group_input_channels, kernel_size);
+
+  if (share_prepacked_weights) {
+    prepacked_weights->buffers_.push_back(std::move(reordered_W_buffer_));
+    prepacked_weights->buffer_sizes_.push_back(reordered_w_data_size);
+  }
+
+  is_W_packed_ = true;
+  is_packed = true;
+  return Status::OK();
+}
+
+Status NhwcFusedConv::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prepacked_buffers,
+                                                int input_idx,
+                                                /*out*/ bool& used_shared_buffers) {
+  if (input_idx != InputTensors::IN_W) {
+    return Status::OK();
+  }
+
+  used_shared_buffers = true;
+
+  if (prepacked_buffers.size() == 1) {  // This means that only packed_W_ exists
+    packed_W_buffer_ = std::move(prepacked_buffers[0]);
+  } else if (prepacked_buffers.size() == 2) {  // This means that only reordered_W_ exists
+    // Enforce that the first "placeholder" buffer is nullptr
+    ORT_ENFORCE(prepacked_buffers[0].get() == nullptr);
+    reordered_W_buffer_ = std::move(prepacked_buffers[1]);
+  }
+
+  return Status::OK();
+}
+
+Status NhwcFusedConv::Compute(OpKernelContext* context) const {
+  const Tensor* X = context->Input<Tensor>(InputTensors::IN_X);
+  const Tensor* W = is_W_packed_ ? nullptr : context->Input<Tensor>(InputTensors::IN_W);
+  const auto& W_shape = W ? W->Shape() : W_shape_;
+  const Tensor* B = context->Input<Tensor>(InputTensors::IN_B);
+  const Tensor* Z = context->InputCount() > InputTensors::IN_Z ? context->Input<Tensor>(InputTensors::IN_Z) : nullptr;
+
+  const int64_t N = X->Shape()[0];
+  const int64_t M = W_shape[0];
+
+  ORT_RETURN_IF_ERROR(conv_attrs_.ValidateInputShape(X->Shape(), W_shape, true));
+
+  TensorShapeVector kernel_shape;
+  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W_shape, kernel_shape));
+
+  const size_t kernel_rank = kernel_shape.size();
+
+  ConvPadVector pads(conv_attrs_.pads);
+  if (pads.empty()) {
+    pads.resize(kernel_rank * 2, 0);
+  }
+  TensorShapeVector dilations(conv_attrs_.dilations);
+  if (dilations.empty()) {
+    dilations.resize(kernel_rank, 1);
+  }
+  TensorShapeVector strides(conv_attrs_.strides);
+  if (strides.empty()) {
+    strides.resize(kernel_rank, 1);
+  }
+
+  const int64_t C = X->Shape()[1 + kernel_rank];
+
+  TensorShapeVector Y_dims({N});
+  TensorShape input_shape = X->Shape().Slice(1, 1 + kernel_rank);
+  ORT_RETURN_IF_ERROR(conv_attrs_.InferPadsAndOutputShape(input_shape, kernel_shape, strides, dilations, pads, Y_dims));
+  Y_dims.push_back(M);
+  Tensor* Y = context->Output(0, TensorShape(Y_dims));
+  TensorShape output_shape = Y->Shape().Slice(1, 1 + kernel_rank);
+
+  if (Z != nullptr) {
+    ORT_RETURN_IF_NOT(Z->Shape() == Y->Shape(), "Z shape ", Z->Shape(), " does not match the output shape ",
+                      Y->Shape());
+  }
+
+  // Bail out early if one of the dimensions is zero.
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  const int64_t input_image_size = input_shape.Size();
+  const int64_t output_image_size = output_shape.Size();
+  const int64_t kernel_size = TensorShape(kernel_shape).Size();
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  // Handle the case of a dynamic weight filter.
+  BufferUniquePtr reordered_W_buffer;
+  const float* reordered_W = nullptr;
+  if (!packed_W_buffer_) {
+    if (W == nullptr) {
+      // Weight was constant and reordered.
+      reordered_W = static_cast<const float*>(reordered_W_buffer_.get());
+    } else {
+      // Weight tensor was not constant or prepacking is disabled.
+      auto* reordered_W_data = static_cast<float*>(alloc->Alloc(SafeInt<size_t>(sizeof(float)) * W_shape.Size()));
+      reordered_W_buffer = BufferUniquePtr(reordered_W_data, BufferDeleter(alloc));
+      ReorderFilter(
+          W->Data<float>(),
+          reordered_W_data,
+          static_cast<size_t>(M),
+          static_cast<size_t>(W_shape[1]),
+          static_cast<size_t>(kernel_size));
+      reordered_W = reordered_W_data;
+    }
+  }
+
+  const int64_t group_count = conv_attrs_.group;
+  const int64_t group_input_channels = W_shape[1];
+  const int64_t group_output_channels = M / group_count;
+  const bool is_depthwise_conv = (group_input_channels == 1 && group_output_channels == 1);
+
+  const int64_t X_offset = C * input_image_size;
+  const int64_t Y_offset = M * output_image_size;
+  const int64_t kernel_dim = group_input_channels * kernel_size;
+  const int64_t col_buffer_size = kernel_dim * output_image_size;
+
+  BufferUniquePtr col_buffer;
+  BufferUniquePtr indirection_buffer;
+  std::vector<float> padding_data;
+
+  if (is_depthwise_conv) {
+    // Allocate indirection buffer pointers and prepare a padding vector for
+    // the im2col transform.
+    auto* indirection_data = alloc->Alloc(SafeInt<size_t>(sizeof(const float*)) * kernel_size * output_image_size);
+    indirection_buffer = BufferUniquePtr(indirection_data, BufferDeleter(alloc));
+    padding_data.resize(static_cast<size_t>(C), 0.0f);
+  } else if (kernel_size != 1 || !conv_attrs_.HasStridesOneAndNoPadding()) {
+    // Pointwise convolutions can use the original input tensor in place,
+    // otherwise a temporary buffer is required for the im2col transform.
+    int64_t group_col_buffer_size = (kernel_rank > 2) ? group_count * col_buffer_size : col_buffer_size;
+    auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * group_col_buffer_size);
+    col_buffer = BufferUniquePtr(col_data, BufferDeleter(alloc));
+  }
+
+  const auto* Xdata = X->Data<float>();
+  const auto* Bdata = B != nullptr ? B->Data<float>() : nullptr;
+  const auto* Zdata = Z != nullptr ? Z->Data<float>() : nullptr;
+  auto* Ydata = Y->MutableData<float>();
+
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+
+  // Partition the output pixels into slices that keep the im2col rows of a slice in cache while the whole filter is
+  // applied to them. Slices are large enough to amortize the task dispatch, with a few of them per thread so that
+  // uneven tasks balance out.
+  constexpr int64_t kMinTaskMacs = 64 * 1024;
+  const int64_t macs_per_output = std::max<int64_t>(group_count * group_output_channels * kernel_dim, 1);
+  const int32_t degree_of_par = concurrency::ThreadPool::DegreeOfParallelism(thread_pool);
+  int64_t stride_m = std::max((kMinTaskMacs + macs_per_output - 1) / macs_per_output,
+                              (output_image_size + 4 * degree_of_par - 1) / (4 * degree_of_par));
+  stride_m = std::min(output_image_size, (stride_m + 7) & ~int64_t{7});
+  const int64_t task_count = (output_image_size + stride_m - 1) / stride_m;
+
+  for (int64_t image_id = 0; image_id < N; ++image_id) {
+    const float* input_data = Xdata;
+    float* output_data = Ydata;
+    const float* sum_data = Zdata;
+
+    // Threaded implementation of ND convolution is not yet supported, so
+    // prepare all im2col transformations here.
+    if (col_buffer && kernel_rank > 2) {
+      for (int64_t group_id = 0; group_id < group_count; ++group_id) {
+        math::Im2col<float, StorageOrder::NHWC>()(
+            input_data + group_id * group_input_channels,
+            group_input_channels,
+            C,
+            input_shape.GetDims().data(),
+            output_shape.GetDims().data(),
+            kernel_shape.data(),
+            strides.data(),
+            dilations.data(),
+            pads.data(),
+            static_cast<int64_t>(kernel_rank),
+            static_cast<float*>(col_buffer.get()) + group_id * col_buffer_size,
+            0.0f);
+      }
+    }
+
+    auto conv_worker = [&](ptrdiff_t batch) {
+      int64_t output_start = batch * stride_m;
+      int64_t output_count = std::min(stride_m, output_image_size - output_start);
+
+      auto* worker_output = output_data + output_start * M;
+      if (sum_data != nullptr) {
+        std::copy_n(sum_data + output_start * M, output_count * M, worker_output);
+      }
+
+      if (is_depthwise_conv) {
+        auto* worker_indirection_buffer =
+            static_cast<float const**>(indirection_buffer.get()) + output_start * kernel_size;
+        math::Im2col<float, StorageOrder::NHWC>()(
+            input_data,
+            C,
+            input_shape.GetDims().data(),
+            output_shape.GetDims().data(),
+            kernel_shape.data(),
+            strides.data(),
+            dilations.data(),
+            pads.data(),
+            static_cast<ptrdiff_t>(kernel_rank),
+            output_start,
+            output_count,
+            worker_indirection_buffer,
+            padding_data.data());
+        DepthwiseConv(worker_indirection_buffer,
+                      reordered_W,
+                      worker_output,
+                      static_cast<size_t>(M),
+                      static_cast<size_t>(output_count),
+                      static_cast<size_t>(kernel_size),
+                      sum_data != nullptr);
+      } else {
+        for (int64_t group_id = 0; group_id < group_count; ++group_id) {
+          // Prepare the im2col transformation or use the input buffer directly for
+          // pointwise convolutions.
+          const auto* group_input_data = input_data + group_id * group_input_channels;
+          MLAS_SGEMM_DATA_PARAMS gemm_params;
+          if (col_buffer) {
+            auto* worker_col_buffer = static_cast<float*>(col_buffer.get()) + output_start * kernel_dim;
+            if (kernel_rank == 2) {
+              math::Im2col<float, StorageOrder::NHWC>()(
+                  group_input_data,
+                  group_input_channels,
+                  C,
+                  input_shape[0],
+                  input_shape[1],
+                  kernel_shape[0],
+                  kernel_shape[1],
+                  dilations[0],
+                  dilations[1],
+                  pads[0],
+                  pads[1],
+                  strides[0],
+                  strides[1],
+                  output_shape[1],
+                  output_start,
+                  output_count,
+                  worker_col_buffer,
+                  0.0f);
+            } else if (kernel_rank == 1) {
+              math::Im2col<float, StorageOrder::NHWC>()(
+                  group_input_data,
+                  group_input_channels,
+                  C,
+                  1,
+                  input_shape[0],
+                  1,
+                  kernel_shape[0],
+                  1,
+                  dilations[0],
+                  0,
+                  pads[0],
+                  1,
+                  strides[0],
+                  output_shape[0],
+                  output_start,
+                  output_count,
+                  worker_col_buffer,
+                  0.0f);
+            } else {
+              // Use the im2col buffer prepared outside the thread, indexed by group.
+              worker_col_buffer += group_id * col_buffer_size;
+            }
+            gemm_params.A = worker_col_buffer;
+            gemm_params.lda = static_cast<size_t>(kernel_dim);
+          } else {
+            gemm_params.A = group_input_data + output_start * C;
+            gemm_params.lda = static_cast<size_t>(C);
+          }
+
+          if (packed_W_buffer_) {
+            gemm_params.B = reinterpret_cast<const float*>(
+                static_cast<const uint8_t*>(packed_W_buffer_.get()) + group_id * packed_W_size_);
+            gemm_params.BIsPacked = true;
+          } else {
+            gemm_params.B = reordered_W + group_id * group_output_channels;
+            gemm_params.ldb = static_cast<size_t>(M);
+          }
+          gemm_params.C = worker_output + group_id * group_output_channels;
+          gemm_params.ldc = static_cast<size_t>(M);
+          gemm_params.beta = sum_data != nullptr ? 1.0f : 0.0f;
+
+          MlasGemm(CblasNoTrans,
+                   CblasNoTrans,
+                   static_cast<size_t>(output_count),
+                   static_cast<size_t>(group_output_channels),
+                   static_cast<size_t>(kernel_dim),
+                   gemm_params,
+                   nullptr);
+        }
+      }
+
+      if (Bdata != nullptr) {
+        for (int64_t i = 0; i < output_count; ++i) {
+          float* row = worker_output + i * M;
+          for (int64_t c = 0; c < M; ++c) {
+            row[c] += Bdata[c];
+          }
+        }
+      }
+
+      MlasActivation(&activation_,
+                     worker_output,
+                     nullptr,
+                     static_cast<size_t>(output_count),
+                     static_cast<size_t>(M),
+                     static_cast<size_t>(M));
+    };
+
+    concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, task_count, conv_worker);
+
+    Xdata += X_offset;
+    Ydata += Y_offset;
+    if (Zdata != nullptr) {
+      Zdata += Y_offset;
+    }
+  }
+
+  return Status::OK();
+}
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NhwcConv,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcFusedConv);
+
+ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
+    NhwcFusedConv,
+    1,
+    float,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    NhwcFusedConv);
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -1,8 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/nn/pool_attributes.h"
 #include "core/common/safeint.h"
 #include "core/util/math.h"
@@ -11,7 +14,32 @@
 namespace onnxruntime {
 namespace contrib {
 
-template <typename T8Bits>
+namespace {
+
+template <typename T>
+void MaximumPool(const T* const* input, T* output, size_t channels, size_t output_count,
+                 size_t kernel_size) {
+  MlasMaximumPool(input, output, channels, output_count, kernel_size);
+}
+
+void MaximumPool(const float* const* input, float* output, size_t channels, size_t output_count,
+                 size_t kernel_size) {
+  for (size_t i = 0; i < output_count; i++) {
+    std::copy_n(input[0], channels, output);
+    for (size_t k = 1; k < kernel_size; k++) {
+      const float* in = input[k];
+      for (size_t c = 0; c < channels; c++) {
+        output[c] = std::max(output[c], in[c]);
+      }
+    }
+    input += kernel_size;
+    output += channels;
+  }
+}
+
+}  // namespace
+
+template <typename T>
 class NhwcMaxPool : public OpKernel {
  public:
   explicit NhwcMaxPool(const OpKernelInfo& info) : OpKernel(info),
@@ -24,8 +52,8 @@ class NhwcMaxPool : public OpKernel {
   PoolAttributes pool_attrs_;
 };
 
-template <typename T8Bits>
-Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
+template <typename T>
+Status NhwcMaxPool<T>::Compute(OpKernelContext* context) const {
   const auto* X = context->Input<Tensor>(0);
   const TensorShape& input_shape = X->Shape();
 
@@ -67,26 +95,45 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
   output_dims.push_back(C);
 
   Tensor* Y = context->Output(0, output_dims);
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
 
-  constexpr int64_t output_batch_count = 512;
-
-  // Allocate indirection buffer pointers and prepare a padding vector for the
-  // im2col transform.
+  // Allocate indirection buffer pointers for the output pixels of an image and
+  // prepare a padding vector for the im2col transform.
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
-  int64_t col_buffer_batch_count = std::min(output_image_size, output_batch_count);
-  auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(const T8Bits*)) * kernel_size * col_buffer_batch_count);
-  BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
-  std::vector<T8Bits> padding_data(static_cast<size_t>(C), std::numeric_limits<T8Bits>::lowest());
+  auto* indirection_data = alloc->Alloc(SafeInt<size_t>(sizeof(const T*)) * kernel_size * output_image_size);
+  BufferUniquePtr indirection_buffer(indirection_data, BufferDeleter(std::move(alloc)));
+  std::vector<T> padding_data(static_cast<size_t>(C), std::numeric_limits<T>::lowest());
+
+  const auto* Xdata = X->Data<T>();
+  auto* Ydata = Y->MutableData<T>();
 
-  const auto* Xdata = X->Data<T8Bits>();
-  auto* Ydata = Y->MutableData<T8Bits>();
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+
+  // Partition the output pixels of an image into slices large enough to amortize the task dispatch, with a few of
+  // them per thread so that uneven tasks balance out.
+  constexpr int64_t kMinTaskElements = 16 * 1024;
+  const int64_t elements_per_output = std::max<int64_t>(kernel_size * C, 1);
+  const int32_t degree_of_par = concurrency::ThreadPool::DegreeOfParallelism(thread_pool);
+  int64_t stride_m = std::max((kMinTaskElements + elements_per_output - 1) / elements_per_output,
+                              (output_image_size + 4 * degree_of_par - 1) / (4 * degree_of_par));
+  stride_m = std::min(output_image_size, (stride_m + 7) & ~int64_t{7});
+  const int64_t task_count = (output_image_size + stride_m - 1) / stride_m;
 
   for (int64_t image_id = 0; image_id < N; ++image_id) {
-    for (int64_t output_start = 0; output_start < output_image_size;) {
-      int64_t output_count = std::min(output_image_size - output_start, output_batch_count);
-      math::Im2col<T8Bits, StorageOrder::NHWC>()(
-          Xdata,
+    const T* input_data = Xdata;
+    T* output_data = Ydata;
+
+    auto pool_worker = [&](ptrdiff_t batch) {
+      const int64_t output_start = batch * stride_m;
+      const int64_t output_count = std::min(stride_m, output_image_size - output_start);
+
+      auto* worker_indirection_buffer =
+          static_cast<T const**>(indirection_buffer.get()) + output_start * kernel_size;
+      math::Im2col<T, StorageOrder::NHWC>()(
+          input_data,
           C,
           input_shape.GetDims().data() + 1,
           output_dims.data() + 1,
@@ -97,20 +144,20 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
           static_cast<ptrdiff_t>(spatial_dims),
           output_start,
           output_count,
-          static_cast<T8Bits const**>(col_buffer.get()),
+          worker_indirection_buffer,
           padding_data.data());
-      MlasMaximumPool(
-          static_cast<T8Bits const**>(col_buffer.get()),
-          Ydata,
+      MaximumPool(
+          worker_indirection_buffer,
+          output_data + output_start * C,
           static_cast<size_t>(C),
           static_cast<size_t>(output_count),
           static_cast<size_t>(kernel_size));
+    };
 
-      Ydata += output_count * C;
-      output_start += output_count;
-    }
+    concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, task_count, pool_worker);
 
     Xdata += input_image_size * C;
+    Ydata += output_image_size * C;
   }
 
   return Status::OK();
@@ -129,6 +176,7 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
 
 REGISTER_NHWCMAXPOOL_TYPED_KERNEL(int8_t);
 REGISTER_NHWCMAXPOOL_TYPED_KERNEL(uint8_t);
+REGISTER_NHWCMAXPOOL_TYPED_KERNEL(float);
 
 }  // namespace contrib
 }  // namespace onnxruntime
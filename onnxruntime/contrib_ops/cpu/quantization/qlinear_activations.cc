@@ -4,6 +4,9 @@
 #include "qlinear_activations.h"
 #include "qlinear_lookup_table.h"
 
+#include <limits>
+#include <string>
+
 #include "core/mlas/inc/mlas.h"
 #include "core/platform/threadpool.h"
 
@@ -35,11 +38,6 @@ void QLinearLookupBase<T>::BuildLookupTableIfFixed(const OpKernelInfo& info, Tra
 template <typename T>
 template <typename Transformer>
 Status QLinearLookupBase<T>::ComputeBase(OpKernelContext* context, Transformer fn) const {
-  const auto& X = *context->Input<Tensor>(0);
-  const auto& input_shape = X.Shape();
-  const auto N = input_shape.Size();
-  auto& Y = *context->Output(0, input_shape);
-
   uint8_t table[256];
   if (fixed_lookup_table_.size() == 0) {
     QlinearBuildLookupTable<T>(
@@ -47,6 +45,17 @@ Status QLinearLookupBase<T>::ComputeBase(OpKernelContext* context, Transformer f
         context->Input<Tensor>(3), context->Input<Tensor>(4), fn);
   }
 
+  ApplyLookupTable(context, fixed_lookup_table_.size() ? fixed_lookup_table_.data() : table);
+  return Status::OK();
+}
+
+template <typename T>
+void QLinearLookupBase<T>::ApplyLookupTable(OpKernelContext* context, const uint8_t* table) {
+  const auto& X = *context->Input<Tensor>(0);
+  const auto& input_shape = X.Shape();
+  const auto N = input_shape.Size();
+  auto& Y = *context->Output(0, input_shape);
+
   using onnxruntime::TensorOpCost;
   using onnxruntime::concurrency::ThreadPool;
   ThreadPool* tp = context->GetOperatorThreadPool();
@@ -54,15 +63,9 @@ Status QLinearLookupBase<T>::ComputeBase(OpKernelContext* context, Transformer f
   uint8_t* y_data = reinterpret_cast<uint8_t*>(Y.MutableData<T>());
   ThreadPool::TryParallelFor(
       tp, N, TensorOpCost{1.0, 1.0, 1.0},
-      [this, x_data, y_data, &table](std::ptrdiff_t first, std::ptrdiff_t last) {
-        QLinearLookupTableTransform(
-            x_data + first,
-            fixed_lookup_table_.size() ? fixed_lookup_table_.data() : table,
-            y_data + first,
-            last - first);
+      [x_data, y_data, table](std::ptrdiff_t first, std::ptrdiff_t last) {
+        QLinearLookupTableTransform(x_data + first, table, y_data + first, last - first);
       });
-
-  return Status::OK();
 }
 
 // Derived classes from QLinearLookupBase
@@ -96,6 +99,88 @@ Status QLinearSigmoid<T>::Compute(OpKernelContext* context) const {
   });
 }
 
+template <typename T>
+QLinearElementwiseChain<T>::QLinearElementwiseChain(const OpKernelInfo& info)
+    : QLinearLookupBase<T>(info) {
+  const auto ops = info.GetAttrsOrDefault<std::string>("ops");
+  const auto scales = info.GetAttrsOrDefault<float>("scales");
+  const auto zero_points = info.GetAttrsOrDefault<int64_t>("zero_points");
+  const auto operands = info.GetAttrsOrDefault<int64_t>("operands");
+  const auto alphas = info.GetAttrsOrDefault<float>("alphas");
+
+  const size_t num_ops = ops.size();
+  ORT_ENFORCE(num_ops > 0, "QLinearElementwiseChain : ops must not be empty");
+  ORT_ENFORCE(scales.size() == 3 * num_ops && zero_points.size() == 3 * num_ops,
+              "QLinearElementwiseChain : scales and zero_points must have 3 values per operator");
+  ORT_ENFORCE(operands.size() == num_ops && alphas.size() == num_ops,
+              "QLinearElementwiseChain : operands and alphas must have 1 value per operator");
+
+  auto quantized_value = [](int64_t value) {
+    ORT_ENFORCE(value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max(),
+                "QLinearElementwiseChain : quantized value ", value, " is out of range");
+    return static_cast<T>(value);
+  };
+
+  // chain_table[x] is the output of the operators processed so far for the input byte x
+  auto& chain_table = this->fixed_lookup_table_;
+  chain_table.resize(256);
+  for (size_t x = 0; x < 256; ++x) {
+    chain_table[x] = static_cast<uint8_t>(x);
+  }
+
+  uint8_t table[256];
+  for (size_t i = 0; i < num_ops; ++i) {
+    const std::string& op = ops[i];
+    const float x_scale = scales[3 * i];
+    const float y_scale = scales[3 * i + 2];
+    const T x_zero_point = quantized_value(zero_points[3 * i]);
+    const T y_zero_point = quantized_value(zero_points[3 * i + 2]);
+
+    // each table is built exactly like the kernel of the operator builds or computes it,
+    // so the chain produces the same values as running the operators one after the other
+    if (op == "QLinearLeakyRelu") {
+      const float alpha = alphas[i];
+      QlinearBuildLookupTable<T>(table, x_scale, x_zero_point, y_scale, y_zero_point,
+                                 [alpha](float v) -> float {
+                                   return v >= 0.0f ? v : alpha * v;
+                                 });
+    } else if (op == "QLinearSigmoid") {
+      QlinearBuildLookupTable<T>(table, x_scale, x_zero_point, y_scale, y_zero_point,
+                                 [](const float* input, float* output, size_t length) {
+                                   MlasComputeLogistic(input, output, length);
+                                 });
+    } else if (op == "QLinearAdd" || op == "QLinearMul") {
+      T inputs[256];
+      for (size_t x = 0; x < 256; ++x) {
+        inputs[x] = static_cast<T>(x);
+      }
+      const T operand = quantized_value(operands[i]);
+      const float operand_scale = scales[3 * i + 1];
+      const T operand_zero_point = quantized_value(zero_points[3 * i + 1]);
+      auto* outputs = reinterpret_cast<T*>(table);
+      if (op == "QLinearAdd") {
+        MlasQLinearAdd(inputs, x_scale, x_zero_point, &operand, operand_scale, operand_zero_point,
+                       y_scale, y_zero_point, outputs, 256, true);
+      } else {
+        MlasQLinearMul(inputs, x_scale, x_zero_point, &operand, operand_scale, operand_zero_point,
+                       y_scale, y_zero_point, outputs, 256, true);
+      }
+    } else {
+      ORT_THROW("QLinearElementwiseChain : unsupported operator ", op);
+    }
+
+    for (auto& value : chain_table) {
+      value = table[value];
+    }
+  }
+}
+
+template <typename T>
+Status QLinearElementwiseChain<T>::Compute(OpKernelContext* context) const {
+  this->ApplyLookupTable(context, this->fixed_lookup_table_.data());
+  return Status::OK();
+}
+
 #define REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(op_name, version, data_type, KERNEL_CLASS) \
   ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(                                                         \
       op_name, version, data_type,                                                           \
@@ -107,6 +192,8 @@ REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearLeakyRelu, 1, int8_t, QLinearLe
 REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearLeakyRelu, 1, uint8_t, QLinearLeakyRelu);
 REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearSigmoid, 1, int8_t, QLinearSigmoid);
 REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearSigmoid, 1, uint8_t, QLinearSigmoid);
+REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearElementwiseChain, 1, int8_t, QLinearElementwiseChain);
+REGISTER_QLINEAR_LOOKUPTABLE_TYPED_KERNEL(QLinearElementwiseChain, 1, uint8_t, QLinearElementwiseChain);
 
 }  // namespace contrib
 }  // namespace onnxruntime
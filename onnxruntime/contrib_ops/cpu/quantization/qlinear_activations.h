@@ -25,6 +25,9 @@ class QLinearLookupBase : public OpKernel {
   template <typename Transformer>
   void BuildLookupTableIfFixed(const OpKernelInfo& info, Transformer fn);
 
+  // Maps input 0 to output 0 through table.
+  static void ApplyLookupTable(OpKernelContext* context, const uint8_t* table);
+
   // when input quantizaton parameters are const, pre-compute table value.
   // After construction, non-zero size means pre-computed. Save space when not pre-computed.
   std::vector<uint8_t> fixed_lookup_table_;
@@ -49,6 +52,17 @@ class QLinearSigmoid final : public QLinearLookupBase<T> {
   Status Compute(OpKernelContext* context) const override;
 };
 
+// Chain of quantized element-wise operators created by QLinearElementwiseChainFusion.
+// Every step maps a quantized value to a quantized value, so the tables of the steps are composed
+// into a single table when the kernel is created and the chain runs as one lookup pass.
+template <typename T>
+class QLinearElementwiseChain final : public QLinearLookupBase<T> {
+ public:
+  QLinearElementwiseChain(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
 }  // namespace contrib
 }  // namespace onnxruntime
 
@@ -61,6 +61,14 @@ void QlinearBuildLookupTable(uint8_t* table,
   const T Y_zero_point =
     (tensor_y_zero_point == nullptr) ? static_cast<T>(0) : *(tensor_y_zero_point->Data<T>());
 
+  QlinearBuildLookupTable<T>(table, X_scale, X_zero_point, Y_scale, Y_zero_point, array_values_transformer);
+}
+
+template <typename T>
+void QlinearBuildLookupTable(uint8_t* table,
+                             float X_scale, T X_zero_point,
+                             float Y_scale, T Y_zero_point,
+                             const LookupTableArrayTransformer& array_values_transformer) {
   float dequantized_input[256];
   float dequantized_output[256];
   for (int i = 0; i < 256; ++i) {
@@ -88,6 +96,20 @@ void QlinearBuildLookupTable(uint8_t* table,
                                     tensor_y_scale, tensor_y_zero_point, array_values_transformer);
 }
 
+template <typename T>
+void QlinearBuildLookupTable(uint8_t* table,
+                             float x_scale, T x_zero_point,
+                             float y_scale, T y_zero_point,
+                             const LookupTableScalarTransformer& value_transformer) {
+  LookupTableArrayTransformer array_values_transformer =
+      [&value_transformer](const float* input, float* output, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+          *output++ = value_transformer(*input++);
+        }
+      };
+  return QlinearBuildLookupTable<T>(table, x_scale, x_zero_point, y_scale, y_zero_point, array_values_transformer);
+}
+
 template void QlinearBuildLookupTable<uint8_t>(uint8_t* table,
                                                const Tensor* tensor_x_scale,
                                                const Tensor* tensor_x_zero_point,
@@ -102,5 +124,25 @@ template void QlinearBuildLookupTable<int8_t>(uint8_t* table,
                                               const Tensor* tensor_y_zero_point,
                                               const LookupTableScalarTransformer& value_transformer);
 
+template void QlinearBuildLookupTable<uint8_t>(uint8_t* table,
+                                               float x_scale, uint8_t x_zero_point,
+                                               float y_scale, uint8_t y_zero_point,
+                                               const LookupTableArrayTransformer& array_values_transformer);
+
+template void QlinearBuildLookupTable<int8_t>(uint8_t* table,
+                                              float x_scale, int8_t x_zero_point,
+                                              float y_scale, int8_t y_zero_point,
+                                              const LookupTableArrayTransformer& array_values_transformer);
+
+template void QlinearBuildLookupTable<uint8_t>(uint8_t* table,
+                                               float x_scale, uint8_t x_zero_point,
+                                               float y_scale, uint8_t y_zero_point,
+                                               const LookupTableScalarTransformer& value_transformer);
+
+template void QlinearBuildLookupTable<int8_t>(uint8_t* table,
+                                              float x_scale, int8_t x_zero_point,
+                                              float y_scale, int8_t y_zero_point,
+                                              const LookupTableScalarTransformer& value_transformer);
+
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -34,6 +34,19 @@ void QlinearBuildLookupTable(uint8_t* table,
                              const Tensor* tensor_y_zero_point,
                              const LookupTableScalarTransformer& value_transformer);
 
+// Same as above with the quantization parameters given as values.
+template <typename T>
+void QlinearBuildLookupTable(uint8_t* table,
+                             float x_scale, T x_zero_point,
+                             float y_scale, T y_zero_point,
+                             const LookupTableArrayTransformer& array_values_transformer);
+
+template <typename T>
+void QlinearBuildLookupTable(uint8_t* table,
+                             float x_scale, T x_zero_point,
+                             float y_scale, T y_zero_point,
+                             const LookupTableScalarTransformer& value_transformer);
+
 template <typename TOutput>
 void QLinearLookupTableTransform(const uint8_t* x, const TOutput* table, TOutput* y, size_t n);
 
@@ -1,11 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+
 #include "core/common/common.h"
 #include "core/common/utf8_util.h"
 #include "core/framework/tensor.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "re2/re2.h"
+#include "re2/set.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -23,18 +30,58 @@ class Tokenizer final : public OpKernel {
   Status CharTokenize(OpKernelContext* context, size_t N, size_t C,
                       gsl::span<const int64_t> input_dims) const;
 
-  Status SeparatorExpressionTokenizer(OpKernelContext* context, size_t N, size_t C,
-                                      gsl::span<const int64_t> input_dims) const;
-
-  Status TokenExpression(OpKernelContext* ctx,
-                         size_t N, size_t C,
-                         gsl::span<const int64_t> input_dims) const;
+  // The tokens of a batch of consecutive rows back to back. They refer to the input strings so no token is copied
+  // before it is written to the output.
+  struct TokenRows {
+    size_t first_row = 0;
+    std::vector<re2::StringPiece> tokens;
+    // end of each row in tokens
+    std::vector<size_t> row_ends;
+    size_t max_tokens = 0;
+    // scratch space of the separator tokenizer, re-used for all the rows of the batch
+    std::vector<re2::StringPiece> pending;
+    std::vector<re2::StringPiece> split;
+    std::vector<int> matched_separators;
+  };
+
+  // Tokenize every input string with tokenize_row and write the output.
+  // The rows are split in batches that are tokenized in parallel on the intra-op thread pool.
+  template <typename RowTokenizer>
+  Status TokenizeRows(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                      const RowTokenizer& tokenize_row) const;
+
+  // Row tokenizers. They append the tokens of one row to rows.tokens.
+  void SplitOnSeparatorChars(re2::StringPiece text, TokenRows& rows) const;
+  Status SplitOnSeparatorExpressions(re2::StringPiece text, TokenRows& rows) const;
+  Status MatchTokenExpression(re2::StringPiece text, TokenRows& rows) const;
+
+  // Split every token in `tokens` on the matches of sep and append the pieces to `split`
+  Status SplitOnSeparator(const re2::RE2& sep, const std::vector<re2::StringPiece>& tokens,
+                          std::vector<re2::StringPiece>& split) const;
+
+  bool IsLongEnough(re2::StringPiece token) const;
+
+  // Write the tokens of each row to the output with the start/end marks and padding
+  Status OutputTokens(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                      gsl::span<const TokenRows> batches) const;
 
   bool mark_{false};
   std::string pad_value_;
   int64_t mincharnum_{0};
   bool char_tokenezation_{false};
   std::vector<std::unique_ptr<re2::RE2>> separators_;
+  // Set when all the separators are single ASCII characters. The string is then split on any of them in a single
+  // pass, which is equivalent to applying the separators one after the other.
+  bool split_on_chars_{false};
+  std::array<bool, 256> separator_chars_{};
+  // All the separators that can not match in a part of a string unless they match in the whole string,
+  // so a separator that the set does not match for a string is not applied to the string.
+  // Null with a single separator or when none qualifies.
+  std::unique_ptr<re2::RE2::Set> separator_set_;
+  // index in separators_ of the separators in separator_set_
+  std::vector<int> set_separators_;
+  // index in separators_ of the separators that are always applied
+  std::vector<int> unfiltered_separators_;
   std::unique_ptr<re2::RE2> regex_;
 };
 
@@ -51,6 +98,33 @@ ONNX_CPU_OPERATOR_TYPED_MS_KERNEL(
 namespace tokenizer_details {
 constexpr char start_text = 0x2;
 constexpr char end_text = 0x3;
+
+// Minimum number of input bytes per batch of rows that are tokenized in parallel
+constexpr size_t kMinBytesPerBatch = 16 * 1024;
+
+// Returns the character a separator matches if it is a single ASCII character, or -1.
+// Only a character or an escaped punctuation character qualifies, classes and other escapes do not.
+int SingleCharSeparator(const std::string& sep) {
+  constexpr const char* kMetaChars = "\\^$.|?*+()[]{}";
+  if (sep.size() == 1) {
+    const unsigned char c = static_cast<unsigned char>(sep[0]);
+    return c < 0x80 && strchr(kMetaChars, c) == nullptr ? c : -1;
+  }
+  if (sep.size() == 2 && sep[0] == '\\') {
+    const unsigned char c = static_cast<unsigned char>(sep[1]);
+    return c < 0x80 && ispunct(c) ? c : -1;
+  }
+  return -1;
+}
+
+// Whether a match of the separator in a part of a string is always also a match in the whole string.
+// That is not the case for the assertions that look at what precedes or follows the match.
+// Conservative, so a pattern such as [^a] is treated as context dependent.
+bool IsContextFree(const std::string& sep) {
+  return sep.find_first_of("^$") == std::string::npos &&
+         sep.find("\\b") == std::string::npos && sep.find("\\B") == std::string::npos &&
+         sep.find("\\A") == std::string::npos && sep.find("\\z") == std::string::npos;
+}
 }  // namespace tokenizer_details
 
 using namespace tokenizer_details;
@@ -90,6 +164,16 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
   // Check if we have separators or tokenexp
   if (!char_tokenezation_) {
     if (!separators.empty()) {
+      split_on_chars_ = true;
+      for (const auto& sep : separators) {
+        const int c = SingleCharSeparator(sep);
+        if (c < 0) {
+          split_on_chars_ = false;
+          break;
+        }
+        separator_chars_[c] = true;
+      }
+
       re2::RE2::Options options;
       options.set_longest_match(true);
       for (const auto& sep : separators) {
@@ -99,6 +183,23 @@ Tokenizer::Tokenizer(const OpKernelInfo& info) : OpKernel(info) {
         }
         separators_.push_back(std::move(regex));
       }
+
+      if (!split_on_chars_ && separators.size() > 1) {
+        auto separator_set = std::make_unique<re2::RE2::Set>(options, re2::RE2::UNANCHORED);
+        for (size_t i = 0; i < separators.size(); ++i) {
+          if (IsContextFree(separators[i]) && separator_set->Add(separators[i], nullptr) >= 0) {
+            set_separators_.push_back(static_cast<int>(i));
+          } else {
+            unfiltered_separators_.push_back(static_cast<int>(i));
+          }
+        }
+        if (!set_separators_.empty() && separator_set->Compile()) {
+          separator_set_ = std::move(separator_set);
+        } else {
+          set_separators_.clear();
+          unfiltered_separators_.clear();
+        }
+      }
     } else {
       // Use tokenexp
       assert(!tokenexp.empty());
@@ -170,7 +271,7 @@ Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
       assert(result);
       (void)result;
       assert(token_idx + tlen <= str_len);
-      *(output_data + output_index) = s.substr(token_idx, tlen);
+      (output_data + output_index)->assign(s.data() + token_idx, tlen);
       ++output_index;
       token_idx += tlen;
       ++tokens;
@@ -191,89 +292,11 @@ Status Tokenizer::CharTokenize(OpKernelContext* ctx, size_t N, size_t C,
   return Status::OK();
 }
 
-Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
-                                               size_t N, size_t C,
-                                               gsl::span<const int64_t> input_dims) const {
-  using namespace re2;
-  std::vector<std::vector<StringPiece>> rows;
-  rows.reserve(N * C);
-
-  // We do not constraint the search to match
-  // on the beginning or end of the string
-  const RE2::Anchor anchor = RE2::UNANCHORED;
-
-  // Scan all strings and attempt to find separators in them
-  // collect all the output tokens here
+Status Tokenizer::OutputTokens(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                               gsl::span<const TokenRows> batches) const {
   size_t max_tokens = 0;
-  auto X = ctx->Input<Tensor>(0);
-  auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
-  while (curr_input != last) {
-    const auto& s = *curr_input;
-    size_t utf8_chars = 0;  // length in utf8 chars
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       utf8_chars)) {
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars: " + s);
-    }
-
-    std::vector<StringPiece> row{s};
-
-    for (const auto& sep : separators_) {
-      std::vector<StringPiece> tokens;
-      for (const auto& text : row) {
-        const auto end_pos = text.length();
-        size_t start_pos = 0;
-        StringPiece submatch;
-
-        bool match = true;
-        do {
-          match = sep->Match(text, start_pos, end_pos, anchor, &submatch, 1);
-          if (match) {
-            // Record  pos/len
-            assert(submatch.data() != nullptr);
-            size_t match_pos = submatch.data() - text.data();
-            assert(match_pos >= start_pos);
-            auto token_len = match_pos - start_pos;
-            utf8_chars = 0;
-            bool valid = utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
-                                  token_len, utf8_chars);
-            if (!valid) {
-              return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                            "Match contains invalid utf8 chars: " + submatch.as_string());
-            }
-            if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, token_len);
-            }
-            // Update starting position
-            // Guard against empty string match
-            auto match_len = submatch.length();
-            if (match_len > 0) {
-              start_pos = match_pos + match_len;
-            } else {
-              size_t bytes = 0;
-              utf8_bytes(*submatch.data(), bytes);
-              start_pos = match_pos + bytes;
-            }
-          } else {
-            // record trailing token
-            auto trailing_len = end_pos - start_pos;
-            utf8_chars = 0;
-            utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
-                     trailing_len, utf8_chars);
-            if (utf8_chars >= size_t(mincharnum_)) {
-              tokens.emplace_back(text.data() + start_pos, trailing_len);
-            }
-          }
-        } while (match);
-      }  // row
-      // Replace the row with the results of this tokenezation
-      row.swap(tokens);
-    }  // separators_
-    max_tokens = std::max(max_tokens, row.size());
-    rows.push_back(std::move(row));
-    ++curr_input;
+  for (const auto& rows : batches) {
+    max_tokens = std::max(max_tokens, rows.max_tokens);
   }
 
   std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
@@ -294,166 +317,259 @@ Status Tokenizer::SeparatorExpressionTokenizer(OpKernelContext* ctx,
   TensorShape output_shape(output_dims);
 
   auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
+  std::string* const output_start = output_tensor->MutableData<std::string>();
+
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(batches.size()),
+      [this, &batches, output_start, max_tokens](std::ptrdiff_t batch_idx) {
+        const TokenRows& rows = batches[batch_idx];
+        std::string* output_data = output_start + rows.first_row * max_tokens;
+        size_t row_start = 0;
+        for (size_t row_end : rows.row_ends) {
+          std::string* output = output_data;
+          if (mark_) {
+            (output++)->assign(&start_text, 1);
+          }
+          // Output tokens for this row
+          for (size_t i = row_start; i < row_end; ++i) {
+            const auto& token = rows.tokens[i];
+            (output++)->assign(token.data(), token.size());
+          }
+          if (mark_) {
+            (output++)->assign(&end_text, 1);
+          }
+          assert(static_cast<size_t>(output - output_data) <= max_tokens);
+          output_data += max_tokens;
+          for (; output != output_data; ++output) {
+            *output = pad_value_;
+          }
+          row_start = row_end;
+        }
+      });
 
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  size_t output_index = 0;
-  curr_input = input_data;
-  for (auto& row : rows) {
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.size());
-      ++output_index;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
-    }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
-    ++curr_input;
-  }
   return Status::OK();
 }
 
-Status Tokenizer::TokenExpression(OpKernelContext* ctx,
-                                  size_t N, size_t C,
-                                  gsl::span<const int64_t> input_dims) const {
-  using namespace re2;
-  // Represents a token that will be output after
-  // first is the index, second is the size;
-  std::vector<std::vector<StringPiece>> tokens;
-  tokens.reserve(N * C);
-
-  size_t max_tokens = 0;
+template <typename RowTokenizer>
+Status Tokenizer::TokenizeRows(OpKernelContext* ctx, gsl::span<const int64_t> input_dims,
+                               const RowTokenizer& tokenize_row) const {
   auto X = ctx->Input<Tensor>(0);
-  auto const input_data = X->Data<std::string>();
-  auto curr_input = input_data;
-  auto const last = input_data + N * C;
+  auto const input = X->DataAsSpan<std::string>();
+  concurrency::ThreadPool* tp = ctx->GetOperatorThreadPool();
 
-  // We do not constraint the search to match
-  // on the beginning or end of the string
-  const RE2::Anchor anchor = RE2::UNANCHORED;
+  // Each batch appends to its own token list. Only split the rows when there is enough text to make it worthwhile.
+  size_t total_bytes = 0;
+  for (const auto& s : input) {
+    total_bytes += s.size();
+  }
+  const size_t num_batches = std::max<size_t>(
+      1, std::min({input.size(), static_cast<size_t>(concurrency::ThreadPool::DegreeOfParallelism(tp)),
+                   total_bytes / kMinBytesPerBatch}));
+
+  std::vector<TokenRows> batches(num_batches);
+  std::vector<Status> statuses(num_batches);
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      tp, static_cast<std::ptrdiff_t>(num_batches),
+      [&](std::ptrdiff_t batch_idx) {
+        const auto work = concurrency::ThreadPool::PartitionWork(batch_idx, static_cast<std::ptrdiff_t>(num_batches),
+                                                                 static_cast<std::ptrdiff_t>(input.size()));
+        TokenRows& rows = batches[batch_idx];
+        rows.first_row = static_cast<size_t>(work.start);
+        rows.row_ends.reserve(static_cast<size_t>(work.end - work.start));
+        for (std::ptrdiff_t row = work.start; row < work.end; ++row) {
+          const auto& s = input[row];
+          size_t utf8_chars = 0;  // length in utf8 chars
+          if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
+                             utf8_chars)) {
+            statuses[batch_idx] = Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                                         "Input string contains invalid utf8 chars: " + s);
+            return;
+          }
 
-  while (curr_input != last) {
-    const auto& s = *curr_input;
+          const size_t row_start = rows.tokens.size();
+          Status status = tokenize_row(re2::StringPiece(s), rows);
+          if (!status.IsOK()) {
+            statuses[batch_idx] = std::move(status);
+            return;
+          }
+          rows.max_tokens = std::max(rows.max_tokens, rows.tokens.size() - row_start);
+          rows.row_ends.push_back(rows.tokens.size());
+        }
+      });
 
-    size_t utf8_chars = 0;
-    if (!utf8_validate(reinterpret_cast<const unsigned char*>(s.data()), s.size(),
-                       utf8_chars)) {
-      return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                    "Input string contains invalid utf8 chars: " + s);
+  for (const auto& status : statuses) {
+    ORT_RETURN_IF_ERROR(status);
+  }
+
+  return OutputTokens(ctx, input_dims, batches);
+}
+
+bool Tokenizer::IsLongEnough(re2::StringPiece token) const {
+  if (token.empty()) {
+    return false;
+  }
+  if (mincharnum_ == 1) {
+    return true;
+  }
+  size_t utf8_chars = 0;
+  utf8_len(reinterpret_cast<const unsigned char*>(token.data()), token.size(), utf8_chars);
+  return utf8_chars >= size_t(mincharnum_);
+}
+
+void Tokenizer::SplitOnSeparatorChars(re2::StringPiece text, TokenRows& rows) const {
+  // All the separators are ASCII so they can not match in the middle of a multibyte utf8 character
+  const char* token_start = text.data();
+  const char* const end = text.data() + text.size();
+  for (const char* p = token_start; p != end; ++p) {
+    if (separator_chars_[static_cast<unsigned char>(*p)]) {
+      re2::StringPiece token(token_start, p - token_start);
+      if (IsLongEnough(token)) {
+        rows.tokens.push_back(token);
+      }
+      token_start = p + 1;
     }
+  }
 
-    tokens.emplace_back();
-    auto& row = tokens.back();
+  // record trailing token
+  re2::StringPiece token(token_start, end - token_start);
+  if (IsLongEnough(token)) {
+    rows.tokens.push_back(token);
+  }
+}
 
-    StringPiece text(s);
-    const auto end_pos = s.length();
+Status Tokenizer::SplitOnSeparator(const re2::RE2& sep, const std::vector<re2::StringPiece>& tokens,
+                                   std::vector<re2::StringPiece>& split) const {
+  using namespace re2;
+  // We do not constraint the search to match
+  // on the beginning or end of the string
+  const RE2::Anchor anchor = RE2::UNANCHORED;
+
+  for (const auto& text : tokens) {
+    const auto end_pos = text.length();
     size_t start_pos = 0;
     StringPiece submatch;
 
     bool match = true;
     do {
-      match = regex_->Match(text, start_pos, end_pos, anchor, &submatch, 1);
+      match = sep.Match(text, start_pos, end_pos, anchor, &submatch, 1);
       if (match) {
         // Record  pos/len
         assert(submatch.data() != nullptr);
-        size_t match_pos = submatch.data() - s.data();
+        size_t match_pos = submatch.data() - text.data();
         assert(match_pos >= start_pos);
-        // Guard against empty match and make
-        // sure we make progress either way
-        auto token_len = submatch.length();
-        utf8_chars = 0;
-        if (!utf8_len(reinterpret_cast<const unsigned char*>(submatch.data()), token_len, utf8_chars)) {
+        auto token_len = match_pos - start_pos;
+        size_t utf8_chars = 0;
+        bool valid = utf8_len(reinterpret_cast<const unsigned char*>(text.data() + start_pos),
+                              token_len, utf8_chars);
+        if (!valid) {
           return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
                         "Match contains invalid utf8 chars: " + submatch.as_string());
         }
         if (utf8_chars >= size_t(mincharnum_)) {
-          row.push_back(submatch);
-          start_pos = match_pos + token_len;
+          split.emplace_back(text.data() + start_pos, token_len);
+        }
+        // Update starting position
+        // Guard against empty string match
+        auto match_len = submatch.length();
+        if (match_len > 0) {
+          start_pos = match_pos + match_len;
         } else {
           size_t bytes = 0;
           utf8_bytes(*submatch.data(), bytes);
           start_pos = match_pos + bytes;
         }
+      } else {
+        // record trailing token
+        StringPiece token(text.data() + start_pos, end_pos - start_pos);
+        if (IsLongEnough(token)) {
+          split.push_back(token);
+        }
       }
     } while (match);
-    max_tokens = std::max(max_tokens, row.size());
-    ++curr_input;
   }
 
-  // Check for empty output
-  std::vector<int64_t> output_dims(input_dims.begin(), input_dims.end());
-  // Check if we have no output due to either empty input
-  // everything is a separator
-  if (max_tokens == 0) {
-    output_dims.push_back(0);
-    TensorShape output_shape(output_dims);
-    ctx->Output(0, output_shape);
+  return Status::OK();
+}
+
+Status Tokenizer::SplitOnSeparatorExpressions(re2::StringPiece text, TokenRows& rows) const {
+  auto& pending = rows.pending;
+  auto& split = rows.split;
+  pending.clear();
+  pending.push_back(text);
+
+  const auto apply = [&](int sep_idx) -> Status {
+    split.clear();
+    ORT_RETURN_IF_ERROR(SplitOnSeparator(*separators_[sep_idx], pending, split));
+    // Replace the row with the results of this tokenezation
+    pending.swap(split);
     return Status::OK();
-  }
+  };
 
-  if (mark_) {
-    max_tokens += 2;  // Start/end markers as separate tokens
+  if (separator_set_ == nullptr) {
+    for (size_t i = 0; i < separators_.size(); ++i) {
+      ORT_RETURN_IF_ERROR(apply(static_cast<int>(i)));
+    }
+  } else {
+    // Find the separators that occur in the string in one pass and only apply those, in their original order.
+    auto& matched = rows.matched_separators;
+    matched.clear();
+    re2::RE2::Set::ErrorInfo error_info{};
+    if (separator_set_->Match(text, &matched, &error_info)) {
+      for (int& set_idx : matched) {
+        set_idx = set_separators_[set_idx];
+      }
+    } else if (error_info.kind != re2::RE2::Set::kNoError) {
+      // the set could not be matched (e.g. the DFA ran out of memory). apply all the separators.
+      matched = set_separators_;
+    }
+    matched.insert(matched.end(), unfiltered_separators_.cbegin(), unfiltered_separators_.cend());
+    std::sort(matched.begin(), matched.end());
+
+    for (int sep_idx : matched) {
+      ORT_RETURN_IF_ERROR(apply(sep_idx));
+    }
   }
 
-  output_dims.push_back(max_tokens);
-  TensorShape output_shape(output_dims);
+  rows.tokens.insert(rows.tokens.end(), pending.cbegin(), pending.cend());
+  return Status::OK();
+}
 
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
+Status Tokenizer::MatchTokenExpression(re2::StringPiece text, TokenRows& rows) const {
+  using namespace re2;
+  // We do not constraint the search to match
+  // on the beginning or end of the string
+  const RE2::Anchor anchor = RE2::UNANCHORED;
 
-#ifdef _DEBUG
-  const size_t max_output_index = N * C * max_tokens;
-#endif
-  curr_input = input_data;
-  size_t output_index = 0;
-  for (const auto& row : tokens) {
-    assert(curr_input != last);
-#ifdef _DEBUG
-    size_t c_idx = output_index;
-#endif
-    if (mark_) {
-      (output_data + output_index)->assign(&start_text, 1);
-      ++output_index;
-    }
-    // Output tokens for this row
-    for (const auto& token : row) {
-      (output_data + output_index)->assign(token.data(), token.length());
-      ++output_index;
-    }
-    if (mark_) {
-      (output_data + output_index)->assign(&end_text, 1);
-      ++output_index;
-    }
-    const size_t pads = max_tokens - (static_cast<size_t>(mark_) * 2) - row.size();
-    for (size_t p = 0; p < pads; ++p) {
-      *(output_data + output_index) = pad_value_;
-      ++output_index;
+  const auto end_pos = text.length();
+  size_t start_pos = 0;
+  StringPiece submatch;
+
+  bool match = true;
+  do {
+    match = regex_->Match(text, start_pos, end_pos, anchor, &submatch, 1);
+    if (match) {
+      // Record  pos/len
+      assert(submatch.data() != nullptr);
+      size_t match_pos = submatch.data() - text.data();
+      assert(match_pos >= start_pos);
+      // Guard against empty match and make
+      // sure we make progress either way
+      auto token_len = submatch.length();
+      size_t utf8_chars = 0;
+      if (!utf8_len(reinterpret_cast<const unsigned char*>(submatch.data()), token_len, utf8_chars)) {
+        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                      "Match contains invalid utf8 chars: " + submatch.as_string());
+      }
+      if (utf8_chars >= size_t(mincharnum_)) {
+        rows.tokens.push_back(submatch);
+        start_pos = match_pos + token_len;
+      } else {
+        size_t bytes = 0;
+        utf8_bytes(*submatch.data(), bytes);
+        start_pos = match_pos + bytes;
+      }
     }
-#ifdef _DEBUG
-    assert(output_index <= max_output_index);
-    assert((output_index - c_idx) <= max_tokens);
-#endif
-    ++curr_input;
-  }
+  } while (match);
 
   return Status::OK();
 }
@@ -499,11 +615,20 @@ Status Tokenizer::Compute(OpKernelContext* ctx) const {
   if (char_tokenezation_) {
     s = CharTokenize(ctx, N, C, input_dims);
   } else {
-    if (!separators_.empty()) {
-      s = SeparatorExpressionTokenizer(ctx, N, C, input_dims);
+    if (split_on_chars_) {
+      s = TokenizeRows(ctx, input_dims, [this](re2::StringPiece text, TokenRows& rows) {
+        SplitOnSeparatorChars(text, rows);
+        return Status::OK();
+      });
+    } else if (!separators_.empty()) {
+      s = TokenizeRows(ctx, input_dims, [this](re2::StringPiece text, TokenRows& rows) {
+        return SplitOnSeparatorExpressions(text, rows);
+      });
     } else {
       assert(regex_ != nullptr);
-      s = TokenExpression(ctx, N, C, input_dims);
+      s = TokenizeRows(ctx, input_dims, [this](re2::StringPiece text, TokenRows& rows) {
+        return MatchTokenExpression(text, rows);
+      });
     }
   }
   return s;
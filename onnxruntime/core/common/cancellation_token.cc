@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/cancellation_token.h"
+
+namespace onnxruntime {
+
+namespace {
+thread_local const CancellationToken* current_token = nullptr;
+thread_local bool loops_cancellable = false;
+}  // namespace
+
+Status CancellationToken::ToStatus() const {
+  if (terminate_flag_ || terminated_.load(std::memory_order_relaxed)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+  }
+  return ORT_MAKE_STATUS(ONNXRUNTIME, DEADLINE_EXCEEDED, "Exiting due to the run exceeding its deadline.");
+}
+
+const CancellationToken* CancellationToken::Current() noexcept {
+  return current_token;
+}
+
+const CancellationToken* CancellationToken::CurrentForLoops() noexcept {
+  return loops_cancellable ? current_token : nullptr;
+}
+
+CancellationToken::Scope::Scope(const CancellationToken* token) noexcept : previous_(current_token) {
+  current_token = token;
+}
+
+CancellationToken::Scope::~Scope() {
+  current_token = previous_;
+}
+
+CancellationToken::CancellableLoopsScope::CancellableLoopsScope() noexcept : previous_(loops_cancellable) {
+  loops_cancellable = true;
+}
+
+CancellationToken::CancellableLoopsScope::~CancellableLoopsScope() {
+  loops_cancellable = previous_;
+}
+
+}  // namespace onnxruntime
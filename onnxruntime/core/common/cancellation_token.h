@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "core/common/common.h"
+
+namespace onnxruntime {
+
+// Tells the work of one Run() call to stop, when the terminate flag of its RunOptions is set or when its deadline
+// has passed.
+//
+// The token of a run is made current on the threads executing its nodes with a CancellationToken::Scope, so that the
+// executors of nested subgraphs and long running kernels can check it without it being passed around. Parallel loops
+// only check it inside a CancellableLoopsScope, as skipping chunks of a loop is only safe for code that does not read
+// back what the loop computes once the run is cancelled.
+class CancellationToken {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit CancellationToken(const bool& terminate_flag, Clock::time_point deadline = Clock::time_point::max())
+      : terminate_flag_(terminate_flag), deadline_(deadline), has_deadline_(deadline != Clock::time_point::max()) {}
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(CancellationToken);
+
+  // Returns whether the run should stop. Cheap enough to be called for every chunk of a parallel loop: the clock is
+  // only read when the run has a deadline, and the result is latched once true.
+  bool IsCancelled() const noexcept {
+    if (cancelled_.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    if (terminate_flag_ || (has_deadline_ && Clock::now() >= deadline_)) {
+      cancelled_.store(true, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  // Cancels the run as if its terminate flag was set. Unlike writing the flag, this is safe from any thread while the
+  // run checks the token.
+  void Cancel() noexcept {
+    terminated_.store(true, std::memory_order_relaxed);
+    cancelled_.store(true, std::memory_order_relaxed);
+  }
+
+  // Returns the error to stop the run with: FAIL if it was terminated through its RunOptions or Cancel,
+  // DEADLINE_EXCEEDED if its deadline passed.
+  Status ToStatus() const;
+
+  // Returns the token of the run executing on the current thread, or nullptr.
+  static const CancellationToken* Current() noexcept;
+
+  // Returns the token parallel loops started on the current thread check, or nullptr outside a CancellableLoopsScope.
+  static const CancellationToken* CurrentForLoops() noexcept;
+
+  // Makes a token current on the calling thread for the lifetime of the scope.
+  class Scope {
+   public:
+    explicit Scope(const CancellationToken* token) noexcept;
+    ~Scope();
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Scope);
+
+   private:
+    const CancellationToken* previous_;
+  };
+
+  // Within the scope, the parallel loops started on the calling thread stop handing out chunks once the current token
+  // is cancelled. The caller must not use the results of a loop after the token is cancelled.
+  class CancellableLoopsScope {
+   public:
+    CancellableLoopsScope() noexcept;
+    ~CancellableLoopsScope();
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(CancellableLoopsScope);
+
+   private:
+    bool previous_;
+  };
+
+ private:
+  const bool& terminate_flag_;
+  const Clock::time_point deadline_;
+  const bool has_deadline_;
+  std::atomic<bool> terminated_{false};
+  mutable std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace onnxruntime
@@ -102,6 +102,8 @@ void CPUIDInfo::X86Init() {
         // Add check for AVX512 Skylake since tensorization GEMM need intrinsics from avx512bw/avx512dq.
         // avx512_skylake = avx512f | avx512vl | avx512cd | avx512bw | avx512dq
         has_avx512_skylake_ = has_avx512 && (data[1] & ((1 << 16) | (1 << 17) | (1 << 28) | (1 << 30) | (1 << 31)));
+        // UMONITOR/UMWAIT/TPAUSE
+        has_waitpkg_ = (data[2] & (1 << 5));
         is_hybrid_ = (data[3] & (1 << 15));
       }
     }
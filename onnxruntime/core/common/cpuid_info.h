@@ -22,6 +22,7 @@ class CPUIDInfo {
   bool HasF16C() const { return has_f16c_; }
   bool HasSSE3() const { return has_sse3_; }
   bool HasSSE4_1() const { return has_sse4_1_; }
+  bool HasWaitPkg() const { return has_waitpkg_; }
   bool IsHybrid() const { return is_hybrid_; }
 
   // ARM
@@ -104,6 +105,7 @@ class CPUIDInfo {
   bool has_f16c_{false};
   bool has_sse3_{false};
   bool has_sse4_1_{false};
+  bool has_waitpkg_{false};
   bool is_hybrid_{false};
 
   std::vector<uint32_t> core_uarchs_; // micro-arch of each core
@@ -13,10 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <chrono>
 #include <memory>
 #include <optional>
 
 #include "core/platform/threadpool.h"
+#include "core/common/cancellation_token.h"
 #include "core/common/common.h"
 #include "core/common/cpuid_info.h"
 #include "core/common/eigen_common_wrapper.h"
@@ -260,6 +262,11 @@ static constexpr unsigned MAX_SHARDS = 8;
 
 static constexpr int TaskGranularityFactor = 4;
 
+// Dynamic block base used on hybrid CPUs when the session doesn't configure one.  The degree of
+// parallelism already includes TaskGranularityFactor there, so the first blocks are 1/4 of a
+// thread's share and later ones shrink with the remaining work.
+static constexpr int HybridDynamicBlockBase = 1;
+
 struct alignas(CACHE_LINE_BYTES) LoopCounterShard {
   ::std::atomic<uint64_t> _next{0};
   uint64_t _end{0};
@@ -369,6 +376,14 @@ class alignas(CACHE_LINE_BYTES) LoopCounter {
 #pragma warning(pop) /* Padding added in LoopCounterShard, LoopCounter */
 #endif
 
+struct ThreadPool::ShareCounters {
+  std::atomic<uint64_t> loops{0};
+  std::atomic<uint64_t> chunks{0};
+  std::atomic<uint64_t> yields{0};
+  std::atomic<uint64_t> queue_time_ns{0};
+  std::atomic<uint64_t> cpu_time_ns{0};
+};
+
 ThreadPool::ThreadPool(Env* env,
                        const ThreadOptions& thread_options,
                        const NAME_CHAR_TYPE* name,
@@ -394,13 +409,90 @@ ThreadPool::ThreadPool(Env* env,
                                                 threads_to_create,
                                                 low_latency_hint,
                                                 *env,
-                                                thread_options_);
+                                                thread_options_,
+                                                CPUIDInfo::GetCPUIDInfo().HasWaitPkg());
     underlying_threadpool_ = extended_eigen_threadpool_.get();
   }
 }
 
+ThreadPool::ThreadPool(ThreadPool* shared, int thread_quota, ThreadPoolPriority priority)
+    : thread_options_(shared->thread_options_),
+      underlying_threadpool_(shared->underlying_threadpool_),
+      force_hybrid_(shared->force_hybrid_),
+      shared_(shared->shared_ != nullptr ? shared->shared_ : shared),
+      thread_quota_(thread_quota),
+      priority_(priority),
+      share_counters_(std::make_unique<ShareCounters>()) {
+  ORT_ENFORCE(thread_quota >= 0, "Thread quota must be non-negative, got ", thread_quota);
+  if (shared->thread_quota_ > 0 && (thread_quota_ == 0 || shared->thread_quota_ < thread_quota_)) {
+    thread_quota_ = shared->thread_quota_;
+  }
+}
+
 ThreadPool::~ThreadPool() = default;
 
+class ThreadPool::LoopWorkItem {
+ public:
+  LoopWorkItem(const ThreadPool& tp, const ThreadPool& owner, unsigned idx,
+               std::chrono::steady_clock::time_point loop_start, const CancellationToken* cancellation)
+      : counters_(tp.share_counters_.get()),
+        cancellation_(cancellation),
+        latency_critical_loops_(owner.latency_critical_loops_),
+        is_batch_helper_(tp.priority_ == ThreadPoolPriority::Batch && idx != 0),
+        is_helper_(idx != 0),
+        loop_start_(loop_start) {
+    if (counters_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~LoopWorkItem() {
+    if (counters_ != nullptr) {
+      const auto end = std::chrono::steady_clock::now();
+      counters_->chunks.fetch_add(chunks_, std::memory_order_relaxed);
+      counters_->cpu_time_ns.fetch_add(ElapsedNs(start_, end), std::memory_order_relaxed);
+      if (is_helper_) {
+        counters_->queue_time_ns.fetch_add(ElapsedNs(loop_start_, start_), std::memory_order_relaxed);
+      }
+      if (yielded_) {
+        counters_->yields.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns whether the work item should stop claiming chunks. The thread that entered the loop never yields, so the
+  // chunks left by the helper threads are still run, unless the run the loop belongs to was cancelled.
+  bool ShouldStop() {
+    if (cancellation_ != nullptr && cancellation_->IsCancelled()) {
+      return true;
+    }
+    if (is_batch_helper_ && latency_critical_loops_.load(std::memory_order_relaxed) > 0) {
+      yielded_ = true;
+    }
+    return yielded_;
+  }
+
+  void ChunkDone() {
+    ++chunks_;
+  }
+
+ private:
+  static uint64_t ElapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), 0));
+  }
+
+  ShareCounters* counters_;
+  const CancellationToken* cancellation_;
+  const std::atomic<int>& latency_critical_loops_;
+  const bool is_batch_helper_;
+  const bool is_helper_;
+  const std::chrono::steady_clock::time_point loop_start_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t chunks_{0};
+  bool yielded_{false};
+};
+
 // Base case for parallel loops, running iterations 0..total, divided into blocks
 // of block_size iterations, and calling into a function that takes a start..end
 // range of indices to run.
@@ -415,8 +507,44 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     return;
   }
 
+  // Latency critical loops are tracked on the pool owning the threads, where the batch loops of all the views of
+  // the pool see them.
+  ThreadPool& owner = shared_ != nullptr ? *shared_ : *this;
+  const bool is_latency_critical = priority_ == ThreadPoolPriority::LatencyCritical;
+  struct LatencyCriticalLoopScope {
+    LatencyCriticalLoopScope(std::atomic<int>& loops, bool active) : loops_(loops), active_(active) {
+      if (active_) {
+        loops_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    ~LatencyCriticalLoopScope() {
+      if (active_) {
+        loops_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    std::atomic<int>& loops_;
+    const bool active_;
+  } latency_critical_loop_scope(owner.latency_critical_loops_, is_latency_critical);
+  // Read on the thread entering the loop, the only one where the token of the run is current.
+  const CancellationToken* cancellation = CancellationToken::CurrentForLoops();
+  std::chrono::steady_clock::time_point loop_start;
+  if (share_counters_) {
+    share_counters_->loops.fetch_add(1, std::memory_order_relaxed);
+    loop_start = std::chrono::steady_clock::now();
+  }
+
   auto d_of_p = DegreeOfParallelism(this);
-  if (thread_options_.dynamic_block_base_ <= 0) {
+  int dynamic_block_base = thread_options_.dynamic_block_base_;
+  std::ptrdiff_t min_block_size = 1;
+  if (dynamic_block_base <= 0 && (force_hybrid_ || CPUIDInfo::GetCPUIDInfo().IsHybrid())) {
+    // On hybrid CPUs a block takes longer on an efficiency core than on a performance core, so with
+    // fixed-size blocks the efficiency cores become the stragglers at the end of the loop.  Hand out
+    // decreasing block sizes instead so that the last blocks claimed are small, but never go below
+    // the block size the caller found worthwhile to run on its own.
+    dynamic_block_base = HybridDynamicBlockBase;
+    min_block_size = block_size;
+  }
+  if (dynamic_block_base <= 0) {
     // Split the work across threads in the pool.  Each work item will run a loop claiming iterations,
     // hence we need at most one for each thread, even if the number of blocks of iterations is larger.
     auto num_blocks = total / block_size;
@@ -426,12 +554,15 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
 
     LoopCounter lc(total, d_of_p, block_size);
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
+      LoopWorkItem work_item(*this, owner, idx, loop_start, cancellation);
       unsigned my_home_shard = lc.GetHomeShard(idx);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
-      while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
+      while (!work_item.ShouldStop() &&
+             lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
+        work_item.ChunkDone();
       }
     };
     // Run the work in the thread pool (and in the current thread).  Synchronization with helping
@@ -439,21 +570,24 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     // run_work.
     RunInParallel(run_work, num_work_items, block_size);
   } else {
-    int num_of_blocks = d_of_p * thread_options_.dynamic_block_base_;
-    std::ptrdiff_t base_block_size = static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(total) / num_of_blocks)));
+    int num_of_blocks = d_of_p * dynamic_block_base;
+    std::ptrdiff_t base_block_size = std::max(min_block_size, static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(total) / num_of_blocks))));
     alignas(CACHE_LINE_BYTES) std::atomic<std::ptrdiff_t> left{total};
     LoopCounter lc(total, d_of_p, base_block_size);
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
+      LoopWorkItem work_item(*this, owner, idx, loop_start, cancellation);
       std::ptrdiff_t b = base_block_size;
       unsigned my_home_shard = lc.GetHomeShard(idx);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
-      while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, b)) {
+      while (!work_item.ShouldStop() &&
+             lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, b)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
+        work_item.ChunkDone();
         auto todo = left.fetch_sub(static_cast<std::ptrdiff_t>(my_iter_end - my_iter_start), std::memory_order_relaxed);
-        if (b > 1) {
-          b = static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(todo) / num_of_blocks)));
+        if (b > min_block_size) {
+          b = std::max(min_block_size, static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(todo) / num_of_blocks))));
         }
       }
     };
@@ -663,6 +797,29 @@ std::string ThreadPool::StopProfiling(concurrency::ThreadPool* tp) {
   }
 }
 
+ThreadPoolShareStats ThreadPool::GetShareStats(const concurrency::ThreadPool* tp) {
+  ThreadPoolShareStats stats;
+  if (tp && tp->share_counters_) {
+    const ShareCounters& counters = *tp->share_counters_;
+    stats.loops = counters.loops.load(std::memory_order_relaxed);
+    stats.chunks = counters.chunks.load(std::memory_order_relaxed);
+    stats.yields = counters.yields.load(std::memory_order_relaxed);
+    stats.queue_time_ns = counters.queue_time_ns.load(std::memory_order_relaxed);
+    stats.cpu_time_ns = counters.cpu_time_ns.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+std::vector<ThreadPoolWorkerStats> ThreadPool::GetWorkerStats(const concurrency::ThreadPool* tp) {
+  if (tp) {
+    const ThreadPool& owner = tp->shared_ != nullptr ? *tp->shared_ : *tp;
+    if (owner.extended_eigen_threadpool_) {
+      return owner.extended_eigen_threadpool_->GetWorkerStats();
+    }
+  }
+  return {};
+}
+
 void ThreadPool::EnableSpinning() {
   if (extended_eigen_threadpool_) {
     extended_eigen_threadpool_->EnableSpinning();
@@ -675,10 +832,14 @@ void ThreadPool::DisableSpinning() {
   }
 }
 
-// Return the number of threads created by the pool.
+// Return the number of threads created by the pool, or the number of them a view of a shared pool may use.
 int ThreadPool::NumThreads() const {
   if (underlying_threadpool_) {
-    return underlying_threadpool_->NumThreads();
+    int num_threads = underlying_threadpool_->NumThreads();
+    if (thread_quota_ > 0) {
+      num_threads = std::min(num_threads, thread_quota_ - 1);
+    }
+    return num_threads;
   } else {
     return 0;
   }
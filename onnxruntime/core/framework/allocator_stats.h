@@ -22,6 +22,8 @@ struct AllocatorStats {
                                   // is known. Certain allocator may return 0 to indicate the limit is
                                   // unknown.
   int64_t bytes_limit;
+  int64_t bytes_saved_by_sharing;  // Bytes that did not have to be allocated because an identical buffer
+                                   // (e.g. pre-packed weights) was shared with another kernel or session.
 
   AllocatorStats() { Clear(); }
 
@@ -35,6 +37,7 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->bytes_saved_by_sharing = 0;
   }
 
   std::string DebugString() const {
@@ -47,7 +50,8 @@ struct AllocatorStats {
        << "NumReserves:              " << this->num_reserves << "\n"
        << "NumArenaExtensions:       " << this->num_arena_extensions << "\n"
        << "NumArenaShrinkages:       " << this->num_arena_shrinkages << "\n"
-       << "MaxAllocSize:             " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:             " << this->max_alloc_size << "\n"
+       << "BytesSavedBySharing:      " << this->bytes_saved_by_sharing << "\n";
     return ss.str();
   }
 };
@@ -3,6 +3,7 @@
 
 #include "core/framework/allocator.h"
 #include "core/framework/bfc_arena.h"
+#include "core/platform/env.h"
 #include <type_traits>
 
 namespace onnxruntime {
@@ -202,6 +203,16 @@ Status BFCArena::Extend(size_t rounded_bytes) {
 
   LOGS_DEFAULT(INFO) << "Allocated memory at " << mem_addr << " to "
                      << static_cast<void*>(static_cast<char*>(mem_addr) + bytes);
+
+  if (numa_node_ >= 0) {
+    // the region hasn't been touched yet, so binding it now decides where its pages are faulted in.
+    auto bind_status = Env::Default().BindMemoryToNumaNode(mem_addr, bytes, numa_node_);
+    if (!bind_status.IsOK()) {
+      LOGS_DEFAULT(WARNING) << "Unable to bind arena region to NUMA node " << numa_node_ << ": "
+                            << bind_status.ErrorMessage();
+    }
+  }
+
   region_manager_.AddAllocationRegion(mem_addr, bytes, stats_.num_arena_extensions);
   stats_.num_arena_extensions += 1;
 
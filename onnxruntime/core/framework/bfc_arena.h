@@ -92,6 +92,13 @@ class BFCArena : public IAllocator {
 
   void GetStats(AllocatorStats* stats) override;
 
+  // Places memory regions allocated from now on preferably on the given NUMA node.
+  // A negative value leaves the placement to the OS (first touch).
+  void SetNumaNode(int numa_node) {
+    std::lock_guard<OrtMutex> lock(lock_);
+    numa_node_ = numa_node;
+  }
+
   size_t RequestedSize(const void* ptr);
 
   size_t AllocatedSize(const void* ptr);
@@ -394,6 +401,9 @@ class BFCArena : public IAllocator {
   size_t memory_limit_ = 0;
   ArenaExtendStrategy arena_extend_strategy_ = ArenaExtendStrategy::kNextPowerOfTwo;
 
+  // NUMA node that new regions are bound to. -1 means no binding.
+  int numa_node_ = -1;
+
   int Log2FloorNonZeroSlow(uint64_t n) {
     int r = 0;
     while (n > 0) {
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/packed_strings.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace onnxruntime {
+
+namespace {
+constexpr size_t kInitialStrings = 16;
+constexpr size_t kInitialBytes = 256;
+
+// Replace buffer with one that can hold capacity elements, preserving the first used elements.
+template <typename T>
+void GrowBuffer(const AllocatorPtr& allocator, IAllocatorUniquePtr<T>& buffer, size_t used, size_t capacity) {
+  auto new_buffer = IAllocator::MakeUniquePtr<T>(allocator, capacity);
+  ORT_ENFORCE(new_buffer != nullptr, "Failed to allocate ", capacity, " elements for PackedStrings.");
+  if (used > 0) {
+    memcpy(new_buffer.get(), buffer.get(), used * sizeof(T));
+  }
+  buffer = std::move(new_buffer);
+}
+}  // namespace
+
+PackedStrings::PackedStrings(AllocatorPtr allocator) : allocator_{std::move(allocator)} {
+  ORT_ENFORCE(allocator_ != nullptr, "PackedStrings requires an allocator.");
+  GrowBuffer(allocator_, offsets_, 0, kInitialStrings + 1);
+  offsets_capacity_ = kInitialStrings + 1;
+  offsets_.get()[0] = 0;
+}
+
+void PackedStrings::Reserve(size_t num_strings, size_t num_bytes) {
+  const size_t offsets_needed = num_strings_ + num_strings + 1;
+  if (offsets_needed > offsets_capacity_) {
+    GrowBuffer(allocator_, offsets_, num_strings_ + 1, offsets_needed);
+    offsets_capacity_ = offsets_needed;
+  }
+
+  const size_t bytes_needed = TotalBytes() + num_bytes;
+  if (bytes_needed > bytes_capacity_) {
+    GrowBuffer(allocator_, bytes_, TotalBytes(), bytes_needed);
+    bytes_capacity_ = bytes_needed;
+  }
+}
+
+void PackedStrings::Append(std::string_view str) {
+  char* dest = ReserveBytes(str.size());
+  if (!str.empty()) {
+    memcpy(dest, str.data(), str.size());
+  }
+  CommitString(str.size());
+}
+
+char* PackedStrings::ReserveBytes(size_t bytes) {
+  const size_t used = TotalBytes();
+  if (used + bytes > bytes_capacity_) {
+    const size_t capacity = std::max({bytes_capacity_ * 2, used + bytes, kInitialBytes});
+    GrowBuffer(allocator_, bytes_, used, capacity);
+    bytes_capacity_ = capacity;
+  }
+
+  return bytes_.get() + used;
+}
+
+void PackedStrings::CommitString(size_t bytes) {
+  if (num_strings_ + 2 > offsets_capacity_) {
+    const size_t capacity = offsets_capacity_ * 2;
+    GrowBuffer(allocator_, offsets_, num_strings_ + 1, capacity);
+    offsets_capacity_ = capacity;
+  }
+
+  size_t* offsets = offsets_.get();
+  offsets[num_strings_ + 1] = offsets[num_strings_] + bytes;
+  ++num_strings_;
+}
+
+void PackedStrings::CopyTo(std::string* output) const {
+  for (size_t i = 0; i < num_strings_; ++i) {
+    const std::string_view str = (*this)[i];
+    output[i].assign(str.data(), str.size());
+  }
+}
+
+}  // namespace onnxruntime
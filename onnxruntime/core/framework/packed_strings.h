@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+
+namespace onnxruntime {
+
+// Compact storage for a sequence of strings.
+//
+// The bytes of all the strings are stored back to back in one buffer and each string is located by an offset into
+// it, so producing a large number of short strings does not need a heap allocation per string. Both buffers come
+// from the allocator the instance is created with. Kernels should use their temp space allocator so the memory comes
+// from the session arena.
+//
+// Strings are accessed as std::string_view. Kernels produce their intermediate strings here and convert them to
+// std::string only once, when writing the string tensor that is the output of the kernel.
+class PackedStrings {
+ public:
+  explicit PackedStrings(AllocatorPtr allocator);
+
+  ORT_DISALLOW_COPY_AND_ASSIGNMENT(PackedStrings);
+  PackedStrings(PackedStrings&&) = default;
+  PackedStrings& operator=(PackedStrings&&) = default;
+
+  // Reserve space for num_strings more strings with num_bytes more bytes in total.
+  void Reserve(size_t num_strings, size_t num_bytes);
+
+  void Append(std::string_view str);
+
+  // Append a string of at most max_bytes bytes that is written in place by fill.
+  // fill is called with a pointer to the destination and returns the number of bytes it wrote.
+  template <typename FillFn>
+  void Append(size_t max_bytes, FillFn&& fill) {
+    char* dest = ReserveBytes(max_bytes);
+    const size_t bytes = fill(dest);
+    ORT_ENFORCE(bytes <= max_bytes, "Wrote ", bytes, " bytes to a string reserved with ", max_bytes, " bytes.");
+    CommitString(bytes);
+  }
+
+  // Removes all strings. Keeps the buffers.
+  void Clear() { num_strings_ = 0; }
+
+  size_t Size() const { return num_strings_; }
+  bool Empty() const { return num_strings_ == 0; }
+
+  // Total number of bytes of all the strings
+  size_t TotalBytes() const { return offsets_.get()[num_strings_]; }
+
+  std::string_view operator[](size_t i) const {
+    const size_t* offsets = offsets_.get();
+    return std::string_view(bytes_.get() + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+
+  // Write the strings to consecutive elements of a string tensor, starting at output.
+  void CopyTo(std::string* output) const;
+
+ private:
+  // Make sure there is space for a string of `bytes` bytes and return the location it starts at.
+  char* ReserveBytes(size_t bytes);
+  // Add the string of `bytes` bytes that was written at the location returned by ReserveBytes.
+  void CommitString(size_t bytes);
+
+  AllocatorPtr allocator_;
+  IAllocatorUniquePtr<char> bytes_;
+  IAllocatorUniquePtr<size_t> offsets_;  // num_strings_ + 1 entries. the last one is the end of the last string.
+  size_t bytes_capacity_ = 0;
+  size_t offsets_capacity_ = 0;
+  size_t num_strings_ = 0;
+};
+
+}  // namespace onnxruntime
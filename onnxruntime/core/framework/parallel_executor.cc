@@ -19,7 +19,10 @@
 namespace onnxruntime {
 
 ParallelExecutor::ParallelExecutor(const SessionState& session_state, const bool& terminate_flag)
-    : out_standings_(0), terminate_flag_(terminate_flag), executor_pool_(session_state.GetInterOpThreadPool()) {
+    : out_standings_(0),
+      terminate_flag_(terminate_flag),
+      cancellation_(CancellationToken::Current()),
+      executor_pool_(session_state.GetInterOpThreadPool()) {
   const auto& graph_viewer = session_state.GetGraphViewer();
   node_refs_.resize(graph_viewer.MaxNodeIndex());
   for (auto& node : graph_viewer.Nodes()) {
@@ -59,6 +62,13 @@ Status ParallelExecutor::Execute(const SessionState& session_state, gsl::span<co
   Status status = Status::OK();
 
   if (!errors_.empty()) {
+    // Several nodes may have stopped because of a cancellation, report it once.
+    if (cancellation_ != nullptr && cancellation_->IsCancelled()) {
+      status = cancellation_->ToStatus();
+      LOGS(logger, WARNING) << status.ErrorMessage();
+      return status;
+    }
+
     if (errors_.size() == 1)
       status = errors_.front();
     else {
@@ -113,6 +123,7 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
 
   size_t node_index = p_node_index;
   bool keep_running = true;
+  CancellationToken::Scope cancellation_scope(cancellation_);
   const auto& graph_viewer = session_state.GetGraphViewer();
   TimePoint sync_time_begin;
   TimePoint kernel_begin_time;
@@ -121,6 +132,11 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
 
   // Avoid context switching if possible.
   while (keep_running) {
+    if (cancellation_ != nullptr && cancellation_->IsCancelled()) {
+      status = cancellation_->ToStatus();
+      LOGS(logger, WARNING) << status.ErrorMessage();
+      break;
+    }
     // TODO: Convert RunNodeAsync return Status.
     // to also handle exception propagation
     if (terminate_flag_) {
@@ -212,6 +228,13 @@ Status ParallelExecutor::RunNodeAsync(size_t p_node_index,
       break;
     }
 
+    // A kernel may have stopped early because the run was cancelled, leaving its outputs incomplete.
+    if (cancellation_ != nullptr && cancellation_->IsCancelled()) {
+      status = cancellation_->ToStatus();
+      LOGS(logger, WARNING) << status.ErrorMessage() << " Stopped after node " << node.Name();
+      break;
+    }
+
     if (f_profiler_enabled) {
       session_state.Profiler().EndTimeAndRecordEvent(profiling::NODE_EVENT,
                                                      node.Name() + "_kernel_time",
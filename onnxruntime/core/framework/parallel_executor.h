@@ -4,6 +4,7 @@
 #pragma once
 
 #include <vector>
+#include "core/common/cancellation_token.h"
 #include "core/common/common.h"
 #include "core/common/status.h"
 #include "core/common/logging/logging.h"
@@ -20,6 +21,8 @@ class ExecutionFrame;
 
 class ParallelExecutor : public IExecutor {
  public:
+  // Captures the cancellation token current on the calling thread, which is then made current on the threads
+  // running the nodes.
   ParallelExecutor(const SessionState& session_state, const bool& terminate_flag = false);
 
   common::Status Execute(const SessionState& session_state, gsl::span<const int> feed_mlvalue_idxs,
@@ -60,6 +63,7 @@ class ParallelExecutor : public IExecutor {
   std::vector<Status> errors_;
 
   const bool& terminate_flag_;
+  const CancellationToken* const cancellation_;
   // TODO: Temporary threadpool for the executor.  This is a costly way to handle the problem.
   onnxruntime::concurrency::ThreadPool* const executor_pool_{};
 };
@@ -7,6 +7,7 @@
 #include <thread>
 #include <vector>
 #include <sstream>
+#include "core/common/cancellation_token.h"
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
 #include "core/framework/allocation_planner.h"
@@ -212,7 +213,15 @@ Status SequentialExecutor::Execute(const SessionState& session_state, gsl::span<
   utils::NodeDumpContext dump_context{session_state.GetGraphExecutionCounter(), program_counter};
 #endif
 
+  // Cancellation of the run, which also covers the deadline of the run and the subgraphs it executes.
+  const CancellationToken* cancellation = CancellationToken::Current();
+
   for (const auto& node_exec_plan : exec_plan_vec) {
+    if (cancellation != nullptr && cancellation->IsCancelled()) {
+      Status status = cancellation->ToStatus();
+      LOGS(logger, WARNING) << status.ErrorMessage();
+      return status;
+    }
     if (terminate_flag_) {
       LOGS(logger, WARNING) << "Exiting due to terminate flag being set to true.";
       return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
@@ -370,6 +379,13 @@ Status SequentialExecutor::Execute(const SessionState& session_state, gsl::span<
       return Status(compute_status.Category(), compute_status.Code(), msg_string);
     }
 
+    // A kernel may have stopped early because the run was cancelled, leaving its outputs incomplete.
+    if (cancellation != nullptr && cancellation->IsCancelled()) {
+      Status status = cancellation->ToStatus();
+      LOGS(logger, WARNING) << status.ErrorMessage() << " Stopped after node " << node.Name();
+      return status;
+    }
+
     if (is_profiler_enabled) {
       // Calculate total output sizes for this operation.
       CalculateTotalOutputSizes(&op_kernel_context, total_output_sizes, node_name_for_profiling, output_type_shape);
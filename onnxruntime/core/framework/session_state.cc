@@ -14,6 +14,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_pattern_planner.h"
 #include "core/framework/session_state_utils.h"
+#include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
@@ -319,8 +320,12 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
                 bool is_packed = false;
                 const Tensor& const_initialized_tensor = constant_initialized_tensors[ort_value_idx].Get<Tensor>();
 
+                // Initializers supplied by the user and initializers from the shared initializer store may be
+                // used by other sessions, so their pre-packed forms are worth caching.
                 auto iter = initializers_to_share_map.find(input_name);
-                bool is_shared_initializer = (iter != initializers_to_share_map.end());
+                bool is_shared_initializer = (iter != initializers_to_share_map.end()) ||
+                                             (shared_initializer_store_ != nullptr &&
+                                              shared_initializer_store_->Contains(const_initialized_tensor));
 
                 // Caching pre-packed weights is limited to shared initializers associated with the CPU EP for now
                 if (is_shared_initializer && should_cache_prepacked_weights_for_shared_initializers &&
@@ -367,6 +372,11 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
                                                                           node.Name()));
 
                       ++used_shared_pre_packed_weights_counter_;
+
+                      // the buffers this kernel packed are released in favor of the shared ones
+                      for (size_t buffer_size : weights_to_be_filled_in.buffer_sizes_) {
+                        used_shared_pre_packed_weights_bytes_ += buffer_size;
+                      }
                     } else {  // container doesn't contain the pre-packed weight - so write into it for sharing across kernel instances
 
                       if (!prepacked_weights_container_->WriteWeight(prepacked_weights_container_key, std::move(weights_to_be_filled_in))) {
@@ -426,6 +436,61 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
   }
 }
 
+Status SessionState::PrecomputeKernelsForStaticShapes() {
+  InlinedVector<TensorShape> input_shapes;
+  InlinedVector<const TensorShape*> input_shape_ptrs;
+
+  for (auto& node : GetGraphViewer().Nodes()) {
+    const auto& input_defs = node.InputDefs();
+    input_shapes.clear();
+    input_shapes.reserve(input_defs.size());
+    input_shape_ptrs.clear();
+
+    bool all_static = true;
+    for (const auto* input_def : input_defs) {
+      if (!input_def->Exists()) {
+        input_shape_ptrs.push_back(nullptr);
+        continue;
+      }
+
+      const auto* shape_proto = input_def->Shape();
+      if (shape_proto == nullptr || !utils::HasTensorType(*input_def->TypeAsProto())) {
+        all_static = false;
+        break;
+      }
+
+      for (const auto& dim : shape_proto->dim()) {
+        if (!utils::HasDimValue(dim)) {
+          all_static = false;
+          break;
+        }
+      }
+      if (!all_static) {
+        break;
+      }
+
+      input_shapes.push_back(utils::GetTensorShapeFromTensorShapeProto(*shape_proto));
+      input_shape_ptrs.push_back(&input_shapes.back());
+    }
+
+    if (!all_static) {
+      continue;
+    }
+
+    bool is_precomputed = false;
+    ORT_RETURN_IF_ERROR(GetMutableKernel(node.Index())->PrecomputeForStaticShapes(input_shape_ptrs, thread_pool_,
+                                                                                   is_precomputed));
+    if (is_precomputed) {
+      ++number_of_static_shape_kernels_;
+    }
+  }
+
+  LOGS(logger_, INFO) << number_of_static_shape_kernels_
+                      << " kernels precomputed their state for the static shapes of their inputs";
+
+  return Status::OK();
+}
+
 static int64_t CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
   int64_t key = 0;
   for (const auto& input : tensor_inputs) {
@@ -911,7 +976,8 @@ Status SessionState::CreateSubgraphSessionState() {
       auto subgraph_session_state =
           std::make_unique<SessionState>(*subgraph, execution_providers_, enable_mem_pattern_,
                                          thread_pool_, inter_op_thread_pool_, data_transfer_mgr_,
-                                         logger_, profiler_);
+                                         logger_, profiler_, use_deterministic_compute_, enable_mem_reuse_,
+                                         prepacked_weights_container_, shared_initializer_store_);
 
       // Pass fused function manager to subgraph
       subgraph_session_state->fused_funcs_mgr_.SetFusedFuncs(fused_funcs_mgr_);
@@ -1282,6 +1348,11 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
 
 #endif
 
+  TimePoint tp;
+  if (profiler_.IsEnabled()) {
+    tp = profiler_.Start();
+  }
+
   ORT_RETURN_IF_ERROR(
       session_state_utils::SaveInitializedTensors(
           Env::Default(), graph_location, *graph_viewer_,
@@ -1295,7 +1366,12 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
             }
             return Status::OK();
           },
-          logger_, data_transfer_mgr_, *p_seq_exec_plan_, session_options, memory_profile_func));
+          logger_, data_transfer_mgr_, *p_seq_exec_plan_, session_options, memory_profile_func, thread_pool_,
+          shared_initializer_store_));
+
+  if (profiler_.IsEnabled()) {
+    profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "initializers_loading", tp);
+  }
 
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
   // Record Weight allocation info on device
@@ -1309,18 +1385,46 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
     CleanInitializedTensorsFromGraph();
   }
 
+  if (profiler_.IsEnabled()) {
+    tp = profiler_.Start();
+  }
+
   ORT_RETURN_IF_ERROR(CreateKernels(kernel_registry_manager));
 
+  if (profiler_.IsEnabled()) {
+    profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "kernels_creation", tp);
+  }
+
 #ifndef ENABLE_TRAINING
   const auto disable_prepacking =
       session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDisablePrepacking, "0");
 
   if (disable_prepacking != "1") {
+    if (profiler_.IsEnabled()) {
+      tp = profiler_.Start();
+    }
+
     ORT_RETURN_IF_ERROR(PrepackConstantInitializedTensors(constant_initializers_use_count,
                                                           session_options.initializers_to_share_map));
+
+    if (profiler_.IsEnabled()) {
+      profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "prepacking", tp);
+    }
   }
 #endif
 
+  if (session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigStaticShapeKernels, "0") == "1") {
+    if (profiler_.IsEnabled()) {
+      tp = profiler_.Start();
+    }
+
+    ORT_RETURN_IF_ERROR(PrecomputeKernelsForStaticShapes());
+
+    if (profiler_.IsEnabled()) {
+      profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "static_shape_kernels", tp);
+    }
+  }
+
   ORT_RETURN_IF_ERROR(
       session_state_utils::SaveInputOutputNamesToNodeMapping(*graph_viewer_, *this, valid_outer_scope_node_args));
 
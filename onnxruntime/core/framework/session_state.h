@@ -21,6 +21,7 @@
 #include "core/framework/feeds_fetches_manager.h"
 #include "core/framework/framework_common.h"
 #include "core/framework/prepacked_weights_container.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/fuse_nodes_funcs.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
@@ -94,7 +95,8 @@ class SessionState {
                profiling::Profiler& profiler,
                bool use_deterministic_compute = false,
                bool enable_mem_reuse = true,
-               PrepackedWeightsContainer* prepacked_weights_container = nullptr)
+               PrepackedWeightsContainer* prepacked_weights_container = nullptr,
+               SharedInitializerStore* shared_initializer_store = nullptr)
       : graph_(graph),
         execution_providers_(execution_providers),
         logger_(logger),
@@ -105,7 +107,8 @@ class SessionState {
         data_transfer_mgr_(data_transfer_mgr),
         use_deterministic_compute_(use_deterministic_compute),
         enable_mem_reuse_(enable_mem_reuse),
-        prepacked_weights_container_(prepacked_weights_container) {
+        prepacked_weights_container_(prepacked_weights_container),
+        shared_initializer_store_(shared_initializer_store) {
     SetupAllocators();
   }
 
@@ -321,6 +324,17 @@ class SessionState {
     return used_shared_pre_packed_weights_counter_;
   }
 
+  // Number of kernels that precomputed their state for the static shapes of their inputs
+  size_t GetNumberOfStaticShapeKernels() const {
+    return number_of_static_shape_kernels_;
+  }
+
+  // Number of bytes of pre-packed weights that this session did not have to keep because a shared version
+  // of the same pre-packed weight from the PrepackedWeightsContainer was used instead.
+  size_t GetUsedSharedPrePackedWeightBytes() const {
+    return used_shared_pre_packed_weights_bytes_;
+  }
+
   const KernelCreateInfoMap& GetKernelCreateInfoMap() const {
     return kernel_create_info_map_;
   }
@@ -361,6 +375,11 @@ class SessionState {
   Status PrepackConstantInitializedTensors(InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
                                            const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map);
 
+  /**
+   * Let the kernels of nodes whose input shapes are all static precompute their shape dependent state.
+   */
+  Status PrecomputeKernelsForStaticShapes();
+
   SessionState* GetMutableSubgraphSessionState(onnxruntime::NodeIndex index, const std::string& attribute_name);
 
   Status CreateSubgraphSessionState();
@@ -509,6 +528,10 @@ class SessionState {
   // prepacked_weights_container_ can be nullptr if no caching is required for prepacked weights
   PrepackedWeightsContainer* const prepacked_weights_container_{};
 
+  // Store to share the constant initializers of this graph and its subgraphs with other graphs holding the same
+  // weights. Owned by the Environment. nullptr if initializers are not deduplicated.
+  SharedInitializerStore* const shared_initializer_store_{};
+
 #if !defined(ORT_MINIMAL_BUILD)
 #ifndef DISABLE_ABSEIL
   InlinedHashMap<InlinedVector<int>, InlinedHashSet<NodeIndex>> to_be_executed_nodes_;
@@ -538,6 +561,12 @@ class SessionState {
   // a constant initialized weight was used by the session state
   size_t used_shared_pre_packed_weights_counter_ = 0;
 
+  // Total size of the pre-packed weights that were replaced by a shared version
+  size_t used_shared_pre_packed_weights_bytes_ = 0;
+
+  // Counter for number of kernels that precomputed their state for static input shapes
+  size_t number_of_static_shape_kernels_ = 0;
+
 #ifdef DEBUG_NODE_INPUTS_OUTPUTS
   // Counter for number of times the session graph has been executed
   size_t graph_executions_counter_ = 0;
@@ -20,12 +20,14 @@
 #include "core/framework/ort_value_name_idx_map.h"
 #include "core/framework/sequential_execution_plan.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/framework/bfc_arena.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/framework/mem_buffer.h"
 #include "core/framework/tensor_allocator.h"
+#include "core/platform/threadpool.h"
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
 #include "core/framework/memory_info.h"
 #endif
@@ -195,7 +197,9 @@ common::Status SaveInitializedTensors(
     const logging::Logger& logger, const DataTransferManager& data_transfer_mgr,
     const ExecutionPlanBase& exec_plan,
     const SessionOptions& session_options,
-    const MemoryProfileFunction& memory_profile_func) {
+    const MemoryProfileFunction& memory_profile_func,
+    concurrency::ThreadPool* thread_pool,
+    SharedInitializerStore* shared_initializer_store) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
   ORT_ENFORCE(ort_value_name_idx_map.MaxIdx() > -1, "OrtValue indexes should have been populated.");
 
@@ -228,10 +232,33 @@ common::Status SaveInitializedTensors(
     return retval;
   };
 
+  // Determine if an initializer is looked up in the shared initializer store. Those are constant dense tensors of a
+  // size worth sharing that are planned on CPU. They are allocated from the store's allocator rather than from the
+  // planned buffers, as they may outlive this session.
+  auto use_shared_initializer_store =
+      [&graph, &exec_plan, shared_initializer_store](int ort_value_index,
+                                                     const ONNX_NAMESPACE::TensorProto& tensor_proto) -> bool {
+    if (shared_initializer_store == nullptr ||
+        tensor_proto.data_type() == ONNX_NAMESPACE::TensorProto_DataType_STRING ||
+        exec_plan.GetLocation(ort_value_index).device.Type() != OrtDevice::CPU ||
+        !graph.IsConstantInitializer(tensor_proto.name(), /* check_outer_scope */ false)) {
+      return false;
+    }
+#if !defined(DISABLE_SPARSE_TENSORS)
+    if (graph.GetGraph().IsSparseInitializer(tensor_proto.name())) {
+      return false;
+    }
+#endif
+    size_t size_in_bytes = 0;
+    return utils::GetSizeInBytesFromTensorProto<0>(tensor_proto, &size_in_bytes).IsOK() &&
+           size_in_bytes >= SharedInitializerStore::kMinBytesToShare;
+  };
+
   // 1. first plan the memory
   const InitializedTensorSet& initialized_tensor_set = graph.GetAllInitializedTensors();
   InlinedHashMap<int, const ONNX_NAMESPACE::TensorProto*> id_to_initialized_tensor;
   InlinedHashSet<int> user_supplied_initializer_ids;  // set containing the ort value ids of all user supplied initializers
+  InlinedHashSet<int> store_initializer_ids;          // set containing the ort value ids of the initializers to share
 
   id_to_initialized_tensor.reserve(initialized_tensor_set.size());
   user_supplied_initializer_ids.reserve(initialized_tensor_set.size());
@@ -241,6 +268,8 @@ common::Status SaveInitializedTensors(
     ORT_RETURN_IF_ERROR(ort_value_name_idx_map.GetIdx(entry.first, ort_value_index));
     if (use_user_supplied_initializer(entry.first)) {
       user_supplied_initializer_ids.insert(ort_value_index);
+    } else if (use_shared_initializer_store(ort_value_index, *entry.second)) {
+      store_initializer_ids.insert(ort_value_index);
     }
     id_to_initialized_tensor[ort_value_index] = entry.second;
   }
@@ -252,7 +281,8 @@ common::Status SaveInitializedTensors(
   auto initialized_tensors_to_allocate = id_to_initialized_tensor;
   for (int ort_value_index : initializer_allocation_order) {
     const auto entry = initialized_tensors_to_allocate.find(ort_value_index);
-    if (!(utils::HasExternalData(*entry->second) && exec_plan.GetLocation(ort_value_index).device.Type() == OrtDevice::CPU)) {
+    if (!(utils::HasExternalData(*entry->second) && exec_plan.GetLocation(ort_value_index).device.Type() == OrtDevice::CPU) &&
+        store_initializer_ids.find(ort_value_index) == store_initializer_ids.end()) {
       // can not trace string tensor
       ORT_ENFORCE(entry != initialized_tensors_to_allocate.end() &&
                   entry->second->data_type() != ONNX_NAMESPACE::TensorProto_DataType_STRING);
@@ -262,8 +292,9 @@ common::Status SaveInitializedTensors(
   }
 
   for (const auto& entry : initialized_tensors_to_allocate) {
-    // We don't want to trace shared initializers since their memory is provided by the user
-    if (user_supplied_initializer_ids.find(entry.first) != user_supplied_initializer_ids.end()) {
+    // We don't want to trace shared initializers since their memory is provided by the user or the store
+    if (user_supplied_initializer_ids.find(entry.first) != user_supplied_initializer_ids.end() ||
+        store_initializer_ids.find(entry.first) != store_initializer_ids.end()) {
       continue;
     }
     if (entry.second->data_type() == ONNX_NAMESPACE::TensorProto_DataType_STRING) {
@@ -289,7 +320,30 @@ common::Status SaveInitializedTensors(
 
   OrtCallback deleter{nullptr, nullptr};
 
-  // 3. create weight tensors based on weights buffer
+  bool use_device_allocator_for_initializers =
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsUseDeviceAllocatorForInitializers, "0") == "1";
+
+  // 3. create weight tensors based on weights buffer.
+  // Buffers are obtained from the planner up front, as the planner isn't thread safe. The tensors that are
+  // deserialized on CPU are then decoded in parallel; large models spend most of this step converting raw
+  // data, while tensors on other devices need a copy through the data transfer manager and are decoded
+  // sequentially.
+  struct InitializerToSave {
+    int ort_value_index;
+    const ONNX_NAMESPACE::TensorProto* tensor_proto;
+    std::optional<MemBuffer> m;
+    AllocatorPtr alloc;
+    OrtValue ort_value;
+    Status status;
+    bool use_store;
+    HashValue hash;
+  };
+
+  std::vector<InitializerToSave> initializers_to_save;
+  initializers_to_save.reserve(id_to_initialized_tensor.size());
+  InlinedVector<size_t> cpu_initializers;
+  InlinedVector<size_t> other_initializers;
+
   for (const auto& entry : id_to_initialized_tensor) {
     int ort_value_index = entry.first;
     const std::string& name = entry.second->name();
@@ -299,28 +353,77 @@ common::Status SaveInitializedTensors(
       continue;
     }
 
-    OrtValue ort_value;
+    initializers_to_save.push_back(InitializerToSave{ort_value_index, entry.second, std::nullopt, nullptr, {}, {},
+                                                     false, 0});
+    auto& initializer = initializers_to_save.back();
 
     if (user_supplied_initializer_ids.find(entry.first) != user_supplied_initializer_ids.end()) {
-      ort_value = *(session_options.initializers_to_share_map.at(name));
+      initializer.ort_value = *(session_options.initializers_to_share_map.at(name));
       LOGS(logger, INFO) << "Using user supplied initializer with name (" << name << ").";
-    } else {
-      const ONNX_NAMESPACE::TensorProto& tensor_proto = *(entry.second);
-
-      std::optional<MemBuffer> m;
-      AllocatorPtr alloc;
-      // TODO: if the tensor need be copied, does it have enough room?
-      ORT_RETURN_IF_ERROR(planner.GetPreallocatedBuffer(ort_value_index, name, m, alloc));
-      bool use_device_allocator_for_initializers =
-          session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsUseDeviceAllocatorForInitializers, "0") == "1";
-
-      Status st = DeserializeTensorProto(env, graph_loc, tensor_proto, (m.has_value()) ? &*m : nullptr, alloc,
-                                         default_cpu_alloc, ort_value, data_transfer_mgr,
-                                         use_device_allocator_for_initializers);
-      if (!st.IsOK()) {
-        std::ostringstream oss;
-        oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
-        return Status(st.Category(), st.Code(), oss.str());
+      continue;
+    }
+
+    if (store_initializer_ids.find(entry.first) != store_initializer_ids.end()) {
+      initializer.use_store = true;
+      initializer.alloc = shared_initializer_store->GetAllocator();
+      cpu_initializers.push_back(initializers_to_save.size() - 1);
+      continue;
+    }
+
+    // TODO: if the tensor need be copied, does it have enough room?
+    ORT_RETURN_IF_ERROR(planner.GetPreallocatedBuffer(ort_value_index, name, initializer.m, initializer.alloc));
+
+    const OrtDevice device = initializer.m.has_value() ? initializer.m->GetAllocInfo().device
+                                                       : initializer.alloc->Info().device;
+    auto& initializers = device.Type() == OrtDevice::CPU ? cpu_initializers : other_initializers;
+    initializers.push_back(initializers_to_save.size() - 1);
+  }
+
+  auto deserialize = [&](InitializerToSave& initializer) {
+    ORT_TRY {
+      initializer.status = DeserializeTensorProto(env, graph_loc, *initializer.tensor_proto,
+                                                  initializer.m.has_value() ? &*initializer.m : nullptr,
+                                                  initializer.alloc, default_cpu_alloc, initializer.ort_value,
+                                                  data_transfer_mgr, use_device_allocator_for_initializers);
+      if (initializer.status.IsOK() && initializer.use_store) {
+        initializer.hash = SharedInitializerStore::Hash(initializer.ort_value.Get<Tensor>());
+      }
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        initializer.status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ex.what());
+      });
+    }
+  };
+
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(cpu_initializers.size()),
+      [&](std::ptrdiff_t i) { deserialize(initializers_to_save[cpu_initializers[i]]); });
+
+  for (size_t i : other_initializers) {
+    deserialize(initializers_to_save[i]);
+  }
+
+  size_t num_deduplicated = 0;
+  size_t bytes_deduplicated = 0;
+  for (auto& initializer : initializers_to_save) {
+    int ort_value_index = initializer.ort_value_index;
+    const std::string& name = initializer.tensor_proto->name();
+
+    if (!initializer.status.IsOK()) {
+      const Status& st = initializer.status;
+      std::ostringstream oss;
+      oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
+      return Status(st.Category(), st.Code(), oss.str());
+    }
+
+    if (initializer.use_store) {
+      bool found = false;
+      initializer.ort_value = shared_initializer_store->GetOrAdd(initializer.ort_value, initializer.hash, found);
+      if (found) {
+        ++num_deduplicated;
+        bytes_deduplicated += initializer.ort_value.Get<Tensor>().SizeInBytes();
+        VLOGS(logger, 1) << "Using the shared copy of initializer with name : " << name;
       }
     }
 
@@ -333,12 +436,17 @@ common::Status SaveInitializedTensors(
     const bool constant = graph.IsConstantInitializer(name, /* check_outer_scope */ false);
 #if !defined(DISABLE_SPARSE_TENSORS)
     const bool sparse = graph.GetGraph().IsSparseInitializer(name);
-    ORT_RETURN_IF_ERROR(save_tensor_func(name, ort_value_index, ort_value, deleter, constant, sparse));
+    ORT_RETURN_IF_ERROR(save_tensor_func(name, ort_value_index, initializer.ort_value, deleter, constant, sparse));
 #else
-    ORT_RETURN_IF_ERROR(save_tensor_func(name, ort_value_index, ort_value, deleter, constant, false));
+    ORT_RETURN_IF_ERROR(save_tensor_func(name, ort_value_index, initializer.ort_value, deleter, constant, false));
 #endif
   }
 
+  if (shared_initializer_store != nullptr) {
+    LOGS(logger, INFO) << "Used the shared copy of " << num_deduplicated << " initializers ("
+                       << bytes_deduplicated << " bytes) held by other graphs";
+  }
+
   LOGS(logger, INFO) << "Done saving initialized tensors";
   return common::Status::OK();
 }
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_initializer_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/framework/murmurhash3.h"
+#include "core/framework/tensor.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+struct SharedInitializerStore::State {
+  struct Entry {
+    std::weak_ptr<OrtValue> value;
+    const Tensor* tensor;
+  };
+
+  // Called by the deleter of an entry once no session uses its tensor anymore.
+  void Remove(HashValue hash, const Tensor& tensor) {
+    std::lock_guard<OrtMutex> lock(mutex);
+    auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.tensor == &tensor) {
+        entries.erase(it);
+        break;
+      }
+    }
+    tensors.erase(&tensor);
+    --stats.num_tensors;
+    stats.bytes_stored -= tensor.SizeInBytes();
+  }
+
+  mutable OrtMutex mutex;
+  std::unordered_multimap<HashValue, Entry> entries;
+  std::unordered_set<const Tensor*> tensors;
+  SharedInitializerStoreStats stats;
+};
+
+namespace {
+bool HaveSameContent(const Tensor& a, const Tensor& b) {
+  return a.GetElementType() == b.GetElementType() &&
+         a.Shape() == b.Shape() &&
+         std::memcmp(a.DataRaw(), b.DataRaw(), a.SizeInBytes()) == 0;
+}
+}  // namespace
+
+SharedInitializerStore::SharedInitializerStore()
+    : state_(std::make_shared<State>()),
+      allocator_(std::make_shared<CPUAllocator>()) {
+}
+
+SharedInitializerStore::~SharedInitializerStore() = default;
+
+HashValue SharedInitializerStore::Hash(const Tensor& tensor) {
+  uint32_t hash[4] = {0, 0, 0, 0};
+
+  auto hash_buffer = [&hash](const void* data, size_t len) {
+    // MurmurHash3 takes an int length, so the content of large tensors is hashed in chunks
+    constexpr size_t kMaxChunkSize = size_t{1} << 30;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+      const size_t chunk_size = std::min(len, kMaxChunkSize);
+      MurmurHash3::x86_128(bytes, static_cast<int>(chunk_size), hash[0], &hash);
+      bytes += chunk_size;
+      len -= chunk_size;
+    }
+  };
+
+  const int32_t element_type = tensor.GetElementType();
+  hash_buffer(&element_type, sizeof(element_type));
+  const auto dims = tensor.Shape().GetDims();
+  hash_buffer(dims.data(), dims.size() * sizeof(int64_t));
+  hash_buffer(tensor.DataRaw(), tensor.SizeInBytes());
+
+  return hash[0] | (uint64_t(hash[1]) << 32);
+}
+
+OrtValue SharedInitializerStore::GetOrAdd(const OrtValue& value, HashValue hash, bool& found) {
+  const Tensor& tensor = value.Get<Tensor>();
+  ORT_ENFORCE(!tensor.IsDataTypeString(), "String tensors cannot be added to the SharedInitializerStore");
+
+  // Declared ahead of the lock: if another session releases an entry meanwhile, the references taken here may be the
+  // last ones, and the entry removes itself from the store under the same lock when they are dropped.
+  std::vector<std::shared_ptr<OrtValue>> candidates;
+  std::shared_ptr<OrtValue> shared_value;
+  {
+    std::lock_guard<OrtMutex> lock(state_->mutex);
+    auto range = state_->entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (auto candidate = it->second.value.lock()) {
+        candidates.push_back(std::move(candidate));
+      }
+    }
+
+    for (const auto& candidate : candidates) {
+      if (HaveSameContent(candidate->Get<Tensor>(), tensor)) {
+        shared_value = candidate;
+        break;
+      }
+    }
+
+    found = shared_value != nullptr;
+    if (found) {
+      ++state_->stats.num_deduplicated;
+      state_->stats.bytes_deduplicated += tensor.SizeInBytes();
+    } else {
+      std::weak_ptr<State> weak_state = state_;
+      shared_value = std::shared_ptr<OrtValue>(new OrtValue(value), [weak_state, hash](OrtValue* entry_value) {
+        if (auto state = weak_state.lock()) {
+          state->Remove(hash, entry_value->Get<Tensor>());
+        }
+        delete entry_value;
+      });
+
+      const Tensor* shared_tensor = &shared_value->Get<Tensor>();
+      state_->entries.emplace(hash, State::Entry{shared_value, shared_tensor});
+      state_->tensors.insert(shared_tensor);
+      ++state_->stats.num_tensors;
+      state_->stats.bytes_stored += shared_tensor->SizeInBytes();
+    }
+  }
+
+  // Every value handed out keeps the entry alive.
+  OrtValue result;
+  result.Init(shared_value->GetMutable<Tensor>(), DataTypeImpl::GetType<Tensor>(),
+              [shared_value](void*) {});
+  return result;
+}
+
+bool SharedInitializerStore::Contains(const Tensor& tensor) const {
+  std::lock_guard<OrtMutex> lock(state_->mutex);
+  return state_->tensors.count(&tensor) != 0;
+}
+
+SharedInitializerStoreStats SharedInitializerStore::GetStats() const {
+  std::lock_guard<OrtMutex> lock(state_->mutex);
+  return state_->stats;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+
+#include "core/common/basic_types.h"
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+
+namespace onnxruntime {
+
+class Tensor;
+
+struct SharedInitializerStoreStats {
+  // Tensors currently in the store, and their size
+  size_t num_tensors = 0;
+  size_t bytes_stored = 0;
+  // Initializers that were served by a tensor already in the store, and their size. This is the memory the store
+  // saved since it was created.
+  size_t num_deduplicated = 0;
+  size_t bytes_deduplicated = 0;
+};
+
+/**
+Content addressed store of constant initializers, owned by the Environment.
+
+Sessions created with the session.deduplicate_initializers config entry look up the large enough constant CPU
+initializers of their main graph and of its subgraphs by element type, shape and content, and use the tensor already
+in the store instead of keeping their own copy. So identical weights loaded by several sessions, or duplicated across
+the subgraphs of If/Loop/Scan nodes, are held once.
+
+The store does not own its tensors: a tensor is released, and removed from the store, when the last session using it
+releases it, e.g. once all the kernels consuming it have pre-packed it. The pre-packed forms are only shared when the
+sessions are given a PrepackedWeightsContainer, whose lifetime the user controls, as a container owned by the store
+would keep them for the lifetime of the Environment.
+*/
+class SharedInitializerStore final {
+ public:
+  // Initializers smaller than this are kept by the session, as an entry would cost about as much as it saves.
+  static constexpr size_t kMinBytesToShare = 1024;
+
+  SharedInitializerStore();
+  ~SharedInitializerStore();
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedInitializerStore);
+
+  // CPU allocator to allocate the tensors that may be added to the store with. They can outlive the session that
+  // created them, so they must not be allocated from its arena.
+  const AllocatorPtr& GetAllocator() const { return allocator_; }
+
+  // Returns the hash of the element type, shape and content of a tensor, to look it up with. Left to the caller, so
+  // that a session can hash its initializers in parallel.
+  static HashValue Hash(const Tensor& tensor);
+
+  // Returns a value holding the tensor of the store that has the element type, shape and content of the tensor held
+  // by `value`, whose Hash() is `hash`. The tensor of `value` is added to the store if there is none.
+  // `found` is set to whether an existing tensor was returned.
+  OrtValue GetOrAdd(const OrtValue& value, HashValue hash, bool& found);
+
+  // Returns whether `tensor` is held by the store.
+  bool Contains(const Tensor& tensor) const;
+
+  SharedInitializerStoreStats GetStats() const;
+
+ private:
+  // Outlives the store while its tensors are in use, as the tensors remove themselves from it when released.
+  struct State;
+  std::shared_ptr<State> state_;
+
+  AllocatorPtr allocator_;
+};
+
+}  // namespace onnxruntime
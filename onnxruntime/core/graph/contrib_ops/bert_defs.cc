@@ -311,5 +311,46 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GemmFastGelu, 1,
                                   ONNX_NAMESPACE::matmulShapeInference(ctx, 0, 1);
                                 }));
 
+constexpr const char* EncoderLayer_ver1_doc = R"DOC(
+A post-LayerNorm transformer encoder layer, i.e. the subgraph
+Attention -> MatMul -> SkipLayerNormalization -> MatMul -> BiasGelu (or FastGelu) -> MatMul -> SkipLayerNormalization
+computed as a single operator:
+  attention = Attention(input, qkv_weight, qkv_bias, mask_index)
+  hidden = SkipLayerNormalization(MatMul(attention, dense_weight), input, attention_gamma, attention_beta, dense_bias)
+  ffn = Gelu(MatMul(hidden, ffn_weight1) + ffn_bias1)
+  output = SkipLayerNormalization(MatMul(ffn, ffn_weight2), hidden, ffn_gamma, ffn_beta, ffn_bias2)
+The mask_index input and the unidirectional attribute are the ones of Attention.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(EncoderLayer, 1,
+                            OpSchema()
+                                .SetDoc(EncoderLayer_ver1_doc)
+                                .Attr("num_heads", "Number of attention heads", AttributeProto::INT)
+                                .Attr("unidirectional",
+                                      "Whether every token can only attend to previous tokens. Default value is 0.",
+                                      AttributeProto::INT,
+                                      static_cast<int64_t>(0))
+                                .Attr("attention_epsilon", "The epsilon value of the LayerNormalization after the attention.", AttributeProto::FLOAT, kDefaultSkipLayerNormEpsilon)
+                                .Attr("ffn_epsilon", "The epsilon value of the LayerNormalization after the feed forward network.", AttributeProto::FLOAT, kDefaultSkipLayerNormEpsilon)
+                                .Attr("activation", "Activation of the feed forward network: 'gelu' (as BiasGelu) or 'fast_gelu' (as FastGelu).", AttributeProto::STRING, std::string("gelu"))
+                                .Input(0, "input", "3D input tensor with shape (batch_size, sequence_length, hidden_size)", "T")
+                                .Input(1, "qkv_weight", "2D input tensor with shape (hidden_size, 3 * hidden_size), where hidden_size = num_heads * head_size", "T")
+                                .Input(2, "qkv_bias", "1D input tensor with shape (3 * hidden_size)", "T")
+                                .Input(3, "mask_index", "Attention mask or index, as the mask_index input of Attention.", "M", OpSchema::Optional)
+                                .Input(4, "dense_weight", "2D input tensor with shape (hidden_size, hidden_size)", "T")
+                                .Input(5, "dense_bias", "1D input tensor with shape (hidden_size)", "T", OpSchema::Optional)
+                                .Input(6, "attention_gamma", "1D input tensor with shape (hidden_size)", "T")
+                                .Input(7, "attention_beta", "1D input tensor with shape (hidden_size)", "T", OpSchema::Optional)
+                                .Input(8, "ffn_weight1", "2D input tensor with shape (hidden_size, intermediate_size)", "T")
+                                .Input(9, "ffn_bias1", "1D input tensor with shape (intermediate_size)", "T", OpSchema::Optional)
+                                .Input(10, "ffn_weight2", "2D input tensor with shape (intermediate_size, hidden_size)", "T")
+                                .Input(11, "ffn_bias2", "1D input tensor with shape (hidden_size)", "T", OpSchema::Optional)
+                                .Input(12, "ffn_gamma", "1D input tensor with shape (hidden_size)", "T")
+                                .Input(13, "ffn_beta", "1D input tensor with shape (hidden_size)", "T", OpSchema::Optional)
+                                .Output(0, "output", "3D output tensor with shape (batch_size, sequence_length, hidden_size)", "T")
+                                .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+                                .TypeConstraint("M", {"tensor(int32)"}, "Constrain mask index to integer types")
+                                .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput));
+
 }
 }  // namespace onnxruntime
\ No newline at end of file
@@ -1614,6 +1614,44 @@ ONNX_MS_OPERATOR_SET_SCHEMA(FusedMatMul, 1,
                                 .SetDoc(FusedMatMul_doc)
                                 .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) { FusedMatMulShapeInference(ctx); }));
 
+constexpr const char* FusedElementwise_doc = R"DOC(
+FusedElementwise evaluates an expression of element-wise operators over its inputs in a single pass. It is created
+by the optimizer from subgraphs of element-wise operators, and produces the same result as running those operators
+one after the other.
+The expression is a list of instructions. Instruction i applies the ONNX operator ops[i] to the values
+operands[3*i], operands[3*i+1] and operands[3*i+2]. Value j is input j if j is less than the number of inputs, and
+the result of instruction (j - number of inputs) otherwise. Unused operands are -1. All inputs are broadcast
+to the output shape following the multidirectional broadcasting rules, and the output is the result of the last
+instruction.
+Supported operators are Add, Sub, Mul, Div, Pow, Erf, Sqrt, Reciprocal, Neg, Abs, Exp, Tanh, Sigmoid, Relu and
+Where. Boolean inputs are only used as the condition of Where.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(FusedElementwise, 1,
+                            OpSchema()
+                                .SetDoc(FusedElementwise_doc)
+                                .Attr("ops", "The operator of each instruction, in evaluation order.", AttributeProto::STRINGS)
+                                .Attr("operands", "The three operands of each instruction.", AttributeProto::INTS)
+                                .Input(0, "inputs", "The inputs of the expression.", "T", OpSchema::Variadic,
+                                       /*is_homogeneous*/ false)
+                                .Output(0, "Y", "The result of the expression.", "T1")
+                                .TypeConstraint("T", {"tensor(float)", "tensor(bool)"},
+                                                "Constrain inputs to float tensors, or bool tensors for conditions.")
+                                .TypeConstraint("T1", {"tensor(float)"}, "Constrain output to float tensors.")
+                                .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+                                  auto* output_type = ctx.getOutputType(0)->mutable_tensor_type();
+                                  output_type->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+                                  std::vector<const TensorShapeProto*> shapes;
+                                  for (size_t i = 0; i < ctx.getNumInputs(); ++i) {
+                                    if (!hasInputShape(ctx, i)) {
+                                      return;
+                                    }
+                                    shapes.push_back(&ctx.getInputType(i)->tensor_type().shape());
+                                  }
+                                  multidirectionalBroadcastShapeInference(shapes, *output_type->mutable_shape());
+                                }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(SparseToDenseMatMul, 1,
                             OpSchema()
                                 .Input(0, "A", "2-dimensional sparse matrix A. Either COO or CSR format", "T")
@@ -1976,6 +2014,52 @@ ONNX_MS_OPERATOR_SET_SCHEMA(CDist, 1,
                                         "T")
                                 .TypeConstraint("T", {"tensor(float)", "tensor(double)"}, "Constrains input to only numeric types."));
 
+constexpr const char* NearestNeighbors_doc = R"DOC(
+Finds the k rows of the database X nearest to each row of the queries Q. It returns the same result as CDist
+followed by TopK over the last axis, without materializing the distances between all the pairs of rows.
+For the "sqeuclidean" and "euclidean" metrics the values are the distances, in increasing order. For the
+"inner_product" and "cosine" metrics the values are the similarities, in decreasing order. Rows with equal values
+are ordered by their index.
+The database can be stored as float16, or as int8 with the scale in X_scale, which is then required. Row j of an
+int8 database is X[j] * X_scale[j], or X[j] * X_scale if X_scale is a scalar.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(NearestNeighbors, 1,
+                            OpSchema()
+                                .SetDoc(NearestNeighbors_doc)
+                                .Attr("k", "Number of neighbors to return for each query.", AttributeProto::INT)
+                                .Attr("metric",
+                                      "The metric to use. One of \"sqeuclidean\", \"euclidean\", \"inner_product\" and \"cosine\".",
+                                      AttributeProto::STRING, std::string("sqeuclidean"))
+                                .Input(0, "Q", "2D matrix of queries with shape (M,D)", "T")
+                                .Input(1, "X", "2D matrix of the database with shape (N,D)", "T1")
+                                .Input(2, "X_scale", "Scale of an int8 database, a scalar or of shape (N).", "T",
+                                       OpSchema::Optional)
+                                .Output(0, "Values", "Distances or similarities of the neighbors, with shape (M,k)", "T")
+                                .Output(1, "Indices", "Indices in X of the neighbors, with shape (M,k)", "I")
+                                .TypeConstraint("T", {"tensor(float)"}, "Constrain queries and values to float tensors.")
+                                .TypeConstraint("T1", {"tensor(float)", "tensor(float16)", "tensor(int8)"},
+                                                "Constrain the database to float, float16 or int8 tensors.")
+                                .TypeConstraint("I", {"tensor(int64)"}, "Constrain indices to int64 tensors.")
+                                .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+                                  propagateElemTypeFromInputToOutput(ctx, 0, 0);
+                                  updateOutputElemType(ctx, 1, ONNX_NAMESPACE::TensorProto::INT64);
+
+                                  if (!hasInputShape(ctx, 0)) {
+                                    return;
+                                  }
+                                  const auto& queries_shape = getInputShape(ctx, 0);
+                                  if (queries_shape.dim_size() != 2) {
+                                    fail_shape_inference("Q must be a 2D matrix");
+                                  }
+
+                                  TensorShapeProto output_shape;
+                                  *output_shape.add_dim() = queries_shape.dim(0);
+                                  output_shape.add_dim()->set_dim_value(getAttribute(ctx, "k", 0));
+                                  updateOutputShape(ctx, 0, output_shape);
+                                  updateOutputShape(ctx, 1, output_shape);
+                                }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(CropAndResize, 1,
                             OpSchema()
                                 .Attr(
@@ -47,6 +47,13 @@ void RegisterNHWCSchemaWithActivation(const RegistrationFunc& f, ::ONNX_NAMESPAC
                   })
                   .SetDomain(onnxruntime::kMSInternalNHWCDomain)));
 }
+
+// For operators where the layout transformer converts every input that carries per-axis values (e.g. the scales and
+// sizes of Resize) to NHWC along with input 0, the ONNX inferencing function already produces the NHWC output shape
+// so it is used as-is.
+void RegisterNHWCSchemaWithNativeInference(const RegistrationFunc& f, ::ONNX_NAMESPACE::OpSchema&& schema) {
+  f(std::move(::ONNX_NAMESPACE::OpSchema(schema).SetDomain(onnxruntime::kMSInternalNHWCDomain)));
+}
 }  // namespace
 
 #define REGISTER_NHWC_SCHEMA_FROM_MSDOMAIN(RegistrationFn, Op, SinceVersion) \
@@ -67,6 +74,12 @@ void RegisterNHWCSchemaWithActivation(const RegistrationFunc& f, ::ONNX_NAMESPAC
       ::ONNX_NAMESPACE::GetOpSchema<                                           \
           ::ONNX_NAMESPACE::ONNX_OPERATOR_SET_SCHEMA_CLASS_NAME(Onnx, SinceVersion, Op)>())
 
+#define REGISTER_NHWC_SCHEMA_WITH_NATIVE_INFERENCE(RegistrationFn, Op, SinceVersion) \
+  RegisterNHWCSchemaWithNativeInference(                                           \
+      RegistrationFn,                                                              \
+      ::ONNX_NAMESPACE::GetOpSchema<                                               \
+          ::ONNX_NAMESPACE::ONNX_OPERATOR_SET_SCHEMA_CLASS_NAME(Onnx, SinceVersion, Op)>())
+
 void OpSet_Internal_NHWC_ONNX::ForEachSchema(const std::function<void(ONNX_NAMESPACE::OpSchema&&)>& fn) {
   // if the operator may be fused with an activation, use the WITH_ACTIVATION variant to add optional attributes
   // for the activation parameters.
@@ -78,6 +91,9 @@ void OpSet_Internal_NHWC_ONNX::ForEachSchema(const std::function<void(ONNX_NAMES
   REGISTER_NHWC_SCHEMA_WITH_ACTIVATION(fn, AveragePool, 11);
   REGISTER_NHWC_SCHEMA(fn, QLinearConv, 10);
   REGISTER_NHWC_SCHEMA_FROM_MSDOMAIN(fn, QLinearAveragePool, 1);
+  // Resize-10 has scales as input 1 which the layout transformer doesn't convert, so it isn't registered.
+  REGISTER_NHWC_SCHEMA_WITH_NATIVE_INFERENCE(fn, Resize, 11);
+  REGISTER_NHWC_SCHEMA_WITH_NATIVE_INFERENCE(fn, Resize, 13);
 
   // TODO: Add other layout sensitive ops when needed. Those are:
   //   BatchNormalization,
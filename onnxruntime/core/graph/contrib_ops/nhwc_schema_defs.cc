@@ -29,7 +29,7 @@ ONNX_MS_OPERATOR_SET_SCHEMA(NhwcMaxPool, 1,
                             OpSchema()
                                 .Input(0, "x", "", "T")
                                 .Output(0, "y", "", "T")
-                                .TypeConstraint("T", {"tensor(int8)", "tensor(uint8)"}, "")
+                                .TypeConstraint("T", {"tensor(int8)", "tensor(uint8)", "tensor(float)"}, "")
                                 .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
                                 .Attr("kernel_shape", "", AttributeProto::INTS)
                                 .Attr("dilations", "", AttributeProto::INTS, OPTIONAL_VALUE)
@@ -41,6 +41,25 @@ ONNX_MS_OPERATOR_SET_SCHEMA(NhwcMaxPool, 1,
                                   ::onnxruntime::contrib::convPoolShapeInferenceNhwc(ctx, true, true, 0, 1);
                                 }));
 
+ONNX_MS_OPERATOR_SET_SCHEMA(NhwcAveragePool, 1,
+                            OpSchema()
+                                .SetDoc(R"DOC(
+AveragePool with the input and output in channels last layout, e.g. (N x H x W x C) for 2D pooling.
+The attributes are the same as for AveragePool.)DOC")
+                                .Input(0, "x", "", "T")
+                                .Output(0, "y", "", "T")
+                                .TypeConstraint("T", {"tensor(float)"}, "")
+                                .Attr("auto_pad", "", AttributeProto::STRING, std::string("NOTSET"))
+                                .Attr("kernel_shape", "", AttributeProto::INTS)
+                                .Attr("strides", "", AttributeProto::INTS, OPTIONAL_VALUE)
+                                .Attr("pads", "", AttributeProto::INTS, OPTIONAL_VALUE)
+                                .Attr("ceil_mode", "", AttributeProto::INT, static_cast<int64_t>(0))
+                                .Attr("count_include_pad", "", AttributeProto::INT, static_cast<int64_t>(0))
+                                .TypeAndShapeInferenceFunction([](InferenceContext& ctx) {
+                                  propagateElemTypeFromInputToOutput(ctx, 0, 0);
+                                  ::onnxruntime::contrib::convPoolShapeInferenceNhwc(ctx, false, true, 0, 1);
+                                }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(QLinearGlobalAveragePool, 1,
                             OpSchema()
                                 .SetDoc(R"DOC(
@@ -379,5 +398,17 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
     NhwcConv,
     1,
     OpSchema().FillUsing(ConvOpSchemaGenerator()));
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    NhwcFusedConv,
+    1,
+    OpSchema()
+        .SetDoc(R"DOC(
+NhwcConv with the activation and the optional sum input of FusedConv, Y = activation(Conv(X, W) + B + Z),
+where Z has the channels last layout of Y.)DOC")
+        .FillUsing(ConvOpSchemaGenerator())
+        .Attr("activation", "", AttributeProto::STRING, OPTIONAL_VALUE)
+        .Attr("activation_params", "", AttributeProto::FLOATS, OPTIONAL_VALUE)
+        .Input(3, "Z", "Tensor to add to the output, with the same shape as Y.", "T", OpSchema::Optional));
 }  // namespace contrib
 }  // namespace onnxruntime
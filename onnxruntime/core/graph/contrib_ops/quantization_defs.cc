@@ -585,6 +585,33 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
         .TypeConstraint("T", {"tensor(uint8)", "tensor(int8)"}, "Constrain input and output types to 8 bit tensors.")
         .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput));
 
+const char* QLinearElementwiseChainDoc_ver1 = R"DOC(
+QLinearElementwiseChain applies a chain of quantized element-wise operators to the input tensor (Tensor<T>), and
+produces one output data (Tensor<T>) of the same shape. It is created by the optimizer from chains of QLinearLeakyRelu,
+QLinearSigmoid, and QLinearAdd and QLinearMul with a constant scalar operand, and produces the same result as running
+those operators one after the other.
+Operator i of the chain is ops[i]. Its input is quantized with scales[3*i] and zero_points[3*i], and its output with
+scales[3*i+2] and zero_points[3*i+2]. QLinearAdd and QLinearMul use operands[i] as their second operand, quantized with
+scales[3*i+1] and zero_points[3*i+1]. QLinearLeakyRelu uses alphas[i] as its coefficient of leakage. Values that an
+operator does not use are ignored.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(
+    QLinearElementwiseChain, 1,
+    OpSchema()
+        .SetDoc(QLinearElementwiseChainDoc_ver1)
+        .Attr("ops",
+              "The operators of the chain, in order. One of QLinearAdd, QLinearMul, QLinearLeakyRelu, QLinearSigmoid.",
+              AttributeProto::STRINGS)
+        .Attr("scales", "Input, operand and output scale of each operator.", AttributeProto::FLOATS)
+        .Attr("zero_points", "Input, operand and output zero point of each operator.", AttributeProto::INTS)
+        .Attr("operands", "Quantized scalar operand of each operator.", AttributeProto::INTS)
+        .Attr("alphas", "Coefficient of leakage of each operator.", AttributeProto::FLOATS)
+        .Input(0, "X", "Input tensor", "T")
+        .Output(0, "Y", "Output tensor", "T")
+        .TypeConstraint("T", {"tensor(uint8)", "tensor(int8)"}, "Constrain input and output types to 8 bit tensors.")
+        .TypeAndShapeInferenceFunction(ONNX_NAMESPACE::propagateShapeAndTypeFromFirstInput));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(
     QLinearSoftmax, 1,
     OpSchema()
@@ -403,6 +403,21 @@ Return Value:
         this->ConvSymS8S8Dispatch = &MlasConvSymS8DispatchDot;
     }
 
+    //
+    // Partition the work more finely on hybrid (big.LITTLE) processors so
+    // that the little cores do not hold up the completion of an operation.
+    // This matches the degree of parallelism reported by the thread pool.
+    //
+    // N.B. Detecting big.LITTLE needs the per-core microarchitectures that
+    // only the ONNX Runtime CPUIDInfo collects.
+    //
+
+#if !defined(BUILD_MLAS_NO_ONNXRUNTIME)
+    if (MLAS_CPUIDINFO::GetCPUIDInfo().IsHybrid()) {
+        this->MaximumThreadCount = MLAS_MAXIMUM_THREAD_COUNT * 4;
+    }
+#endif
+
 #endif // MLAS_TARGET_ARM64
 #if defined(MLAS_TARGET_POWER)
     this->GemmFloatKernel = MlasSgemmKernel;
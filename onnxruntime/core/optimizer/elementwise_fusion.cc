@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/elementwise_fusion.h"
+
+#include <algorithm>
+
+#include "core/graph/graph_utils.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// Upper bound of the nodes in one fused subgraph, which bounds the scratch memory the fused kernel uses per thread.
+constexpr size_t kMaxFusedNodes = 32;
+
+bool IsTensorOfType(const NodeArg& node_arg, int32_t elem_type) {
+  const auto* type = node_arg.TypeAsProto();
+  return type != nullptr && type->has_tensor_type() && type->tensor_type().elem_type() == elem_type;
+}
+
+bool IsFusibleNode(const Node& node, const InlinedHashSet<std::string_view>& compatible_providers) {
+  if (!graph_utils::IsSupportedOptypeVersionAndDomain(node, "Add", {7, 13, 14}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sub", {7, 13, 14}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Mul", {7, 13, 14}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Div", {7, 13, 14}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Pow", {7, 12, 13, 15}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Erf", {9, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sqrt", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Reciprocal", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Neg", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Abs", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Exp", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Tanh", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Sigmoid", {6, 13}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Relu", {6, 13, 14}) &&
+      !graph_utils::IsSupportedOptypeVersionAndDomain(node, "Where", {9, 16})) {
+    return false;
+  }
+
+  if (!graph_utils::IsSupportedProvider(node, compatible_providers) ||
+      node.OutputDefs().size() != 1 || !IsTensorOfType(*node.OutputDefs()[0], TensorProto_DataType_FLOAT)) {
+    return false;
+  }
+
+  // all the inputs are float, except for the condition of Where
+  const bool is_where = node.OpType() == "Where";
+  const auto& input_defs = node.InputDefs();
+  for (size_t i = 0; i < input_defs.size(); ++i) {
+    const auto elem_type = is_where && i == 0 ? TensorProto_DataType_BOOL : TensorProto_DataType_FLOAT;
+    if (!input_defs[i]->Exists() || !IsTensorOfType(*input_defs[i], elem_type)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// A producer can join the subgraph once the subgraph consumes all of its output, so that the output of the last node
+// is the only value leaving the subgraph. Nodes with different priorities are not mixed, so that e.g. recompute nodes
+// keep being scheduled late.
+bool CanAddToSubgraph(const Graph& graph, const Node& producer, const Node& last_node,
+                      const InlinedHashSet<NodeIndex>& subgraph,
+                      const InlinedHashSet<std::string_view>& compatible_providers) {
+  if (!IsFusibleNode(producer, compatible_providers) ||
+      producer.GetExecutionProviderType() != last_node.GetExecutionProviderType() ||
+      producer.Priority() != last_node.Priority() ||
+      graph.NodeProducesGraphOutput(producer)) {
+    return false;
+  }
+
+  for (auto edge = producer.OutputEdgesBegin(); edge != producer.OutputEdgesEnd(); ++edge) {
+    if (subgraph.count(edge->GetNode().Index()) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+Status ElementwiseFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                    const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+  InlinedHashMap<NodeIndex, size_t> topological_position;
+  topological_position.reserve(node_topology_list.size());
+
+  for (size_t i = 0; i < node_topology_list.size(); ++i) {
+    auto* node_ptr = graph.GetNode(node_topology_list[i]);
+    if (nullptr == node_ptr)
+      continue;  // node was removed
+
+    ORT_RETURN_IF_ERROR(Recurse(*node_ptr, modified, graph_level, logger));
+    topological_position[node_topology_list[i]] = i;
+  }
+
+  InlinedVector<std::reference_wrapper<Node>> nodes_to_remove;
+  InlinedHashSet<NodeIndex> fused_nodes;
+  const auto& compatible_providers = GetCompatibleExecutionProviders();
+
+  // Visit the nodes in reverse topological order, so a subgraph is found from the node producing its output.
+  for (auto it = node_topology_list.rbegin(); it != node_topology_list.rend(); ++it) {
+    auto* node_ptr = graph.GetNode(*it);
+    if (nullptr == node_ptr || fused_nodes.count(*it) != 0 || !IsFusibleNode(*node_ptr, compatible_providers)) {
+      continue;
+    }
+
+    Node& last_node = *node_ptr;
+    InlinedHashSet<NodeIndex> subgraph{last_node.Index()};
+    InlinedVector<Node*> members{&last_node};
+
+    // A producer shared by two members is only taken in once both consumers are, so grow until nothing changes.
+    bool grown = true;
+    while (grown && members.size() < kMaxFusedNodes) {
+      grown = false;
+      for (size_t i = 0; i < members.size() && members.size() < kMaxFusedNodes; ++i) {
+        const Node& member = *members[i];
+        for (auto edge = member.InputEdgesBegin(); edge != member.InputEdgesEnd(); ++edge) {
+          const Node& producer = edge->GetNode();
+          if (subgraph.count(producer.Index()) != 0 || fused_nodes.count(producer.Index()) != 0 ||
+              !CanAddToSubgraph(graph, producer, last_node, subgraph, compatible_providers)) {
+            continue;
+          }
+
+          subgraph.insert(producer.Index());
+          members.push_back(graph.GetNode(producer.Index()));
+          grown = true;
+          if (members.size() == kMaxFusedNodes) {
+            break;
+          }
+        }
+      }
+    }
+
+    if (members.size() < 2) {
+      continue;
+    }
+
+    std::sort(members.begin(), members.end(), [&topological_position](const Node* a, const Node* b) {
+      return topological_position.at(a->Index()) < topological_position.at(b->Index());
+    });
+
+    // Value i of the expression is input i of the fused node, followed by the output of each member in order.
+    InlinedHashSet<const NodeArg*> member_outputs;
+    for (const Node* member : members) {
+      member_outputs.insert(member->OutputDefs()[0]);
+    }
+
+    InlinedVector<NodeArg*> fused_inputs;
+    InlinedHashMap<const NodeArg*, int64_t> value_indices;
+    for (Node* member : members) {
+      for (NodeArg* input_def : member->MutableInputDefs()) {
+        if (member_outputs.count(input_def) == 0 && value_indices.count(input_def) == 0) {
+          value_indices[input_def] = static_cast<int64_t>(fused_inputs.size());
+          fused_inputs.push_back(input_def);
+        }
+      }
+    }
+
+    std::vector<std::string> ops;
+    std::vector<int64_t> operands;
+    for (size_t i = 0; i < members.size(); ++i) {
+      const Node& member = *members[i];
+      const auto& input_defs = member.InputDefs();
+      ops.push_back(member.OpType());
+      for (size_t j = 0; j < 3; ++j) {
+        operands.push_back(j < input_defs.size() ? value_indices.at(input_defs[j]) : -1);
+      }
+      value_indices[member.OutputDefs()[0]] = static_cast<int64_t>(fused_inputs.size() + i);
+    }
+
+    Node& fused_node = graph.AddNode(graph.GenerateNodeName("FusedElementwise"),
+                                     "FusedElementwise",
+                                     "fused element-wise operators",
+                                     fused_inputs,
+                                     {last_node.MutableOutputDefs()[0]},
+                                     nullptr,
+                                     kMSDomain);
+    fused_node.AddAttribute("ops", ops);
+    fused_node.AddAttribute("operands", operands);
+
+    // Assign provider to this new node. Provider should be same as the provider for old nodes.
+    fused_node.SetExecutionProviderType(last_node.GetExecutionProviderType());
+    fused_node.SetPriority(last_node.Priority());
+
+    for (Node* member : members) {
+      fused_nodes.insert(member->Index());
+      nodes_to_remove.push_back(*member);
+    }
+  }
+
+  modified = modified || !nodes_to_remove.empty();
+
+  for (const auto& node : nodes_to_remove) {
+    graph_utils::RemoveNodeOutputEdges(graph, node);
+    graph.RemoveNode(node.get().Index());
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class ElementwiseFusion
+
+Fuses connected subgraphs of float element-wise operators into a single FusedElementwise node, which evaluates the
+whole expression block by block instead of writing every intermediate result to memory.
+
+The fused operators are Add, Sub, Mul, Div, Pow, Erf, Sqrt, Reciprocal, Neg, Abs, Exp, Tanh, Sigmoid, Relu and
+Where, with any broadcasting between their inputs. A subgraph is grown backwards from the node producing its output,
+and takes in a producer once all the consumers of the producer's output are in the subgraph, so only the output of
+the last node leaves it. The intermediate outputs must not be graph outputs.
+
+      X    B                   X    B
+      |    |                   |    |
+      Add--+                   FusedElementwise
+       |  \                         |
+       | Sigmoid        ==>         Y
+       |  /
+       Mul
+        |
+        Y
+*/
+class ElementwiseFusion : public GraphTransformer {
+ public:
+  ElementwiseFusion(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("ElementwiseFusion", compatible_execution_providers) {
+  }
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/encoder_layer_fusion.h"
+
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/contrib_ops/contrib_defs.h"
+#include "core/graph/graph_utils.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+bool IsFloatTensor(const NodeArg& node_arg) {
+  const auto* type = node_arg.TypeAsProto();
+  return type != nullptr && type->has_tensor_type() &&
+         type->tensor_type().elem_type() == TensorProto_DataType_FLOAT;
+}
+
+bool HasInput(const Node& node, size_t index) {
+  return index < node.InputDefs().size() && node.InputDefs()[index]->Exists();
+}
+
+// Returns whether none of the outputs of a node but the first one are used.
+bool UsesOnlyFirstOutput(const Node& node) {
+  for (size_t i = 1; i < node.OutputDefs().size(); ++i) {
+    if (node.OutputDefs()[i]->Exists()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the only consumer of the output of a node, or nullptr if there are several or if it is a graph output.
+Node* GetOnlyConsumer(Graph& graph, const Node& node) {
+  if (node.GetOutputEdgesCount() != 1 || graph.NodeProducesGraphOutput(node)) {
+    return nullptr;
+  }
+  return graph.GetNode(node.OutputNodesBegin()->Index());
+}
+
+// Returns whether a node is a MatMul of `input` by a 2D initializer.
+bool IsMatMulByWeight(const Graph& graph, const Node* node, const NodeArg* input, ProviderType provider) {
+  if (node == nullptr ||
+      !graph_utils::IsSupportedOptypeVersionAndDomain(*node, "MatMul", {1, 9, 13}) ||
+      node->GetExecutionProviderType() != provider ||
+      node->InputDefs()[0] != input ||
+      !graph_utils::NodeArgIsConstant(graph, *node->InputDefs()[1])) {
+    return false;
+  }
+  const auto* weight_shape = node->InputDefs()[1]->Shape();
+  return weight_shape != nullptr && weight_shape->dim_size() == 2;
+}
+
+// Returns whether the QKV weight of an Attention node has the shape (hidden_size, 3 * hidden_size). Attention also
+// allows the hidden size of its input to differ from the hidden size of Q, K and V, which EncoderLayer does not.
+bool HasSquareQkvWeight(const Node& attention_node) {
+  const auto* weight_shape = attention_node.InputDefs()[1]->Shape();
+  if (weight_shape == nullptr || weight_shape->dim_size() != 2) {
+    return false;
+  }
+  const auto& input_hidden_size = weight_shape->dim(0);
+  const auto& qkv_hidden_size = weight_shape->dim(1);
+  return utils::HasDimValue(input_hidden_size) && utils::HasDimValue(qkv_hidden_size) &&
+         qkv_hidden_size.dim_value() == 3 * input_hidden_size.dim_value();
+}
+
+// Returns whether a node is a SkipLayerNormalization of `input` and `skip`, in either order.
+bool IsSkipLayerNorm(const Node* node, const NodeArg* input, const NodeArg* skip, ProviderType provider) {
+  if (node == nullptr ||
+      !graph_utils::IsSupportedOptypeVersionAndDomain(*node, "SkipLayerNormalization", {1}, kMSDomain) ||
+      node->GetExecutionProviderType() != provider ||
+      !UsesOnlyFirstOutput(*node)) {
+    return false;
+  }
+  const auto& inputs = node->InputDefs();
+  return (inputs[0] == input && inputs[1] == skip) || (inputs[0] == skip && inputs[1] == input);
+}
+
+float GetEpsilon(const Node& node) {
+  const auto* attr = graph_utils::GetNodeAttribute(node, "epsilon");
+  return attr != nullptr && attr->has_f() ? attr->f() : contrib::kDefaultSkipLayerNormEpsilon;
+}
+
+}  // namespace
+
+Status EncoderLayerFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                     const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (auto node_index : node_topology_list) {
+    auto* node_ptr = graph.GetNode(node_index);
+    if (nullptr == node_ptr)
+      continue;  // node was removed
+
+    auto& attention_node = *node_ptr;
+    ORT_RETURN_IF_ERROR(Recurse(attention_node, modified, graph_level, logger));
+
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(attention_node, "Attention", {1}, kMSDomain) ||
+        !graph_utils::IsSupportedProvider(attention_node, GetCompatibleExecutionProviders()) ||
+        !IsFloatTensor(*attention_node.InputDefs()[0]) ||
+        HasInput(attention_node, 4) ||
+        HasInput(attention_node, 5) ||
+        graph_utils::GetNodeAttribute(attention_node, "qkv_hidden_sizes") != nullptr ||
+        !HasSquareQkvWeight(attention_node) ||
+        !UsesOnlyFirstOutput(attention_node)) {
+      continue;
+    }
+
+    const ProviderType provider = attention_node.GetExecutionProviderType();
+    NodeArg* input = attention_node.MutableInputDefs()[0];
+
+    Node* dense_node = GetOnlyConsumer(graph, attention_node);
+    if (!IsMatMulByWeight(graph, dense_node, attention_node.OutputDefs()[0], provider)) {
+      continue;
+    }
+
+    // The output of the first SkipLayerNormalization feeds the feed forward network and is its residual.
+    Node* attention_norm_node = GetOnlyConsumer(graph, *dense_node);
+    if (!IsSkipLayerNorm(attention_norm_node, dense_node->OutputDefs()[0], input, provider) ||
+        attention_norm_node->GetOutputEdgesCount() != 2 ||
+        graph.NodeProducesGraphOutput(*attention_norm_node)) {
+      continue;
+    }
+
+    const NodeArg* hidden = attention_norm_node->OutputDefs()[0];
+    Node* ffn1_node = nullptr;
+    Node* ffn_norm_node = nullptr;
+    for (auto it = attention_norm_node->OutputNodesBegin(); it != attention_norm_node->OutputNodesEnd(); ++it) {
+      Node* consumer = graph.GetNode(it->Index());
+      if (consumer->OpType() == "MatMul") {
+        ffn1_node = consumer;
+      } else {
+        ffn_norm_node = consumer;
+      }
+    }
+    if (!IsMatMulByWeight(graph, ffn1_node, hidden, provider)) {
+      continue;
+    }
+
+    Node* gelu_node = GetOnlyConsumer(graph, *ffn1_node);
+    if (gelu_node == nullptr ||
+        !(graph_utils::IsSupportedOptypeVersionAndDomain(*gelu_node, "BiasGelu", {1}, kMSDomain) ||
+          graph_utils::IsSupportedOptypeVersionAndDomain(*gelu_node, "FastGelu", {1}, kMSDomain)) ||
+        gelu_node->GetExecutionProviderType() != provider ||
+        gelu_node->InputDefs()[0] != ffn1_node->OutputDefs()[0]) {
+      continue;
+    }
+
+    Node* ffn2_node = GetOnlyConsumer(graph, *gelu_node);
+    if (!IsMatMulByWeight(graph, ffn2_node, gelu_node->OutputDefs()[0], provider) ||
+        GetOnlyConsumer(graph, *ffn2_node) != ffn_norm_node ||
+        !IsSkipLayerNorm(ffn_norm_node, ffn2_node->OutputDefs()[0], hidden, provider)) {
+      continue;
+    }
+
+    NodeArg empty_place_holder("", nullptr);
+    auto optional_input = [&empty_place_holder](Node& node, size_t index) {
+      return HasInput(node, index) ? node.MutableInputDefs()[index] : &empty_place_holder;
+    };
+
+    InlinedVector<NodeArg*> encoder_layer_input_defs{input,
+                                                     attention_node.MutableInputDefs()[1],
+                                                     attention_node.MutableInputDefs()[2],
+                                                     optional_input(attention_node, 3),
+                                                     dense_node->MutableInputDefs()[1],
+                                                     optional_input(*attention_norm_node, 4),
+                                                     attention_norm_node->MutableInputDefs()[2],
+                                                     optional_input(*attention_norm_node, 3),
+                                                     ffn1_node->MutableInputDefs()[1],
+                                                     optional_input(*gelu_node, 1),
+                                                     ffn2_node->MutableInputDefs()[1],
+                                                     optional_input(*ffn_norm_node, 4),
+                                                     ffn_norm_node->MutableInputDefs()[2],
+                                                     optional_input(*ffn_norm_node, 3)};
+
+    InlinedVector<NodeArg*> encoder_layer_output_defs{ffn_norm_node->MutableOutputDefs()[0]};
+
+    Node& encoder_layer_node = graph.AddNode(graph.GenerateNodeName("EncoderLayer"),
+                                             "EncoderLayer",
+                                             "fused Attention, SkipLayerNormalization and BiasGelu subgraph",
+                                             encoder_layer_input_defs,
+                                             encoder_layer_output_defs,
+                                             nullptr,
+                                             kMSDomain);
+    for (const char* name : {"num_heads", "unidirectional"}) {
+      const auto* attr = graph_utils::GetNodeAttribute(attention_node, name);
+      if (attr != nullptr) {
+        encoder_layer_node.AddAttributeProto(*attr);
+      }
+    }
+    encoder_layer_node.AddAttribute("attention_epsilon", GetEpsilon(*attention_norm_node));
+    encoder_layer_node.AddAttribute("ffn_epsilon", GetEpsilon(*ffn_norm_node));
+    encoder_layer_node.AddAttribute("activation",
+                                    std::string(gelu_node->OpType() == "FastGelu" ? "fast_gelu" : "gelu"));
+
+    // Assign provider to this new node. Provider should be same as the provider for old nodes.
+    encoder_layer_node.SetExecutionProviderType(provider);
+
+    for (Node* node : {&attention_node, dense_node, attention_norm_node, ffn1_node, gelu_node, ffn2_node,
+                       ffn_norm_node}) {
+      graph_utils::RemoveNodeOutputEdges(graph, *node);
+      graph.RemoveNode(node->Index());
+    }
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class EncoderLayerFusion
+
+Fuses the nodes of a post-LayerNorm transformer encoder layer, as left behind by the Attention, SkipLayerNorm and
+BiasGelu fusions, into a single EncoderLayer node.
+
+     X
+   /   \
+  |   Attention
+  |      |
+  |    MatMul
+   \     |
+  SkipLayerNormalization
+    /        \
+   |       MatMul                              X
+   |         |                                 |
+   |   BiasGelu/FastGelu         ==>      EncoderLayer
+   |         |                                 |
+   |       MatMul                              Y
+    \        |
+  SkipLayerNormalization
+             |
+             Y
+
+The Attention must have no past, extra_add or qkv_hidden_sizes, its present output must not be used and its QKV
+weight must have the shape (hidden_size, 3 * hidden_size), and the weights of the MatMul nodes must be 2D
+initializers. Apart from the output of the first SkipLayerNormalization,
+which is also the residual of the second one, every intermediate result must have a single consumer and must not be
+a graph output.
+*/
+class EncoderLayerFusion : public GraphTransformer {
+ public:
+  EncoderLayerFusion(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("EncoderLayerFusion", compatible_execution_providers) {
+  }
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -4,6 +4,9 @@
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
 
+#include <chrono>
+#include <limits>
+
 using namespace onnxruntime;
 using namespace ::onnxruntime::common;
 
@@ -25,14 +28,61 @@ common::Status GraphTransformerManager::ApplyTransformers(Graph& graph, Transfor
     return Status::OK();
   }
 
+  // Statistics of one transformer across all the steps, logged once the level is done.
+  struct TransformerStats {
+    std::chrono::nanoseconds duration{0};
+    unsigned num_applied = 0;
+    unsigned num_skipped = 0;
+    unsigned num_modified = 0;
+    size_t nodes_added = 0;
+    size_t nodes_removed = 0;
+  };
+
+  const size_t num_transformers = transformers->second.size();
+  InlinedVector<TransformerStats> stats(num_transformers);
+
+  // The graph version is bumped every time a transformer modifies the graph. A transformer that left the graph
+  // unchanged at some version would leave it unchanged again, so it isn't rerun until another transformer has
+  // modified the graph. After the first step this limits the work to the transformers that can see a change.
+  constexpr size_t kNeverUnchanged = std::numeric_limits<size_t>::max();
+  size_t graph_version = 0;
+  InlinedVector<size_t> unchanged_at_version(num_transformers, kNeverUnchanged);
+
   for (unsigned step = 0; step < steps_; ++step) {
     bool graph_changed = false;
-    for (const auto& transformer : transformers->second) {
+    for (size_t i = 0; i < num_transformers; ++i) {
+      const auto& transformer = transformers->second[i];
       if (step > 0 && transformer->ShouldOnlyApplyOnce())
         continue;
 
+      if (unchanged_at_version[i] == graph_version) {
+        ++stats[i].num_skipped;
+        continue;
+      }
+
+      const int num_nodes_before = graph.NumberOfNodes();
+      const int max_node_index_before = graph.MaxNodeIndex();
+      const auto start_time = std::chrono::high_resolution_clock::now();
+
       bool modified = false;
       ORT_RETURN_IF_ERROR(transformer->Apply(graph, modified, logger));
+
+      auto& transformer_stats = stats[i];
+      transformer_stats.duration += std::chrono::high_resolution_clock::now() - start_time;
+      ++transformer_stats.num_applied;
+
+      if (modified) {
+        // new nodes always get a new index, so the growth of the max index is the number of nodes added
+        const size_t nodes_added = static_cast<size_t>(graph.MaxNodeIndex() - max_node_index_before);
+        ++transformer_stats.num_modified;
+        transformer_stats.nodes_added += nodes_added;
+        transformer_stats.nodes_removed +=
+            static_cast<size_t>(num_nodes_before) + nodes_added - static_cast<size_t>(graph.NumberOfNodes());
+        ++graph_version;
+      } else {
+        unchanged_at_version[i] = graph_version;
+      }
+
       graph_changed = graph_changed || modified;
     }
     if (!graph_changed) {
@@ -40,6 +90,20 @@ common::Status GraphTransformerManager::ApplyTransformers(Graph& graph, Transfor
     }
   }
 
+  for (size_t i = 0; i < num_transformers; ++i) {
+    const auto& transformer_stats = stats[i];
+    if (transformer_stats.num_applied == 0) {
+      continue;
+    }
+
+    LOGS(logger, VERBOSE) << "GraphTransformer " << transformers->second[i]->Name()
+                          << ": applied " << transformer_stats.num_applied << " time(s) in "
+                          << std::chrono::duration_cast<std::chrono::microseconds>(transformer_stats.duration).count()
+                          << " us, skipped " << transformer_stats.num_skipped << " time(s), modified the graph "
+                          << transformer_stats.num_modified << " time(s), nodes added: " << transformer_stats.nodes_added
+                          << ", nodes removed: " << transformer_stats.nodes_removed;
+  }
+
   return Status::OK();
 }
 
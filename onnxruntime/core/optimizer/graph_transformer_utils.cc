@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <variant>
 
+#include "core/common/parse_string.h"
 #include "core/optimizer/conv_activation_fusion.h"
 #include "core/optimizer/nhwc_transformer.h"
 #include "core/optimizer/qdq_transformer/qdq_final_cleanup.h"
@@ -34,7 +35,9 @@
 #include "core/optimizer/div_mul_fusion.h"
 #include "core/optimizer/dropout_elimination.h"
 #include "core/optimizer/dynamic_quantize_matmul_fusion.h"
+#include "core/optimizer/elementwise_fusion.h"
 #include "core/optimizer/embed_layer_norm_fusion.h"
+#include "core/optimizer/encoder_layer_fusion.h"
 #include "core/optimizer/expand_elimination.h"
 #include "core/optimizer/fast_gelu_fusion.h"
 #include "core/optimizer/free_dim_override_transformer.h"
@@ -51,12 +54,14 @@
 #include "core/optimizer/matmul_scale_fusion.h"
 #include "core/optimizer/matmul_transpose_fusion.h"
 #include "core/optimizer/nchwc_transformer.h"
+#include "core/optimizer/nearest_neighbors_fusion.h"
 #include "core/optimizer/noop_elimination.h"
 #include "core/optimizer/not_where_fusion.h"
 #include "core/optimizer/qdq_transformer/clip_quantizelinear.h"
 #include "core/optimizer/qdq_transformer/qdq_propagation.h"
 #include "core/optimizer/qdq_transformer/qdq_s8_to_u8.h"
 #include "core/optimizer/qdq_transformer/relu_quantizelinear.h"
+#include "core/optimizer/qlinear_elementwise_chain_fusion.h"
 #include "core/optimizer/relu_clip_fusion.h"
 #include "core/optimizer/reshape_fusion.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
@@ -67,6 +72,7 @@
 #ifdef ENABLE_TRAINING
 #include "orttraining/core/optimizer/bitmask_dropout_replacement.h"
 #include "orttraining/core/optimizer/bias_softmax_dropout_fusion.h"
+#include "orttraining/core/optimizer/memory_budget_recompute.h"
 #include "orttraining/core/optimizer/sce_loss_grad_bias_fusion.h"
 #endif
 
@@ -248,6 +254,8 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
       transformers.emplace_back(std::make_unique<GemmActivationFusion>(cpu_ep));
       transformers.emplace_back(std::make_unique<MatMulIntegerToFloatFusion>(cpu_ep));
       transformers.emplace_back(std::make_unique<DynamicQuantizeMatMulFusion>(cpu_ep));
+      transformers.emplace_back(std::make_unique<QLinearElementwiseChainFusion>(cpu_ep));
+      transformers.emplace_back(std::make_unique<NearestNeighborsFusion>(cpu_ep));
 
       transformers.emplace_back(std::make_unique<ConvActivationFusion>(cpu_cuda_rocm_acl_armnn_eps));
 
@@ -274,6 +282,9 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
 
       transformers.emplace_back(std::make_unique<MatMulScaleFusion>(cpu_cuda_rocm_eps));
 
+      // Runs after the Attention, SkipLayerNorm and BiasGelu fusions, whose output it fuses into whole layers.
+      transformers.emplace_back(std::make_unique<EncoderLayerFusion>(cpu_ep));
+
       // GeluApproximation has side effects which may change results. It needs to be manually enabled,
       // or alternatively the model can be updated offline using a model conversion script
       //   e.g. fusion_gelu_approximation function used by onnxruntime/python/tools/transformers/onnx_model_bert.py
@@ -287,6 +298,22 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
       }
 #endif
 
+#ifdef ENABLE_TRAINING
+      // Runs after the fusions above, so that e.g. fused Gelu and LayerNormalization nodes are recomputed as a whole.
+      const std::string activation_memory_budget_mb =
+          session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigActivationMemoryBudgetMB, "");
+      if (!activation_memory_budget_mb.empty()) {
+        // the value is validated by InferenceSession::Initialize
+        double memory_budget_mb = 0.0;
+        ORT_ENFORCE(TryParseStringWithClassicLocale(activation_memory_budget_mb, memory_budget_mb) &&
+                        memory_budget_mb >= 0.0,
+                    "Invalid value for ", kOrtSessionOptionsConfigActivationMemoryBudgetMB, ": ",
+                    activation_memory_budget_mb);
+        const auto memory_budget_bytes = static_cast<int64_t>(memory_budget_mb * 1024 * 1024);
+        transformers.emplace_back(std::make_unique<MemoryBudgetRecompute>(memory_budget_bytes, cpu_cuda_rocm_eps));
+      }
+#endif
+
 #endif
       // The QDQFinalCleanupTransformer must run AFTER other transformers that fuse Q/DQ nodes. Otherwise, their
       // fusions might be prevented if this one removes a Q/DQ node too early.
@@ -295,12 +322,15 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
 
     case TransformerLevel::Level3: {
 #ifndef DISABLE_CONTRIB_OPS
-      // Register the NCHWc layout transformer if supported by the platform.
-      if (MlasNchwcGetBlockSize() > 1) {
+      // Register the NCHWc layout transformer if supported by the platform, unless float models are requested to
+      // run in NHWC, in which case the NhwcTransformer converts the float convolutions instead.
+      const bool nhwc_float_layout =
+          session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNhwcFloatLayout, "0") == "1";
+      if (MlasNchwcGetBlockSize() > 1 && !nhwc_float_layout) {
         transformers.emplace_back(std::make_unique<NchwcTransformer>());
       }
       auto cpu_allocator = cpu_execution_provider.GetAllocator(0, OrtMemTypeDefault);
-      transformers.emplace_back(std::make_unique<NhwcTransformer>(std::move(cpu_allocator)));
+      transformers.emplace_back(std::make_unique<NhwcTransformer>(std::move(cpu_allocator), nhwc_float_layout));
       // NCHWCtransformer should have a higher priority versus this. Because NCHWCtransformer also do the similar things
       // of fusion patterns and target on CPU. However, NCHWCtransformer will reorder the layout to nchwc which is only available for
       // x86-64 cpu, not edge cpu like arm. But This tranformer could be used by opencl-ep/cpu-ep. So
@@ -308,6 +338,9 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformers(
       // PR #6351 implemented similar fusion-pattern for CUDA only, and can only fuse conv-add-relu,
       // while we can fuse more activation.
       transformers.emplace_back(std::make_unique<ConvAddActivationFusion>(cpu_ep));
+      // Runs last so it only picks up the element-wise operators that the fusions above, and the Level2 fusions of
+      // patterns such as Gelu and LayerNormalization, left behind.
+      transformers.emplace_back(std::make_unique<ElementwiseFusion>(cpu_ep));
 #endif
     } break;
 
@@ -371,8 +404,10 @@ InlinedVector<std::unique_ptr<GraphTransformer>> GenerateTransformersForMinimalB
       if (!saving) {
 #ifndef DISABLE_CONTRIB_OPS
         const InlinedHashSet<std::string_view> cpu_ep = {onnxruntime::kCpuExecutionProvider};
+        const bool nhwc_float_layout =
+            session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNhwcFloatLayout, "0") == "1";
         auto cpu_allocator = cpu_execution_provider.GetAllocator(0, OrtMemTypeDefault);
-        transformers.emplace_back(std::make_unique<NhwcTransformer>(std::move(cpu_allocator)));
+        transformers.emplace_back(std::make_unique<NhwcTransformer>(std::move(cpu_allocator), nhwc_float_layout));
 #else
         ORT_UNUSED_PARAMETER(cpu_execution_provider);
 #endif
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/nearest_neighbors_fusion.h"
+
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/utils.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+int64_t GetIntAttribute(const Node& node, const std::string& name, int64_t default_value) {
+  const auto* attr = graph_utils::GetNodeAttribute(node, name);
+  return attr != nullptr && attr->has_i() ? attr->i() : default_value;
+}
+
+bool IsFloatTensor(const NodeArg& node_arg) {
+  const auto* type = node_arg.TypeAsProto();
+  return type != nullptr && type->has_tensor_type() &&
+         type->tensor_type().elem_type() == TensorProto_DataType_FLOAT;
+}
+
+}  // namespace
+
+Status NearestNeighborsFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                         const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (auto node_index : node_topology_list) {
+    auto* node_ptr = graph.GetNode(node_index);
+    if (nullptr == node_ptr)
+      continue;  // node was removed
+
+    auto& cdist_node = *node_ptr;
+    ORT_RETURN_IF_ERROR(Recurse(cdist_node, modified, graph_level, logger));
+
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(cdist_node, "CDist", {1}, kMSDomain) ||
+        !graph_utils::IsSupportedProvider(cdist_node, GetCompatibleExecutionProviders()) ||
+        !IsFloatTensor(*cdist_node.InputDefs()[0]) ||
+        cdist_node.GetOutputEdgesCount() != 1 ||
+        graph.NodeProducesGraphOutput(cdist_node)) {
+      continue;
+    }
+
+    auto& topk_node = *graph.GetNode(cdist_node.OutputNodesBegin()->Index());
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(topk_node, "TopK", {10, 11}) ||
+        topk_node.GetExecutionProviderType() != cdist_node.GetExecutionProviderType() ||
+        topk_node.InputDefs()[0] != cdist_node.OutputDefs()[0]) {
+      continue;
+    }
+
+    // the distances are the last axis of the CDist output, and the kernel only returns the smallest in order
+    const int64_t axis = GetIntAttribute(topk_node, "axis", -1);
+    if ((axis != -1 && axis != 1) ||
+        GetIntAttribute(topk_node, "largest", 1) != 0 ||
+        GetIntAttribute(topk_node, "sorted", 1) != 1) {
+      continue;
+    }
+
+    InlinedVector<int64_t> k;
+    if (!optimizer_utils::AppendTensorFromInitializer(graph, *topk_node.InputDefs()[1], k, true) || k.size() != 1) {
+      continue;
+    }
+
+    const auto* metric_attr = graph_utils::GetNodeAttribute(cdist_node, "metric");
+    const std::string metric = metric_attr != nullptr ? metric_attr->s() : "sqeuclidean";
+    if (metric != "sqeuclidean" && metric != "euclidean") {
+      continue;
+    }
+
+    Node& nearest_neighbors_node = graph.AddNode(graph.GenerateNodeName("NearestNeighbors"),
+                                                 "NearestNeighbors",
+                                                 "fused CDist and TopK",
+                                                 cdist_node.MutableInputDefs(),
+                                                 topk_node.MutableOutputDefs(),
+                                                 nullptr,
+                                                 kMSDomain);
+    nearest_neighbors_node.AddAttribute("k", k[0]);
+    nearest_neighbors_node.AddAttribute("metric", metric);
+
+    // Assign provider to this new node. Provider should be same as the provider for old nodes.
+    nearest_neighbors_node.SetExecutionProviderType(cdist_node.GetExecutionProviderType());
+
+    graph_utils::RemoveNodeOutputEdges(graph, cdist_node);
+    graph.RemoveNode(cdist_node.Index());
+    graph_utils::RemoveNodeOutputEdges(graph, topk_node);
+    graph.RemoveNode(topk_node.Index());
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class NearestNeighborsFusion
+
+Fuses a float CDist followed by a TopK of the smallest distances into a single NearestNeighbors node, which finds
+the nearest rows without materializing the distance matrix.
+
+  Q    X                          Q    X
+  |    |                          |    |
+  CDist               ==>         NearestNeighbors
+    |                               |        |
+  TopK(k, largest=0)              Values   Indices
+   |       |
+ Values  Indices
+
+The TopK must be over the last axis with sorted output and a constant k. The CDist output must have no other
+consumers and must not be a graph output.
+*/
+class NearestNeighborsFusion : public GraphTransformer {
+ public:
+  NearestNeighborsFusion(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("NearestNeighborsFusion", compatible_execution_providers) {
+  }
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -1,7 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
+#include <optional>
 #include "core/graph/graph_utils.h"
 #include "core/optimizer/initializer.h"
 #include "core/optimizer/nhwc_transformer.h"
@@ -14,6 +17,74 @@ using namespace onnx_layout_transformation;
 
 namespace onnxruntime {
 
+namespace {
+
+// Returns the rank of the first input of the node if it is a float tensor of known rank of at least 3.
+std::optional<size_t> GetFloatImageRank(const api::GraphRef& graph, const api::NodeRef& node) {
+  auto info = graph.GetValueInfo(node.Inputs()[0]);
+  auto shape = info->Shape();
+  if (info->DType() != api::DataType::FLOAT || !shape || shape->size() < 3) {
+    return std::nullopt;
+  }
+  return shape->size();
+}
+
+// Replaces a BatchNormalization with constant parameters by Mul(X, scale / sqrt(var + epsilon)) and
+// Add(.., B - mean * scale / sqrt(var + epsilon)) with [C, 1, ..., 1] constants, which transposes are pushed through.
+bool DecomposeBatchNormalization(api::GraphRef& graph, api::NodeRef& node, size_t rank) {
+  auto inputs = node.Inputs();
+  auto outputs = node.Outputs();
+  if (inputs.size() != 5 || node.GetAttributeIntDefault("training_mode", 0) != 0 ||
+      std::any_of(outputs.begin() + 1, outputs.end(), [](std::string_view output) { return output != ""; })) {
+    return false;
+  }
+
+  std::vector<float> params[4];
+  for (size_t i = 0; i < 4; ++i) {
+    auto constant = graph.GetConstant(inputs[i + 1]);
+    if (constant == nullptr || constant->DType() != api::DataType::FLOAT) {
+      return false;
+    }
+    std::vector<uint8_t> data = constant->Data();
+    params[i].resize(constant->NumElements());
+    memcpy(params[i].data(), data.data(), data.size());
+  }
+
+  const size_t channels = params[0].size();
+  if (params[1].size() != channels || params[2].size() != channels || params[3].size() != channels) {
+    return false;
+  }
+
+  float epsilon = 1e-5f;
+  const auto* epsilon_attr = graph_utils::GetNodeAttribute(NodeFromApiNode(node), "epsilon");
+  if (epsilon_attr != nullptr) {
+    epsilon = epsilon_attr->f();
+  }
+
+  std::vector<uint8_t> scale_data(channels * sizeof(float));
+  std::vector<uint8_t> bias_data(channels * sizeof(float));
+  float* scale = reinterpret_cast<float*>(scale_data.data());
+  float* bias = reinterpret_cast<float*>(bias_data.data());
+  for (size_t c = 0; c < channels; ++c) {
+    scale[c] = params[0][c] / std::sqrt(params[3][c] + epsilon);
+    bias[c] = params[1][c] - params[2][c] * scale[c];
+  }
+
+  std::vector<int64_t> shape(rank - 1, 1);
+  shape[0] = static_cast<int64_t>(channels);
+  std::string_view scale_name = graph.AddInitializer(api::DataType::FLOAT, shape, scale_data);
+  std::string_view bias_name = graph.AddInitializer(api::DataType::FLOAT, shape, bias_data);
+
+  auto mul = graph.AddNode("Mul", {inputs[0], scale_name}, 1);
+  auto add = graph.AddNode("Add", {mul->Outputs()[0], bias_name}, 1);
+  graph.CopyValueInfo(outputs[0], mul->Outputs()[0]);
+  graph.MoveOutput(node, 0, *add, 0);
+  graph.RemoveNode(node);
+  return true;
+}
+
+}  // namespace
+
 Status NhwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const {
 #if defined(ORT_MINIMAL_BUILD)
   // update the producer/consumer info as previous optimizations may have invalidated it.
@@ -30,12 +101,48 @@ Status NhwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level,
   auto api_graph = MakeApiGraph(graph, cpu_allocator_, kCpuExecutionProvider);
 
   modified = false;
+  size_t converted_count = 0;
   for (std::unique_ptr<api::NodeRef>& node : api_graph->Nodes()) {
     // If the node is not supported in the CPU EP, skip it
     if (node->GetExecutionProviderType() != kCpuExecutionProvider) {
       continue;
     }
 
+    if (float_layout_) {
+      const bool is_conv = node->IsOp("Conv");
+      const bool is_fused_conv = node->IsOp("FusedConv", kMSDomain);
+      if (is_conv || is_fused_conv || node->IsOp("BatchNormalization")) {
+        std::optional<size_t> rank = GetFloatImageRank(*api_graph, *node);
+        if (rank == std::nullopt) {
+          continue;
+        }
+
+        if (!is_conv && !is_fused_conv) {
+          if (DecomposeBatchNormalization(*api_graph, *node, *rank)) {
+            ++converted_count;
+            modified = true;
+          }
+          continue;
+        }
+
+        // Transpose X, and Z of FusedConv which is added to the output.
+        std::vector<int64_t> input_perm = ChannelFirstToLastPerm(*rank);
+        std::vector<int64_t> output_perm = ChannelLastToFirstPerm(*rank);
+        auto inputs = node->Inputs();
+        std::vector<const std::vector<int64_t>*> input_perms(inputs.size(), nullptr);
+        input_perms[0] = &input_perm;
+        if (inputs.size() > 3 && inputs[3] != "") {
+          input_perms[3] = &input_perm;
+        }
+        WrapTransposesAroundNode(*api_graph, *node, input_perms, {&output_perm});
+        SwapNodeOpTypeDomainAndSinceVersion(*api_graph, *node, is_conv ? "NhwcConv" : "NhwcFusedConv", kMSDomain, 1);
+
+        ++converted_count;
+        modified = true;
+        continue;
+      }
+    }
+
     // Only QLinearConv needs to be handled explicitly. The rest will be transformed if needed during transpose
     // optimization.
     if (node->OpType() == "QLinearConv") {
@@ -69,12 +176,22 @@ Status NhwcTransformer::ApplyImpl(Graph& graph, bool& modified, int graph_level,
         SwapNodeOpTypeDomainAndSinceVersion(*api_graph, *node, "QLinearConv", kMSDomain, 1);
       }
 
+      ++converted_count;
       modified = true;
     }
   }
 
   if (modified) {
-    Optimize(*api_graph, /*allow_extended_ops*/ true, kCpuExecutionProvider);
+    Optimize(*api_graph, /*allow_extended_ops*/ true, kCpuExecutionProvider, OptimizerMode::OPTIMIZE_TRANSPOSE,
+             /*layout_sensitive_ops*/ {}, /*nhwc_float_layout*/ float_layout_);
+
+    const auto nodes = api_graph->Nodes();
+    const auto transpose_count = std::count_if(nodes.begin(), nodes.end(),
+                                               [](const std::unique_ptr<api::NodeRef>& n) {
+                                                 return n->IsOp("Transpose");
+                                               });
+    LOGS(logger, INFO) << "NhwcTransformer converted " << converted_count << " nodes to NHWC, leaving "
+                       << transpose_count << " Transpose nodes in the graph";
   }
 
   return Status::OK();
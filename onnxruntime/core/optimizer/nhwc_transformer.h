@@ -14,14 +14,19 @@ namespace onnxruntime {
 
 Transformer that optimizes the graph by using NHWC nodes instead of NCHW nodes
 and inserts nodes to transpose tensors as needed.
+
+QLinearConv is always converted. With float_layout, float Conv and FusedConv are converted to NhwcConv and
+NhwcFusedConv and BatchNormalization with constant parameters is decomposed into a channel wise Mul and Add, so
+that a float CNN runs in NHWC between a transpose at its inputs and one at its outputs.
 */
 class NhwcTransformer : public GraphTransformer {
  private:
   AllocatorPtr cpu_allocator_;
+  bool float_layout_;
 
  public:
-  explicit NhwcTransformer(AllocatorPtr cpu_allocator) noexcept
-    : GraphTransformer("NhwcTransformer"), cpu_allocator_(std::move(cpu_allocator)){};
+  explicit NhwcTransformer(AllocatorPtr cpu_allocator, bool float_layout = false) noexcept
+    : GraphTransformer("NhwcTransformer"), cpu_allocator_(std::move(cpu_allocator)), float_layout_(float_layout){};
 
  private:
   Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
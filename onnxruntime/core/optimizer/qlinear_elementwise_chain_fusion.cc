@@ -0,0 +1,254 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/qlinear_elementwise_chain_fusion.h"
+
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/initializer.h"
+#include "core/optimizer/utils.h"
+
+#include <optional>
+
+using namespace ONNX_NAMESPACE;
+using namespace ::onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// One node of a chain, with the quantization parameters the fused kernel needs to rebuild its lookup table.
+struct ChainLink {
+  Node* node;
+  int input_index;  // index of the input that continues the chain
+  int32_t elem_type;
+  float scales[3];         // input, operand, output
+  int64_t zero_points[3];  // input, operand, output
+  int64_t operand{0};
+  float alpha{0.0f};
+};
+
+bool GetFloatScalar(const Graph& graph, const Node& node, int index, float& value) {
+  const auto& input_defs = node.InputDefs();
+  if (static_cast<size_t>(index) >= input_defs.size() || !input_defs[index]->Exists() ||
+      !optimizer_utils::IsScalar(*input_defs[index])) {
+    return false;
+  }
+
+  const auto* tensor_proto = graph_utils::GetConstantInitializer(graph, input_defs[index]->Name());
+  if (tensor_proto == nullptr || tensor_proto->data_type() != TensorProto_DataType_FLOAT) {
+    return false;
+  }
+
+  Initializer initializer{*tensor_proto, graph.ModelPath()};
+  value = *initializer.data<float>();
+  return true;
+}
+
+// A missing optional input is treated as 0, which is what the kernels default zero points to.
+bool GetQuantizedScalar(const Graph& graph, const Node& node, int index, int32_t elem_type, bool optional,
+                        int64_t& value) {
+  const auto& input_defs = node.InputDefs();
+  if (static_cast<size_t>(index) >= input_defs.size() || !input_defs[index]->Exists()) {
+    value = 0;
+    return optional;
+  }
+
+  if (!optimizer_utils::IsScalar(*input_defs[index])) {
+    return false;
+  }
+
+  const auto* tensor_proto = graph_utils::GetConstantInitializer(graph, input_defs[index]->Name());
+  if (tensor_proto == nullptr || tensor_proto->data_type() != elem_type) {
+    return false;
+  }
+
+  Initializer initializer{*tensor_proto, graph.ModelPath()};
+  if (elem_type == TensorProto_DataType_UINT8) {
+    value = *initializer.data<uint8_t>();
+  } else {
+    value = *initializer.data<int8_t>();
+  }
+  return true;
+}
+
+std::optional<ChainLink> GetChainLink(const Graph& graph, Node& node,
+                                      const InlinedHashSet<std::string_view>& compatible_providers) {
+  const bool is_unary = graph_utils::IsSupportedOptypeVersionAndDomain(node, "QLinearLeakyRelu", {1}, kMSDomain) ||
+                        graph_utils::IsSupportedOptypeVersionAndDomain(node, "QLinearSigmoid", {1}, kMSDomain);
+  const bool is_binary = !is_unary &&
+                         (graph_utils::IsSupportedOptypeVersionAndDomain(node, "QLinearAdd", {1}, kMSDomain) ||
+                          graph_utils::IsSupportedOptypeVersionAndDomain(node, "QLinearMul", {1}, kMSDomain));
+  if ((!is_unary && !is_binary) || !graph_utils::IsSupportedProvider(node, compatible_providers)) {
+    return std::nullopt;
+  }
+
+  const auto* output_type = node.OutputDefs()[0]->TypeAsProto();
+  if (output_type == nullptr || !output_type->has_tensor_type()) {
+    return std::nullopt;
+  }
+
+  ChainLink link{};
+  link.node = &node;
+  link.elem_type = output_type->tensor_type().elem_type();
+  if (link.elem_type != TensorProto_DataType_UINT8 && link.elem_type != TensorProto_DataType_INT8) {
+    return std::nullopt;
+  }
+
+  if (is_unary) {
+    // X, X_scale, X_zero_point, Y_scale, Y_zero_point
+    link.input_index = 0;
+    link.scales[1] = 1.0f;
+    link.zero_points[1] = 0;
+    if (!GetFloatScalar(graph, node, 1, link.scales[0]) ||
+        !GetQuantizedScalar(graph, node, 2, link.elem_type, true, link.zero_points[0]) ||
+        !GetFloatScalar(graph, node, 3, link.scales[2]) ||
+        !GetQuantizedScalar(graph, node, 4, link.elem_type, true, link.zero_points[2])) {
+      return std::nullopt;
+    }
+    if (node.OpType() == "QLinearLeakyRelu") {
+      link.alpha = graph_utils::GetNodeAttribute(node, "alpha") != nullptr
+                       ? graph_utils::GetNodeAttribute(node, "alpha")->f()
+                       : 0.01f;
+    }
+    return link;
+  }
+
+  // A, A_scale, A_zero_point, B, B_scale, B_zero_point, C_scale, C_zero_point.
+  // One of A and B must be a constant scalar, the other one continues the chain.
+  const auto& input_defs = node.InputDefs();
+  int operand_index;
+  if (graph_utils::IsConstantInitializer(graph, input_defs[3]->Name()) && optimizer_utils::IsScalar(*input_defs[3])) {
+    operand_index = 3;
+    link.input_index = 0;
+  } else if (graph_utils::IsConstantInitializer(graph, input_defs[0]->Name()) &&
+             optimizer_utils::IsScalar(*input_defs[0])) {
+    operand_index = 0;
+    link.input_index = 3;
+  } else {
+    return std::nullopt;
+  }
+
+  // A [1] shaped operand broadcasts a scalar input to [1]. Only fuse when that cannot change the output shape.
+  const auto* operand_shape = input_defs[operand_index]->Shape();
+  if (operand_shape != nullptr && operand_shape->dim_size() == 1) {
+    const auto* input_shape = input_defs[link.input_index]->Shape();
+    if (input_shape == nullptr || input_shape->dim_size() == 0) {
+      return std::nullopt;
+    }
+  }
+
+  if (!GetFloatScalar(graph, node, link.input_index + 1, link.scales[0]) ||
+      !GetQuantizedScalar(graph, node, link.input_index + 2, link.elem_type, true, link.zero_points[0]) ||
+      !GetQuantizedScalar(graph, node, operand_index, link.elem_type, false, link.operand) ||
+      !GetFloatScalar(graph, node, operand_index + 1, link.scales[1]) ||
+      !GetQuantizedScalar(graph, node, operand_index + 2, link.elem_type, true, link.zero_points[1]) ||
+      !GetFloatScalar(graph, node, 6, link.scales[2]) ||
+      !GetQuantizedScalar(graph, node, 7, link.elem_type, true, link.zero_points[2])) {
+    return std::nullopt;
+  }
+
+  return link;
+}
+
+// Returns the node consuming the output of link if it continues the chain.
+std::optional<ChainLink> GetNextChainLink(Graph& graph, const ChainLink& link,
+                                          const InlinedHashSet<std::string_view>& compatible_providers) {
+  const Node& node = *link.node;
+  if (node.GetOutputEdgesCount() != 1 || graph.NodeProducesGraphOutput(node)) {
+    return std::nullopt;
+  }
+
+  const auto edge = node.OutputEdgesBegin();
+  Node& next_node = *graph.GetNode(edge->GetNode().Index());
+  auto next_link = GetChainLink(graph, next_node, compatible_providers);
+  if (!next_link.has_value() ||
+      next_link->input_index != edge->GetDstArgIndex() ||
+      next_link->elem_type != link.elem_type ||
+      // Make sure the nodes do not span execution providers.
+      next_node.GetExecutionProviderType() != node.GetExecutionProviderType()) {
+    return std::nullopt;
+  }
+
+  return next_link;
+}
+
+}  // namespace
+
+Status QLinearElementwiseChainFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                                const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+  InlinedVector<std::reference_wrapper<Node>> nodes_to_remove;
+  InlinedHashSet<NodeIndex> fused_nodes;
+
+  for (auto node_index : node_topology_list) {
+    auto* node_ptr = graph.GetNode(node_index);
+    if (nullptr == node_ptr)
+      continue;  // node was removed
+
+    auto& node = *node_ptr;
+
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level, logger));
+
+    // the nodes are visited in topological order, so a chain is found from its first node
+    if (fused_nodes.count(node_index) != 0) {
+      continue;
+    }
+
+    auto link = GetChainLink(graph, node, GetCompatibleExecutionProviders());
+    if (!link.has_value()) {
+      continue;
+    }
+
+    InlinedVector<ChainLink> chain{*link};
+    while (auto next_link = GetNextChainLink(graph, chain.back(), GetCompatibleExecutionProviders())) {
+      chain.push_back(*next_link);
+    }
+
+    if (chain.size() < 2) {
+      continue;
+    }
+
+    std::vector<std::string> ops;
+    std::vector<float> scales;
+    std::vector<int64_t> zero_points;
+    std::vector<int64_t> operands;
+    std::vector<float> alphas;
+    for (const auto& chain_link : chain) {
+      ops.push_back(chain_link.node->OpType());
+      scales.insert(scales.end(), std::begin(chain_link.scales), std::end(chain_link.scales));
+      zero_points.insert(zero_points.end(), std::begin(chain_link.zero_points), std::end(chain_link.zero_points));
+      operands.push_back(chain_link.operand);
+      alphas.push_back(chain_link.alpha);
+      fused_nodes.insert(chain_link.node->Index());
+      nodes_to_remove.push_back(*chain_link.node);
+    }
+
+    Node& first_node = *chain.front().node;
+    Node& last_node = *chain.back().node;
+    Node& fused_node = graph.AddNode(graph.GenerateNodeName("QLinearElementwiseChain"),
+                                     "QLinearElementwiseChain",
+                                     "fused chain of quantized element-wise operators",
+                                     {first_node.MutableInputDefs()[chain.front().input_index]},
+                                     {last_node.MutableOutputDefs()[0]},
+                                     nullptr,
+                                     kMSDomain);
+    fused_node.AddAttribute("ops", ops);
+    fused_node.AddAttribute("scales", scales);
+    fused_node.AddAttribute("zero_points", zero_points);
+    fused_node.AddAttribute("operands", operands);
+    fused_node.AddAttribute("alphas", alphas);
+
+    // Assign provider to this new node. Provider should be same as the provider for old nodes.
+    fused_node.SetExecutionProviderType(first_node.GetExecutionProviderType());
+  }
+
+  modified = modified || !nodes_to_remove.empty();
+
+  for (const auto& node : nodes_to_remove) {
+    graph_utils::RemoveNodeOutputEdges(graph, node);
+    graph.RemoveNode(node.get().Index());
+  }
+
+  return Status::OK();
+}
+}  // namespace onnxruntime
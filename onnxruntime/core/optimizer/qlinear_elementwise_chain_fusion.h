@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class QLinearElementwiseChainFusion
+
+Fuses chains of quantized element-wise operators into a single QLinearElementwiseChain node.
+
+A chain link is a QLinearLeakyRelu or QLinearSigmoid node, or a QLinearAdd or QLinearMul node whose other operand
+is a constant scalar. All scales and zero points must be constant scalars. Every link maps each quantized input
+value to exactly one quantized output value, so the fused kernel composes the links into one lookup table and
+requantizes once per element instead of once per node.
+
+  X --> QLinearAdd(c) --> QLinearLeakyRelu --> QLinearSigmoid --> Y   ==>   X --> QLinearElementwiseChain --> Y
+
+The intermediate outputs must have no other consumers and must not be graph outputs.
+*/
+class QLinearElementwiseChainFusion : public GraphTransformer {
+ public:
+  QLinearElementwiseChainFusion(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("QLinearElementwiseChainFusion", compatible_execution_providers) {
+  }
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
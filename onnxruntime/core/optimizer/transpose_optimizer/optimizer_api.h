@@ -472,12 +472,16 @@ struct OptimizeResult {
 /// <param name="layout_sensitive_ops">List of ops which are treated as layout sensitive by the ONNX standard
 /// as well as any runtime specific ops. These ops should be provided when mode is set to OPTIMIZE_LAYOUT_TRANSFORM.
 /// If these ops are not provided, transpose optimizer may convert the layout for these ops </param>
+/// <param name="nhwc_float_layout">Whether float pooling ops on the CPU EP can be converted to their NHWC contrib
+/// variants (MaxPool, AveragePool) or to reductions over the spatial axes (GlobalAveragePool, GlobalMaxPool).
+/// Requires allow_extended_ops.</param>
 /// <returns>OptimizeResult. If error_msg is set the Optimize failed. If not set, graph_modified indicates whether
 /// any changes were required during optimization.</returns>
 OptimizeResult Optimize(api::GraphRef& graph, bool allow_extended_ops,
                         const std::string& provider_type = "",
                         OptimizerMode mode = OptimizerMode::OPTIMIZE_TRANSPOSE,
-                        const std::unordered_set<std::string_view>& layout_sensitive_ops = {});
+                        const std::unordered_set<std::string_view>& layout_sensitive_ops = {},
+                        bool nhwc_float_layout = false);
 
 /* Layout Transformation Tools
  * These methods help change the channel ordering of layout sensitive ops (like Conv). ONNX currently only supports
@@ -20,6 +20,7 @@ struct OptimizerCtx {
   const std::string provider_type;
   OptimizerMode mode;
   std::unordered_set<std::string_view> layout_sensitive_ops;
+  bool nhwc_float_layout;
 };
 
 // Each op handler points to a (potentially shared) function for determining which input indices are eligible for
@@ -1586,7 +1587,8 @@ static bool HandleQLinearPoolOp(HandlerArgs& args) {
 constexpr HandlerInfo q_linear_pool_op_handler = {&FirstInput, &HandleQLinearPoolOp};
 
 static bool HandleMaxPool(HandlerArgs& args) {
-  // For CPU EP replace with NhwcMaxPool if possible. Only int8 and uint8 dtypes are supported by NhwcMaxPool.
+  // For CPU EP replace with NhwcMaxPool if possible. Only int8 and uint8 dtypes are supported by NhwcMaxPool, and
+  // float when the float NHWC layout is enabled.
   if (args.node.GetExecutionProviderType() != "CPUExecutionProvider") {
     return false;
   }
@@ -1599,7 +1601,8 @@ static bool HandleMaxPool(HandlerArgs& args) {
 
   auto info = args.ctx.graph.GetValueInfo(outputs[0]);
   api::DataType dtype = info->DType();
-  if (dtype != api::DataType::UINT8 && dtype != api::DataType::INT8) {
+  if (dtype != api::DataType::UINT8 && dtype != api::DataType::INT8 &&
+      !(dtype == api::DataType::FLOAT && args.ctx.nhwc_float_layout)) {
     return false;
   }
 
@@ -1617,6 +1620,79 @@ static bool HandleMaxPool(HandlerArgs& args) {
 
 constexpr HandlerInfo max_pool_op_handler = {&FirstInput, &HandleMaxPool};
 
+static bool HandleAveragePool(HandlerArgs& args) {
+  // For CPU EP replace float AveragePool with NhwcAveragePool when the float NHWC layout is enabled.
+  if (!args.ctx.nhwc_float_layout || args.node.GetExecutionProviderType() != "CPUExecutionProvider") {
+    return false;
+  }
+
+  auto info = args.ctx.graph.GetValueInfo(args.node.Outputs()[0]);
+  if (info->DType() != api::DataType::FLOAT) {
+    return false;
+  }
+
+  // NhwcAveragePool has no dilations.
+  std::optional<std::vector<int64_t>> dilations = args.node.GetAttributeInts("dilations");
+  if (dilations != std::nullopt &&
+      std::any_of(dilations->begin(), dilations->end(), [](int64_t d) { return d != 1; })) {
+    return false;
+  }
+
+  size_t rank = args.perm.size();
+  if (args.perm != ChannelLastToFirstPerm(rank)) {
+    return false;
+  }
+
+  auto new_node = SwapNodeOpTypeDomainAndSinceVersion(args.ctx.graph, args.node, "NhwcAveragePool", "com.microsoft",
+                                                      1);
+  new_node->ClearAttribute("dilations");
+  TransposeFirstInput(args.ctx, *new_node, args.perm_inv);
+  TransposeOutputs(args.ctx, *new_node, args.perm);
+  return true;
+}
+
+constexpr HandlerInfo average_pool_op_handler = {&FirstInput, &HandleAveragePool};
+
+static bool HandleGlobalPool(HandlerArgs& args) {
+  // A global pool over channels last data is a reduction over the spatial axes, which the reduce handler then
+  // pushes the transpose through. Only done when the float NHWC layout is enabled.
+  if (!args.ctx.nhwc_float_layout) {
+    return false;
+  }
+
+  auto info = args.ctx.graph.GetValueInfo(args.node.Outputs()[0]);
+  if (info->DType() != api::DataType::FLOAT) {
+    return false;
+  }
+
+  size_t rank = args.perm.size();
+  if (rank < 3 || args.perm != ChannelLastToFirstPerm(rank)) {
+    return false;
+  }
+
+  int64_t opset = args.ctx.opset;
+  std::unique_ptr<api::NodeRef> new_node;
+  if (args.node.OpType() == "GlobalAveragePool") {
+    int since_version = opset >= 13 ? 13 : (opset >= 11 ? 11 : 1);
+    new_node = SwapNodeOpTypeDomainAndSinceVersion(args.ctx.graph, args.node, "ReduceMean", "", since_version);
+  } else {
+    int since_version = opset >= 13 ? 13 : (opset >= 12 ? 12 : (opset >= 11 ? 11 : 1));
+    new_node = SwapNodeOpTypeDomainAndSinceVersion(args.ctx.graph, args.node, "ReduceMax", "", since_version);
+  }
+
+  std::vector<int64_t> axes;
+  for (size_t i = 2; i < rank; ++i) {
+    axes.push_back(static_cast<int64_t>(i));
+  }
+  new_node->SetAttributeInts("axes", axes);
+  new_node->SetAttributeInt("keepdims", 1);
+
+  HandlerArgs reduce_args{args.ctx, args.transpose, *new_node, args.perm, args.perm_inv, args.transposible_inputs};
+  return HandleReduceOp(reduce_args);
+}
+
+constexpr HandlerInfo global_pool_op_handler = {&FirstInput, &HandleGlobalPool};
+
 // TODO: check binary size of this and replace it with constexpr if large
 static const std::unordered_map<std::string_view, const HandlerInfo&> handler_map{
 
@@ -1737,12 +1813,16 @@ static const std::unordered_map<std::string_view, const HandlerInfo&> extended_h
     {"com.microsoft.QLinearReduceMean", reduce_op_handler},
     {"com.microsoft.QLinearSigmoid", node_1_inp_handler},
     {"com.microsoft.QLinearLeakyRelu", node_1_inp_handler},
+    {"com.microsoft.QLinearElementwiseChain", node_1_inp_handler},
     {"com.microsoft.QLinearConcat", q_linear_concat_handler},
     {"com.microsoft.QLinearAdd", q_linear_binary_op_handler},
     {"com.microsoft.QLinearMul", q_linear_binary_op_handler},
     {"com.microsoft.QLinearAveragePool", q_linear_pool_op_handler},
     {"com.microsoft.QLinearGlobalAveragePool", q_linear_pool_op_handler},
     {"MaxPool", max_pool_op_handler},
+    {"AveragePool", average_pool_op_handler},
+    {"GlobalAveragePool", global_pool_op_handler},
+    {"GlobalMaxPool", global_pool_op_handler},
 };
 
 static const HandlerInfo* GetHandler(api::NodeRef& node, bool allow_extended_ops) {
@@ -1778,6 +1858,14 @@ static bool CanNodeSkipCostCheck(const OptimizerCtx& ctx, const api::NodeRef& no
     // Inclusion of MaxPool is a hack because it has higher perf in the NHWC variant when supported.
     return true;
   }
+  if (ctx.nhwc_float_layout && node.IsOp("AveragePool")) {
+    // Same as MaxPool for the float NHWC variant.
+    return true;
+  }
+  if (ctx.nhwc_float_layout && (node.IsOp("GlobalAveragePool") || node.IsOp("GlobalMaxPool"))) {
+    // The reduction over channels last data is as cheap and removes the transpose before it.
+    return true;
+  }
   if (node.IsOp("Resize")) {
     // Resize is included because it has higher perf in the NHWC variant when
     // the input X is 4D int8 tensor and the mode is linear
@@ -1848,7 +1936,7 @@ bool ProcessTranspose(OptimizerCtx& ctx, api::NodeRef& transpose, api::NodeRef&
 std::optional<OptimizerCtx> MakeOptimizerContext(api::GraphRef& graph, bool allow_extended_ops,
                                                  const std::string& provider_type, OptimizerMode mode,
                                                  const std::unordered_set<std::string_view>& layout_sensitive_ops,
-                                                 std::string& error_msg) {
+                                                 bool nhwc_float_layout, std::string& error_msg) {
   auto opset = graph.Opset("");
   if (opset == std::nullopt) {
     opset = graph.Opset("ai.onnx");
@@ -1873,7 +1961,8 @@ std::optional<OptimizerCtx> MakeOptimizerContext(api::GraphRef& graph, bool allo
   // during layout transformation we want to push the transposes as far out as possible.
   // it is important that the EP gets the entire graph in the layout it prefers.
   bool skip_cost_check = mode == OptimizerMode::OPTIMIZE_LAYOUT_TRANSFORM;
-  OptimizerCtx ctx{*opset, graph, allow_extended_ops, skip_cost_check, provider_type, mode, layout_sensitive_ops};
+  OptimizerCtx ctx{*opset, graph, allow_extended_ops, skip_cost_check, provider_type, mode, layout_sensitive_ops,
+                   nhwc_float_layout && allow_extended_ops};
   return ctx;
 }
 
@@ -2042,11 +2131,13 @@ const std::unordered_set<std::string_view>& GetLayoutSensitiveOps() {
 
 OptimizeResult Optimize(api::GraphRef& graph, bool allow_extended_ops,
                         const std::string& provider_type, OptimizerMode mode,
-                        const std::unordered_set<std::string_view>& layout_sensitive_ops) {
+                        const std::unordered_set<std::string_view>& layout_sensitive_ops,
+                        bool nhwc_float_layout) {
   OptimizeResult result{};
 
   std::string error_msg;
-  auto ctx = MakeOptimizerContext(graph, allow_extended_ops, provider_type, mode, layout_sensitive_ops, error_msg);
+  auto ctx = MakeOptimizerContext(graph, allow_extended_ops, provider_type, mode, layout_sensitive_ops,
+                                  nhwc_float_layout, error_msg);
   if (ctx == std::nullopt) {
     if (!error_msg.empty()) {
       result.error_msg = error_msg;
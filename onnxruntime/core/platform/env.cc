@@ -15,12 +15,87 @@ limitations under the License.
 // Portions Copyright (c) Microsoft Corporation
 
 #include "core/platform/env.h"
+
+#include <cctype>
+#include <limits>
+#include <string_view>
+
 #include "gsl/gsl"
 
 namespace onnxruntime {
 
 Env::Env() = default;
 
+namespace {
+
+// No machine has anywhere near this many processors or NUMA nodes, so longer ranges are malformed.
+constexpr size_t kMaxSysfsRangeLength = size_t{1} << 20;
+
+// Parses `str` as a decimal id. Returns false if it is empty, isn't a number or overflows.
+bool ParseSysfsId(std::string_view str, size_t& id) {
+  if (str.empty()) {
+    return false;
+  }
+  id = 0;
+  for (char c : str) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    const size_t digit = static_cast<size_t>(c - '0');
+    if (id > (std::numeric_limits<size_t>::max() - digit) / 10) {
+      return false;
+    }
+    id = id * 10 + digit;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::vector<size_t> ParseSysfsList(const std::string& list) {
+  // sysfs lists end with a newline when read with a plain read(), so ignore surrounding whitespace.
+  std::string_view remaining{list};
+  while (!remaining.empty() && std::isspace(static_cast<unsigned char>(remaining.back()))) {
+    remaining.remove_suffix(1);
+  }
+
+  std::vector<size_t> ids;
+  while (!remaining.empty()) {
+    const size_t comma = remaining.find(',');
+    std::string_view range = remaining.substr(0, comma);
+    remaining = comma == std::string_view::npos ? std::string_view{} : remaining.substr(comma + 1);
+
+    const size_t dash = range.find('-');
+    size_t first = 0;
+    size_t last = 0;
+    if (!ParseSysfsId(range.substr(0, dash), first)) {
+      continue;
+    }
+    if (dash == std::string_view::npos) {
+      last = first;
+    } else if (!ParseSysfsId(range.substr(dash + 1), last) || last < first ||
+               last - first >= kMaxSysfsRangeLength) {
+      continue;
+    }
+    for (size_t id = first;; ++id) {
+      ids.push_back(id);
+      if (id == last) {
+        break;
+      }
+    }
+  }
+  return ids;
+}
+
+std::vector<size_t> GetNumaNodeAffinity(const std::vector<size_t>& node_cpus, size_t num_threads) {
+  ORT_ENFORCE(!node_cpus.empty(), "The NUMA node has no logical processors.");
+  std::vector<size_t> affinity(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    affinity[i] = node_cpus[i % node_cpus.size()];
+  }
+  return affinity;
+}
+
 }  // namespace onnxruntime
 
 // This definition is provided to handle GSL failures in CUDA as
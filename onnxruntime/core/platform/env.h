@@ -79,6 +79,14 @@ struct ThreadOptions {
   void* custom_thread_creation_options = nullptr;
   OrtCustomJoinThreadFn custom_join_thread_fn = nullptr;
   int dynamic_block_base_ = 0;
+
+  // If true, each thread tunes how long it spins waiting for work from the gaps it observed between pieces of work,
+  // instead of spinning for a fixed count. Only has an effect on thread pools that allow spinning.
+  bool adaptive_spinning = false;
+
+  // If true, each thread counts the tasks it runs and the time it spends running them, spinning and blocked, as
+  // returned by ThreadPool::GetWorkerStats. Always on with adaptive spinning, which needs the same timings.
+  bool collect_worker_stats = false;
 };
 /// \brief An interface used by the onnxruntime implementation to
 /// access operating system functionality like the filesystem etc.
@@ -122,6 +130,23 @@ class Env {
   // This function doesn't support systems with more than 64 logical processors
   virtual std::vector<size_t> GetThreadAffinityMasks() const = 0;
 
+  // Returns the logical processor ids that belong to each NUMA node, indexed by node id.
+  // Node ids that are not online have an empty entry. An empty result means the platform
+  // doesn't expose its NUMA topology and the machine should be treated as a single node.
+  virtual std::vector<std::vector<size_t>> GetNumaNodeProcessors() const {
+    return {};
+  }
+
+  // Sets the memory policy of the pages fully contained in [addr, addr + size) so that they are
+  // preferably placed on the given NUMA node, regardless of which thread touches them first.
+  // It is a no-op on platforms without NUMA memory policy support.
+  virtual common::Status BindMemoryToNumaNode(void* addr, size_t size, int numa_node) const {
+    ORT_UNUSED_PARAMETER(addr);
+    ORT_UNUSED_PARAMETER(size);
+    ORT_UNUSED_PARAMETER(numa_node);
+    return common::Status::OK();
+  }
+
   /// \brief Returns the number of micro-seconds since the Unix epoch.
   virtual uint64_t NowMicros() const {
     return env_time_->NowMicros();
@@ -253,4 +278,12 @@ class Env {
   EnvTime* env_time_ = EnvTime::Default();
 };
 
+// Parses a Linux sysfs list such as "0-3,8,10-11" into the ids it contains.
+// Empty, malformed and reversed ranges are skipped.
+std::vector<size_t> ParseSysfsList(const std::string& list);
+
+// Returns the logical processor of each of the `num_threads` threads of a pool bound to a NUMA node.
+// The threads cycle through the processors of the node when there are more threads than processors.
+std::vector<size_t> GetNumaNodeAffinity(const std::vector<size_t>& node_cpus, size_t num_threads);
+
 }  // namespace onnxruntime
@@ -19,6 +19,7 @@ limitations under the License.
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <fcntl.h>
 #include <stdlib.h>
@@ -27,10 +28,14 @@ limitations under the License.
 #include <dlfcn.h>
 #include <ftw.h>
 #include <string.h>
+#include <fstream>
 #include <thread>
 #include <utility>  // for std::forward
 #include <vector>
 #include <assert.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 
 #include "core/common/common.h"
 #include "core/common/logging/logging.h"
@@ -128,6 +133,16 @@ struct Freer {
 
 using MallocdStringPtr = std::unique_ptr<char, Freer<char> >;
 
+// Reads the first line of a sysfs file. Returns an empty string if the file doesn't exist.
+std::string ReadSysfsLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  if (file) {
+    std::getline(file, line);
+  }
+  return line;
+}
+
 class PosixThread : public EnvThread {
  private:
   struct Param {
@@ -245,6 +260,52 @@ class PosixEnv : public Env {
     return ret;
   }
 
+  std::vector<std::vector<size_t>> GetNumaNodeProcessors() const override {
+    std::vector<std::vector<size_t>> nodes;
+#if defined(__linux__) && !defined(__ANDROID__)
+    const std::vector<size_t> online_nodes = ParseSysfsList(ReadSysfsLine("/sys/devices/system/node/online"));
+    for (size_t node : online_nodes) {
+      if (node >= nodes.size()) {
+        nodes.resize(node + 1);
+      }
+      nodes[node] = ParseSysfsList(
+          ReadSysfsLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+    }
+#endif
+    return nodes;
+  }
+
+  common::Status BindMemoryToNumaNode(void* addr, size_t size, int numa_node) const override {
+    ORT_RETURN_IF_NOT(numa_node >= 0, "Invalid NUMA node: ", numa_node);
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    // mbind() works on whole pages, so only the pages fully inside the range are affected.
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + page_size - 1) & ~(page_size - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size) & ~(page_size - 1);
+    if (end <= begin) {
+      return Status::OK();
+    }
+
+    // Values from <linux/mempolicy.h>. MPOL_PREFERRED falls back to other nodes instead of failing
+    // allocations when the requested node runs out of memory.
+    constexpr int kMpolPreferred = 1;
+    constexpr unsigned int kMpolMfMove = 1 << 1;
+    constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;
+    const size_t node = static_cast<size_t>(numa_node);
+    std::vector<unsigned long> node_mask(node / kBitsPerMask + 1, 0);
+    node_mask[node / kBitsPerMask] |= 1UL << (node % kBitsPerMask);
+    if (syscall(SYS_mbind, begin, end - begin, kMpolPreferred, node_mask.data(),
+                node_mask.size() * kBitsPerMask + 1, kMpolMfMove) != 0) {
+      auto [err_no, err_msg] = GetSystemError();
+      return ORT_MAKE_STATUS(SYSTEM, err_no, "mbind failed for NUMA node ", numa_node, ": ", err_msg);
+    }
+#else
+    ORT_UNUSED_PARAMETER(addr);
+    ORT_UNUSED_PARAMETER(size);
+#endif
+    return Status::OK();
+  }
+
   void SleepForMicroseconds(int64_t micros) const override {
     while (micros > 0) {
       timespec sleep_time;
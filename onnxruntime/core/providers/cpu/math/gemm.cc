@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/gemm.h"
+#include "core/common/cancellation_token.h"
 #include "core/providers/cpu/math/gemm_matmul_common.h"
 #include "core/util/math_cpuonly.h"
 #include "gemm_helper.h"
@@ -193,6 +194,60 @@ Status Gemm<float>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>& prep
   return Status::OK();
 }
 
+template <typename T>
+Status Gemm<T>::PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                          concurrency::ThreadPool* /*thread_pool*/,
+                                          /*out*/ bool& is_precomputed) {
+  is_precomputed = false;
+
+  const TensorShape& a_shape = *input_shapes[0];
+  const TensorShape& b_shape = *input_shapes[1];
+  const TensorShape* c_shape = input_shapes.size() > 2 ? input_shapes[2] : nullptr;
+
+  // leave invalid or empty inputs to Compute so it reports the same errors with or without the precomputed state
+  if ((a_shape.NumDimensions() != 1 && a_shape.NumDimensions() != 2) || b_shape.NumDimensions() != 2 ||
+      a_shape.Size() <= 0 || b_shape.Size() <= 0) {
+    return Status::OK();
+  }
+
+  GemmHelper helper(a_shape, trans_A_ != CblasNoTrans, b_shape, trans_B_ != CblasNoTrans,
+                    c_shape != nullptr ? *c_shape : TensorShape({}));
+  if (!helper.State().IsOK()) {
+    return Status::OK();
+  }
+
+  static_shapes_ = StaticShapes{a_shape, b_shape,
+                                c_shape != nullptr ? std::optional<TensorShape>(*c_shape) : std::nullopt,
+                                helper.M(), helper.N(), helper.K()};
+  is_precomputed = true;
+  return Status::OK();
+}
+
+template <typename T>
+Status Gemm<T>::ComputeGemmSizes(const TensorShape& a_shape, const TensorShape& b_shape, const TensorShape* c_shape,
+                                 int64_t& M, int64_t& N, int64_t& K) const {
+  if (static_shapes_.has_value() && static_shapes_->a_shape == a_shape && static_shapes_->b_shape == b_shape &&
+      static_shapes_->c_shape.has_value() == (c_shape != nullptr) &&
+      (c_shape == nullptr || *static_shapes_->c_shape == *c_shape)) {
+    M = static_shapes_->M;
+    N = static_shapes_->N;
+    K = static_shapes_->K;
+    return Status::OK();
+  }
+
+  // Bias could be missing. Treat as scalar 0 if that is the case.
+  GemmHelper helper(a_shape, trans_A_ != CblasNoTrans, b_shape, trans_B_ != CblasNoTrans,
+                    c_shape != nullptr ? *c_shape : TensorShape({}));
+
+  if (!helper.State().IsOK())
+    return helper.State();
+
+  M = helper.M();
+  N = helper.N();
+  K = helper.K();
+  return Status::OK();
+}
+
 template <typename T>
 void Gemm<T>::ComputeActivation(T* y_data, size_t y_size, concurrency::ThreadPool* thread_pool) const {
   if (activation_) {
@@ -217,16 +272,8 @@ Status Gemm<T>::Compute(OpKernelContext* context) const {
   const auto* B = context->Input<Tensor>(1);
   const auto* C = context->Input<Tensor>(2);
 
-  // Bias could be missing. Treat as scalar 0 if that is the case.
-  GemmHelper helper(A->Shape(), trans_A_ != CblasNoTrans, B->Shape(), trans_B_ != CblasNoTrans,
-                    C != nullptr ? C->Shape() : TensorShape({}));
-
-  if (!helper.State().IsOK())
-    return helper.State();
-
-  int64_t M = helper.M();
-  int64_t N = helper.N();
-  int64_t K = helper.K();
+  int64_t M, N, K;
+  ORT_RETURN_IF_ERROR(ComputeGemmSizes(A->Shape(), B->Shape(), C != nullptr ? &C->Shape() : nullptr, M, N, K));
 
   auto Y = context->Output(0, {M, N});
 
@@ -254,16 +301,9 @@ Status Gemm<float>::Compute(OpKernelContext* context) const {
   const auto* B = packed_b_ ? nullptr : context->Input<Tensor>(1);
   const auto* C = context->Input<Tensor>(2);
 
-  // Bias could be missing. Treat as scalar 0 if that is the case.
-  GemmHelper helper(A->Shape(), trans_A_ != CblasNoTrans, B ? B->Shape() : b_shape_, trans_B_ != CblasNoTrans,
-                    C != nullptr ? C->Shape() : TensorShape({}));
-
-  if (!helper.State().IsOK())
-    return helper.State();
-
-  int64_t M = helper.M();
-  int64_t N = helper.N();
-  int64_t K = helper.K();
+  int64_t M, N, K;
+  ORT_RETURN_IF_ERROR(ComputeGemmSizes(A->Shape(), B ? B->Shape() : b_shape_, C != nullptr ? &C->Shape() : nullptr,
+                                       M, N, K));
 
   auto Y = context->Output(0, {M, N});
 
@@ -276,6 +316,8 @@ Status Gemm<float>::Compute(OpKernelContext* context) const {
   const float* c_data = C != nullptr ? C->Data<float>() : nullptr;
   const TensorShape* c_shape = C != nullptr ? &C->Shape() : nullptr;
 
+  // The output is only written by the GEMM and the activation, so they can stop early when the run is cancelled.
+  CancellationToken::CancellableLoopsScope cancellable_loops;
   if (B) {
     ComputeGemm(trans_A_, trans_B_, M, N, K, alpha_, A->Data<float>(), B->Data<float>(), beta_,
                 c_data, c_shape, y_data, thread_pool);
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "gemm_base.h"
 
 #include "core/framework/op_kernel.h"
@@ -28,6 +30,10 @@ class Gemm : protected GemmBase, public OpKernel {
                                    int input_idx,
                                    /*out*/ bool& used_shared_buffers) override;
 
+  Status PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                   concurrency::ThreadPool* thread_pool,
+                                   /*out*/ bool& is_precomputed) override;
+
   static void ComputeGemm(CBLAS_TRANSPOSE trans_a, CBLAS_TRANSPOSE trans_b,
                           int64_t M, int64_t N, int64_t K,
                           float alpha,
@@ -44,7 +50,21 @@ class Gemm : protected GemmBase, public OpKernel {
   // For fused gemm + activation
   std::unique_ptr<functors::ElementWiseRangedTransform<T>> activation_;
 
+  // Sizes of the product for static input shapes, see PrecomputeForStaticShapes
+  struct StaticShapes {
+    TensorShape a_shape;
+    TensorShape b_shape;
+    std::optional<TensorShape> c_shape;
+    int64_t M;
+    int64_t N;
+    int64_t K;
+  };
+  std::optional<StaticShapes> static_shapes_;
+
   void ComputeActivation(T* y_data, size_t y_size, concurrency::ThreadPool* thread_pool) const;
+
+  Status ComputeGemmSizes(const TensorShape& a_shape, const TensorShape& b_shape, const TensorShape* c_shape,
+                          int64_t& M, int64_t& N, int64_t& K) const;
 };
 
 }  // namespace onnxruntime
@@ -119,6 +119,26 @@ Status Softmax<T>::ComputeImpl(const Tensor& input, Tensor& output, size_t axis,
   return SoftmaxCPU<T>(N, D, input.Data<T>(), output.MutableData<T>(), log_softmax_, thread_pool);
 }
 
+namespace {
+// The permutation that swaps the innermost dim with the dim corresponding to axis, and the shape of the
+// input transposed with it.
+void GetAxisTranspose(const TensorShape& X_shape, size_t axis,
+                      InlinedVector<size_t>& permutation, TensorShape& transposed_shape) {
+  const size_t rank = X_shape.NumDimensions();
+  permutation.resize(rank);
+  std::iota(std::begin(permutation), std::end(permutation), 0);
+  permutation[axis] = rank - 1;
+  permutation[rank - 1] = axis;
+
+  TensorShapeVector transposed_input_dims;
+  transposed_input_dims.reserve(rank);
+  for (auto e : permutation) {
+    transposed_input_dims.push_back(X_shape[e]);
+  }
+  transposed_shape = TensorShape(transposed_input_dims);
+}
+}  // namespace
+
 // opset-13 and above
 template <typename T>
 Status Softmax<T>::ComputeImplOpset13(const Tensor& input, Tensor& output, size_t axis,
@@ -126,64 +146,73 @@ Status Softmax<T>::ComputeImplOpset13(const Tensor& input, Tensor& output, size_
   const auto& X_shape = input.Shape();
   size_t rank = X_shape.NumDimensions();
 
-  bool is_transpose_required = false;
-  Tensor transposed_input;
-  std::vector<int64_t> transposed_input_dims;
-  Tensor intermediate_output;  // output that the softmax implementation will write into while using transposed input
-  std::vector<size_t> permutation(rank);
-
   // The "semantic" meaning of axis has changed in opset-13.
   // Please compare: https://github.com/onnx/onnx/blob/main/docs/Operators.md#Softmax
   // with https://github.com/onnx/onnx/blob/main/docs/Changelog.md#Softmax-11 for detailed explanations
   // To account for the opset-13 behavior, our plan will be to transpose the "axis" dim to the innermost dim
   // and perform softmax and then reverse the transpose. We can skip the transposing aspect if the axis is already
   // the innermost dim
-  if (axis != (rank - 1)) {
-    is_transpose_required = true;
+  if (axis == (rank - 1)) {
+    return SoftmaxCPU<T>(X_shape.SizeToDimension(rank - 1), X_shape.SizeFromDimension(rank - 1),
+                         input.Data<T>(), output.MutableData<T>(), log_softmax_, thread_pool);
   }
 
-  if (is_transpose_required) {
-    AllocatorPtr alloc;
-    auto status = ctx->GetTempSpaceAllocator(&alloc);
-    if (!status.IsOK())
-      return status;
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
 
-    std::iota(std::begin(permutation), std::end(permutation), 0);
+  // use the transpose precomputed at session initialization if the input has the static shape
+  InlinedVector<size_t> computed_permutation;
+  TensorShape computed_transposed_shape;
+  const bool use_static_transpose = static_transpose_.has_value() && static_transpose_->input_shape == X_shape;
+  if (!use_static_transpose) {
+    GetAxisTranspose(X_shape, axis, computed_permutation, computed_transposed_shape);
+  }
+  gsl::span<const size_t> permutation = use_static_transpose ? static_transpose_->permutation : computed_permutation;
+  const TensorShape& transposed_shape =
+      use_static_transpose ? static_transpose_->transposed_shape : computed_transposed_shape;
 
-    // swap the innermost dim with the dim corresponding to axis
-    permutation[axis] = rank - 1;
-    permutation[rank - 1] = axis;
+  // Allocate a temporary tensor to hold transposed input
+  Tensor transposed_input(input.DataType(), transposed_shape, alloc);
 
-    transposed_input_dims.reserve(rank);
-    for (auto e : permutation) {
-      transposed_input_dims.push_back(X_shape[e]);
-    }
+  // Perform the transpose
+  ORT_RETURN_IF_ERROR(TransposeBase::DoTranspose(permutation, input, transposed_input));
 
-    // Allocate a temporary tensor to hold transposed input
-    Tensor temp_input(input.DataType(), TensorShape(transposed_input_dims), alloc);
+  // Allocate memory for the intermediate output that the softmax implementation will write into
+  Tensor intermediate_output(output.DataType(), transposed_shape, alloc);
 
-    // Perform the transpose
-    ORT_RETURN_IF_ERROR(TransposeBase::DoTranspose(permutation, input, temp_input));
-    transposed_input = std::move(temp_input);
+  const size_t N = transposed_shape.SizeToDimension(rank - 1);
+  const size_t D = transposed_shape.SizeFromDimension(rank - 1);
 
-    // Allocate memory for the intermediate output
-    Tensor temp_output(output.DataType(), TensorShape(transposed_input_dims), alloc);
-    intermediate_output = std::move(temp_output);
-  }
+  ORT_RETURN_IF_ERROR(SoftmaxCPU<T>(N, D, transposed_input.Data<T>(), intermediate_output.MutableData<T>(),
+                                    log_softmax_, thread_pool));
 
-  const size_t N = is_transpose_required ? TensorShape(transposed_input_dims).SizeToDimension(rank - 1) : X_shape.SizeToDimension(rank - 1);
-  const size_t D = is_transpose_required ? TensorShape(transposed_input_dims).SizeFromDimension(rank - 1) : X_shape.SizeFromDimension(rank - 1);
+  // Perform the transpose to get the axes back to the original ordering
+  return TransposeBase::DoTranspose(permutation, intermediate_output, output);
+}
 
-  ORT_RETURN_IF_ERROR(SoftmaxCPU<T>(N, D,
-                                    is_transpose_required ? transposed_input.Data<T>() : input.Data<T>(),
-                                    is_transpose_required ? intermediate_output.MutableData<T>() : output.MutableData<T>(),
-                                    log_softmax_, thread_pool));
+template <typename T>
+Status Softmax<T>::PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                             concurrency::ThreadPool* /*thread_pool*/,
+                                             /*out*/ bool& is_precomputed) {
+  is_precomputed = false;
+
+  // only the opset-13 implementation has shape dependent state worth precomputing
+  const TensorShape& X_shape = *input_shapes[0];
+  const auto rank = static_cast<int64_t>(X_shape.NumDimensions());
+  if (opset_ < 13 || X_shape.Size() == 0 || axis_ < -rank || axis_ >= rank) {
+    return Status::OK();
+  }
 
-  if (is_transpose_required) {
-    // Perform the transpose to get the axes back to the original ordering
-    ORT_RETURN_IF_ERROR(TransposeBase::DoTranspose(permutation, intermediate_output, output));
+  const size_t axis = static_cast<size_t>(HandleNegativeAxis(axis_, rank));
+  if (axis == static_cast<size_t>(rank - 1)) {
+    return Status::OK();
   }
 
+  StaticTranspose static_transpose;
+  static_transpose.input_shape = X_shape;
+  GetAxisTranspose(X_shape, axis, static_transpose.permutation, static_transpose.transposed_shape);
+  static_transpose_ = std::move(static_transpose);
+  is_precomputed = true;
   return Status::OK();
 }
 
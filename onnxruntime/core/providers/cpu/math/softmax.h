@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "gsl/gsl-lite.hpp"
 
 #include "core/common/common.h"
@@ -36,6 +38,10 @@ class Softmax final : public OpKernel {
 
   Status Compute(OpKernelContext* ctx) const override;
 
+  Status PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                   concurrency::ThreadPool* thread_pool,
+                                   /*out*/ bool& is_precomputed) override;
+
  private:
   Status ComputeImpl(const Tensor& input, Tensor& output, size_t axis,
                      concurrency::ThreadPool* thread_pool) const;
@@ -46,6 +52,14 @@ class Softmax final : public OpKernel {
   int axis_;
   int opset_;
   bool log_softmax_;
+
+  // Transpose of the axis to the innermost dim for a static input shape, see PrecomputeForStaticShapes
+  struct StaticTranspose {
+    TensorShape input_shape;
+    InlinedVector<size_t> permutation;
+    TensorShape transposed_shape;
+  };
+  std::optional<StaticTranspose> static_transpose_;
 };
 
 }  // namespace onnxruntime
@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/platform/threadpool.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace onnxruntime {
+namespace ml {
+namespace flat_lookup_details {
+
+inline uint64_t MixHash(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Hash and lookup argument type of the supported key types.
+// Keys compare with operator==, like std::unordered_map, so -0.0f and 0.0f are the same key and NaN never matches.
+template <typename TKey>
+struct KeyTraits;
+
+template <>
+struct KeyTraits<int64_t> {
+  using Arg = int64_t;
+  static uint64_t Hash(int64_t key) { return MixHash(static_cast<uint64_t>(key)); }
+};
+
+template <>
+struct KeyTraits<float> {
+  using Arg = float;
+  static uint64_t Hash(float key) {
+    // -0.0f == 0.0f so they need the same hash
+    if (key == 0.0f) {
+      key = 0.0f;
+    }
+    uint32_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return MixHash(bits);
+  }
+};
+
+template <>
+struct KeyTraits<std::string> {
+  using Arg = std::string_view;
+  static uint64_t Hash(std::string_view key) { return MixHash(std::hash<std::string_view>{}(key)); }
+};
+
+inline void Prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+  ORT_UNUSED_PARAMETER(p);
+#endif
+}
+
+}  // namespace flat_lookup_details
+
+// Read-only key to value mapping for the ML encoder kernels, built once when the kernel is created.
+//
+// Keys and values are stored in contiguous arrays. They are found through an open addressing table (linear probing,
+// at most half full) whose slots hold the index of the entry and the upper bits of its hash, so most mismatches are
+// rejected without touching the key. Lookup() processes the input in blocks: the hashes of a block are computed and
+// their slots prefetched before any of them is probed.
+template <typename TKey, typename TValue>
+class FlatLookupTable {
+  using Traits = flat_lookup_details::KeyTraits<TKey>;
+  using KeyArg = typename Traits::Arg;
+
+ public:
+  FlatLookupTable() : slots_(kMinSlots), mask_(kMinSlots - 1) {}
+
+  // Add a key, or replace the value of an existing key.
+  void InsertOrAssign(const TKey& key, const TValue& value) {
+    const uint64_t hash = Traits::Hash(key);
+    Slot& slot = FindSlot(key, hash);
+    if (slot.index != kEmpty) {
+      values_[slot.index] = value;
+      return;
+    }
+
+    ORT_ENFORCE(keys_.size() < kEmpty, "Too many entries in lookup table");
+    slot.index = static_cast<uint32_t>(keys_.size());
+    slot.tag = Tag(hash);
+    keys_.push_back(key);
+    values_.push_back(value);
+
+    if (keys_.size() * 2 > slots_.size()) {
+      Rehash(slots_.size() * 2);
+    }
+  }
+
+  size_t Size() const { return keys_.size(); }
+
+  // Returns the value of key or nullptr if the key is not in the table.
+  const TValue* Find(const KeyArg& key) const {
+    return Find(key, Traits::Hash(key));
+  }
+
+  // output[i] = value of input[i], or default_value if input[i] is not in the table.
+  template <typename TInput>
+  void Lookup(const TInput* input, size_t count, TValue* output, const TValue& default_value) const {
+    constexpr size_t kBlock = 16;
+    uint64_t hashes[kBlock];
+    for (size_t start = 0; start < count; start += kBlock) {
+      const size_t n = std::min(kBlock, count - start);
+      for (size_t i = 0; i < n; ++i) {
+        hashes[i] = Traits::Hash(input[start + i]);
+        flat_lookup_details::Prefetch(&slots_[hashes[i] & mask_]);
+      }
+      for (size_t i = 0; i < n; ++i) {
+        const TValue* value = Find(input[start + i], hashes[i]);
+        output[start + i] = value ? *value : default_value;
+      }
+    }
+  }
+
+  // Lookup() over a tensor, split across the thread pool when the input is large enough to benefit.
+  template <typename TInput>
+  void ParallelLookup(concurrency::ThreadPool* tp, const TInput* input, size_t count, TValue* output,
+                      const TValue& default_value) const {
+    // hashing a string is the dominant cost for string keys
+    const double compute_cycles = std::is_same<TKey, std::string>::value ? 64.0 : 16.0;
+    concurrency::ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(count),
+        TensorOpCost{static_cast<double>(sizeof(TInput)), static_cast<double>(sizeof(TValue)), compute_cycles},
+        [this, input, output, &default_value](std::ptrdiff_t first, std::ptrdiff_t last) {
+          Lookup(input + first, static_cast<size_t>(last - first), output + first, default_value);
+        });
+  }
+
+ private:
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kMinSlots = 8;
+
+  struct Slot {
+    uint32_t tag = 0;
+    uint32_t index = kEmpty;
+  };
+
+  static uint32_t Tag(uint64_t hash) { return static_cast<uint32_t>(hash >> 32); }
+
+  const TValue* Find(const KeyArg& key, uint64_t hash) const {
+    const uint32_t tag = Tag(hash);
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+      const Slot& slot = slots_[i];
+      if (slot.index == kEmpty) {
+        return nullptr;
+      }
+      if (slot.tag == tag && keys_[slot.index] == key) {
+        return &values_[slot.index];
+      }
+    }
+  }
+
+  // Returns the slot of key, or the empty slot where it should be inserted.
+  Slot& FindSlot(const TKey& key, uint64_t hash) {
+    const uint32_t tag = Tag(hash);
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+      Slot& slot = slots_[i];
+      if (slot.index == kEmpty || (slot.tag == tag && keys_[slot.index] == key)) {
+        return slot;
+      }
+    }
+  }
+
+  void Rehash(size_t num_slots) {
+    slots_.assign(num_slots, Slot{});
+    mask_ = num_slots - 1;
+    for (size_t index = 0; index < keys_.size(); ++index) {
+      const uint64_t hash = Traits::Hash(keys_[index]);
+      for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+        Slot& slot = slots_[i];
+        if (slot.index == kEmpty) {
+          slot.tag = Tag(hash);
+          slot.index = static_cast<uint32_t>(index);
+          break;
+        }
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;  // size is a power of 2
+  size_t mask_;
+  std::vector<TKey> keys_;
+  std::vector<TValue> values_;
+};
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -4,6 +4,8 @@
 #include "core/providers/cpu/ml/linearclassifier.h"
 #include "core/providers/cpu/math/gemm.h"
 
+#include <algorithm>
+
 namespace onnxruntime {
 namespace ml {
 
@@ -67,8 +69,12 @@ void LinearClassifier::ComputeImpl(const gsl::span<const float> input,
                                         scores_output_data.data(),
                                         threadpool);
 
-  float* score = scores_output_data.data();
-  float* end_scores = score + (num_batches * num_targets);  // we haven't added extra targets yet so iterate the original scores
+  // we haven't added extra targets yet so the scores are num_targets per row.
+  // the label of each row only depends on its scores so the rows are labelled in parallel.
+  const float* scores = scores_output_data.data();
+  const TensorOpCost label_cost{static_cast<double>(num_targets * sizeof(float)),
+                                static_cast<double>(sizeof(int64_t)),
+                                static_cast<double>(num_targets)};
 
   if (num_targets == 1) {
     if (using_strings_) {
@@ -77,39 +83,42 @@ void LinearClassifier::ComputeImpl(const gsl::span<const float> input,
       std::string positive_label = use_class_labels ? classlabels_strings_[1] : "1";
       std::string negative_label = use_class_labels ? classlabels_strings_[0] : "0";
 
-      while (score < end_scores) {
-        *y_out++ = (*score++ > 0) ? positive_label
-                                  : negative_label;
-      }
+      concurrency::ThreadPool::TryParallelFor(
+          threadpool, num_batches, label_cost,
+          [scores, y_out, &positive_label, &negative_label](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              y_out[i] = scores[i] > 0 ? positive_label : negative_label;
+            }
+          });
     } else {
       int64_t* y_out = labels_output.MutableData<int64_t>();
       bool use_class_labels = classlabels_ints_.size() == 2;
       int64_t positive_label = use_class_labels ? classlabels_ints_[1] : 1;
       int64_t negative_label = use_class_labels ? classlabels_ints_[0] : 0;
 
-      while (score < end_scores) {
-        *y_out++ = (*score++ > 0) ? positive_label
-                                  : negative_label;
-      }
+      concurrency::ThreadPool::TryParallelFor(
+          threadpool, num_batches, label_cost,
+          [scores, y_out, positive_label, negative_label](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              y_out[i] = scores[i] > 0 ? positive_label : negative_label;
+            }
+          });
     }
   } else {
-    for (int64_t i = 0; i < num_batches; ++i) {
-      int maxclass = 0;
-      float maxweight = *score++;
-
-      for (int j = 1; j < num_targets; ++j, ++score) {
-        if (*score > maxweight) {
-          maxweight = *score;
-          maxclass = j;
-        }
-      }
-
-      if (using_strings_) {
-        labels_output.MutableData<std::string>()[i] = classlabels_strings_[maxclass];
-      } else {
-        labels_output.MutableData<int64_t>()[i] = classlabels_ints_[maxclass];
-      }
-    }
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, num_batches, label_cost,
+        [this, scores, num_targets, &labels_output](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            const float* row_scores = scores + i * num_targets;
+            const auto maxclass = std::max_element(row_scores, row_scores + num_targets) - row_scores;
+
+            if (using_strings_) {
+              labels_output.MutableData<std::string>()[i] = classlabels_strings_[maxclass];
+            } else {
+              labels_output.MutableData<int64_t>()[i] = classlabels_ints_[maxclass];
+            }
+          }
+        });
   }
 
   if (post_transform != POST_EVAL_TRANSFORM::NONE || add_second_class) {
@@ -245,8 +245,10 @@ static inline void multiclass_probability(int64_t classcount,
 static constexpr float ml_sqrt2 = 1.41421356f;
 
 static inline float ComputeLogistic(float val) {
-  float v = 1 / (1 + std::exp(-std::abs(val)));
-  return (val < 0) ? (1 - v) : v;
+  // exp(val) / (1 + exp(val)) rather than 1 - logistic(-val) for negative values, so small probabilities keep
+  // their precision
+  float e = std::exp(-std::abs(val));
+  return (val < 0) ? (e / (1 + e)) : (1 / (1 + e));
 }
 
 static inline float ComputeProbit(float val) {
@@ -255,7 +257,7 @@ static inline float ComputeProbit(float val) {
 
 static inline float sigmoid_probability(float score, float proba, float probb) {
   float val = score * proba + probb;
-  return 1 - ComputeLogistic(val);  // ref: https://github.com/arnaudsj/libsvm/blob/eaaefac5ebd32d0e07902e1ae740e038eaaf0826/svm.cpp#L1818
+  return ComputeLogistic(-val);  // 1 - logistic(val), ref: https://github.com/arnaudsj/libsvm/blob/eaaefac5ebd32d0e07902e1ae740e038eaaf0826/svm.cpp#L1818
 }
 
 template <typename T>
@@ -384,8 +386,8 @@ static void write_scores(InlinedVector<T>& scores, POST_EVAL_TRANSFORM post_tran
 }
 
 // TODO: Update TreeEnsemble* ops to use this instead of write_scores if possible.
-//       Attempted to parallelize the calculations if the number of scores to process was large, but no clear benefit
-//       was seen from testing with the arbitrary values of 1000 scores per threads.
+// The transforms are split across the thread pool based on their cost, so small batches are still processed on the
+// calling thread. Pass a nullptr threadpool when calling this for a single batch from an already parallelized loop.
 template <typename T>
 void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in, int64_t batch_size,
                                    POST_EVAL_TRANSFORM post_transform,
@@ -404,17 +406,45 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
   T* s = scores.data();
   const T* s_end = s + static_cast<int32_t>(num_scores);
 
+  // cost of transforming one score
+  const auto score_cost = [](double compute_cycles) {
+    return TensorOpCost{static_cast<double>(sizeof(T)), static_cast<double>(sizeof(T)), compute_cycles};
+  };
+
+  const auto compute_probit = [s](std::ptrdiff_t first, std::ptrdiff_t last) {
+    for (std::ptrdiff_t i = first; i < last; ++i) {
+      s[i] = ComputeProbit(s[i]);
+    }
+  };
+
+  // apply transform_batch to each batch of scores in parallel
+  const auto for_each_batch = [s, batch_size, num_batches, threadpool](double compute_cycles_per_score,
+                                                                       auto transform_batch) {
+    const double bytes = static_cast<double>(batch_size * sizeof(T));
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, static_cast<int32_t>(num_batches),
+        TensorOpCost{bytes, bytes, compute_cycles_per_score * batch_size},
+        [s, batch_size, &transform_batch](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            gsl::span<T> scores_for_batch(s + i * batch_size, static_cast<size_t>(batch_size));
+            transform_batch(scores_for_batch);
+          }
+        });
+  };
+
   if (batch_size > 1) {
     switch (post_transform) {
       case POST_EVAL_TRANSFORM::PROBIT: {
-        while (s < s_end) {
-          *s = ComputeProbit(*s);
-          ++s;
-        }
+        concurrency::ThreadPool::TryParallelFor(threadpool, static_cast<int32_t>(num_scores), score_cost(40.0),
+                                                compute_probit);
         break;
       }
       case POST_EVAL_TRANSFORM::LOGISTIC: {
-        MlasComputeLogistic(s, s, scores.size());
+        concurrency::ThreadPool::TryParallelFor(threadpool, static_cast<int32_t>(num_scores), score_cost(4.0),
+                                                [s](std::ptrdiff_t first, std::ptrdiff_t last) {
+                                                  MlasComputeLogistic(s + first, s + first,
+                                                                      static_cast<size_t>(last - first));
+                                                });
         break;
       }
       case POST_EVAL_TRANSFORM::SOFTMAX: {
@@ -441,21 +471,13 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
         if (use_mlas) {
           MlasComputeSoftmax(s, s, num_batches, batch_size, false, threadpool);
         } else {
-          while (s < s_end) {
-            gsl::span<float> scores_for_batch(s, s + batch_size);
-            ComputeSoftmax(scores_for_batch);
-            s += batch_size;
-          }
+          for_each_batch(20.0, [](gsl::span<T>& scores_for_batch) { ComputeSoftmax(scores_for_batch); });
         }
 
         break;
       }
       case POST_EVAL_TRANSFORM::SOFTMAX_ZERO: {
-        while (s < s_end) {
-          gsl::span<float> scores_for_batch(s, s + batch_size);
-          ComputeSoftmaxZero(scores_for_batch);
-          s += batch_size;
-        }
+        for_each_batch(20.0, [](gsl::span<T>& scores_for_batch) { ComputeSoftmaxZero(scores_for_batch); });
         break;
       }
       case POST_EVAL_TRANSFORM::NONE:
@@ -464,15 +486,14 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
     }
   } else {  // binary case
     if (post_transform == POST_EVAL_TRANSFORM::PROBIT) {
-      while (s < s_end) {
-        *s = ComputeProbit(*s);
-        ++s;
-      }
+      concurrency::ThreadPool::TryParallelFor(threadpool, static_cast<int32_t>(num_scores), score_cost(40.0),
+                                              compute_probit);
     } else if (add_second_class >= 0) {
       // in this case we have a buffer that holds 2x scores. the actual scores are at the start of the buffer,
       // and for each score we need 2 entries.
       // process the scores from the back to the front so we don't need a separate buffer.
       std::function<void(const float score, float* output)> update_scores;
+      bool logistic_of_expanded_scores = false;
 
       switch (add_second_class) {
         case 0:
@@ -486,10 +507,21 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
         case 2:  //2 = mixed weights, winning class is positive
         case 3:  //3 = mixed weights, winning class is negative
           if (post_transform == POST_EVAL_TRANSFORM::LOGISTIC) {
-            update_scores = [](const float score, float* output) {
-              *output++ = ComputeLogistic(-score);
-              *output = ComputeLogistic(score);
-            };
+            if (!have_space_for_second_class) {
+              // expand to (-score, score) pairs, then compute the logistic of the whole buffer at once.
+              // logistic(-score) is used rather than 1 - logistic(score), which loses the precision of
+              // small probabilities.
+              logistic_of_expanded_scores = true;
+              update_scores = [](const float score, float* output) {
+                *output++ = -score;
+                *output = score;
+              };
+            } else {
+              update_scores = [](const float score, float* output) {
+                *output++ = ComputeLogistic(-score);
+                *output = ComputeLogistic(score);
+              };
+            }
           } else {
             update_scores = [](const float score, float* output) {
               *output++ = -score;
@@ -518,6 +550,10 @@ void batched_update_scores_inplace(gsl::span<T> scores, int64_t num_batches_in,
           cur_out -= 2;
           update_scores(*cur_in, cur_out);
         }
+
+        if (logistic_of_expanded_scores) {
+          MlasComputeLogistic(scores.data(), scores.data(), scores.size());
+        }
       }
     }
   }
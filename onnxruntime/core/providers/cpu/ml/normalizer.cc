@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include "gsl/gsl"
+#include "core/platform/threadpool.h"
 
 /*
 ONNX_OPERATOR_SCHEMA(Normalizer)
@@ -43,7 +44,7 @@ ONNX_CPU_OPERATOR_ML_KERNEL(
     Normalizer);
 
 template <typename T>
-void NormalizeMax(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
+static void NormalizeMax(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
   for (int b = 0; b < num_batches; ++b) {
     float max = std::numeric_limits<float>::lowest();
 
@@ -89,7 +90,7 @@ static void NormalizeL1(const T* in, float* out, int64_t num_batches, int64_t ba
 }
 
 template <typename T>
-void NormalizeL2(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
+static void NormalizeL2(const T* in, float* out, int64_t num_batches, int64_t batch_size) {
   for (int b = 0; b < num_batches; ++b) {
     float sum = 0.f;
 
@@ -137,17 +138,18 @@ Status Normalizer::Normalize(OpKernelContext* context) const {
   const T* input = X.Data<T>();
   float* output = Y->MutableData<float>();
 
+  void (*normalize)(const T*, float*, int64_t, int64_t) = nullptr;
   switch (normalization_) {
     case NORMALIZE::NMAX: {
-      NormalizeMax(input, output, num_batches, batch_size);
+      normalize = NormalizeMax<T>;
       break;
     }
     case NORMALIZE::L1: {
-      NormalizeL1(input, output, num_batches, batch_size);
+      normalize = NormalizeL1<T>;
       break;
     }
     case NORMALIZE::L2: {
-      NormalizeL2(input, output, num_batches, batch_size);
+      normalize = NormalizeL2<T>;
       break;
     }
     default: {
@@ -155,6 +157,15 @@ Status Normalizer::Normalize(OpKernelContext* context) const {
     }
   }
 
+  // rows are normalized independently so split them across the thread pool
+  concurrency::ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), num_batches,
+      TensorOpCost{static_cast<double>(batch_size * sizeof(T)), static_cast<double>(batch_size * sizeof(float)),
+                   static_cast<double>(batch_size * 3)},
+      [normalize, input, output, batch_size](std::ptrdiff_t first, std::ptrdiff_t last) {
+        normalize(input + first * batch_size, output + first * batch_size, last - first, batch_size);
+      });
+
   return Status::OK();
 }
 
@@ -39,28 +39,29 @@ class SVMCommon {
     assert(a.size() == size_t(m * k) && b.size() == size_t(k * n) && out.size() == size_t(m * n));
 
     if (kernel_type_ == KERNEL::RBF) {
-      T* cur_out = out.data();
-      const T* cur_batch = a.data();
-
-      // each batch has 'k' features
-      for (int64_t batch = 0; batch < m; ++batch) {
-        const T* cur_support_vector = b.data();
-
-        // broadcast the support vectors against the k features in each batch. output is one value per support vector
-        for (int64_t support_vector = 0; support_vector < n; ++support_vector) {
-          T sum = 0.f;
-          const T* cur_input = cur_batch;
-
-          for (int64_t feature = 0; feature < k; ++feature) {
-            T val = *cur_input++ - *cur_support_vector++;
-            sum += val * val;
-          }
-
-          *cur_out++ = std::exp(-gamma_ * sum);
-        }
-
-        cur_batch += k;  // move to start of next batch
-      }
+      // The squared distances are computed directly instead of as |a|^2 - 2 * a.b + |b|^2 with a GEMM.
+      // The expanded form loses too much precision with the unscaled features classic ML models are often given.
+      const double row_cost = static_cast<double>(n * k * 3);
+      concurrency::ThreadPool::TryParallelFor(
+          threadpool, m,
+          TensorOpCost{static_cast<double>(k * sizeof(T)), static_cast<double>(n * sizeof(T)), row_cost},
+          [this, &a, &b, &out, n, k](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t batch = first; batch < last; ++batch) {
+              // each batch has 'k' features
+              ConstEigenVectorArrayMap<T> cur_batch(a.data() + batch * k, k);
+              T* cur_out = out.data() + batch * n;
+
+              // broadcast the support vectors against the k features in the batch. output is one value per support
+              // vector
+              const T* cur_support_vector = b.data();
+              for (int64_t support_vector = 0; support_vector < n; ++support_vector, cur_support_vector += k) {
+                cur_out[support_vector] =
+                    -gamma_ * (cur_batch - ConstEigenVectorArrayMap<T>(cur_support_vector, k)).square().sum();
+              }
+
+              MlasComputeExp(cur_out, cur_out, static_cast<size_t>(n));
+            }
+          });
     } else {
       float alpha = 1.f;
       float beta = 1.f;
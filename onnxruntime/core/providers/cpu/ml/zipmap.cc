@@ -3,6 +3,9 @@
 
 #include "core/providers/cpu/ml/zipmap.h"
 #include "core/util/math_cpuonly.h"
+
+#include <algorithm>
+#include <numeric>
 /**
 https://github.com/onnx/onnx/blob/main/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(ZipMap)
@@ -42,6 +45,55 @@ ZipMapOp::ZipMapOp(const OpKernelInfo& info)
   ORT_ENFORCE(classlabels_strings_.empty() ^ classlabels_int64s_.empty(),
               "Must provide classlabels_strings or classlabels_int64s but not both.");
   using_strings_ = !classlabels_strings_.empty();
+
+  auto sort_labels = [this](const auto& classlabels) {
+    sorted_label_indices_.resize(classlabels.size());
+    std::iota(sorted_label_indices_.begin(), sorted_label_indices_.end(), size_t{0});
+    std::stable_sort(sorted_label_indices_.begin(), sorted_label_indices_.end(),
+                     [&classlabels](size_t a, size_t b) { return classlabels[a] < classlabels[b]; });
+
+    // keep the last index of each repeated label. the indices of equal labels are in ascending order.
+    std::vector<size_t> unique_indices;
+    for (size_t i = 0; i < sorted_label_indices_.size(); ++i) {
+      const size_t idx = sorted_label_indices_[i];
+      if (i + 1 < sorted_label_indices_.size() && classlabels[sorted_label_indices_[i + 1]] == classlabels[idx]) {
+        continue;
+      }
+      unique_indices.push_back(idx);
+    }
+    sorted_label_indices_ = std::move(unique_indices);
+  };
+
+  if (using_strings_) {
+    sort_labels(classlabels_strings_);
+  } else {
+    sort_labels(classlabels_int64s_);
+  }
+}
+
+template <typename TKey>
+void ZipMapOp::CreateMaps(const std::vector<TKey>& classlabels, const float* x_data, int64_t batch_size,
+                          int64_t features_per_batch, std::vector<std::map<TKey, float>>& maps,
+                          concurrency::ThreadPool* threadpool) const {
+  maps.resize(batch_size);
+
+  // the labels are inserted in ascending order at the end of each map so every insertion is O(1) without a search.
+  // the maps of the rows are independent so they are created in parallel.
+  concurrency::ThreadPool::TryParallelFor(
+      threadpool, batch_size,
+      TensorOpCost{static_cast<double>(features_per_batch * sizeof(float)),
+                   static_cast<double>(features_per_batch * (sizeof(TKey) + sizeof(float))),
+                   static_cast<double>(features_per_batch * 50)},
+      [this, &classlabels, x_data, features_per_batch, &maps](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t n = first; n < last; ++n) {
+          const float* row = x_data + n * features_per_batch;
+          std::map<TKey, float> map;
+          for (size_t idx : sorted_label_indices_) {
+            map.emplace_hint(map.end(), classlabels[idx], row[idx]);
+          }
+          maps[n] = std::move(map);
+        }
+      });
 }
 
 common::Status ZipMapOp::Compute(OpKernelContext* context) const {
@@ -77,17 +129,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     auto* y_data = context->Output<std::vector<std::map<std::string, float>>>(0);
     if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
 
-    //auto* y_data = Y->MutableData<std::vector<std::map<std::string, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int64_t n = 0; n < batch_size; n++) {
-      std::map<std::string, float> map1;
-      for (int64_t j = 0; j < features_per_batch; j++) {
-        map1[classlabels_strings_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map1);
-    }
+    CreateMaps(classlabels_strings_, x_data, batch_size, features_per_batch, *y_data,
+               context->GetOperatorThreadPool());
   } else {
     if (features_per_batch != static_cast<int64_t>(classlabels_int64s_.size())) {
       return Status(ONNXRUNTIME,
@@ -97,17 +140,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     }
     auto* y_data = context->Output<std::vector<std::map<std::int64_t, float>>>(0);
     if (y_data == nullptr) return Status(common::ONNXRUNTIME, common::FAIL, "input count mismatch");
-    //auto* y_data = Y->MutableData<std::vector<std::map<int64_t, float>>>();
-    y_data->resize(batch_size);
-    int64_t current_weight_0 = 0;
-    for (int n = 0; n < batch_size; n++) {
-      std::map<int64_t, float> map2;
-      for (int j = 0; j < features_per_batch; j++) {
-        map2[classlabels_int64s_[j]] = x_data[current_weight_0 + j];
-      }
-      current_weight_0 += features_per_batch;
-      (*y_data)[n] = std::move(map2);
-    }
+    CreateMaps(classlabels_int64s_, x_data, batch_size, features_per_batch, *y_data,
+               context->GetOperatorThreadPool());
   }
   return common::Status::OK();
 }
@@ -4,6 +4,9 @@
 #pragma once
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+#include <map>
 namespace onnxruntime {
 namespace ml {
 
@@ -13,9 +16,17 @@ class ZipMapOp final : public OpKernel {
   common::Status Compute(OpKernelContext* context) const override;
 
  private:
+  template <typename TKey>
+  void CreateMaps(const std::vector<TKey>& classlabels, const float* x_data, int64_t batch_size,
+                  int64_t features_per_batch, std::vector<std::map<TKey, float>>& maps,
+                  concurrency::ThreadPool* threadpool) const;
+
   bool using_strings_;
   std::vector<int64_t> classlabels_int64s_;
   std::vector<std::string> classlabels_strings_;
+  // index of each distinct class label in ascending order of the labels. the last index of a repeated label is used,
+  // as its value is the one that ends up in the map.
+  std::vector<size_t> sorted_label_indices_;
 };
 
 }  // namespace ml
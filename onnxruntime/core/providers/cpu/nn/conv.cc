@@ -152,37 +152,163 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
-Status Conv<float>::Compute(OpKernelContext* context) const {
-  size_t num_inputs = OpKernel::Node().InputDefs().size();
-  const Tensor* X = context->Input<Tensor>(0);
-  const Tensor* W = context->Input<Tensor>(1);
-  const Tensor* B = num_inputs >= 3 ? context->Input<Tensor>(2) : nullptr;
-  const Tensor* Sum = num_inputs >= 4 ? context->Input<Tensor>(3) : nullptr;
-  const int64_t N = X->Shape()[0];
-  const int64_t C = X->Shape()[1];
-  const int64_t M = W->Shape()[0];
-  ORT_RETURN_IF_ERROR(conv_attrs_.ValidateInputShape(X, W));
+namespace {
+
+// Check for the optional Conv/Sum fusion. Beta is set to the value the convolution accumulates into Y with.
+Status CopySumToOutput(const Tensor* Sum, Tensor& Y, float& Beta) {
+  Beta = 0.0f;
+  if (Sum != nullptr) {
+    const auto& sum_shape = Sum->Shape();
+    ORT_RETURN_IF_NOT(Y.Shape() == sum_shape, "output and sum shape must match");
+    // If the output was not allocated inplace with the sum tensor, then copy here.
+    const auto* sum_data = Sum->Data<float>();
+    auto* Ydata = Y.MutableData<float>();
+    if (Ydata != sum_data) {
+      memcpy(Ydata, sum_data, sum_shape.Size() * sizeof(float));
+    }
+    Beta = 1.0f;
+  }
+  return Status::OK();
+}
+
+Status RunMlasConv(OpKernelContext* context, const MLAS_CONV_PARAMETERS& Parameters, size_t WorkingBufferSize,
+                   const Tensor* X, const Tensor* W, const Tensor* B, Tensor* Y,
+                   concurrency::ThreadPool* thread_pool) {
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+  auto* working_data = WorkingBufferSize > 0 ? alloc->Alloc(SafeInt<size_t>(sizeof(float)) * WorkingBufferSize)
+                                             : nullptr;
+  BufferUniquePtr working_buffer(working_data, BufferDeleter(std::move(alloc)));
+
+  MlasConv(&Parameters,
+           X->Data<float>(),
+           W->Data<float>(),
+           B != nullptr ? B->Data<float>() : nullptr,
+           static_cast<float*>(working_buffer.get()),
+           Y->MutableData<float>(),
+           thread_pool);
+
+  return Status::OK();
+}
+
+}  // namespace
+
+Status Conv<float>::InferConvShapes(const TensorShape& X_shape, const TensorShape& W_shape,
+                                    TensorShapeVector& kernel_shape, ConvPadVector& pads,
+                                    TensorShapeVector& dilations, TensorShapeVector& strides,
+                                    TensorShapeVector& Y_dims) const {
+  ORT_RETURN_IF_ERROR(conv_attrs_.ValidateInputShape(X_shape, W_shape));
 
   // kernel_shape is an optional attribute and has to be inferred from W if not provided
-  TensorShapeVector kernel_shape;
-  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W->Shape(), kernel_shape));
+  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W_shape, kernel_shape));
 
-  ConvPadVector pads(conv_attrs_.pads);
+  pads.assign(conv_attrs_.pads.begin(), conv_attrs_.pads.end());
   if (pads.empty()) {
     pads.resize(kernel_shape.size() * 2, 0);
   }
-  TensorShapeVector dilations(conv_attrs_.dilations);
+  dilations.assign(conv_attrs_.dilations.begin(), conv_attrs_.dilations.end());
   if (dilations.empty()) {
     dilations.resize(kernel_shape.size(), 1);
   }
-  TensorShapeVector strides(conv_attrs_.strides);
+  strides.assign(conv_attrs_.strides.begin(), conv_attrs_.strides.end());
   if (strides.empty()) {
     strides.resize(kernel_shape.size(), 1);
   }
 
-  TensorShapeVector Y_dims({N, M});
+  Y_dims.assign({X_shape[0], W_shape[0]});
+  TensorShape input_shape = X_shape.Slice(2);
+  return conv_attrs_.InferPadsAndOutputShape(input_shape, kernel_shape, strides, dilations, pads, Y_dims);
+}
+
+Status Conv<float>::PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                              concurrency::ThreadPool* thread_pool,
+                                              /*out*/ bool& is_precomputed) {
+  is_precomputed = false;
+
+  const TensorShape& X_shape = *input_shapes[0];
+  const TensorShape& W_shape = *input_shapes[1];
+  const bool has_sum = input_shapes.size() >= 4 && input_shapes[3] != nullptr;
+
+  // invalid shapes are left to Compute to report
+  TensorShapeVector kernel_shape;
+  ConvPadVector pads;
+  TensorShapeVector dilations;
+  TensorShapeVector strides;
+  TensorShapeVector Y_dims;
+  if (X_shape.NumDimensions() < 3 || W_shape.NumDimensions() < 3 ||
+      !InferConvShapes(X_shape, W_shape, kernel_shape, pads, dilations, strides, Y_dims).IsOK()) {
+    return Status::OK();
+  }
+
+  const size_t kernel_rank = kernel_shape.size();
+  TensorShape Y_shape(Y_dims);
+  if (kernel_rank < 1 || kernel_rank > 3 || Y_shape.Size() <= 0) {
+    return Status::OK();
+  }
+
+  auto static_shape_conv = std::make_unique<StaticShapeConv>();
+  static_shape_conv->X_shape = X_shape;
+  static_shape_conv->W_shape = W_shape;
+  static_shape_conv->Y_shape = Y_shape;
+  static_shape_conv->has_sum = has_sum;
+  static_shape_conv->thread_pool = thread_pool;
+
+  const int64_t C = X_shape[1];
+  const int64_t M = W_shape[0];
+  MlasConvPrepare(&static_shape_conv->parameters,
+                  kernel_rank,
+                  static_cast<size_t>(X_shape[0]),
+                  static_cast<size_t>(conv_attrs_.group),
+                  static_cast<size_t>(C / conv_attrs_.group),
+                  X_shape.GetDims().data() + 2,
+                  kernel_shape.data(),
+                  dilations.data(),
+                  pads.data(),
+                  strides.data(),
+                  Y_shape.GetDims().data() + 2,
+                  static_cast<size_t>(M / conv_attrs_.group),
+                  &activation_,
+                  &static_shape_conv->working_buffer_size,
+                  has_sum ? 1.0f : 0.0f,
+                  thread_pool);
+
+  static_shape_conv_ = std::move(static_shape_conv);
+  is_precomputed = true;
+  return Status::OK();
+}
+
+Status Conv<float>::Compute(OpKernelContext* context) const {
+  size_t num_inputs = OpKernel::Node().InputDefs().size();
+  const Tensor* X = context->Input<Tensor>(0);
+  const Tensor* W = context->Input<Tensor>(1);
+  const Tensor* B = num_inputs >= 3 ? context->Input<Tensor>(2) : nullptr;
+  const Tensor* Sum = num_inputs >= 4 ? context->Input<Tensor>(3) : nullptr;
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+  float Beta;
+
+  // use the convolution prepared at session initialization if the inputs have the static shapes
+  const StaticShapeConv* static_shape_conv = static_shape_conv_.get();
+  if (static_shape_conv != nullptr &&
+      static_shape_conv->X_shape == X->Shape() && static_shape_conv->W_shape == W->Shape() &&
+      static_shape_conv->has_sum == (Sum != nullptr) && static_shape_conv->thread_pool == thread_pool) {
+    Tensor* Y = context->Output(0, static_shape_conv->Y_shape);
+    ORT_RETURN_IF_ERROR(CopySumToOutput(Sum, *Y, Beta));
+    return RunMlasConv(context, static_shape_conv->parameters, static_shape_conv->working_buffer_size,
+                       X, W, B, Y, thread_pool);
+  }
+
+  const int64_t N = X->Shape()[0];
+  const int64_t C = X->Shape()[1];
+  const int64_t M = W->Shape()[0];
+
+  TensorShapeVector kernel_shape;
+  ConvPadVector pads;
+  TensorShapeVector dilations;
+  TensorShapeVector strides;
+  TensorShapeVector Y_dims;
+  ORT_RETURN_IF_ERROR(InferConvShapes(X->Shape(), W->Shape(), kernel_shape, pads, dilations, strides, Y_dims));
   TensorShape input_shape = X->Shape().Slice(2);
-  ORT_RETURN_IF_ERROR(conv_attrs_.InferPadsAndOutputShape(input_shape, kernel_shape, strides, dilations, pads, Y_dims));
   Tensor* Y = context->Output(0, TensorShape(Y_dims));
   TensorShape output_shape = Y->Shape().Slice(2);
 
@@ -191,26 +317,8 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
     return Status::OK();
   }
 
-  AllocatorPtr alloc;
-  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
-
-  const auto* Xdata = X->Data<float>();
-  const auto* Bdata = B != nullptr ? B->Data<float>() : nullptr;
-  auto* Ydata = Y->MutableData<float>();
-  // Check for the optional Conv/Sum fusion.
-  float Beta = 0.0f;
-  if (Sum != nullptr) {
-    const auto& sum_shape = Sum->Shape();
-    ORT_RETURN_IF_NOT(Y->Shape() == sum_shape, "output and sum shape must match");
-    // If the output was not allocated inplace with the sum tensor, then copy here.
-    const auto* sum_data = Sum->Data<float>();
-    if (Ydata != sum_data) {
-      memcpy(Ydata, sum_data, sum_shape.Size() * sizeof(float));
-    }
-    Beta = 1.0f;
-  }
+  ORT_RETURN_IF_ERROR(CopySumToOutput(Sum, *Y, Beta));
   const size_t kernel_rank = kernel_shape.size();
-  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
 
   if (kernel_rank >= 1 && kernel_rank <= 3) {
     MLAS_CONV_PARAMETERS Parameters;
@@ -232,64 +340,61 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     Beta,
                     thread_pool);
 
-    auto* working_data = WorkingBufferSize > 0 ? alloc->Alloc(SafeInt<size_t>(sizeof(float)) * WorkingBufferSize)
-                                               : nullptr;
-    BufferUniquePtr working_buffer(working_data, BufferDeleter(std::move(alloc)));
-
-    MlasConv(&Parameters,
-             Xdata,
-             W->Data<float>(),
-             Bdata,
-             static_cast<float*>(working_buffer.get()),
-             Ydata,
-             thread_pool);
-  } else {
-    const int64_t input_image_size = input_shape.Size();
-    const int64_t output_image_size = output_shape.Size();
-    const int64_t kernel_size = TensorShape(kernel_shape).Size();
-    const int64_t X_offset = C / conv_attrs_.group * input_image_size;
-    const int64_t Y_offset = Y->Shape().Size() / Y->Shape()[0] / conv_attrs_.group;
-    const int64_t W_offset = W->Shape().Size() / conv_attrs_.group;
-    const int64_t kernel_dim = C / conv_attrs_.group * kernel_size;
-    const int64_t col_buffer_size = kernel_dim * output_image_size;
-
-    auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * col_buffer_size);
-    BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
-    auto* col_buffer_data = static_cast<float*>(col_buffer.get());
-
-    for (int image_id = 0; image_id < N; ++image_id) {
-      for (int group_id = 0; group_id < conv_attrs_.group; ++group_id) {
-        math::Im2col<float, StorageOrder::NCHW>()(
-            Xdata + group_id * X_offset,
-            input_shape.GetDims().data(),
-            output_shape.GetDims().data(),
-            kernel_dim,
-            kernel_shape.data(),
-            strides.data(),
-            dilations.data(),
-            pads.data(),
-            static_cast<int>(kernel_shape.size()),
-            col_buffer_data);
-
-        math::Gemm<float>(
-            CblasNoTrans,
-            CblasNoTrans,
-            M / conv_attrs_.group,
-            output_image_size,
-            kernel_dim,
-            1,
-            W->Data<float>() + group_id * W_offset,
-            col_buffer_data,
-            Beta,
-            Ydata + group_id * Y_offset,
-            thread_pool);
-      }
+    return RunMlasConv(context, Parameters, WorkingBufferSize, X, W, B, Y, thread_pool);
+  }
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
 
-      MlasActivation(&activation_, Ydata, Bdata, M, output_image_size, output_image_size);
+  const auto* Xdata = X->Data<float>();
+  const auto* Bdata = B != nullptr ? B->Data<float>() : nullptr;
+  auto* Ydata = Y->MutableData<float>();
 
-      Xdata += X_offset * conv_attrs_.group;
-      Ydata += Y_offset * conv_attrs_.group;
+  const int64_t input_image_size = input_shape.Size();
+  const int64_t output_image_size = output_shape.Size();
+  const int64_t kernel_size = TensorShape(kernel_shape).Size();
+  const int64_t X_offset = C / conv_attrs_.group * input_image_size;
+  const int64_t Y_offset = Y->Shape().Size() / Y->Shape()[0] / conv_attrs_.group;
+  const int64_t W_offset = W->Shape().Size() / conv_attrs_.group;
+  const int64_t kernel_dim = C / conv_attrs_.group * kernel_size;
+  const int64_t col_buffer_size = kernel_dim * output_image_size;
+
+  auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * col_buffer_size);
+  BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
+  auto* col_buffer_data = static_cast<float*>(col_buffer.get());
+
+  for (int image_id = 0; image_id < N; ++image_id) {
+    for (int group_id = 0; group_id < conv_attrs_.group; ++group_id) {
+      math::Im2col<float, StorageOrder::NCHW>()(
+          Xdata + group_id * X_offset,
+          input_shape.GetDims().data(),
+          output_shape.GetDims().data(),
+          kernel_dim,
+          kernel_shape.data(),
+          strides.data(),
+          dilations.data(),
+          pads.data(),
+          static_cast<int>(kernel_shape.size()),
+          col_buffer_data);
+
+      math::Gemm<float>(
+          CblasNoTrans,
+          CblasNoTrans,
+          M / conv_attrs_.group,
+          output_image_size,
+          kernel_dim,
+          1,
+          W->Data<float>() + group_id * W_offset,
+          col_buffer_data,
+          Beta,
+          Ydata + group_id * Y_offset,
+          thread_pool);
     }
+
+    MlasActivation(&activation_, Ydata, Bdata, M, output_image_size, output_image_size);
+
+    Xdata += X_offset * conv_attrs_.group;
+    Ydata += Y_offset * conv_attrs_.group;
   }
 
   return Status::OK();
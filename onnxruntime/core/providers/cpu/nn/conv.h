@@ -29,11 +29,33 @@ class Conv<float> : public OpKernel {
   }
 
   Status Compute(OpKernelContext* context) const override;
-  
+
+  Status PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                   concurrency::ThreadPool* thread_pool,
+                                   /*out*/ bool& is_precomputed) override;
+
  protected:
   MLAS_ACTIVATION activation_;
 
   ConvAttributes conv_attrs_;
+
+ private:
+  Status InferConvShapes(const TensorShape& X_shape, const TensorShape& W_shape,
+                         TensorShapeVector& kernel_shape, ConvAttributes::ConvPadVector& pads,
+                         TensorShapeVector& dilations, TensorShapeVector& strides,
+                         TensorShapeVector& Y_dims) const;
+
+  // MLAS convolution prepared for static input shapes, see PrecomputeForStaticShapes
+  struct StaticShapeConv {
+    TensorShape X_shape;
+    TensorShape W_shape;
+    TensorShape Y_shape;
+    bool has_sum;
+    concurrency::ThreadPool* thread_pool;
+    MLAS_CONV_PARAMETERS parameters;
+    size_t working_buffer_size;
+  };
+  std::unique_ptr<StaticShapeConv> static_shape_conv_;
 };
 
 }  // namespace onnxruntime
@@ -18,8 +18,25 @@ LayerNormImpl::LayerNormImpl(const OpKernelInfo& op_kernel_info, bool simplified
 }
 
 namespace {
+LayerNormImpl::NormShapes ComputeNormShapes(const TensorShape& x_shape, int64_t orig_axis) {
+  const int64_t axis = HandleNegativeAxis(orig_axis, x_shape.NumDimensions());
+
+  TensorShapeVector mean_inv_std_dev_dim;
+  mean_inv_std_dev_dim.reserve(x_shape.NumDimensions());
+  for (int i = 0; i < static_cast<int>(x_shape.NumDimensions()); ++i) {
+    if (i < axis) {
+      mean_inv_std_dev_dim.emplace_back(x_shape.GetDims()[i]);
+    } else {
+      mean_inv_std_dev_dim.emplace_back(1);
+    }
+  }
+
+  return {x_shape, x_shape.SizeToDimension(axis), x_shape.SizeFromDimension(axis), TensorShape(mean_inv_std_dev_dim)};
+}
+
 template <typename T, typename U>
-Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, bool simplified) {
+Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, bool simplified,
+                   const LayerNormImpl::NormShapes* static_shapes) {
   // Inputs
   const Tensor* X = p_ctx->Input<Tensor>(0);
   const Tensor* scale = p_ctx->Input<Tensor>(1);
@@ -29,9 +46,13 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
   auto bias_data = (simplified || nullptr == bias) ? nullptr : bias->Data<T>();
 
   const TensorShape& x_shape = X->Shape();
-  const int64_t axis = HandleNegativeAxis(orig_axis, x_shape.NumDimensions());
-  auto norm_count = x_shape.SizeToDimension(axis);
-  auto norm_size = x_shape.SizeFromDimension(axis);
+  std::optional<LayerNormImpl::NormShapes> computed_shapes;
+  if (static_shapes == nullptr || static_shapes->x_shape != x_shape) {
+    computed_shapes = ComputeNormShapes(x_shape, orig_axis);
+  }
+  const auto& norm_shapes = computed_shapes.has_value() ? *computed_shapes : *static_shapes;
+  const auto norm_count = norm_shapes.norm_count;
+  const auto norm_size = norm_shapes.norm_size;
 
   const auto scale_size = scale->Shape().Size();
   const auto bias_size = (bias_data) ? bias->Shape().Size() : 0;
@@ -45,16 +66,6 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
   Tensor* Y = p_ctx->Output(0, x_shape);
   auto Y_data = Y->MutableData<T>();
 
-  std::vector<int64_t> mean_inv_std_dev_dim;
-  mean_inv_std_dev_dim.reserve(x_shape.NumDimensions());
-  for (int i = 0; i < static_cast<int>(x_shape.NumDimensions()); ++i) {
-    if (i < axis) {
-      mean_inv_std_dev_dim.emplace_back(x_shape.GetDims()[i]);
-    } else {
-      mean_inv_std_dev_dim.emplace_back(1);
-    }
-  }
-
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(p_ctx->GetTempSpaceAllocator(&alloc));
 
@@ -62,14 +73,14 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
 
   U* mean_data = nullptr;
   if (!simplified) {
-    Tensor* mean = p_ctx->Output(output_index++, TensorShape(mean_inv_std_dev_dim));
+    Tensor* mean = p_ctx->Output(output_index++, norm_shapes.stats_shape);
     if (mean != nullptr) {
       mean_data = mean->MutableData<U>();
     }
   }
 
   U* inv_std_dev_data = nullptr;
-  Tensor* inv_std_dev = p_ctx->Output(output_index, TensorShape(mean_inv_std_dev_dim));
+  Tensor* inv_std_dev = p_ctx->Output(output_index, norm_shapes.stats_shape);
   if (inv_std_dev != nullptr) {
     inv_std_dev_data = inv_std_dev->MutableData<U>();
   }
@@ -121,18 +132,19 @@ Status ComputeImpl(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, boo
 
 template <typename T>
 struct SrcDispatcher {
-  Status operator()(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, bool simplified, bool contrib_op) const {
+  Status operator()(OpKernelContext* p_ctx, int64_t orig_axis, float epsilon, bool simplified, bool contrib_op,
+                    const LayerNormImpl::NormShapes* static_shapes) const {
     // the contrib op kernel was always registered with the same type for all constraints.
     // our implementation of the onnx op only supports 'float' as the U constraint.
 #if !defined(DISABLE_CONTRIB_OPS)
     if (contrib_op) {
-      return ComputeImpl<T, T>(p_ctx, orig_axis, epsilon, simplified);
+      return ComputeImpl<T, T>(p_ctx, orig_axis, epsilon, simplified, static_shapes);
     } else
 #else
     ORT_UNUSED_PARAMETER(contrib_op);
 #endif
     {
-      return ComputeImpl<T, float>(p_ctx, orig_axis, epsilon, simplified);
+      return ComputeImpl<T, float>(p_ctx, orig_axis, epsilon, simplified, static_shapes);
     }
   }
 };
@@ -144,7 +156,25 @@ Status LayerNormImpl::Compute(OpKernelContext* p_ctx) const {
   using SupportedTypeList = boost::mp11::mp_list<float, double>;
 
   utils::MLTypeCallDispatcherFromTypeList<SupportedTypeList> t_disp(elem_type);
-  return t_disp.InvokeRet<Status, SrcDispatcher>(p_ctx, axis_, epsilon_, simplified_, contrib_op_);
+  return t_disp.InvokeRet<Status, SrcDispatcher>(p_ctx, axis_, epsilon_, simplified_, contrib_op_,
+                                                 static_shapes_.has_value() ? &*static_shapes_ : nullptr);
+}
+
+Status LayerNormImpl::PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                                concurrency::ThreadPool* /*thread_pool*/,
+                                                /*out*/ bool& is_precomputed) {
+  is_precomputed = false;
+
+  // an invalid axis is left to Compute to report
+  const TensorShape& x_shape = *input_shapes[0];
+  const auto rank = static_cast<int64_t>(x_shape.NumDimensions());
+  if (axis_ < -rank || axis_ >= rank) {
+    return Status::OK();
+  }
+
+  static_shapes_ = ComputeNormShapes(x_shape, axis_);
+  is_precomputed = true;
+  return Status::OK();
 }
 
 }  // namespace onnxruntime
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensor.h"
@@ -14,11 +16,26 @@ class LayerNormImpl : public OpKernel {
   LayerNormImpl(const OpKernelInfo& op_kernel_info, bool simplified = false, bool contrib_op = false);
   Status Compute(OpKernelContext* p_op_kernel_context) const override;
 
+  Status PrecomputeForStaticShapes(gsl::span<const TensorShape* const> input_shapes,
+                                   concurrency::ThreadPool* thread_pool,
+                                   /*out*/ bool& is_precomputed) override;
+
+  // Normalization sizes for an input shape
+  struct NormShapes {
+    TensorShape x_shape;
+    int64_t norm_count;
+    int64_t norm_size;
+    TensorShape stats_shape;  // shape of the mean and inv_std_dev outputs
+  };
+
  private:
   int64_t axis_;
   float epsilon_;
   const bool simplified_;
   const bool contrib_op_;
+
+  // sizes for the static input shape, see PrecomputeForStaticShapes
+  std::optional<NormShapes> static_shapes_;
 };
 
 }  // namespace onnxruntime
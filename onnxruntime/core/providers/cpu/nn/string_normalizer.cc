@@ -3,6 +3,7 @@
 
 #include "string_normalizer.h"
 #include "core/common/common.h"
+#include "core/framework/packed_strings.h"
 #include "core/framework/tensor.h"
 
 #ifdef _MSC_VER
@@ -15,6 +16,7 @@
 #include <iconv.h>
 #endif  // _MSC_VER
 
+#include <algorithm>
 #include <locale>
 #include <functional>
 #include <unordered_set>
@@ -115,75 +117,89 @@ using Utf8Converter = std::wstring_convert<std::codecvt_utf8<wchar_t>>;
 #else
 
 // All others (Linux)
+// The iconv descriptors are opened once and re-used for all the strings converted by an instance.
 class Utf8Converter {
  public:
-  Utf8Converter(const std::string&, const std::wstring&) {}
+  Utf8Converter(const std::string&, const std::wstring&)
+      : from_utf8_(iconv_open("WCHAR_T", "UTF-8")),  // Order of arguments is to, from
+        to_utf8_(iconv_open("UTF-8", "WCHAR_T")) {
+  }
+
+  ~Utf8Converter() {
+    if (IsValid(from_utf8_)) {
+      iconv_close(from_utf8_);
+    }
+    if (IsValid(to_utf8_)) {
+      iconv_close(to_utf8_);
+    }
+  }
 
-  std::wstring from_bytes(const std::string& s) const {
-    std::wstring result;
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Utf8Converter);
+
+  // Converts s into wstr, re-using the capacity of wstr. Returns false if s could not be converted.
+  bool from_bytes(const std::string& s, std::wstring& wstr) const {
+    wstr.clear();
     if (s.empty()) {
-      return result;
+      return true;
     }
-    // Order of arguments is to, from
-    auto icvt = iconv_open("WCHAR_T", "UTF-8");
-    // CentOS is not happy with -1
-    if (std::numeric_limits<iconv_t>::max() == icvt) {
-      return wconv_error;
+    if (!IsValid(from_utf8_)) {
+      return false;
     }
 
-    char* iconv_in = const_cast<char*>(s.c_str());
+    // reset the conversion state
+    iconv(from_utf8_, nullptr, nullptr, nullptr, nullptr);
+    char* iconv_in = const_cast<char*>(s.data());
     size_t iconv_in_bytes = s.length();
-    // Temporary buffer assumes 1 byte to 1 wchar_t
-    // to make sure it is enough.
-    const size_t buffer_len = iconv_in_bytes * sizeof(wchar_t);
-    auto buffer = std::make_unique<char[]>(buffer_len);
-    char* iconv_out = buffer.get();
-    size_t iconv_out_bytes = buffer_len;
-    auto ret = iconv(icvt, &iconv_in, &iconv_in_bytes, &iconv_out, &iconv_out_bytes);
+    // Every byte converts to at most one wchar_t
+    wstr.resize(s.length());
+    char* iconv_out = reinterpret_cast<char*>(&wstr[0]);
+    size_t iconv_out_bytes = wstr.length() * sizeof(wchar_t);
+    auto ret = iconv(from_utf8_, &iconv_in, &iconv_in_bytes, &iconv_out, &iconv_out_bytes);
     if (static_cast<size_t>(-1) == ret) {
-      result = wconv_error;
-    } else {
-      size_t converted_bytes = buffer_len - iconv_out_bytes;
-      assert((converted_bytes % sizeof(wchar_t)) == 0);
-      result.assign(reinterpret_cast<const wchar_t*>(buffer.get()), converted_bytes / sizeof(wchar_t));
+      wstr.clear();
+      return false;
     }
-    iconv_close(icvt);
-    return result;
+
+    assert((iconv_out_bytes % sizeof(wchar_t)) == 0);
+    wstr.resize(s.length() - iconv_out_bytes / sizeof(wchar_t));
+    return true;
   }
 
-  std::string to_bytes(const std::wstring& wstr) const {
-    std::string result;
+  // Converts wstr into dest, which has room for MaxBytes(wstr) bytes.
+  // Returns the number of bytes written or std::string::npos if wstr could not be converted.
+  size_t to_bytes(const std::wstring& wstr, char* dest) const {
     if (wstr.empty()) {
-      return result;
+      return 0;
     }
-    // Order of arguments is to, from
-    auto icvt = iconv_open("UTF-8", "WCHAR_T");
-    // CentOS is not happy with -1
-    if (std::numeric_limits<iconv_t>::max() == icvt) {
-      return conv_error;
+    if (!IsValid(to_utf8_)) {
+      return std::string::npos;
     }
 
+    iconv(to_utf8_, nullptr, nullptr, nullptr, nullptr);
     // I hope this does not modify the incoming buffer
     wchar_t* non_const_in = const_cast<wchar_t*>(wstr.c_str());
     char* iconv_in = reinterpret_cast<char*>(non_const_in);
     size_t iconv_in_bytes = wstr.length() * sizeof(wchar_t);
-    // Temp buffer, assume every code point converts into 3 bytes, this should be enough
     // We do not convert terminating zeros
-    const size_t buffer_len = wstr.length() * 3;
-    auto buffer = std::make_unique<char[]>(buffer_len);
-
-    char* iconv_out = buffer.get();
+    const size_t buffer_len = MaxBytes(wstr);
+    char* iconv_out = dest;
     size_t iconv_out_bytes = buffer_len;
-    auto ret = iconv(icvt, &iconv_in, &iconv_in_bytes, &iconv_out, &iconv_out_bytes);
+    auto ret = iconv(to_utf8_, &iconv_in, &iconv_in_bytes, &iconv_out, &iconv_out_bytes);
     if (static_cast<size_t>(-1) == ret) {
-      result = conv_error;
-    } else {
-      size_t converted_len = buffer_len - iconv_out_bytes;
-      result.assign(buffer.get(), converted_len);
+      return std::string::npos;
     }
-    iconv_close(icvt);
-    return result;
+    return buffer_len - iconv_out_bytes;
   }
+
+  // Every code point converts into at most 4 bytes
+  static size_t MaxBytes(const std::wstring& wstr) { return wstr.length() * 4; }
+
+ private:
+  // CentOS is not happy with -1
+  static bool IsValid(iconv_t icvt) { return std::numeric_limits<iconv_t>::max() != icvt; }
+
+  iconv_t from_utf8_;
+  iconv_t to_utf8_;
 };
 
 #endif  // __APPLE__
@@ -192,56 +208,33 @@ const std::string default_locale("en_US.UTF-8");  // All non-MS
 
 #endif  // MS_VER
 
-template <class ForwardIter>
-Status CopyCaseAction(ForwardIter first, ForwardIter end, OpKernelContext* ctx,
-                      const Locale& loc,
-                      Utf8Converter& converter,
-                      size_t N, size_t C,
-                      StringNormalizer::CaseAction caseaction) {
-  std::vector<int64_t> output_dims;
-  if (N == 1) {
-    output_dims.push_back(1);
-  }
-
-  // Empty output case
-  if (C == 0) {
-    output_dims.push_back(1);
-    TensorShape output_shape(output_dims);
-    // This will create one empty string
-    ctx->Output(0, output_shape);
-    return Status::OK();
-  }
-
-  output_dims.push_back(C);
+#if defined(_MSC_VER) || defined(__APPLE__) || defined(__ANDROID__)
+// std::wstring_convert returns new strings
+bool FromUtf8(Utf8Converter& converter, const std::string& s, std::wstring& wstr) {
+  wstr = converter.from_bytes(s);
+  return wstr != wconv_error;
+}
 
-  TensorShape output_shape(output_dims);
-  auto output_tensor = ctx->Output(0, output_shape);
-  auto const output_data = output_tensor->MutableData<std::string>();
+void AppendUtf8(Utf8Converter& converter, const std::wstring& wstr, PackedStrings& strings) {
+  strings.Append(converter.to_bytes(wstr));
+}
+#else
+// Convert utf8 to wide chars re-using the capacity of wstr. Returns false if s contains invalid utf8 chars.
+bool FromUtf8(Utf8Converter& converter, const std::string& s, std::wstring& wstr) {
+  return converter.from_bytes(s, wstr);
+}
 
-  size_t output_idx = 0;
-  while (first != end) {
-    auto& s = *first;
-    if (caseaction == StringNormalizer::LOWER || caseaction == StringNormalizer::UPPER) {
-      std::wstring wstr = converter.from_bytes(s);
-      if (wstr == wconv_error) {
-        // Please do not include the input text in the error message as it could
-        // be deemed as a compliance violation by teams using this operator
-        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                      "Input contains invalid utf8 chars");
-      }
-      // In place transform
-      loc.ChangeCase(caseaction, wstr);
-      *(output_data + output_idx) = converter.to_bytes(wstr);
-    } else {
-      assert(caseaction == StringNormalizer::NONE);
-      // Simple copy or move if the iterator points to a non-const string
-      *(output_data + output_idx) = std::move(s);
+// Convert wstr to utf8 in place at the end of strings
+void AppendUtf8(Utf8Converter& converter, const std::wstring& wstr, PackedStrings& strings) {
+  strings.Append(std::max(Utf8Converter::MaxBytes(wstr), conv_error.size()), [&](char* dest) {
+    size_t bytes = converter.to_bytes(wstr, dest);
+    if (bytes == std::string::npos) {
+      bytes = conv_error.copy(dest, conv_error.size());
     }
-    ++output_idx;
-    ++first;
-  }
-  return Status::OK();
+    return bytes;
+  });
 }
+#endif
 }  // namespace string_normalizer
 
 using namespace string_normalizer;
@@ -284,8 +277,8 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info),
       auto p = stopwords_.insert(std::move(sw));
       ORT_ENFORCE(p.second, "Duplicate stopwords not allowed");
     } else {
-      std::wstring wstr = converter.from_bytes(sw);
-      ORT_ENFORCE(wstr != wconv_error, "Stopword contains invalid utf8 chars");
+      std::wstring wstr;
+      ORT_ENFORCE(FromUtf8(converter, sw, wstr), "Stopword contains invalid utf8 chars");
       locale.ChangeCase(compare_caseaction_, wstr);
       auto p = wstopwords_.insert(std::move(wstr));
       ORT_ENFORCE(p.second, "Duplicate stopwords not allowed");
@@ -320,72 +313,87 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
                   "Input dimensions are either[C > 0] or [1][C > 0] allowed");
   }
 
-  Status status;
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&alloc));
+
   Locale locale(locale_name_);
   Utf8Converter converter(conv_error, wconv_error);
   auto* const input_data = X->Data<std::string>();
-  using StrRef = std::reference_wrapper<const std::string>;
-  if (is_case_sensitive_) {
-    if (!stopwords_.empty()) {
-      InlinedVector<StrRef> filtered_strings;
-      filtered_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        if (0 == stopwords_.count(s)) {
-          filtered_strings.push_back(std::cref(s));
-        }
-        ++first;
-      }
-      status = CopyCaseAction(filtered_strings.cbegin(), filtered_strings.cend(), ctx, locale, converter,
-                              N, filtered_strings.size(), case_change_action_);
-    } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
+  const bool change_case = case_change_action_ != NONE;
+
+  // The strings that pass the stopwords filter. When the case is changed the converted strings are packed into
+  // a buffer from the temp space allocator, otherwise we refer to the input strings.
+  PackedStrings cased_strings(alloc);
+  InlinedVector<const std::string*> original_strings;
+  if (change_case) {
+    size_t input_bytes = 0;
+    for (size_t i = 0; i < C; ++i) {
+      input_bytes += input_data[i].size();
     }
+    cased_strings.Reserve(C, input_bytes);
   } else {
-    if (!wstopwords_.empty()) {
-      // Filter input. When no case action is required
-      // we simply store original string references.
-      // Otherwise, we store converted strings.
-      InlinedVector<StrRef> filtered_orignal_strings;
-      InlinedVector<std::string> filtered_cased_strings;
-      filtered_orignal_strings.reserve(C);
-      filtered_cased_strings.reserve(C);
-      auto first = input_data;
-      auto const last = input_data + C;
-      while (first != last) {
-        const std::string& s = *first;
-        std::wstring wstr = converter.from_bytes(s);
-        if (wstr == wconv_error) {
-          // Please do not include the input text in the error message as it could
-          // be deemed as a compliance violation by teams using this operator
-          return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
-                        "Input contains invalid utf8 chars");
-        }
-        locale.ChangeCase(compare_caseaction_, wstr);
-        if (0 == wstopwords_.count(wstr)) {
-          if (case_change_action_ == NONE) {
-            filtered_orignal_strings.push_back(std::cref(s));
-          } else {
-            filtered_cased_strings.push_back(converter.to_bytes(wstr));
-          }
-        }
-        ++first;
+    original_strings.reserve(C);
+  }
+
+  // re-used for all the strings
+  std::wstring wstr;
+  for (size_t i = 0; i < C; ++i) {
+    const std::string& s = input_data[i];
+    bool converted = false;
+    if (is_case_sensitive_) {
+      if (!stopwords_.empty() && stopwords_.count(s) != 0) {
+        continue;
       }
-      if (case_change_action_ == NONE) {
-        status = CopyCaseAction(filtered_orignal_strings.cbegin(), filtered_orignal_strings.cend(), ctx, locale, converter,
-                                N, filtered_orignal_strings.size(), NONE);
-      } else {
-        status = CopyCaseAction(filtered_cased_strings.begin(), filtered_cased_strings.end(), ctx, locale, converter,
-                                N, filtered_cased_strings.size(), NONE);
+    } else if (!wstopwords_.empty()) {
+      if (!FromUtf8(converter, s, wstr)) {
+        // Please do not include the input text in the error message as it could
+        // be deemed as a compliance violation by teams using this operator
+        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                      "Input contains invalid utf8 chars");
       }
-    } else {
-      // Nothing to filter. Copy input to output and change case if needed
-      status = CopyCaseAction(input_data, input_data + C, ctx, locale, converter, N, C, case_change_action_);
+      // compare_caseaction_ is the same as case_change_action_ if the case is changed
+      locale.ChangeCase(compare_caseaction_, wstr);
+      if (wstopwords_.count(wstr) != 0) {
+        continue;
+      }
+      converted = true;
+    }
+
+    if (!change_case) {
+      original_strings.push_back(&s);
+      continue;
+    }
+
+    if (!converted) {
+      if (!FromUtf8(converter, s, wstr)) {
+        return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
+                      "Input contains invalid utf8 chars");
+      }
+      // In place transform
+      locale.ChangeCase(case_change_action_, wstr);
     }
+    AppendUtf8(converter, wstr, cased_strings);
   }
-  return status;
+
+  const size_t output_count = change_case ? cased_strings.Size() : original_strings.size();
+  std::vector<int64_t> output_dims;
+  if (N == 1) {
+    output_dims.push_back(1);
+  }
+
+  // Empty output case. This will create one empty string
+  output_dims.push_back(output_count == 0 ? 1 : static_cast<int64_t>(output_count));
+  auto output_tensor = ctx->Output(0, TensorShape(output_dims));
+  auto* const output_data = output_tensor->MutableData<std::string>();
+
+  if (change_case) {
+    cased_strings.CopyTo(output_data);
+  } else {
+    for (size_t i = 0; i < output_count; ++i) {
+      output_data[i] = *original_strings[i];
+    }
+  }
+
+  return Status::OK();
 }
 }  // namespace onnxruntime
@@ -3,11 +3,14 @@
 
 #include "tfidfvectorizer.h"
 #include "core/common/common.h"
+#include "core/common/inlined_containers.h"
 #include "core/framework/tensor.h"
 #include "core/platform/threadpool.h"
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
+#include <limits>
+#include <string_view>
 
 namespace onnxruntime {
 
@@ -23,61 +26,124 @@ ONNX_CPU_OPERATOR_KERNEL(
 
 namespace ngram_details {
 
-// NgrampPart implements a Trie like structure
-// for a unigram (1) it would insert into a root map with a valid id.
+// NgramTrie is a flat trie of the n-grams in the pool.
+// Every distinct pool item is mapped to a dense token id when the trie is built, so an input row is converted
+// to token ids with a single hash lookup per item, regardless of how many n-gram windows and skip distances the
+// item is part of. Walking the trie then only deals with token ids:
+// the edges are stored in one open addressing table keyed by (parent node, token id), and the n-gram id of every
+// node in a contiguous vector, instead of a tree of hash maps linked by heap pointers.
+// for a unigram (1) the root has an edge to a node with a valid id.
 // for (1,2,3) node 2 would be a child of 1 but have id == 0
 // because (1,2) does not exists. Node 3 would have a valid id.
-template <class T>
-struct NgramPart;
+class NgramTrie {
+ public:
+  static constexpr uint32_t kRoot = 0;
+  static constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+  // token id of an input item that is not in the pool
+  static constexpr uint32_t kNoToken = std::numeric_limits<uint32_t>::max();
+
+  NgramTrie() : ngram_ids_(1, 0), edges_(16) {}
+
+  // Returns the child of node for token, creating it if needed
+  uint32_t AddChild(uint32_t node, uint32_t token) {
+    if ((num_edges_ + 1) * 2 > edges_.size()) {
+      Grow();
+    }
 
-template <>
-struct NgramPart<int64_t>;
+    Edge& edge = FindSlot(edges_, node, token);
+    if (edge.child == kNoNode) {
+      edge.parent = node;
+      edge.token = token;
+      edge.child = static_cast<uint32_t>(ngram_ids_.size());
+      ngram_ids_.push_back(0);
+      ++num_edges_;
+    }
 
-template <>
-struct NgramPart<std::string>;
+    return edge.child;
+  }
 
-using NgramPartInt = NgramPart<int64_t>;
-using NgramPartString = NgramPart<std::string>;
+  // Returns the child of node for token or kNoNode
+  uint32_t Child(uint32_t node, uint32_t token) const {
+    if (token == kNoToken) {
+      return kNoNode;
+    }
 
-// Avoid recursive class definitions using unique_ptr + forward declaration
-using IntMap = std::unordered_map<int64_t, std::unique_ptr<NgramPartInt>>;
+    const size_t mask = edges_.size() - 1;
+    for (size_t i = Hash(node, token) & mask;; i = (i + 1) & mask) {
+      const Edge& edge = edges_[i];
+      if (edge.child == kNoNode || (edge.parent == node && edge.token == token)) {
+        return edge.child;
+      }
+    }
+  }
 
-using StrMap = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                  std::hash<std::string>, std::equal_to<std::string>>;
+  // 0 - means no entry, search for a bigger N
+  size_t NgramId(uint32_t node) const { return ngram_ids_[node]; }
+  void SetNgramId(uint32_t node, size_t ngram_id) { ngram_ids_[node] = ngram_id; }
 
-template <>
-struct NgramPart<int64_t> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  IntMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+  bool Empty() const { return num_edges_ == 0; }
+
+ private:
+  struct Edge {
+    uint32_t parent = 0;
+    uint32_t token = 0;
+    uint32_t child = kNoNode;
+  };
+
+  static size_t Hash(uint32_t node, uint32_t token) {
+    uint64_t key = (uint64_t{node} << 32) | token;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+  }
+
+  static Edge& FindSlot(std::vector<Edge>& edges, uint32_t node, uint32_t token) {
+    const size_t mask = edges.size() - 1;
+    for (size_t i = Hash(node, token) & mask;; i = (i + 1) & mask) {
+      Edge& edge = edges[i];
+      if (edge.child == kNoNode || (edge.parent == node && edge.token == token)) {
+        return edge;
+      }
+    }
+  }
 
-template <>
-struct NgramPart<std::string> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  StrMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
+  void Grow() {
+    std::vector<Edge> edges(edges_.size() * 2);
+    for (const auto& edge : edges_) {
+      if (edge.child != kNoNode) {
+        FindSlot(edges, edge.parent, edge.token) = edge;
+      }
+    }
+    edges_.swap(edges);
+  }
+
+  std::vector<size_t> ngram_ids_;  // indexed by node
+  std::vector<Edge> edges_;        // size is a power of 2, at most half full
+  size_t num_edges_ = 0;
 };
 
+using IntTokens = InlinedHashMap<int64_t, uint32_t>;
+// keys reference the pool_strings attribute
+using StrTokens = InlinedHashMap<std::string_view, uint32_t>;
+
+inline std::string_view TokenKey(const std::reference_wrapper<const std::string>& item) { return item.get(); }
+inline int64_t TokenKey(int64_t item) { return item; }
+
 // Returns next ngram_id
-template <class K, class ForwardIter, class Map>
+template <class ForwardIter, class TokenMap>
 inline size_t PopulateGrams(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id,
-                            Map& c) {
+                            TokenMap& tokens, NgramTrie& trie) {
   for (; ngrams > 0; --ngrams) {
-    size_t n = 1;
-    Map* m = &c;
-    while (true) {
-      auto p = m->emplace(*first, std::make_unique<NgramPart<K>>(0));
-      ++first;
-      if (n == ngram_size) {
-        ORT_ENFORCE(p.first->second->id_ == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
-        p.first->second->id_ = ngram_id;
-        ++ngram_id;
-        break;
-      }
-      ++n;
-      m = &p.first->second->leafs_;
+    uint32_t node = NgramTrie::kRoot;
+    for (size_t n = 0; n < ngram_size; ++n, ++first) {
+      const uint32_t next_token = static_cast<uint32_t>(tokens.size());
+      const uint32_t token = tokens.emplace(TokenKey(*first), next_token).first->second;
+      node = trie.AddChild(node, token);
     }
+    ORT_ENFORCE(trie.NgramId(node) == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
+    trie.SetNgramId(node, ngram_id);
+    ++ngram_id;
   }
   return ngram_id;
 }
@@ -89,10 +155,6 @@ using namespace onnxruntime::ngram_details;
 
 namespace onnxruntime {
 
-inline const void* AdvanceElementPtr(const void* p, size_t elements, size_t element_size) {
-  return reinterpret_cast<const uint8_t*>(p) + elements * element_size;
-}
-
 // The weighting criteria.
 // "TF"(term frequency),
 //    the counts are propagated to output
@@ -127,11 +189,11 @@ struct TfIdfVectorizer::Impl {
   gsl::span<const int64_t> ngram_indexes_;
   gsl::span<const float> weights_;
 
-  // This map contains references to pool_string_ entries
-  // of pool_strings attribute
-  StrMap str_map_;
-  // This map contains pool_int64s entries
-  IntMap int64_map_;
+  // Token ids of the pool_strings entries
+  StrTokens str_tokens_;
+  // Token ids of the pool_int64s entries
+  IntTokens int64_tokens_;
+  NgramTrie trie_;
 
   size_t output_size_ = 0;
 
@@ -140,12 +202,11 @@ struct TfIdfVectorizer::Impl {
   Impl(const Impl&) = delete;
   Impl& operator=(const Impl&) = delete;
 
-  void IncrementCount(size_t ngram_id, size_t row_num,
-                      std::vector<uint32_t>& frequencies) const {
+  void IncrementCount(size_t ngram_id, std::vector<uint32_t>& frequencies) const {
     assert(ngram_id != 0);
     --ngram_id;
     assert(ngram_id < ngram_indexes_.size());
-    auto output_idx = static_cast<int64_t>(row_num) * output_size_ + ngram_indexes_[ngram_id];
+    auto output_idx = ngram_indexes_[ngram_id];
     assert(static_cast<size_t>(output_idx) < frequencies.size());
     ++frequencies[output_idx];
   }
@@ -237,9 +298,11 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
         if (pool_strings.empty()) {
-          ngram_id = PopulateGrams<int64_t>(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_map_);
+          ngram_id = PopulateGrams(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id,
+                                   impl_->int64_tokens_, impl_->trie_);
         } else {
-          ngram_id = PopulateGrams<std::string>(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_map_);
+          ngram_id = PopulateGrams(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id,
+                                   impl_->str_tokens_, impl_->trie_);
         }
       } else {
         ngram_id += ngrams;
@@ -251,24 +314,8 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
 
 TfIdfVectorizer::~TfIdfVectorizer() = default;
 
-void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::vector<uint32_t>& frequences) const {
+void TfIdfVectorizer::OutputResult(const std::vector<uint32_t>& frequences, float* output_data) const {
   const Impl& impl = *impl_;
-  std::vector<int64_t> output_dims;
-  if (B == 0) {
-    output_dims.push_back(impl.output_size_);
-    B = 1;  // For use in the loops below
-  } else {
-    output_dims.push_back(B);
-    output_dims.push_back(impl.output_size_);
-  }
-
-  const auto row_size = impl.output_size_;
-
-  TensorShape output_shape(output_dims);
-  assert(frequences.size() == static_cast<size_t>(output_shape.Size()));
-
-  auto Y = ctx->Output(0, output_shape);
-  auto output_data = Y->MutableData<float>();
   const auto& w = impl.weights_;
   switch (impl.weighting_criteria_) {
     case kTF: {
@@ -279,10 +326,8 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
     case kIDF: {
       if (!w.empty()) {
         const auto* freqs = frequences.data();
-        for (size_t batch = 0; batch < B; ++batch) {
-          for (size_t i = 0; i < row_size; ++i) {
-            *output_data++ = (*freqs++ > 0) ? w[i] : 0;
-          }
+        for (size_t i = 0, row_size = frequences.size(); i < row_size; ++i) {
+          *output_data++ = (*freqs++ > 0) ? w[i] : 0;
         }
       } else {
         for (auto f : frequences) {
@@ -293,10 +338,8 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
     case kTFIDF: {
       if (!w.empty()) {
         const auto* freqs = frequences.data();
-        for (size_t batch = 0; batch < B; ++batch) {
-          for (size_t i = 0; i < row_size; ++i) {
-            *output_data++ = *freqs++ * w[i];
-          }
+        for (size_t i = 0, row_size = frequences.size(); i < row_size; ++i) {
+          *output_data++ = *freqs++ * w[i];
         }
       } else {
         for (auto f : frequences) {
@@ -310,68 +353,61 @@ void TfIdfVectorizer::OutputResult(OpKernelContext* ctx, size_t B, const std::ve
   }
 }
 
-void TfIdfVectorizer::ComputeImpl(OpKernelContext* ctx, ptrdiff_t row_num, size_t row_size,
-                                  std::vector<uint32_t>& frequencies) const {
-  auto X = ctx->Input<Tensor>(0);
-  const auto elem_size = X->DataType()->Size();
+void TfIdfVectorizer::ComputeImpl(const Tensor& X, ptrdiff_t row_num, size_t row_size,
+                                  std::vector<uint32_t>& tokens, std::vector<uint32_t>& frequencies) const {
+  const auto& impl = *impl_;
 
-  const void* const row_begin = AdvanceElementPtr(X->DataRaw(), row_num * row_size, elem_size);
-  const void* const row_end = AdvanceElementPtr(row_begin, row_size, elem_size);
+  // Look up each item of the row once. Items that are not in the pool can not be part of any n-gram.
+  tokens.resize(row_size);
+  const size_t row_offset = static_cast<size_t>(row_num) * row_size;
+  if (X.IsDataTypeString()) {
+    const std::string* row = X.Data<std::string>() + row_offset;
+    for (size_t i = 0; i < row_size; ++i) {
+      auto hit = impl.str_tokens_.find(std::string_view(row[i]));
+      tokens[i] = hit == impl.str_tokens_.end() ? NgramTrie::kNoToken : hit->second;
+    }
+  } else {
+    auto lookup = [&impl, &tokens](const auto* row, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+        auto hit = impl.int64_tokens_.find(int64_t{row[i]});
+        tokens[i] = hit == impl.int64_tokens_.end() ? NgramTrie::kNoToken : hit->second;
+      }
+    };
 
-  const auto& impl = *impl_;
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
+    if (X.IsDataType<int32_t>()) {
+      lookup(X.Data<int32_t>() + row_offset, row_size);
+    } else {
+      lookup(X.Data<int64_t>() + row_offset, row_size);
+    }
+  }
 
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = row_begin;
-    auto const ngram_row_end = row_end;
+  const auto& trie = impl.trie_;
+  const size_t max_gram_length = impl.max_gram_length_;
+  const size_t max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
+  size_t start_ngram_size = impl.min_gram_length_;
 
-    while (ngram_start < ngram_row_end) {
+  for (size_t skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
+    for (size_t ngram_start = 0; ngram_start < row_size; ++ngram_start) {
       // We went far enough so no n-grams of any size can be gathered
-      auto at_least_this = AdvanceElementPtr(ngram_start, skip_distance * (start_ngram_size - 1), elem_size);
-      if (at_least_this >= ngram_row_end) {
+      if (ngram_start + skip_distance * (start_ngram_size - 1) >= row_size) {
         break;
       }
 
-      auto ngram_item = ngram_start;
-      if (X->IsDataTypeString()) {
-        const std::string* str_item = reinterpret_cast<const std::string*>(ngram_item);
-        const StrMap* str_map = &impl.str_map_;
-        for (auto ngram_size = 1;
-             !str_map->empty() &&
-             ngram_size <= max_gram_length &&
-             str_item < ngram_row_end;
-             ++ngram_size, str_item += skip_distance) {
-          auto hit = str_map->find(*str_item);
-          if (hit == str_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
-          }
-          str_map = &hit->second->leafs_;
+      uint32_t node = NgramTrie::kRoot;
+      for (size_t ngram_size = 1, item = ngram_start;
+           ngram_size <= max_gram_length && item < row_size;
+           ++ngram_size, item += skip_distance) {
+        node = trie.Child(node, tokens[item]);
+        if (node == NgramTrie::kNoNode) {
+          break;
         }
-      } else {
-        const IntMap* int_map = &impl.int64_map_;
-        for (auto ngram_size = 1;
-             !int_map->empty() &&
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
-             ++ngram_size, ngram_item = AdvanceElementPtr(ngram_item, skip_distance, elem_size)) {
-          int64_t val = (X->IsDataType<int32_t>()) ? int64_t{*reinterpret_cast<const int32_t*>(ngram_item)} : *reinterpret_cast<const int64_t*>(ngram_item);
-          auto hit = int_map->find(val);
-          if (hit == int_map->end()) {
-            break;
+        if (ngram_size >= start_ngram_size) {
+          const size_t ngram_id = trie.NgramId(node);
+          if (ngram_id != 0) {
+            impl.IncrementCount(ngram_id, frequencies);
           }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            impl.IncrementCount(hit->second->id_, row_num, frequencies);
-          }
-          int_map = &hit->second->leafs_;
         }
       }
-      // Sliding window shift
-      ngram_start = AdvanceElementPtr(ngram_start, 1, elem_size);
     }
     // We count UniGrams only once since they are not affected
     // by skip distance
@@ -411,30 +447,49 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   }
 
   assert((num_rows * C) == total_items);
-  // Frequency holder allocate [B..output_size_]
-  // and init all to zero
-  std::vector<uint32_t> frequencies;
-  frequencies.resize(num_rows * impl_->output_size_, 0);
+
+  const size_t output_size = impl_->output_size_;
+  std::vector<int64_t> output_dims;
+  if (B == 0) {
+    output_dims.push_back(output_size);
+  } else {
+    output_dims.push_back(B);
+    output_dims.push_back(output_size);
+  }
+
+  auto Y = ctx->Output(0, TensorShape(output_dims));
+  auto output_data = Y->MutableData<float>();
 
   if (total_items == 0 ||
-      (X->IsDataTypeString() && impl_->str_map_.empty()) ||
-      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_map_.empty())) {
+      (X->IsDataTypeString() && impl_->str_tokens_.empty()) ||
+      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_tokens_.empty())) {
     // TfidfVectorizer may receive an empty input when it follows a Tokenizer
     // (for example for a string containing only stopwords).
     // TfidfVectorizer returns a zero tensor of shape
     // {b_dim, output_size} when b_dim is the number of received observations
     // and output_size the is the maximum value in ngram_indexes attribute plus 1.
-    OutputResult(ctx, B, frequencies);
+    std::fill_n(output_data, static_cast<size_t>(num_rows) * output_size, 0.f);
     return Status::OK();
   }
 
-  std::function<void(ptrdiff_t)> fn = [this, ctx, C, &frequencies](ptrdiff_t row_num) {
-    ComputeImpl(ctx, row_num, C, frequencies);
-  };
-
-  concurrency::ThreadPool::TryBatchParallelFor(ctx->GetOperatorThreadPool(), num_rows, std::move(fn), 0);
-
-  OutputResult(ctx, B, frequencies);
+  // Rows are independent. Each batch of rows counts the n-grams of a row into a frequency buffer
+  // of output_size and applies the weighting criteria to write the output row.
+  const double max_windows = static_cast<double>(C) * (impl_->max_skip_count_ + 1) * impl_->max_gram_length_;
+  const TensorOpCost cost{static_cast<double>(C * X->DataType()->Size()),
+                          static_cast<double>(output_size * sizeof(float)),
+                          max_windows * 4 + static_cast<double>(output_size)};
+
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), num_rows, cost,
+      [this, X, C, output_size, output_data](ptrdiff_t first, ptrdiff_t last) {
+        std::vector<uint32_t> tokens;
+        std::vector<uint32_t> frequencies;
+        for (ptrdiff_t row_num = first; row_num < last; ++row_num) {
+          frequencies.assign(output_size, 0);
+          ComputeImpl(*X, row_num, C, tokens, frequencies);
+          OutputResult(frequencies, output_data + row_num * output_size);
+        }
+      });
 
   return Status::OK();
 }
@@ -19,6 +19,12 @@
 #include "core/providers/xnnpack/nn/max_pool.h"
 #include "core/providers/xnnpack/nn/average_pool.h"
 #include "core/providers/xnnpack/nn/softmax.h"
+#include "core/providers/xnnpack/math/binary_elementwise.h"
+#include "core/providers/xnnpack/math/gemm.h"
+#include "core/providers/xnnpack/math/matmul.h"
+#include "core/providers/xnnpack/tensor/concat.h"
+#include "core/providers/xnnpack/tensor/resize.h"
+#include "core/providers/xnnpack/tensor/transpose.h"
 
 namespace onnxruntime {
 namespace xnnpack {
@@ -92,10 +98,31 @@ bool NodeSupportChecker::IsNodeSupported(const NodeUnit& nodeunit) {
       {"MaxPool", MaxPool::IsMaxPoolOnnxNodeSupported},
       {"AveragePool", AveragePool::IsAveragePoolOnnxNodeSupported},
       {"Softmax", Softmax::IsSoftmaxOnnxNodeSupported},
+      {"MatMul", MatMul::IsMatMulOnnxNodeSupported},
+      {"QLinearMatMul", MatMul::IsMatMulOnnxNodeSupported},
+      {"Gemm", Gemm::IsGemmOnnxNodeSupported},
+      {"Add", BinaryElementwise::IsBinaryElementwiseOnnxNodeSupported},
+      {"Sub", BinaryElementwise::IsBinaryElementwiseOnnxNodeSupported},
+      {"Mul", BinaryElementwise::IsBinaryElementwiseOnnxNodeSupported},
+      {"Div", BinaryElementwise::IsBinaryElementwiseOnnxNodeSupported},
+      {"Transpose", Transpose::IsTransposeOnnxNodeSupported},
+      {"Concat", Concat::IsConcatOnnxNodeSupported},
+      {"Resize", Resize::IsResizeOnnxNodeSupported},
   };
 
+  // float ops the user asked to leave to the CPU EP. the QDQ node groups of MatMul are quantized and remain
+  // supported.
+  static const std::unordered_set<std::string> float_matmul_and_binary_ops{"MatMul", "Gemm", "Add", "Sub", "Mul",
+                                                                           "Div"};
+
   bool supported = false;
 
+  if (!enable_float_matmul_and_binary_ops_ &&
+      nodeunit.UnitType() == NodeUnit::Type::SingleNode &&
+      float_matmul_and_binary_ops.count(nodeunit.OpType()) != 0) {
+    return supported;
+  }
+
   if (nodeunit.Domain() == onnxruntime::kOnnxDomain) {
     const auto entry = checkers.find(nodeunit.OpType());
     if (entry != checkers.cend()) {
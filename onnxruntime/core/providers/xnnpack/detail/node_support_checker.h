@@ -15,9 +15,11 @@ namespace xnnpack {
 class NodeSupportChecker {
  public:
   NodeSupportChecker(const GraphViewer& graph,
-                     const std::unordered_map<const Node*, const NodeUnit*>& supported_node_unit_map)
+                     const std::unordered_map<const Node*, const NodeUnit*>& supported_node_unit_map,
+                     bool enable_float_matmul_and_binary_ops = true)
       : graph_{graph},
-        supported_node_unit_map_{supported_node_unit_map} {
+        supported_node_unit_map_{supported_node_unit_map},
+        enable_float_matmul_and_binary_ops_{enable_float_matmul_and_binary_ops} {
   }
 
   bool IsNodeSupported(const NodeUnit& node_unit);
@@ -29,6 +31,9 @@ class NodeSupportChecker {
   // previously selected nodes as of each time IsNodeSupport{WithFusion} is called.
   // updated in the background by the EP when it decides it will take a node_unit.
   const std::unordered_map<const Node*, const NodeUnit*>& supported_node_unit_map_;
+
+  // whether float MatMul, Gemm, Add, Sub, Mul and Div nodes are taken. see XnnpackExecutionProviderInfo.
+  const bool enable_float_matmul_and_binary_ops_;
 };
 
 }  // namespace xnnpack
@@ -0,0 +1,311 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Implementation of the pthreadpool API on top of the ORT thread pool.
+//
+// XNNPACK parallelizes its operators through pthreadpool. With the real pthreadpool library the XNNPACK kernels run
+// on a second set of threads that competes with the intra-op thread pool for the same cores. This file is compiled
+// as the 'pthreadpool' library instead (see cmake/external/xnnpack.cmake), so that a pthreadpool_t handed to
+// XNNPACK is simply an onnxruntime::concurrency::ThreadPool*. XnnpackKernel::GetThreadPool passes the intra-op
+// thread pool of the current kernel invocation. A null handle runs the work on the calling thread, which is the
+// behavior of both pthreadpool and ThreadPool::TrySimpleParallelFor.
+//
+// Only the pthreadpool_parallelize_* entry points used by XNNPACK are implemented. The flags argument is ignored:
+// denormal handling of the ORT threads is controlled by the session options.
+
+#include <pthreadpool.h>
+
+#include <algorithm>
+#include <array>
+#include <thread>
+
+#include "core/platform/env.h"
+#include "core/platform/threadpool.h"
+#include "core/session/onnxruntime_c_api.h"
+
+namespace {
+
+using onnxruntime::concurrency::ThreadPool;
+
+template <size_t N>
+using Index = std::array<size_t, N>;
+
+ThreadPool* ToOrtThreadPool(pthreadpool_t threadpool) {
+  return reinterpret_cast<ThreadPool*>(threadpool);
+}
+
+size_t DivideRoundUp(size_t n, size_t q) {
+  return n / q + (n % q != 0 ? 1 : 0);
+}
+
+// Splits the N-dimensional 'range' into tiles of size 'tile' and calls fn(start, size) once per tile.
+// The tiles are handed out as one contiguous range per thread, in row-major order, so neighbouring tiles that share
+// input data run on the same thread and the thread pool is entered once per thread instead of once per tile.
+template <size_t N, typename F>
+void ParallelizeTiled(pthreadpool_t threadpool, const Index<N>& range, const Index<N>& tile, const F& fn) {
+  Index<N> tile_count;
+  size_t total = 1;
+  for (size_t d = 0; d < N; ++d) {
+    tile_count[d] = DivideRoundUp(range[d], tile[d]);
+    total *= tile_count[d];
+  }
+
+  if (total == 0) {
+    return;
+  }
+
+  ThreadPool* tp = ToOrtThreadPool(threadpool);
+  const size_t num_blocks = std::min(total, static_cast<size_t>(ThreadPool::DegreeOfParallelism(tp)));
+
+  ThreadPool::TrySimpleParallelFor(
+      tp, static_cast<std::ptrdiff_t>(num_blocks),
+      [&](std::ptrdiff_t block) {
+        const size_t block_idx = static_cast<size_t>(block);
+        const size_t begin = total / num_blocks * block_idx + std::min(total % num_blocks, block_idx);
+        const size_t end = begin + total / num_blocks + (block_idx < total % num_blocks ? 1 : 0);
+
+        // N-dimensional index of the first tile of the block
+        Index<N> tile_idx;
+        size_t idx = begin;
+        for (size_t d = N; d-- > 0;) {
+          tile_idx[d] = idx % tile_count[d];
+          idx /= tile_count[d];
+        }
+
+        Index<N> start;
+        Index<N> size;
+        for (size_t i = begin; i < end; ++i) {
+          for (size_t d = 0; d < N; ++d) {
+            start[d] = tile_idx[d] * tile[d];
+            size[d] = std::min(tile[d], range[d] - start[d]);
+          }
+          fn(start, size);
+
+          // step to the next tile, innermost dimension first
+          for (size_t d = N; d-- > 0;) {
+            if (++tile_idx[d] < tile_count[d]) {
+              break;
+            }
+            tile_idx[d] = 0;
+          }
+        }
+      });
+}
+
+}  // namespace
+
+pthreadpool_t pthreadpool_create(size_t threads_count) {
+  // as in pthreadpool, 0 requests one thread per logical processor
+  if (threads_count == 0) {
+    threads_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  onnxruntime::ThreadOptions thread_options;
+  auto* threadpool = new ThreadPool(&onnxruntime::Env::Default(), thread_options, ORT_TSTR("xnnpack"),
+                                    static_cast<int>(threads_count), true);
+  return reinterpret_cast<pthreadpool_t>(threadpool);
+}
+
+size_t pthreadpool_get_threads_count(pthreadpool_t threadpool) {
+  return static_cast<size_t>(ThreadPool::DegreeOfParallelism(ToOrtThreadPool(threadpool)));
+}
+
+void pthreadpool_destroy(pthreadpool_t threadpool) {
+  delete ToOrtThreadPool(threadpool);
+}
+
+void pthreadpool_parallelize_1d(pthreadpool_t threadpool, pthreadpool_task_1d_t function, void* context,
+                                size_t range, uint32_t /*flags*/) {
+  ParallelizeTiled<1>(threadpool, {range}, {1},
+                      [&](const Index<1>& start, const Index<1>& /*size*/) {
+                        function(context, start[0]);
+                      });
+}
+
+void pthreadpool_parallelize_1d_with_uarch(pthreadpool_t threadpool, pthreadpool_task_1d_with_id_t function,
+                                           void* context, uint32_t default_uarch_index, uint32_t /*max_uarch_index*/,
+                                           size_t range, uint32_t /*flags*/) {
+  ParallelizeTiled<1>(threadpool, {range}, {1},
+                      [&](const Index<1>& start, const Index<1>& /*size*/) {
+                        function(context, default_uarch_index, start[0]);
+                      });
+}
+
+void pthreadpool_parallelize_1d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_1d_tile_1d_t function,
+                                        void* context, size_t range, size_t tile, uint32_t /*flags*/) {
+  ParallelizeTiled<1>(threadpool, {range}, {tile},
+                      [&](const Index<1>& start, const Index<1>& size) {
+                        function(context, start[0], size[0]);
+                      });
+}
+
+void pthreadpool_parallelize_2d(pthreadpool_t threadpool, pthreadpool_task_2d_t function, void* context,
+                                size_t range_i, size_t range_j, uint32_t /*flags*/) {
+  ParallelizeTiled<2>(threadpool, {range_i, range_j}, {1, 1},
+                      [&](const Index<2>& start, const Index<2>& /*size*/) {
+                        function(context, start[0], start[1]);
+                      });
+}
+
+void pthreadpool_parallelize_2d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_2d_tile_1d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t tile_j,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<2>(threadpool, {range_i, range_j}, {1, tile_j},
+                      [&](const Index<2>& start, const Index<2>& size) {
+                        function(context, start[0], start[1], size[1]);
+                      });
+}
+
+void pthreadpool_parallelize_2d_tile_2d(pthreadpool_t threadpool, pthreadpool_task_2d_tile_2d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t tile_i, size_t tile_j,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<2>(threadpool, {range_i, range_j}, {tile_i, tile_j},
+                      [&](const Index<2>& start, const Index<2>& size) {
+                        function(context, start[0], start[1], size[0], size[1]);
+                      });
+}
+
+void pthreadpool_parallelize_2d_tile_2d_with_uarch(pthreadpool_t threadpool,
+                                                   pthreadpool_task_2d_tile_2d_with_id_t function, void* context,
+                                                   uint32_t default_uarch_index, uint32_t /*max_uarch_index*/,
+                                                   size_t range_i, size_t range_j, size_t tile_i, size_t tile_j,
+                                                   uint32_t /*flags*/) {
+  ParallelizeTiled<2>(threadpool, {range_i, range_j}, {tile_i, tile_j},
+                      [&](const Index<2>& start, const Index<2>& size) {
+                        function(context, default_uarch_index, start[0], start[1], size[0], size[1]);
+                      });
+}
+
+void pthreadpool_parallelize_3d(pthreadpool_t threadpool, pthreadpool_task_3d_t function, void* context,
+                                size_t range_i, size_t range_j, size_t range_k, uint32_t /*flags*/) {
+  ParallelizeTiled<3>(threadpool, {range_i, range_j, range_k}, {1, 1, 1},
+                      [&](const Index<3>& start, const Index<3>& /*size*/) {
+                        function(context, start[0], start[1], start[2]);
+                      });
+}
+
+void pthreadpool_parallelize_3d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_3d_tile_1d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k, size_t tile_k,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<3>(threadpool, {range_i, range_j, range_k}, {1, 1, tile_k},
+                      [&](const Index<3>& start, const Index<3>& size) {
+                        function(context, start[0], start[1], start[2], size[2]);
+                      });
+}
+
+void pthreadpool_parallelize_3d_tile_2d(pthreadpool_t threadpool, pthreadpool_task_3d_tile_2d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t tile_j, size_t tile_k, uint32_t /*flags*/) {
+  ParallelizeTiled<3>(threadpool, {range_i, range_j, range_k}, {1, tile_j, tile_k},
+                      [&](const Index<3>& start, const Index<3>& size) {
+                        function(context, start[0], start[1], start[2], size[1], size[2]);
+                      });
+}
+
+void pthreadpool_parallelize_3d_tile_2d_with_uarch(pthreadpool_t threadpool,
+                                                   pthreadpool_task_3d_tile_2d_with_id_t function, void* context,
+                                                   uint32_t default_uarch_index, uint32_t /*max_uarch_index*/,
+                                                   size_t range_i, size_t range_j, size_t range_k,
+                                                   size_t tile_j, size_t tile_k, uint32_t /*flags*/) {
+  ParallelizeTiled<3>(threadpool, {range_i, range_j, range_k}, {1, tile_j, tile_k},
+                      [&](const Index<3>& start, const Index<3>& size) {
+                        function(context, default_uarch_index, start[0], start[1], start[2], size[1], size[2]);
+                      });
+}
+
+void pthreadpool_parallelize_4d(pthreadpool_t threadpool, pthreadpool_task_4d_t function, void* context,
+                                size_t range_i, size_t range_j, size_t range_k, size_t range_l, uint32_t /*flags*/) {
+  ParallelizeTiled<4>(threadpool, {range_i, range_j, range_k, range_l}, {1, 1, 1, 1},
+                      [&](const Index<4>& start, const Index<4>& /*size*/) {
+                        function(context, start[0], start[1], start[2], start[3]);
+                      });
+}
+
+void pthreadpool_parallelize_4d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_4d_tile_1d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t tile_l, uint32_t /*flags*/) {
+  ParallelizeTiled<4>(threadpool, {range_i, range_j, range_k, range_l}, {1, 1, 1, tile_l},
+                      [&](const Index<4>& start, const Index<4>& size) {
+                        function(context, start[0], start[1], start[2], start[3], size[3]);
+                      });
+}
+
+void pthreadpool_parallelize_4d_tile_2d(pthreadpool_t threadpool, pthreadpool_task_4d_tile_2d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t tile_k, size_t tile_l, uint32_t /*flags*/) {
+  ParallelizeTiled<4>(threadpool, {range_i, range_j, range_k, range_l}, {1, 1, tile_k, tile_l},
+                      [&](const Index<4>& start, const Index<4>& size) {
+                        function(context, start[0], start[1], start[2], start[3], size[2], size[3]);
+                      });
+}
+
+void pthreadpool_parallelize_4d_tile_2d_with_uarch(pthreadpool_t threadpool,
+                                                   pthreadpool_task_4d_tile_2d_with_id_t function, void* context,
+                                                   uint32_t default_uarch_index, uint32_t /*max_uarch_index*/,
+                                                   size_t range_i, size_t range_j, size_t range_k, size_t range_l,
+                                                   size_t tile_k, size_t tile_l, uint32_t /*flags*/) {
+  ParallelizeTiled<4>(threadpool, {range_i, range_j, range_k, range_l}, {1, 1, tile_k, tile_l},
+                      [&](const Index<4>& start, const Index<4>& size) {
+                        function(context, default_uarch_index,
+                                 start[0], start[1], start[2], start[3], size[2], size[3]);
+                      });
+}
+
+void pthreadpool_parallelize_5d(pthreadpool_t threadpool, pthreadpool_task_5d_t function, void* context,
+                                size_t range_i, size_t range_j, size_t range_k, size_t range_l, size_t range_m,
+                                uint32_t /*flags*/) {
+  ParallelizeTiled<5>(threadpool, {range_i, range_j, range_k, range_l, range_m}, {1, 1, 1, 1, 1},
+                      [&](const Index<5>& start, const Index<5>& /*size*/) {
+                        function(context, start[0], start[1], start[2], start[3], start[4]);
+                      });
+}
+
+void pthreadpool_parallelize_5d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_5d_tile_1d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t range_m, size_t tile_m, uint32_t /*flags*/) {
+  ParallelizeTiled<5>(threadpool, {range_i, range_j, range_k, range_l, range_m}, {1, 1, 1, 1, tile_m},
+                      [&](const Index<5>& start, const Index<5>& size) {
+                        function(context, start[0], start[1], start[2], start[3], start[4], size[4]);
+                      });
+}
+
+void pthreadpool_parallelize_5d_tile_2d(pthreadpool_t threadpool, pthreadpool_task_5d_tile_2d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t range_m, size_t tile_l, size_t tile_m,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<5>(threadpool, {range_i, range_j, range_k, range_l, range_m}, {1, 1, 1, tile_l, tile_m},
+                      [&](const Index<5>& start, const Index<5>& size) {
+                        function(context, start[0], start[1], start[2], start[3], start[4], size[3], size[4]);
+                      });
+}
+
+void pthreadpool_parallelize_6d(pthreadpool_t threadpool, pthreadpool_task_6d_t function, void* context,
+                                size_t range_i, size_t range_j, size_t range_k, size_t range_l, size_t range_m,
+                                size_t range_n, uint32_t /*flags*/) {
+  ParallelizeTiled<6>(threadpool, {range_i, range_j, range_k, range_l, range_m, range_n}, {1, 1, 1, 1, 1, 1},
+                      [&](const Index<6>& start, const Index<6>& /*size*/) {
+                        function(context, start[0], start[1], start[2], start[3], start[4], start[5]);
+                      });
+}
+
+void pthreadpool_parallelize_6d_tile_1d(pthreadpool_t threadpool, pthreadpool_task_6d_tile_1d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t range_m, size_t range_n, size_t tile_n,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<6>(threadpool, {range_i, range_j, range_k, range_l, range_m, range_n}, {1, 1, 1, 1, 1, tile_n},
+                      [&](const Index<6>& start, const Index<6>& size) {
+                        function(context, start[0], start[1], start[2], start[3], start[4], start[5], size[5]);
+                      });
+}
+
+void pthreadpool_parallelize_6d_tile_2d(pthreadpool_t threadpool, pthreadpool_task_6d_tile_2d_t function,
+                                        void* context, size_t range_i, size_t range_j, size_t range_k,
+                                        size_t range_l, size_t range_m, size_t range_n, size_t tile_m, size_t tile_n,
+                                        uint32_t /*flags*/) {
+  ParallelizeTiled<6>(threadpool, {range_i, range_j, range_k, range_l, range_m, range_n},
+                      {1, 1, 1, 1, tile_m, tile_n},
+                      [&](const Index<6>& start, const Index<6>& size) {
+                        function(context, start[0], start[1], start[2], start[3], start[4], start[5],
+                                 size[4], size[5]);
+                      });
+}
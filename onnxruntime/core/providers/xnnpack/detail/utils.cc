@@ -92,8 +92,12 @@ QuantizedOpType GetQuantizedOpType(const NodeUnit& node_unit) {
       return QuantizedOpType::QDQAvgPool;
     else if (op_type == "Softmax")
       return QuantizedOpType::QDQSoftmax;
+    else if (op_type == "MatMul")
+      return QuantizedOpType::QDQMatMul;
   } else if (node_unit.OpType() == "QLinearConv") {
     return QuantizedOpType::QLinearConv;
+  } else if (node_unit.OpType() == "QLinearMatMul") {
+    return QuantizedOpType::QLinearMatMul;
   }
   return QuantizedOpType::Unknown;
 }
@@ -111,6 +115,7 @@ static const std::unordered_map<QuantizedOpType, ONNXOpType> qdq_to_onnx_type_ma
     {QuantizedOpType::QDQAvgPool, "QLinearAveragePool"},
     {QuantizedOpType::QDQSoftmax, "QLinearSoftmax"},
     {QuantizedOpType::QDQMaxPool, "MaxPool"},
+    {QuantizedOpType::QDQMatMul, "QLinearMatMul"},
 };
 
 std::unique_ptr<IndexedSubGraph::MetaDef> FuseQDQGroup(const NodeUnit& node_unit) {
@@ -128,7 +133,7 @@ std::unique_ptr<IndexedSubGraph::MetaDef> FuseQDQGroup(const NodeUnit& node_unit
   // x x-scale x-zp w w-scale w-zp. Some QDQops wouldn't have 9 inputs,
   // but the 5 more unit extra memory is not too expensive
   def.inputs.reserve(9);
-  if (qtype == QuantizedOpType::QDQConv) {
+  if (qtype == QuantizedOpType::QDQConv || qtype == QuantizedOpType::QDQMatMul) {
     std::for_each(inputs.cbegin(), inputs.cbegin() + 2,
                   [&def](const NodeUnitIODef& arg) {
                     // keep the number of inputs the same by inserting an empty string for a missing optional input
@@ -146,6 +151,12 @@ std::unique_ptr<IndexedSubGraph::MetaDef> FuseQDQGroup(const NodeUnit& node_unit
     if (inputs.size() > 2) {
       def.inputs.push_back(inputs[2].node_arg.Name());
     }
+
+    // layout insensitive. QLinearMatMul is an ONNX operator so the fused node can use the ONNX schema.
+    if (qtype == QuantizedOpType::QDQMatMul) {
+      def.domain = kOnnxDomain;
+      def.since_version = 10;
+    }
   } else if (qtype == QuantizedOpType::QDQAvgPool || qtype == QuantizedOpType::QDQSoftmax) {
     // x x-scale x-zp
     std::for_each(inputs.cbegin(), inputs.cend(),
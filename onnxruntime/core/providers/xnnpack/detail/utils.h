@@ -49,11 +49,13 @@ enum class QuantizedOpType : uint8_t {
   QLinearConv,
   QLinearMaxPool,
   QlinearAvgPool,
+  QLinearMatMul,
   // QDQ operator
   QDQConv,
   QDQMaxPool,
   QDQAvgPool,
   QDQSoftmax,
+  QDQMatMul,
   Unknown,
 };
 
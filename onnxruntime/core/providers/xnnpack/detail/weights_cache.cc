@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/detail/weights_cache.h"
+
+#include "core/common/logging/logging.h"
+#include "core/framework/allocator_stats.h"
+#include "core/framework/murmurhash3.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+namespace {
+// initial size of the cache buffer. it grows as needed until the cache is finalized.
+constexpr size_t kInitialWeightsCacheSize = 1024 * 1024;
+}  // namespace
+
+std::shared_ptr<WeightsCache> WeightsCache::GetShared() {
+  static std::mutex mutex;
+  static std::weak_ptr<WeightsCache> instance;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto cache = instance.lock();
+  if (!cache) {
+    cache = std::shared_ptr<WeightsCache>(new WeightsCache());
+    instance = cache;
+  }
+
+  return cache;
+}
+
+WeightsCache::WeightsCache() {
+  xnn_status status = xnn_create_weights_cache_with_size(kInitialWeightsCacheSize, &weights_cache_);
+  ORT_ENFORCE(status == xnn_status_success, "xnn_create_weights_cache_with_size returned ", status);
+}
+
+WeightsCache::~WeightsCache() {
+  xnn_delete_weights_cache(weights_cache_);
+}
+
+std::string WeightsCache::CreateKey(const std::string& op_type, gsl::span<const Tensor* const> weights) {
+  uint32_t hash[4] = {0, 0, 0, 0};
+  for (const Tensor* weight : weights) {
+    if (weight != nullptr) {
+      MurmurHash3::x86_128(weight->DataRaw(), gsl::narrow<int>(weight->SizeInBytes()), hash[0], &hash);
+    }
+  }
+
+  uint64_t hash_value = hash[0] | (uint64_t(hash[1]) << 32);
+  return op_type + "+" + std::to_string(hash_value);
+}
+
+Status WeightsCache::CreateOperator(const std::string& key, int64_t weights_size,
+                                    const std::function<Status(xnn_caches_t)>& create_fn, int64_t& bytes_saved) {
+  bytes_saved = 0;
+  std::lock_guard<std::mutex> create_lock(create_mutex_);
+
+  // the cache takes new weights, which may move its buffer, only until it is finalized. a finalized cache is only
+  // looked up, so running operators can keep going. finalization takes the lock exclusively, so the state can't
+  // change while either lock is held.
+  std::shared_lock<std::shared_mutex> lookup_lock(mutex_, std::defer_lock);
+  std::unique_lock<std::shared_mutex> insert_lock(mutex_, std::defer_lock);
+  if (finalized_.load(std::memory_order_acquire)) {
+    lookup_lock.lock();
+  } else {
+    insert_lock.lock();
+  }
+
+  const bool in_cache = weights_sizes_.count(key) != 0;
+  xnn_caches caches = {nullptr, weights_cache_};
+  Status status = create_fn(&caches);
+  if (!status.IsOK()) {
+    // a finalized cache can't take new weights. fall back to packed weights owned by the operator.
+    if (!finalized_) {
+      return status;
+    }
+
+    LOGS_DEFAULT(VERBOSE) << "Weights of " << key << " were not added to the finalized XNNPACK weights cache: "
+                          << status.ErrorMessage();
+    return create_fn(nullptr);
+  }
+
+  if (in_cache) {
+    bytes_saved = weights_size;
+    bytes_saved_ += bytes_saved;
+  } else {
+    weights_sizes_.emplace(key, weights_size);
+    bytes_in_use_ += weights_size;
+  }
+
+  return Status::OK();
+}
+
+std::shared_lock<std::shared_mutex> WeightsCache::LockForCompute() {
+  if (!finalized_.load(std::memory_order_acquire)) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!finalized_.load(std::memory_order_relaxed)) {
+      // soft finalization keeps enough space to look up the weights of operators created later
+      xnn_status status = xnn_finalize_weights_cache(weights_cache_, xnn_weights_cache_finalization_kind_soft);
+      ORT_ENFORCE(status == xnn_status_success, "xnn_finalize_weights_cache returned ", status);
+      finalized_.store(true, std::memory_order_release);
+    }
+  }
+
+  return std::shared_lock<std::shared_mutex>(mutex_);
+}
+
+void WeightsCache::GetStats(AllocatorStats& stats) const {
+  std::lock_guard<std::mutex> lock(create_mutex_);
+  stats.bytes_in_use = bytes_in_use_;
+  stats.total_allocated_bytes = stats.bytes_in_use;
+  stats.bytes_saved_by_sharing = bytes_saved_;
+}
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
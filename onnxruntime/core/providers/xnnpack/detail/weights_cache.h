@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <xnnpack.h>
+
+#include "core/common/common.h"
+#include "gsl/gsl"
+
+namespace onnxruntime {
+struct AllocatorStats;
+class Tensor;
+
+namespace xnnpack {
+
+// Process wide xnnpack weights cache that allows the xnnpack operators of different sessions (or different nodes in
+// one session) to share packed weights.
+//
+// xnnpack hashes the packed weights of an operator created with the cache and re-uses an existing identical entry,
+// so a model loaded by N sessions keeps a single copy of its packed weights instead of N.
+//
+// xnnpack only runs operators created with a weights cache once the cache is finalized, so the cache is soft
+// finalized before the first operator that uses it is run. A soft finalized cache still finds the weights of later
+// operators that are already in it. Weights that are new once the cache is finalized can't be added to it, and those
+// operators get private packed weights instead.
+//
+// Adding weights can move the cache buffer, so setup/run of an operator that uses the cache must hold the shared lock
+// from LockForCompute(), and operator creation takes the lock exclusively while the cache can still take new weights.
+// Once the cache is finalized its buffer no longer moves: operator creation only looks weights up and takes the lock
+// shared, so sessions that create kernels don't block the sessions that are running. Operator creation is serialized
+// separately, as xnnpack packs the weights of every operator into the same scratch space of a finalized cache.
+class WeightsCache {
+ public:
+  // Get the process wide instance. It is created on first use and released when the last user releases it.
+  static std::shared_ptr<WeightsCache> GetShared();
+
+  ~WeightsCache();
+
+  // Create the key used to track the weights in the cache. Same scheme as the PrepackedWeightsContainer:
+  // the op type plus a hash of the weights before packing.
+  static std::string CreateKey(const std::string& op_type, gsl::span<const Tensor* const> weights);
+
+  // Call create_fn with the xnnpack caches to create an operator whose packed weights live in the cache.
+  // weights_size is the size of the weights before packing. bytes_saved is set to it if the same weights were
+  // already in the cache.
+  Status CreateOperator(const std::string& key, int64_t weights_size,
+                        const std::function<Status(xnn_caches_t)>& create_fn, int64_t& bytes_saved);
+
+  // Finalizes the cache on first use, then returns the lock to hold while setting up and running an operator.
+  [[nodiscard]] std::shared_lock<std::shared_mutex> LockForCompute();
+
+  // bytes_in_use is the size of the distinct weights in the cache and bytes_saved_by_sharing the total size of the
+  // weights that were found in the cache instead of being added to it. xnnpack doesn't expose the size of the packed
+  // weights, so both are measured before packing.
+  void GetStats(AllocatorStats& stats) const;
+
+ private:
+  WeightsCache();
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(WeightsCache);
+
+  // guards the cache buffer. see the class comment.
+  mutable std::shared_mutex mutex_;
+  xnn_weights_cache_t weights_cache_{nullptr};
+  std::atomic<bool> finalized_{false};
+
+  // serializes operator creation and guards the members below
+  mutable std::mutex create_mutex_;
+
+  // size of the weights for each key in the cache
+  std::unordered_map<std::string, int64_t> weights_sizes_;
+  int64_t bytes_in_use_ = 0;
+  int64_t bytes_saved_ = 0;
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,193 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/math/binary_elementwise.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/framework/op_kernel.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+namespace {
+// numpy-style broadcast of the two input shapes. returns false if the shapes are not compatible.
+bool ComputeBroadcastOutputShape(gsl::span<const int64_t> lhs, gsl::span<const int64_t> rhs,
+                                 TensorShapeVector& output_dims) {
+  const size_t rank = std::max(lhs.size(), rhs.size());
+  output_dims.resize(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    const int64_t l = i < rank - lhs.size() ? 1 : lhs[i - (rank - lhs.size())];
+    const int64_t r = i < rank - rhs.size() ? 1 : rhs[i - (rank - rhs.size())];
+    if (l == r || r == 1) {
+      output_dims[i] = l;
+    } else if (l == 1) {
+      output_dims[i] = r;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const char* OpKindToString(BinaryElementwise::OpKind kind) {
+  switch (kind) {
+    case BinaryElementwise::OpKind::Add:
+      return "add";
+    case BinaryElementwise::OpKind::Sub:
+      return "subtract";
+    case BinaryElementwise::OpKind::Mul:
+      return "multiply";
+    case BinaryElementwise::OpKind::Div:
+      return "divide";
+  }
+
+  return "unknown";
+}
+}  // namespace
+
+bool BinaryElementwise::IsBinaryElementwiseOnnxNodeSupported(const NodeUnit& node_unit,
+                                                             const GraphViewer& /*graph*/) {
+  bool supported = false;
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    // no QDQ support yet
+    if (node_unit.UnitType() != NodeUnit::Type::SingleNode) {
+      break;
+    }
+
+    const auto& inputs = node_unit.Inputs();
+    const auto* a_type = inputs[0].node_arg.TypeAsProto();
+    if (a_type == nullptr || a_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      break;
+    }
+
+    // the rank of both inputs must be known and within the xnnpack limit
+    const auto* a_shape = inputs[0].node_arg.Shape();
+    const auto* b_shape = inputs[1].node_arg.Shape();
+    if (!a_shape || !b_shape ||
+        a_shape->dim_size() > XNN_MAX_TENSOR_DIMS || b_shape->dim_size() > XNN_MAX_TENSOR_DIMS) {
+      break;
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+BinaryElementwise::BinaryElementwise(const OpKernelInfo& info) : XnnpackKernel(info) {
+  const auto& op_type = info.node().OpType();
+  if (op_type == "Add") {
+    op_kind_ = OpKind::Add;
+  } else if (op_type == "Sub") {
+    op_kind_ = OpKind::Sub;
+  } else if (op_type == "Mul") {
+    op_kind_ = OpKind::Mul;
+  } else if (op_type == "Div") {
+    op_kind_ = OpKind::Div;
+  } else {
+    ORT_THROW("unsupported element-wise operator in XnnpackEP: ", op_type);
+  }
+
+  const float output_min = -std::numeric_limits<float>::infinity();
+  const float output_max = std::numeric_limits<float>::infinity();
+
+  xnn_status status = xnn_status_invalid_state;
+  struct xnn_operator* p = nullptr;
+  switch (op_kind_) {
+    case OpKind::Add:
+      status = xnn_create_add_nd_f32(output_min, output_max, 0, &p);
+      break;
+    case OpKind::Sub:
+      status = xnn_create_subtract_nd_f32(output_min, output_max, 0, &p);
+      break;
+    case OpKind::Mul:
+      status = xnn_create_multiply_nd_f32(output_min, output_max, 0, &p);
+      break;
+    case OpKind::Div:
+      status = xnn_create_divide_nd_f32(output_min, output_max, 0, &p);
+      break;
+  }
+
+  ORT_ENFORCE(status == xnn_status_success, "xnn_create_", OpKindToString(op_kind_), "_nd_f32 failed. Status:",
+              status);
+  op0_.reset(p);
+}
+
+Status BinaryElementwise::Compute(OpKernelContext* context) const {
+  const Tensor& A = *context->Input<Tensor>(0);
+  const Tensor& B = *context->Input<Tensor>(1);
+  const auto a_dims = A.Shape().GetDims();
+  const auto b_dims = B.Shape().GetDims();
+
+  TensorShapeVector y_dims;
+  if (!ComputeBroadcastOutputShape(a_dims, b_dims, y_dims)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, Node().Name(), ": left operand cannot broadcast on dim. ",
+                           "LeftShape: ", A.Shape(), ", RightShape: ", B.Shape());
+  }
+
+  Tensor* Y = context->Output(0, TensorShape(y_dims));
+
+  // edge case. one or more dims with value of 0. nothing to do
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  InlinedVector<size_t, XNN_MAX_TENSOR_DIMS> a_shape(a_dims.begin(), a_dims.end());
+  InlinedVector<size_t, XNN_MAX_TENSOR_DIMS> b_shape(b_dims.begin(), b_dims.end());
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  xnn_status status = xnn_status_invalid_state;
+  switch (op_kind_) {
+    case OpKind::Add:
+      status = xnn_setup_add_nd_f32(op0_.get(), a_shape.size(), a_shape.data(), b_shape.size(), b_shape.data(),
+                                    A.Data<float>(), B.Data<float>(), Y->MutableData<float>(), t_pool);
+      break;
+    case OpKind::Sub:
+      status = xnn_setup_subtract_nd_f32(op0_.get(), a_shape.size(), a_shape.data(), b_shape.size(), b_shape.data(),
+                                         A.Data<float>(), B.Data<float>(), Y->MutableData<float>(), t_pool);
+      break;
+    case OpKind::Mul:
+      status = xnn_setup_multiply_nd_f32(op0_.get(), a_shape.size(), a_shape.data(), b_shape.size(), b_shape.data(),
+                                         A.Data<float>(), B.Data<float>(), Y->MutableData<float>(), t_pool);
+      break;
+    case OpKind::Div:
+      status = xnn_setup_divide_nd_f32(op0_.get(), a_shape.size(), a_shape.data(), b_shape.size(), b_shape.data(),
+                                       A.Data<float>(), B.Data<float>(), Y->MutableData<float>(), t_pool);
+      break;
+  }
+
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_", OpKindToString(op_kind_), "_nd_f32 returned ", status);
+  }
+
+  status = xnn_run_operator(op0_.get(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+  }
+
+  return Status::OK();
+}
+
+#define REGISTER_XNNPACK_BINARY_ELEMENTWISE_KERNEL(op)                                                            \
+  ONNX_OPERATOR_VERSIONED_KERNEL_EX(op, kOnnxDomain, 7, 12, kXnnpackExecutionProvider,                            \
+                                    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()), \
+                                    BinaryElementwise);                                                           \
+  ONNX_OPERATOR_VERSIONED_KERNEL_EX(op, kOnnxDomain, 13, 13, kXnnpackExecutionProvider,                           \
+                                    KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()), \
+                                    BinaryElementwise);                                                           \
+  ONNX_OPERATOR_KERNEL_EX(op, kOnnxDomain, 14, kXnnpackExecutionProvider,                                         \
+                          KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),           \
+                          BinaryElementwise);
+
+REGISTER_XNNPACK_BINARY_ELEMENTWISE_KERNEL(Add)
+REGISTER_XNNPACK_BINARY_ELEMENTWISE_KERNEL(Sub)
+REGISTER_XNNPACK_BINARY_ELEMENTWISE_KERNEL(Mul)
+REGISTER_XNNPACK_BINARY_ELEMENTWISE_KERNEL(Div)
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
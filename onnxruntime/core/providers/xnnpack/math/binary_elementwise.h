@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/providers/xnnpack/xnnpack_kernel.h"
+#include "core/providers/xnnpack/detail/utils.h"
+
+namespace onnxruntime {
+class GraphViewer;
+namespace xnnpack {
+
+// fp32 Add/Sub/Mul/Div with numpy-style broadcasting.
+class BinaryElementwise : public XnnpackKernel {
+ public:
+  enum class OpKind : uint8_t {
+    Add,
+    Sub,
+    Mul,
+    Div,
+  };
+
+  BinaryElementwise(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* /*context*/) const override;
+
+  static bool IsBinaryElementwiseOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph);
+
+ private:
+  OpKind op_kind_;
+  XnnpackOperator op0_ = nullptr;
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/math/gemm.h"
+
+#include <limits>
+
+#include "core/framework/op_kernel.h"
+#include "core/framework/op_node_proto_helper.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+bool Gemm::IsGemmOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph) {
+  bool supported = false;
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    // no QDQ Gemm support yet
+    if (node_unit.UnitType() != NodeUnit::Type::SingleNode) {
+      break;
+    }
+
+    const auto& inputs = node_unit.Inputs();
+    const auto& a_arg = inputs[0].node_arg;
+    const auto& b_arg = inputs[1].node_arg;
+
+    const auto* a_type = a_arg.TypeAsProto();
+    if (a_type == nullptr || a_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      break;
+    }
+
+    const auto* a_shape = a_arg.Shape();
+    if (!a_shape || a_shape->dim_size() != 2) {
+      break;
+    }
+
+    ProtoHelperNodeContext nc(node_unit.GetNode());
+    OpNodeProtoHelper info(&nc);
+
+    int64_t trans_a = 0;
+    int64_t trans_b = 0;
+    float alpha = 1.f;
+    float beta = 1.f;
+    info.GetAttrOrDefault<int64_t>("transA", &trans_a, 0);
+    info.GetAttrOrDefault<int64_t>("transB", &trans_b, 0);
+    info.GetAttrOrDefault<float>("alpha", &alpha, 1.f);
+    info.GetAttrOrDefault<float>("beta", &beta, 1.f);
+
+    // xnnpack doesn't scale the output or the bias
+    if (trans_a != 0 || alpha != 1.f) {
+      break;
+    }
+
+    // B must be a constant 2D initializer so it can be packed when the kernel is created
+    const auto* b_tensor = graph.GetConstantInitializer(b_arg.Name(), true);
+    if (!b_tensor || b_tensor->dims_size() != 2) {
+      break;
+    }
+
+    const int64_t N = trans_b ? b_tensor->dims(0) : b_tensor->dims(1);
+
+    // C is used as the bias of the fully connected operator, so it must be a constant that is broadcast
+    // across the rows of the output
+    if (inputs.size() > 2 && inputs[2].node_arg.Exists()) {
+      if (beta != 1.f) {
+        break;
+      }
+
+      const auto* c_tensor = graph.GetConstantInitializer(inputs[2].node_arg.Name(), true);
+      if (!c_tensor) {
+        break;
+      }
+
+      const auto& c_dims = c_tensor->dims();
+      if (!((c_dims.size() == 1 && c_dims[0] == N) ||
+            (c_dims.size() == 2 && c_dims[0] == 1 && c_dims[1] == N))) {
+        break;
+      }
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+Gemm::Gemm(const OpKernelInfo& info) : XnnpackKernel(info) {
+  const auto& node{Node()};
+
+  int64_t trans_b = 0;
+  info.GetAttrOrDefault<int64_t>("transB", &trans_b, 0);
+  trans_B_ = trans_b != 0;
+
+  const Tensor* B = nullptr;
+  ORT_ENFORCE(info.TryGetConstantInput(1, &B),
+              "B input was not constant initializer. XNNPACK EP should not have asked for the node. Node name:",
+              node.Name());
+  K_ = trans_B_ ? B->Shape()[1] : B->Shape()[0];
+  N_ = trans_B_ ? B->Shape()[0] : B->Shape()[1];
+
+  const auto& input_defs = node.InputDefs();
+  bool has_bias = input_defs.size() == 3 && input_defs[2]->Exists();
+  ORT_ENFORCE(has_bias == false || info.TryGetConstantInput(2, &C_),
+              "Invalid Node with non-constant C input. XNNPACK EP should not have asked for the node. Node name:",
+              node.Name());
+
+  // have to delay creating the xnnpack kernel until PrePack as that is where we are given B in its final location.
+}
+
+Status Gemm::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr /*alloc*/,
+                     /*out*/ bool& is_packed,
+                     /*out*/ PrePackedWeights* /*prepacked_weights*/) {
+  is_packed = false;
+  if (input_idx != 1) {
+    return Status::OK();
+  }
+
+  const size_t input_channels = gsl::narrow<size_t>(K_);
+  const size_t output_channels = gsl::narrow<size_t>(N_);
+
+  // a transposed B is {N, K} which is the layout xnnpack expects by default
+  struct xnn_operator* p = nullptr;
+  const Tensor* weights[] = {&tensor, C_};
+  ORT_RETURN_IF_ERROR(CreateOperatorWithWeights(weights, [&](xnn_caches_t caches) {
+    xnn_status status = xnn_create_fully_connected_nc_f32(
+        input_channels, output_channels, input_channels, output_channels,
+        tensor.Data<float>(), C_ ? C_->Data<float>() : nullptr,
+        -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+        trans_B_ ? 0 : XNN_FLAG_TRANSPOSE_WEIGHTS, caches, &p);
+
+    if (status != xnn_status_success) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_create_fully_connected_nc_f32 returned ", status);
+    }
+
+    return Status::OK();
+  }));
+
+  op0_.reset(p);
+
+  // xnnpack has copied B into its own packed buffer
+  is_packed = true;
+
+  return Status::OK();
+}
+
+Status Gemm::Compute(OpKernelContext* context) const {
+  const Tensor& A = *context->Input<Tensor>(0);
+  const auto& a_shape = A.Shape();
+
+  if (a_shape.NumDimensions() != 2 || a_shape[1] != K_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Gemm dimension mismatch. A:", a_shape,
+                           " K: ", K_, " N: ", N_);
+  }
+
+  const int64_t M = a_shape[0];
+  Tensor* Y = context->Output(0, {M, N_});
+
+  // empty input or output. nothing to do
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  auto weights_lock = LockWeightsCache();
+  xnn_status status = xnn_setup_fully_connected_nc_f32(op0_.get(), gsl::narrow<size_t>(M),
+                                                       A.Data<float>(), Y->MutableData<float>(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_fully_connected_nc_f32 returned ", status);
+  }
+
+  status = xnn_run_operator(op0_.get(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Gemm, kOnnxDomain, 7, 8, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Gemm);
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Gemm, kOnnxDomain, 9, 10, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Gemm);
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Gemm, kOnnxDomain, 11, 12, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Gemm);
+
+ONNX_OPERATOR_KERNEL_EX(Gemm, kOnnxDomain, 13, kXnnpackExecutionProvider,
+                        KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                        Gemm);
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/framework/allocator.h"
+#include "core/providers/xnnpack/xnnpack_kernel.h"
+#include "core/providers/xnnpack/detail/utils.h"
+
+namespace onnxruntime {
+class GraphViewer;
+namespace xnnpack {
+
+// fp32 Gemm with constant B and an optional constant C of shape {N} or {1, N}, implemented with the xnnpack
+// fully connected operator. alpha and beta must be 1 and A must not be transposed.
+class Gemm : public XnnpackKernel {
+ public:
+  Gemm(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* /*context*/) const override;
+
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  static bool IsGemmOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph);
+
+ private:
+  bool trans_B_ = false;
+  int64_t K_ = 0;
+  int64_t N_ = 0;
+  const Tensor* C_{nullptr};
+
+  XnnpackOperator op0_ = nullptr;
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
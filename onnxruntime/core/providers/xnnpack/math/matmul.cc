@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/math/matmul.h"
+
+#include <limits>
+
+#include "core/framework/op_kernel.h"
+#include "core/graph/graph_viewer.h"
+#include "core/optimizer/initializer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+std::pair<const onnx::TensorProto*, const onnx::TensorProto*>
+GetQuantizationZeroPointAndScale(const GraphViewer& graphview,
+                                 const NodeUnitIODef& io_def);
+namespace {
+bool IsQuantizedMatMul(QuantizedOpType quant_op_type) {
+  return (quant_op_type == QuantizedOpType::QLinearMatMul) ||
+         (quant_op_type == QuantizedOpType::QDQMatMul);
+}
+
+// xnnpack supports qs8 and qu8 with per-tensor quantization.
+// the qs8 kernel has no zero point for the weight, so B must be symmetrically quantized.
+bool IsValidQuantMatMul(const NodeUnit& node_unit, const GraphViewer& graph) {
+  bool supported = false;
+  do {
+    TensorQuantType a_input_type = GetTensorQuantType(node_unit, 0, false, graph);
+    TensorQuantType b_input_type = GetTensorQuantType(node_unit, 1, false, graph);
+    TensorQuantType output_type = GetTensorQuantType(node_unit, 0, true, graph);
+    if (a_input_type != b_input_type || a_input_type != output_type ||
+        (a_input_type != TensorTypeUint8 && a_input_type != TensorTypeInt8)) {
+      break;
+    }
+
+    if (a_input_type == TensorTypeInt8) {
+      auto [scale_tensor, zero_tensor] = GetQuantizationZeroPointAndScale(graph, node_unit.Inputs()[1]);
+      if (zero_tensor) {
+        Initializer b_zp(*zero_tensor, node_unit.ModelPath());
+        if (b_zp.DataAsSpan<int8_t>()[0] != 0) {
+          break;
+        }
+      }
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+}  // namespace
+
+bool MatMul::IsMatMulOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph) {
+  bool supported = false;
+  auto qtype = GetQuantizedOpType(node_unit);
+  if (IsQuantizedMatMul(qtype) && IsValidQuantMatMul(node_unit, graph) == false) {
+    return false;
+  }
+
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    const auto& inputs = node_unit.Inputs();
+    const auto& a_arg = inputs[0].node_arg;
+    const auto& b_arg = inputs[1].node_arg;
+
+    const auto* a_type = a_arg.TypeAsProto();
+    if (a_type == nullptr ||
+        (a_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT &&
+         !IsQuantizedMatMul(qtype))) {
+      break;
+    }
+
+    // A must be at least 2D. a 1D A removes a dimension from the output which the fully connected operator
+    // doesn't do.
+    const auto* a_shape = a_arg.Shape();
+    if (!a_shape || a_shape->dim_size() < 2) {
+      break;
+    }
+
+    // B must be a constant 2D initializer so it can be packed when the kernel is created
+    const auto* b_tensor = graph.GetConstantInitializer(b_arg.Name(), true);
+    if (!b_tensor || b_tensor->dims_size() != 2) {
+      break;
+    }
+
+    const auto& a_k_dim = a_shape->dim(a_shape->dim_size() - 1);
+    if (a_k_dim.has_dim_value() && a_k_dim.dim_value() != b_tensor->dims(0)) {
+      break;
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+MatMul::MatMul(const OpKernelInfo& info) : XnnpackKernel(info) {
+  const auto& node{Node()};
+  const NodeArg& A = *node.InputDefs()[0];
+
+  auto input_dtype = A.TypeAsProto()->tensor_type().elem_type();
+  if (input_dtype == ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+    op_type_ = OpComputeType::op_compute_type_fp32;
+  } else if (input_dtype == ONNX_NAMESPACE::TensorProto_DataType_INT8) {
+    b_index_ = 3;
+    quant_param_ = ParseQuantParamForOp(info, input_dtype, 2);
+    op_type_ = OpComputeType::op_compute_type_qs8;
+  } else if (input_dtype == ONNX_NAMESPACE::TensorProto_DataType_UINT8) {
+    b_index_ = 3;
+    quant_param_ = ParseQuantParamForOp(info, input_dtype, 2);
+    op_type_ = OpComputeType::op_compute_type_qu8;
+  } else {
+    auto stype = DataTypeImpl::ToString(DataTypeImpl::TypeFromProto(*A.TypeAsProto()));
+    ORT_THROW("unsupported MatMul in XnnpackEP, we have FLOAT|UINT8|INT8, but got ", stype);
+  }
+
+  const Tensor* B = nullptr;
+  ORT_ENFORCE(info.TryGetConstantInput(b_index_, &B),
+              "B input was not constant initializer. XNNPACK EP should not have asked for the node. Node name:",
+              node.Name());
+  K_ = B->Shape()[0];
+  N_ = B->Shape()[1];
+
+  // have to delay creating the xnnpack kernel until PrePack as that is where we are given B in its final location.
+}
+
+Status MatMul::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr /*alloc*/,
+                       /*out*/ bool& is_packed,
+                       /*out*/ PrePackedWeights* /*prepacked_weights*/) {
+  is_packed = false;
+  if (input_idx != b_index_) {
+    return Status::OK();
+  }
+
+  // B is {K, N} which is {input_channels, output_channels}. xnnpack expects {output_channels, input_channels}
+  // unless XNN_FLAG_TRANSPOSE_WEIGHTS is set.
+  const size_t input_channels = gsl::narrow<size_t>(K_);
+  const size_t output_channels = gsl::narrow<size_t>(N_);
+  const uint32_t flags = XNN_FLAG_TRANSPOSE_WEIGHTS;
+
+  struct xnn_operator* p = nullptr;
+  const Tensor* weights[] = {&tensor};
+  ORT_RETURN_IF_ERROR(CreateOperatorWithWeights(weights, [&](xnn_caches_t caches) {
+    xnn_status status = xnn_status_invalid_state;
+    if (op_type_ == OpComputeType::op_compute_type_fp32) {
+      status = xnn_create_fully_connected_nc_f32(
+          input_channels, output_channels, input_channels, output_channels,
+          tensor.Data<float>(), nullptr,
+          -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+          flags, caches, &p);
+    } else if (op_type_ == OpComputeType::op_compute_type_qs8) {
+      status = xnn_create_fully_connected_nc_qs8(
+          input_channels, output_channels, input_channels, output_channels,
+          static_cast<int8_t>(quant_param_[0].second), quant_param_[0].first[0],
+          quant_param_[1].first[0], tensor.Data<int8_t>(), nullptr,
+          static_cast<int8_t>(quant_param_[2].second), quant_param_[2].first[0],
+          std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max(),
+          flags, caches, &p);
+    } else if (op_type_ == OpComputeType::op_compute_type_qu8) {
+      status = xnn_create_fully_connected_nc_qu8(
+          input_channels, output_channels, input_channels, output_channels,
+          quant_param_[0].second, quant_param_[0].first[0],
+          quant_param_[1].second, quant_param_[1].first[0], tensor.Data<uint8_t>(), nullptr,
+          quant_param_[2].second, quant_param_[2].first[0],
+          std::numeric_limits<uint8_t>::min(), std::numeric_limits<uint8_t>::max(),
+          flags, caches, &p);
+    }
+
+    if (status != xnn_status_success) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_create_fully_connected_nc_",
+                             OpTypeToString(op_type_), " returned ", status);
+    }
+
+    return Status::OK();
+  }));
+
+  op0_.reset(p);
+
+  // xnnpack has copied B into its own packed buffer
+  is_packed = true;
+
+  return Status::OK();
+}
+
+Status MatMul::Compute(OpKernelContext* context) const {
+  const Tensor& A = *context->Input<Tensor>(0);
+  const auto& a_shape = A.Shape();
+  const size_t rank = a_shape.NumDimensions();
+
+  if (a_shape[rank - 1] != K_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "MatMul dimension mismatch. A:", a_shape,
+                           " B: {", K_, ",", N_, "}");
+  }
+
+  TensorShapeVector y_dims(a_shape.GetDims().begin(), a_shape.GetDims().end());
+  y_dims[rank - 1] = N_;
+  Tensor* Y = context->Output(0, TensorShape(y_dims));
+
+  // empty input or output. nothing to do
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  auto weights_lock = LockWeightsCache();
+  const size_t batch_size = gsl::narrow<size_t>(a_shape.SizeToDimension(rank - 1));
+
+  xnn_status status = xnn_status_invalid_state;
+  if (op_type_ == OpComputeType::op_compute_type_fp32) {
+    status = xnn_setup_fully_connected_nc_f32(op0_.get(), batch_size, A.Data<float>(), Y->MutableData<float>(),
+                                              t_pool);
+  } else if (op_type_ == OpComputeType::op_compute_type_qs8) {
+    status = xnn_setup_fully_connected_nc_qs8(op0_.get(), batch_size, A.Data<int8_t>(), Y->MutableData<int8_t>(),
+                                              t_pool);
+  } else if (op_type_ == OpComputeType::op_compute_type_qu8) {
+    status = xnn_setup_fully_connected_nc_qu8(op0_.get(), batch_size, A.Data<uint8_t>(), Y->MutableData<uint8_t>(),
+                                              t_pool);
+  }
+
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_fully_connected_nc_",
+                           OpTypeToString(op_type_), " returned ", status);
+  }
+
+  status = xnn_run_operator(op0_.get(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(MatMul, kOnnxDomain, 1, 8, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  MatMul);
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(MatMul, kOnnxDomain, 9, 12, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  MatMul);
+
+ONNX_OPERATOR_KERNEL_EX(MatMul, kOnnxDomain, 13, kXnnpackExecutionProvider,
+                        KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                        MatMul);
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    QLinearMatMul,
+    kOnnxDomain,
+    10,
+    uint8_t,
+    kXnnpackExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<uint8_t>())
+        .TypeConstraint("T2", DataTypeImpl::GetTensorType<uint8_t>())
+        .TypeConstraint("T3", DataTypeImpl::GetTensorType<uint8_t>()),
+    MatMul);
+
+ONNX_OPERATOR_TYPED_KERNEL_EX(
+    QLinearMatMul,
+    kOnnxDomain,
+    10,
+    int8_t,
+    kXnnpackExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", DataTypeImpl::GetTensorType<int8_t>())
+        .TypeConstraint("T2", DataTypeImpl::GetTensorType<int8_t>())
+        .TypeConstraint("T3", DataTypeImpl::GetTensorType<int8_t>()),
+    MatMul);
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/framework/allocator.h"
+#include "core/providers/xnnpack/xnnpack_kernel.h"
+#include "core/providers/xnnpack/detail/utils.h"
+
+namespace onnxruntime {
+class GraphViewer;
+namespace xnnpack {
+
+// MatMul/QLinearMatMul with a constant 2D B input, implemented with the xnnpack fully connected operator.
+// A is treated as a batch of rows with B[0] elements each.
+class MatMul : public XnnpackKernel {
+ public:
+  MatMul(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* /*context*/) const override;
+
+  // the xnnpack operator packs B when it is created, so we create it in PrePack and let ORT release B.
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
+  static bool IsMatMulOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph);
+
+ private:
+  int b_index_ = 1;
+  int64_t K_ = 0;
+  int64_t N_ = 0;
+
+  XnnpackOperator op0_ = nullptr;
+  OpQuantParam quant_param_;
+  OpComputeType op_type_ = OpComputeType::op_compute_type_invalid;
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
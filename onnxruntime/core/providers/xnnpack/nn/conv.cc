@@ -370,16 +370,6 @@ Conv::Conv(const OpKernelInfo& info) : XnnpackKernel(info), conv_attrs_{info} {
       }
     }
   }
-  // xnnpack cache_code, unfortunately these definitions are only available in xnnpack/cache.h,
-#ifdef XNN_CACHE_ENABLE
-#if XNN_PLATFORM_JIT
-  xnn_init_code_cache(&code_cache_);
-  xnn_caches_.code_cache = &code_cache_;
-#endif
-  // TODO(Jicwen) enable weight-cache and code-cache
-  xnn_init_weights_cache(&weights_cache_);
-  xnn_caches_.weights_cache = &weights_cache_;
-#endif
   const auto& node{Node()};
 
   const auto& input_defs = node.InputDefs();
@@ -454,23 +444,20 @@ Status Conv::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
                                orig_shape[3],
                                orig_shape[1]};
 
-    packed_w_ = Tensor(tensor.DataType(), TensorShape(new_dims), std::move(alloc));
+    // the transposed weights are only needed until xnnpack has packed them into the operator
+    Tensor packed_w(tensor.DataType(), TensorShape(new_dims), std::move(alloc));
 
-    SingleAxisTranspose(perm, tensor, packed_w_, /*from*/ 1, /*to*/ 3);
+    SingleAxisTranspose(perm, tensor, packed_w, /*from*/ 1, /*to*/ 3);
 
     is_packed = true;
 
     // we can create the kernel now
     struct xnn_operator* p = nullptr;
-    auto ret = CreateXnnpackKernel(conv_attrs_, C_, M_, kernel_shape_, clip_min_max_, packed_w_,
-                                   B_, p,
-#ifdef XNN_CACHE_ENABLE
-                                   &xnn_caches_,
-#else
-                                   0,
-#endif
-                                   quant_param_, conv_type_);
-    ORT_RETURN_IF_ERROR(ret);
+    const Tensor* weights[] = {&packed_w, B_};
+    ORT_RETURN_IF_ERROR(CreateOperatorWithWeights(weights, [&](xnn_caches_t caches) {
+      return CreateXnnpackKernel(conv_attrs_, C_, M_, kernel_shape_, clip_min_max_, packed_w,
+                                 B_, p, caches, quant_param_, conv_type_);
+    }));
     op0_.reset(p);
   }
 
@@ -505,7 +492,8 @@ Status Conv::Compute(OpKernelContext* context) const {
   if (Y->Shape().Size() == 0) {
     return Status::OK();
   }
-  pthreadpool_t t_pool = GetThreadPool();
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  auto weights_lock = LockWeightsCache();
 
   xnn_status status = xnn_status_invalid_state;
   if (conv_type_ == OpComputeType::op_compute_type_fp32) {
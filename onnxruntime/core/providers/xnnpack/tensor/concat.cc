@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/tensor/concat.h"
+
+#include "core/framework/op_kernel.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+bool Concat::IsConcatOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& /*graph*/) {
+  bool supported = false;
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    if (node_unit.UnitType() != NodeUnit::Type::SingleNode) {
+      break;
+    }
+
+    const auto* x_type = node_unit.Inputs()[0].node_arg.TypeAsProto();
+    if (x_type == nullptr || x_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      break;
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+Status Concat::Compute(OpKernelContext* context) const {
+  const int input_count = Node().InputArgCount().front();
+
+  InlinedTensorsVector input_tensors;
+  input_tensors.reserve(input_count);
+  for (int i = 0; i < input_count; ++i) {
+    input_tensors.push_back(context->Input<Tensor>(i));
+  }
+
+  Prepare p;
+  ORT_RETURN_IF_ERROR(PrepareForCompute(context, input_tensors, p));
+
+  // Return at this point if output tensor is going to be empty
+  if (p.output_num_elements == 0) {
+    return Status::OK();
+  }
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  float* output = p.output_tensor->MutableData<float>();
+  const size_t output_stride = gsl::narrow<size_t>(p.output_axis_pitch);
+
+  // the strides of the copy operator are fixed when it is created, and they depend on the input shapes,
+  // so the operators are created per call. creation only records the parameters so this is cheap.
+  int64_t output_offset = 0;
+  for (const auto& input : p.inputs) {
+    if (input.num_elements == 0) {
+      continue;
+    }
+
+    const size_t channels = gsl::narrow<size_t>(input.axis_pitch);
+    const size_t batch_size = gsl::narrow<size_t>(input.num_elements / input.axis_pitch);
+
+    struct xnn_operator* op = nullptr;
+    xnn_status status = xnn_create_copy_nc_x32(channels, channels, output_stride, 0, &op);
+    if (status != xnn_status_success) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_create_copy_nc_x32 returned ", status);
+    }
+
+    XnnpackOperator copy_op(op);
+    status = xnn_setup_copy_nc_x32(copy_op.get(), batch_size, input.tensor->Data<float>(), output + output_offset,
+                                   t_pool);
+    if (status != xnn_status_success) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_copy_nc_x32 returned ", status);
+    }
+
+    status = xnn_run_operator(copy_op.get(), t_pool);
+    if (status != xnn_status_success) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+    }
+
+    output_offset += input.axis_pitch;
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Concat, kOnnxDomain, 4, 10, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Concat);
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Concat, kOnnxDomain, 11, 12, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Concat);
+
+ONNX_OPERATOR_KERNEL_EX(Concat, kOnnxDomain, 13, kXnnpackExecutionProvider,
+                        KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                        Concat);
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
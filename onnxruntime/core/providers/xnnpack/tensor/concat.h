@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/providers/xnnpack/xnnpack_kernel.h"
+#include "core/providers/cpu/tensor/concatbase.h"
+#include "core/providers/xnnpack/detail/utils.h"
+
+namespace onnxruntime {
+class GraphViewer;
+namespace xnnpack {
+
+// fp32 Concat. each input is copied into its slice of the output with an xnnpack strided copy operator.
+class Concat : public XnnpackKernel, public ConcatBase {
+ public:
+  Concat(const OpKernelInfo& info) : XnnpackKernel(info), ConcatBase(info) {}
+
+  Status Compute(OpKernelContext* /*context*/) const override;
+
+  static bool IsConcatOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph);
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/tensor/resize.h"
+
+#include <cmath>
+
+#include "core/framework/op_kernel.h"
+#include "core/framework/op_node_proto_helper.h"
+#include "core/graph/graph_viewer.h"
+#include "core/optimizer/initializer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+namespace {
+// xnnpack derives the sampling ratio from the input and output sizes. when the output size is computed from scales
+// ONNX uses the scale instead, so the two only agree if the scaled size is a whole number.
+bool IsWholeNumber(float value) {
+  return std::floor(value) == value;
+}
+
+bool GetCoordinateTransformationFlags(const std::string& mode, uint32_t& flags) {
+  if (mode == "half_pixel") {
+    flags = 0;
+  } else if (mode == "align_corners") {
+    flags = XNN_FLAG_ALIGN_CORNERS;
+  } else if (mode == "asymmetric") {
+    flags = XNN_FLAG_TENSORFLOW_LEGACY_MODE;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+// helper to check whether an ONNX Resize node is supported by the NHWC version
+// if this returns true, the layout transformer will be run by GraphPartitioner to convert the first input/output and
+// the constant scales/sizes to NHWC format, and move the node to the internal NHWC domain.
+bool Resize::IsResizeOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& graph) {
+  bool supported = false;
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    // Resize-10 has the scales as input 1 which the layout transformer doesn't convert to NHWC
+    if (node_unit.UnitType() != NodeUnit::Type::SingleNode || node_unit.SinceVersion() < 11) {
+      break;
+    }
+
+    const auto& inputs = node_unit.Inputs();
+    const auto& x_arg = inputs[0].node_arg;
+
+    const auto* x_type = x_arg.TypeAsProto();
+    if (x_type == nullptr || x_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      break;
+    }
+
+    // we only support 2D (4 dims with batch and channel)
+    const auto* x_shape = x_arg.Shape();
+    if (!x_shape || x_shape->dim_size() != 4) {
+      break;
+    }
+
+    // require C, H, W to be known so we can construct the xnnpack kernel prior to Compute and validate the scales
+    if (!x_shape->dim(1).has_dim_value() ||
+        !x_shape->dim(2).has_dim_value() ||
+        !x_shape->dim(3).has_dim_value()) {
+      break;
+    }
+
+    ProtoHelperNodeContext nc(node_unit.GetNode());
+    OpNodeProtoHelper info(&nc);
+
+    std::string mode;
+    std::string coordinate_transformation_mode;
+    info.GetAttrOrDefault<std::string>("mode", &mode, "nearest");
+    info.GetAttrOrDefault<std::string>("coordinate_transformation_mode", &coordinate_transformation_mode,
+                                       "half_pixel");
+    uint32_t flags = 0;
+    if (mode != "linear" || !GetCoordinateTransformationFlags(coordinate_transformation_mode, flags)) {
+      break;
+    }
+
+    // scales or sizes must be constant so the layout transformer converts them to NHWC
+    const ONNX_NAMESPACE::TensorProto* scales = nullptr;
+    const ONNX_NAMESPACE::TensorProto* sizes = nullptr;
+    if (inputs.size() > 2 && inputs[2].node_arg.Exists()) {
+      scales = graph.GetConstantInitializer(inputs[2].node_arg.Name(), true);
+      if (!scales) {
+        break;
+      }
+    }
+
+    if (inputs.size() > 3 && inputs[3].node_arg.Exists()) {
+      sizes = graph.GetConstantInitializer(inputs[3].node_arg.Name(), true);
+      if (!sizes) {
+        break;
+      }
+    }
+
+    const int64_t C = x_shape->dim(1).dim_value();
+    const int64_t H = x_shape->dim(2).dim_value();
+    const int64_t W = x_shape->dim(3).dim_value();
+
+    if (scales && scales->dims_size() == 1 && scales->dims(0) == 4) {
+      Initializer scales_values(*scales, node_unit.ModelPath());
+      auto s = scales_values.DataAsSpan<float>();
+      if (s[0] != 1.f || s[1] != 1.f || !IsWholeNumber(H * s[2]) || !IsWholeNumber(W * s[3])) {
+        break;
+      }
+    } else if (sizes && sizes->dims_size() == 1 && sizes->dims(0) == 4) {
+      Initializer sizes_values(*sizes, node_unit.ModelPath());
+      auto s = sizes_values.DataAsSpan<int64_t>();
+      // the batch size is checked in Compute as it may be symbolic
+      if (s[1] != C) {
+        break;
+      }
+    } else {
+      break;
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+Resize::Resize(const OpKernelInfo& info) : XnnpackKernel(info) {
+  const auto& node{Node()};
+  const NodeArg& X = *node.InputDefs()[0];
+  // input is NHWC. op support checker made sure C dim was known
+  const size_t channels = gsl::narrow<size_t>(X.Shape()->dim(3).dim_value());
+
+  // the constant scales or sizes have been converted to NHWC by the layout transformer
+  const Tensor* scales = nullptr;
+  const Tensor* sizes = nullptr;
+  if (info.TryGetConstantInput(2, &scales) && scales->Shape().Size() == 4) {
+    auto s = scales->DataAsSpan<float>();
+    scales_.assign(s.begin(), s.end());
+  } else {
+    ORT_ENFORCE(info.TryGetConstantInput(3, &sizes) && sizes->Shape().Size() == 4,
+                "Resize requires constant scales or sizes. XNNPACK EP should not have asked for the node. Node name:",
+                node.Name());
+    auto s = sizes->DataAsSpan<int64_t>();
+    sizes_.assign(s.begin(), s.end());
+  }
+
+  std::string coordinate_transformation_mode =
+      info.GetAttrOrDefault<std::string>("coordinate_transformation_mode", "half_pixel");
+  uint32_t flags = 0;
+  ORT_ENFORCE(GetCoordinateTransformationFlags(coordinate_transformation_mode, flags),
+              "Unsupported coordinate_transformation_mode of ", coordinate_transformation_mode);
+
+  struct xnn_operator* p = nullptr;
+  xnn_status status = xnn_create_resize_bilinear2d_nhwc_f32(channels, channels, channels, flags, &p);
+  ORT_ENFORCE(status == xnn_status_success, "xnn_create_resize_bilinear2d_nhwc_f32 failed. Status:", status);
+  op0_.reset(p);
+}
+
+Status Resize::Compute(OpKernelContext* context) const {
+  const Tensor& X = *context->Input<Tensor>(0);  // this is in NHWC format
+  const auto& x_shape = X.Shape();
+  const int64_t N = x_shape[0];
+  const int64_t H = x_shape[1];
+  const int64_t W = x_shape[2];
+  const int64_t C = x_shape[3];
+
+  int64_t output_h;
+  int64_t output_w;
+  if (!sizes_.empty()) {
+    if (sizes_[0] != N) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Resize of the batch dimension is not supported. Input:",
+                             x_shape, " sizes: {", sizes_[0], ",", sizes_[1], ",", sizes_[2], ",", sizes_[3], "}");
+    }
+
+    output_h = sizes_[1];
+    output_w = sizes_[2];
+  } else {
+    output_h = static_cast<int64_t>(scales_[1] * H);
+    output_w = static_cast<int64_t>(scales_[2] * W);
+  }
+
+  Tensor* Y = context->Output(0, {N, output_h, output_w, C});
+
+  // edge case. one or more dims with value of 0. nothing to do
+  if (X.Shape().Size() == 0 || Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  xnn_status status = xnn_setup_resize_bilinear2d_nhwc_f32(op0_.get(), N, H, W, output_h, output_w,
+                                                           X.Data<float>(), Y->MutableData<float>(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_resize_bilinear2d_nhwc_f32 returned ", status);
+  }
+
+  status = xnn_run_operator(op0_.get(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Resize, kMSInternalNHWCDomain, 11, 12, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T1", DataTypeImpl::GetTensorType<float>()),
+                                  Resize);
+
+ONNX_OPERATOR_KERNEL_EX(Resize, kMSInternalNHWCDomain, 13, kXnnpackExecutionProvider,
+                        KernelDefBuilder().TypeConstraint("T1", DataTypeImpl::GetTensorType<float>()),
+                        Resize);
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
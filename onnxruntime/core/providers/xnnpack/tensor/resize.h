@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/providers/xnnpack/xnnpack_kernel.h"
+#include "core/providers/xnnpack/detail/utils.h"
+
+namespace onnxruntime {
+class GraphViewer;
+namespace xnnpack {
+
+// fp32 2D bilinear Resize in NHWC layout. the layout transformer converts input 0, the output, and the constant
+// scales or sizes input to NHWC.
+class Resize : public XnnpackKernel {
+ public:
+  Resize(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* /*context*/) const override;
+
+  // check to see if an ONNX NCHW Resize node is supported by this implementation.
+  static bool IsResizeOnnxNodeSupported(const NodeUnit& nchw_nodeunit, const GraphViewer& graph);
+
+ private:
+  std::vector<float> scales_;
+  std::vector<int64_t> sizes_;
+  XnnpackOperator op0_ = nullptr;
+};
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/providers/xnnpack/tensor/transpose.h"
+
+#include "core/framework/op_kernel.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace xnnpack {
+
+bool Transpose::IsTransposeOnnxNodeSupported(const NodeUnit& node_unit, const GraphViewer& /*graph*/) {
+  bool supported = false;
+  // use do {} while(false) so it's easier to set a breakpoint on the return
+  do {
+    if (node_unit.UnitType() != NodeUnit::Type::SingleNode) {
+      break;
+    }
+
+    const auto& x_arg = node_unit.Inputs()[0].node_arg;
+    const auto* x_type = x_arg.TypeAsProto();
+    if (x_type == nullptr || x_type->tensor_type().elem_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      break;
+    }
+
+    const auto* x_shape = x_arg.Shape();
+    if (!x_shape || x_shape->dim_size() == 0 || x_shape->dim_size() > XNN_MAX_TENSOR_DIMS) {
+      break;
+    }
+
+    supported = true;
+  } while (false);
+
+  return supported;
+}
+
+Transpose::Transpose(const OpKernelInfo& info) : XnnpackKernel(info), TransposeBase(info) {
+  struct xnn_operator* p = nullptr;
+  xnn_status status = xnn_create_transpose_nd_x32(0, &p);
+  ORT_ENFORCE(status == xnn_status_success, "xnn_create_transpose_nd_x32 failed. Status:", status);
+  op0_.reset(p);
+}
+
+Status Transpose::Compute(OpKernelContext* context) const {
+  const Tensor& X = *context->Input<Tensor>(0);
+  const auto& x_shape = X.Shape();
+
+  TensorShapeVector y_dims;
+  InlinedVector<size_t> default_perm;
+  const InlinedVector<size_t>* p_perm = nullptr;
+  ORT_RETURN_IF_ERROR(ComputeOutputShape(X, y_dims, default_perm, p_perm));
+
+  Tensor* Y = context->Output(0, TensorShape(y_dims));
+
+  // edge case. one or more dims with value of 0. nothing to do
+  if (x_shape.Size() == 0) {
+    return Status::OK();
+  }
+
+  const size_t rank = x_shape.NumDimensions();
+  if (rank > XNN_MAX_TENSOR_DIMS) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Transpose input rank of ", rank,
+                           " exceeds the xnnpack limit of ", XNN_MAX_TENSOR_DIMS);
+  }
+
+  const auto x_dims = x_shape.GetDims();
+  InlinedVector<size_t, XNN_MAX_TENSOR_DIMS> input_shape(x_dims.begin(), x_dims.end());
+
+  pthreadpool_t t_pool = GetThreadPool(*context);
+  xnn_status status = xnn_setup_transpose_nd_x32(op0_.get(), X.DataRaw(), Y->MutableDataRaw(),
+                                                 rank, input_shape.data(), p_perm->data(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_setup_transpose_nd_x32 returned ", status);
+  }
+
+  status = xnn_run_operator(op0_.get(), t_pool);
+  if (status != xnn_status_success) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "xnn_run_operator returned ", status);
+  }
+
+  return Status::OK();
+}
+
+ONNX_OPERATOR_VERSIONED_KERNEL_EX(Transpose, kOnnxDomain, 1, 12, kXnnpackExecutionProvider,
+                                  KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                                  Transpose);
+
+ONNX_OPERATOR_KERNEL_EX(Transpose, kOnnxDomain, 13, kXnnpackExecutionProvider,
+                        KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+                        Transpose);
+
+}  // namespace xnnpack
+}  // namespace onnxruntime
@@ -10,7 +10,10 @@
 #include "xnnpack_execution_provider.h"
 #include "detail/utils.h"
 #include "detail/node_support_checker.h"
+#include "detail/weights_cache.h"
 
+#include "core/common/logging/logging.h"
+#include "core/framework/allocator_stats.h"
 #include "core/framework/compute_capability.h"
 #include "core/framework/kernel_registry.h"
 #include "core/providers/shared/node_unit/node_unit.h"
@@ -36,16 +39,57 @@ KernelCreateInfo BuildKernelCreateInfo<void>() {
   BuildKernelCreateInfo<                          \
       ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, Start, type, Op)>
 
+#define ONNX_KERNEL_CREATE_INFO_VERSIONED(Start, End, Op) \
+  BuildKernelCreateInfo<                                  \
+      ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, Start, End, Op)>
+
+#define ONNX_KERNEL_CREATE_INFO(Start, Op) \
+  BuildKernelCreateInfo<                   \
+      ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, Start, Op)>
+
+#define ONNX_KERNEL_CREATE_INFO_TYPED(Start, type, Op) \
+  BuildKernelCreateInfo<                               \
+      ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, Start, type, Op)>
+
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 11, Conv);
 class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 11, 11, MaxPool);
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 12, MaxPool);
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 11, AveragePool);
 class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 1, 12, Softmax);
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, Softmax);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 11, 12, Resize);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 13, Resize);
+
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 1, 8, MatMul);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 9, 12, MatMul);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, MatMul);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 7, 8, Gemm);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 9, 10, Gemm);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 11, 12, Gemm);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, Gemm);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 7, 12, Add);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, 13, Add);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 14, Add);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 7, 12, Sub);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, 13, Sub);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 14, Sub);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 7, 12, Mul);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, 13, Mul);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 14, Mul);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 7, 12, Div);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, 13, Div);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 14, Div);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 1, 12, Transpose);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, Transpose);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 4, 10, Concat);
+class ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 11, 12, Concat);
+class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, Concat);
 
 class ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 10, uint8_t, QLinearConv);
 class ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 10, int8_t, QLinearConv);
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kMSInternalNHWCDomain, 1, QLinearAveragePool);
+class ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 10, uint8_t, QLinearMatMul);
+class ONNX_OPERATOR_TYPED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 10, int8_t, QLinearMatMul);
 class ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider,
                                       kDynamicDomainByCreate, 1, QLinearSoftmax);
 
@@ -58,16 +102,42 @@ std::unique_ptr<KernelRegistry> RegisterKernels() {
       KERNEL_CREATE_INFO_VERSIONED(11, 11, MaxPool),
       KERNEL_CREATE_INFO(12, MaxPool),
       KERNEL_CREATE_INFO(11, AveragePool),
+      KERNEL_CREATE_INFO_VERSIONED(11, 12, Resize),
+      KERNEL_CREATE_INFO(13, Resize),
       // layout insensitive, use ONNX-domain directly
-      BuildKernelCreateInfo<
-          ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 13, Softmax)>,
-      BuildKernelCreateInfo<
-          ONNX_OPERATOR_VERSIONED_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kOnnxDomain, 1, 12, Softmax)>,
+      ONNX_KERNEL_CREATE_INFO(13, Softmax),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(1, 12, Softmax),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(1, 8, MatMul),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(9, 12, MatMul),
+      ONNX_KERNEL_CREATE_INFO(13, MatMul),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(7, 8, Gemm),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(9, 10, Gemm),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(11, 12, Gemm),
+      ONNX_KERNEL_CREATE_INFO(13, Gemm),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(7, 12, Add),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(13, 13, Add),
+      ONNX_KERNEL_CREATE_INFO(14, Add),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(7, 12, Sub),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(13, 13, Sub),
+      ONNX_KERNEL_CREATE_INFO(14, Sub),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(7, 12, Mul),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(13, 13, Mul),
+      ONNX_KERNEL_CREATE_INFO(14, Mul),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(7, 12, Div),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(13, 13, Div),
+      ONNX_KERNEL_CREATE_INFO(14, Div),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(1, 12, Transpose),
+      ONNX_KERNEL_CREATE_INFO(13, Transpose),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(4, 10, Concat),
+      ONNX_KERNEL_CREATE_INFO_VERSIONED(11, 12, Concat),
+      ONNX_KERNEL_CREATE_INFO(13, Concat),
 
       //  quantization op
       KERNEL_CREATE_INFO_TYPED(10, uint8_t, QLinearConv),
       KERNEL_CREATE_INFO_TYPED(10, int8_t, QLinearConv),
       KERNEL_CREATE_INFO(1, QLinearAveragePool),
+      ONNX_KERNEL_CREATE_INFO_TYPED(10, uint8_t, QLinearMatMul),
+      ONNX_KERNEL_CREATE_INFO_TYPED(10, int8_t, QLinearMatMul),
       BuildKernelCreateInfo<
           ONNX_OPERATOR_KERNEL_CLASS_NAME(kXnnpackExecutionProvider, kDynamicDomainByCreate, 1, QLinearSoftmax)>,
   };
@@ -87,14 +157,34 @@ std::unique_ptr<KernelRegistry> RegisterKernels() {
 using namespace xnnpack;
 
 XnnpackExecutionProvider::XnnpackExecutionProvider(const XnnpackExecutionProviderInfo& info)
-    : IExecutionProvider{kXnnpackExecutionProvider, true} {
-  if (info.xnn_thread_pool_size > 1) {
-    // pthreadpool is independent of ort-threadpoool, so we have to disable cpu spinning for ort-threadpool.
-    // otherwise, the pthreadpool will be starved and harm performance a lot.
-    xnnpack_thread_pool_ = pthreadpool_create(static_cast<size_t>(info.xnn_thread_pool_size));
+    : IExecutionProvider{kXnnpackExecutionProvider, true},
+      enable_float_matmul_and_binary_ops_{info.enable_float_matmul_and_binary_ops} {
+  if (info.share_packed_weights) {
+    weights_cache_ = WeightsCache::GetShared();
   }
 }
 
+void XnnpackExecutionProvider::GetWeightsSharingStats(AllocatorStats& stats) const {
+  stats.Clear();
+  if (weights_cache_) {
+    weights_cache_->GetStats(stats);
+  }
+
+  stats.bytes_saved_by_sharing = bytes_saved_by_sharing_;
+}
+
+common::Status XnnpackExecutionProvider::OnSessionInitializationEnd() {
+  if (weights_cache_) {
+    AllocatorStats stats;
+    GetWeightsSharingStats(stats);
+    LOGS_DEFAULT(INFO) << "XNNPACK weights sharing saved " << stats.bytes_saved_by_sharing
+                       << " bytes of packed weights. The shared weights cache holds " << stats.bytes_in_use
+                       << " bytes.";
+  }
+
+  return Status::OK();
+}
+
 // implement RegisterAllocator to test/validate sharing the CPU EP's allocator
 void XnnpackExecutionProvider::RegisterAllocator(AllocatorManager& allocator_manager) {
   OrtDevice cpu_device{OrtDevice::CPU, OrtDevice::MemType::DEFAULT, DEFAULT_CPU_ALLOCATOR_DEVICE_ID};
@@ -191,7 +281,7 @@ std::vector<std::unique_ptr<ComputeCapability>> XnnpackExecutionProvider::GetCap
 
   std::shared_ptr<KernelRegistry> registry = GetKernelRegistry();
   std::unordered_map<const Node*, const NodeUnit*> supported_node_unit_map;
-  NodeSupportChecker checker{graph, supported_node_unit_map};
+  NodeSupportChecker checker{graph, supported_node_unit_map, enable_float_matmul_and_binary_ops_};
   std::unordered_map<const NodeUnit*, ComputeCapability*> node_to_compute_capability;
 
   // Get all the NodeUnits in the GraphViewer so we can check if something is in a QDQ node group
@@ -284,7 +374,6 @@ std::shared_ptr<KernelRegistry> XnnpackExecutionProvider::GetKernelRegistry() co
 
 XnnpackExecutionProvider::~XnnpackExecutionProvider() {
   xnn_deinitialize();
-  pthreadpool_destroy(xnnpack_thread_pool_);
 }
 
 }  // namespace onnxruntime
@@ -4,22 +4,51 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "core/framework/allocatormgr.h"
 #include "core/framework/execution_provider.h"
 #include "core/graph/constants.h"
 #include "core/providers/providers.h"
 
-struct pthreadpool;
 namespace onnxruntime {
-// placeholder for future use. no options currently
+namespace xnnpack {
+class WeightsCache;
+}
+
 struct XnnpackExecutionProviderInfo {
-  int xnn_thread_pool_size{0};
+  // share the packed weights of xnnpack operators with all other sessions in the process that set this.
+  // provider option "share_packed_weights" = "1". useful when the same model is loaded by many sessions.
+  bool share_packed_weights{false};
+
+  // take float MatMul, Gemm, Add, Sub, Mul and Div nodes. on by default so that a float NHWC graph is not split
+  // between xnnpack and the CPU EP around them. provider option "enable_float_matmul_and_binary_ops" = "0" leaves
+  // them to the CPU EP.
+  bool enable_float_matmul_and_binary_ops{true};
+
   XnnpackExecutionProviderInfo() = default;
 
   XnnpackExecutionProviderInfo(const ProviderOptions& po) {
-    if (auto it = po.find("intra_op_num_threads"); it != po.end()) {
-      xnn_thread_pool_size = std::stoi(it->second);
+    // xnnpack kernels run on the intra-op thread pool of the session, so a separate xnnpack thread count can't be
+    // honored. reject it rather than silently running with a different number of threads.
+    ORT_ENFORCE(po.find("intra_op_num_threads") == po.end(),
+                "The XNNPACK provider option 'intra_op_num_threads' is not supported. XNNPACK kernels run on the "
+                "intra-op thread pool of the session; set SessionOptions intra_op_num_threads instead.");
+    share_packed_weights = ParseBoolOption(po, "share_packed_weights", share_packed_weights);
+    enable_float_matmul_and_binary_ops = ParseBoolOption(po, "enable_float_matmul_and_binary_ops",
+                                                         enable_float_matmul_and_binary_ops);
+  }
+
+ private:
+  static bool ParseBoolOption(const ProviderOptions& po, const std::string& name, bool default_value) {
+    auto it = po.find(name);
+    if (it == po.end()) {
+      return default_value;
     }
+    ORT_ENFORCE(it->second == "0" || it->second == "1",
+                "Invalid value for XNNPACK provider option '", name, "': ", it->second);
+    return it->second == "1";
   }
 };
 
@@ -43,12 +72,23 @@ class XnnpackExecutionProvider : public IExecutionProvider {
   // xnnpack does not support concurrent execution of a kernel
   bool ConcurrentRunSupported() const override { return false; }
 
-  pthreadpool* GetPrivateThreadPool() const {
-    return xnnpack_thread_pool_;
-  }
+  // logs the weights sharing stats once the kernels of the session are created
+  common::Status OnSessionInitializationEnd() override;
+
+  // weights cache shared with other sessions. nullptr if weights sharing is not enabled.
+  const std::shared_ptr<xnnpack::WeightsCache>& GetWeightsCache() const { return weights_cache_; }
+
+  // called by kernels of this EP when their packed weights were found in the shared weights cache
+  void AddBytesSavedByWeightsSharing(int64_t bytes) const { bytes_saved_by_sharing_ += bytes; }
+
+  // bytes_saved_by_sharing is the size of the packed weights this session did not have to create as they were
+  // shared with another kernel or session. bytes_in_use is the size of the shared weights cache.
+  void GetWeightsSharingStats(AllocatorStats& stats) const;
 
  private:
-  pthreadpool* xnnpack_thread_pool_{nullptr};
+  const bool enable_float_matmul_and_binary_ops_;
+  std::shared_ptr<xnnpack::WeightsCache> weights_cache_;
+  mutable std::atomic<int64_t> bytes_saved_by_sharing_{0};
 };
 
 }  // namespace onnxruntime
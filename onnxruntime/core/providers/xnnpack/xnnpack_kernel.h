@@ -2,8 +2,14 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
 #include "core/framework/op_kernel.h"
 #include "core/providers/xnnpack/xnnpack_execution_provider.h"
+#include "core/providers/xnnpack/detail/weights_cache.h"
 
 struct pthreadpool;
 
@@ -14,16 +20,52 @@ class XnnpackKernel : public OpKernel {
  public:
   explicit XnnpackKernel(const OpKernelInfo& info)
       : OpKernel(info),
-        xnnpack_threadpool_(
-            static_cast<const XnnpackExecutionProvider*>(info.GetExecutionProvider())
-                ->GetPrivateThreadPool()) {
+        ep_{*static_cast<const XnnpackExecutionProvider*>(info.GetExecutionProvider())},
+        weights_cache_{ep_.GetWeightsCache()} {
+  }
+
+  // xnnpack is linked against a pthreadpool implementation that runs on the ORT thread pool
+  // (see detail/pthreadpool_shim.cc), so the intra-op thread pool of the session is handed to xnnpack directly.
+  // nullptr runs the xnnpack operator on the calling thread.
+  [[nodiscard]] static pthreadpool* GetThreadPool(const OpKernelContext& context) {
+    return reinterpret_cast<pthreadpool*>(context.GetOperatorThreadPool());
+  }
+
+ protected:
+  // Create an xnnpack operator that packs constant weights. create_fn is called with the caches to pass to the
+  // xnn_create_* function, which are nullptr unless the EP shares packed weights across sessions.
+  // `weights` are the tensors the operator packs, and identify the packed weights for the sharing statistics.
+  Status CreateOperatorWithWeights(gsl::span<const Tensor* const> weights,
+                                   const std::function<Status(xnn_caches_t)>& create_fn) {
+    if (!weights_cache_) {
+      return create_fn(nullptr);
+    }
+
+    int64_t weights_size = 0;
+    for (const Tensor* weight : weights) {
+      if (weight != nullptr) {
+        weights_size += static_cast<int64_t>(weight->SizeInBytes());
+      }
+    }
+
+    int64_t bytes_saved = 0;
+    ORT_RETURN_IF_ERROR(weights_cache_->CreateOperator(WeightsCache::CreateKey(Node().OpType(), weights),
+                                                       weights_size, create_fn, bytes_saved));
+    ep_.AddBytesSavedByWeightsSharing(bytes_saved);
+    return Status::OK();
   }
-  [[nodiscard]] pthreadpool* GetThreadPool() const {
-    return xnnpack_threadpool_;
+
+  // Must be held while setting up and running an operator created by CreateOperatorWithWeights, as the buffer of a
+  // shared weights cache moves if another session adds weights to it. Finalizes the cache on the first run, which
+  // xnnpack requires before running an operator that uses it.
+  [[nodiscard]] std::shared_lock<std::shared_mutex> LockWeightsCache() const {
+    return weights_cache_ ? weights_cache_->LockForCompute() : std::shared_lock<std::shared_mutex>();
   }
 
  private:
-  pthreadpool* xnnpack_threadpool_;
+  const XnnpackExecutionProvider& ep_;
+  // keep the cache alive for as long as operators that reference it exist
+  std::shared_ptr<WeightsCache> weights_cache_;
 };
 }  // namespace xnnpack
 }  // namespace onnxruntime
@@ -4,6 +4,7 @@
 #include "core/session/environment.h"
 #include "core/session/allocator_adapters.h"
 #include "core/framework/allocatormgr.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/graph/constants.h"
 #include "core/graph/op.h"
 
@@ -196,6 +197,7 @@ Status Environment::Initialize(std::unique_ptr<logging::LoggingManager> logging_
   auto status = Status::OK();
 
   logging_manager_ = std::move(logging_manager);
+  shared_initializer_store_ = std::make_shared<SharedInitializerStore>();
 
   // create thread pools
   if (create_global_thread_pools) {
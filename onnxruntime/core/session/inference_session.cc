@@ -11,6 +11,7 @@
 #include <string>
 #include <thread>
 
+#include "core/common/cancellation_token.h"
 #include "core/common/denormal.h"
 #include "core/common/logging/logging.h"
 #include "core/common/parse_string.h"
@@ -33,6 +34,7 @@
 #include "core/framework/tensor_type_and_shape.h"
 #include "core/framework/op_kernel_context_internal.h"
 #include "core/framework/ort_value_pattern_planner.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/utils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -289,8 +291,13 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
                                session_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL &&
                                to.affinity_vec_len == 0;
         to.allow_spinning = allow_intra_op_spinning;
+        to.adaptive_spinning =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigAdaptiveSpinning, "0") == "1";
+        to.collect_worker_stats =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpWorkerStats, "0") == "1";
         to.dynamic_block_base_ = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBlockBase, "0"));
         LOGS(*session_logger_, INFO) << "Dynamic block base set to " << to.dynamic_block_base_;
+        to.numa_node = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNumaNode, "-1"));
 
         // Set custom threading functions
         to.custom_create_thread_fn = session_options_.custom_create_thread_fn;
@@ -322,7 +329,10 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         to.name = inter_thread_pool_name_.c_str();
         to.set_denormal_as_zero = set_denormal_as_zero;
         to.allow_spinning = allow_inter_op_spinning;
+        to.adaptive_spinning =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigAdaptiveSpinning, "0") == "1";
         to.dynamic_block_base_ = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBlockBase, "0"));
+        to.numa_node = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNumaNode, "-1"));
 
         // Set custom threading functions
         to.custom_create_thread_fn = session_options_.custom_create_thread_fn;
@@ -347,6 +357,35 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
     ORT_ENFORCE(session_env.EnvCreatedWithGlobalThreadPools(),
                 "When the session is not configured to use per session"
                 " threadpools, the env must be created with the the CreateEnvWithGlobalThreadPools API.");
+
+    if (intra_op_thread_pool_from_env_ != nullptr) {
+      // Run the loops of this session through a view of the global pool, which applies the thread quota and the
+      // priority of the session and counts the work the session gives to the pool.
+      // The constructor can't return an error, so invalid values fail Initialize() instead.
+      const std::string thread_quota_string =
+          session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpThreadQuota, "0");
+      int thread_quota = 0;
+      if (!TryParseStringWithClassicLocale(thread_quota_string, thread_quota) || thread_quota < 0) {
+        thread_pool_options_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ",
+                                                      kOrtSessionOptionsConfigIntraOpThreadQuota, ": ",
+                                                      thread_quota_string);
+        thread_quota = 0;
+      }
+      std::string priority =
+          session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpPriority, "latency");
+      if (priority != "latency" && priority != "batch") {
+        thread_pool_options_status_ = ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ",
+                                                      kOrtSessionOptionsConfigIntraOpPriority, ": ", priority,
+                                                      ". Valid values are 'latency' and 'batch'.");
+        priority = "latency";
+      }
+      intra_op_thread_pool_share_ = std::make_unique<concurrency::ThreadPool>(
+          intra_op_thread_pool_from_env_, thread_quota,
+          priority == "batch" ? concurrency::ThreadPoolPriority::Batch : concurrency::ThreadPoolPriority::LatencyCritical);
+      intra_op_thread_pool_from_env_ = intra_op_thread_pool_share_.get();
+      LOGS(*session_logger_, INFO) << "Using the global intra-op threadpool with a thread quota of " << thread_quota
+                                   << " and " << priority << " priority";
+    }
   }
 
   session_profiler_.Initialize(session_logger_);
@@ -458,6 +497,29 @@ InferenceSession::~InferenceSession() {
     }
   }
 
+  if (thread_pool_ &&
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpWorkerStats, "0") == "1") {
+    concurrency::ThreadPoolWorkerStats total;
+    for (const auto& worker : concurrency::ThreadPool::GetWorkerStats(thread_pool_.get())) {
+      total.tasks += worker.tasks;
+      total.active_ns += worker.active_ns;
+      total.spin_ns += worker.spin_ns;
+      total.spin_hits += worker.spin_hits;
+      total.blocks += worker.blocks;
+    }
+    LOGS(*session_logger_, INFO) << "Intra-op threadpool workers: " << total.tasks << " tasks, "
+                                 << total.active_ns / 1000 << " us running, " << total.spin_ns / 1000
+                                 << " us spinning, " << total.spin_hits << " spin hits, " << total.blocks << " blocks";
+  }
+
+  if (intra_op_thread_pool_share_) {
+    const auto stats = GetIntraOpThreadPoolStats();
+    LOGS(*session_logger_, INFO) << "Global intra-op threadpool usage: " << stats.loops << " loops, "
+                                 << stats.chunks << " chunks, " << stats.yields << " yields, "
+                                 << stats.queue_time_ns / 1000 << " us queued, "
+                                 << stats.cpu_time_ns / 1000 << " us running";
+  }
+
 #ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
   if (session_activity_started_)
     TraceLoggingWriteStop(session_activity, "OrtInferenceSessionActivity");
@@ -896,10 +958,20 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
   // 4. insert cast nodes
   // 5. insert copy nodes
 
+  TimePoint tp;
+  if (session_profiler_.IsEnabled()) {
+    tp = session_profiler_.Start();
+  }
+
   // first apply execution provider independent level 1 graph optimizations.
   ORT_RETURN_IF_ERROR_SESSIONID_(
       graph_transformer_mgr.ApplyTransformers(graph, TransformerLevel::Level1, *session_logger_));
 
+  if (session_profiler_.IsEnabled()) {
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "level1_graph_optimization", tp);
+    tp = session_profiler_.Start();
+  }
+
   // if saving model to ORT format we only assign nodes a custom EP can handle and don't compile them.
   // we do this to preserve the original nodes in the model but prevent optimizers from changing them.
   // at runtime, the ORT format model will re-do the partitioning/compilation of these nodes, which may change
@@ -917,6 +989,11 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
   ORT_RETURN_IF_ERROR_SESSIONID_(partitioner.Partition(graph, session_state.GetMutableFuncMgr(), transform_layout_fn,
                                                        mode));
 
+  if (session_profiler_.IsEnabled()) {
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "graph_partitioning", tp);
+    tp = session_profiler_.Start();
+  }
+
   // apply Level2 and higher transformers.
   // we do not run Level 1 again as those transformers assume partitioning will run later to do node assignment.
   for (int i = static_cast<int>(TransformerLevel::Level2); i <= static_cast<int>(TransformerLevel::MaxLevel); i++) {
@@ -937,6 +1014,10 @@ common::Status InferenceSession::TransformGraph(onnxruntime::Graph& graph,
   MemcpyTransformer copy_transformer{provider_types, kernel_registry_manager};
   ORT_RETURN_IF_ERROR_SESSIONID_(copy_transformer.Apply(graph, modified, *session_logger_));
 
+  if (session_profiler_.IsEnabled()) {
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "graph_optimization", tp);
+  }
+
   return common::Status::OK();
 }
 #endif  // !defined(ORT_MINIMAL_BUILD)
@@ -1217,6 +1298,19 @@ static void ResolveMemoryPatternFlags(SessionState& session_state) {
     }
   }
 }
+
+// Adds up the pre-packed weights the session state and its subgraph session states took from the
+// PrepackedWeightsContainer instead of keeping their own copy.
+static void AccumulateUsedSharedPrePackedWeights(const SessionState& session_state, size_t& count, size_t& bytes) {
+  count += session_state.GetUsedSharedPrePackedWeightCounter();
+  bytes += session_state.GetUsedSharedPrePackedWeightBytes();
+
+  for (const auto& entry : session_state.GetSubgraphSessionStateMap()) {
+    for (const auto& name_to_subgraph_session_state : entry.second) {
+      AccumulateUsedSharedPrePackedWeights(*name_to_subgraph_session_state.second, count, bytes);
+    }
+  }
+}
 #if defined(_MSC_VER) && !defined(__clang__)
 #pragma warning(push)
 // VC++ reports: "Releasing unheld lock 'l' in function 'onnxruntime::InferenceSession::Initialize'". But I don't see anything wrong.
@@ -1231,6 +1325,7 @@ common::Status InferenceSession::Initialize() {
 
   ORT_TRY {
     LOGS(*session_logger_, INFO) << "Initializing session.";
+    ORT_RETURN_IF_ERROR_SESSIONID_(thread_pool_options_status_);
     const Env& env = Env::Default();
     env.GetTelemetryProvider().LogSessionCreationStart();
 
@@ -1315,11 +1410,58 @@ common::Status InferenceSession::Initialize() {
       UpdateProvidersWithSharedAllocators();
     }
 
+    const int numa_node =
+        std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNumaNode, "-1"));
+    if (numa_node >= 0 && !use_env_allocators) {
+      // Place the CPU arena regions on the node the session threads are bound to.
+      auto cpu_alloc = execution_providers_.Get(onnxruntime::kCpuExecutionProvider)->GetAllocator(0, OrtMemTypeDefault);
+      if (cpu_alloc && cpu_alloc->Info().alloc_type == OrtAllocatorType::OrtArenaAllocator) {
+        static_cast<BFCArena*>(cpu_alloc.get())->SetNumaNode(numa_node);
+        LOGS(*session_logger_, INFO) << "CPU arena memory will be placed on NUMA node " << numa_node;
+      }
+    }
+
 #ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
     TraceLoggingWriteStart(session_activity, "OrtInferenceSessionActivity");
     session_activity_started_ = true;
 #endif
 
+#if defined(ENABLE_TRAINING) && !defined(ORT_MINIMAL_BUILD)
+    // The recompute nodes added to fit an activation memory budget only run late, where they free the activations
+    // they replace, with the priority based execution order.
+    const std::string activation_memory_budget_mb =
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigActivationMemoryBudgetMB, "");
+    if (!activation_memory_budget_mb.empty()) {
+      double memory_budget_mb = 0.0;
+      if (!TryParseStringWithClassicLocale(activation_memory_budget_mb, memory_budget_mb) || memory_budget_mb < 0.0) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ",
+                               kOrtSessionOptionsConfigActivationMemoryBudgetMB, ": ", activation_memory_budget_mb);
+      }
+
+      if (session_options_.execution_order != ExecutionOrder::PRIORITY_BASED) {
+        LOGS(*session_logger_, WARNING)
+            << "The activation memory budget requires the priority based execution order. "
+            << "So using it for this session.";
+        session_options_.execution_order = ExecutionOrder::PRIORITY_BASED;
+      }
+    }
+#endif
+
+    // Share the constant initializers with the other sessions of the environment holding the same weights. Their
+    // pre-packed forms are only shared through the container the user supplied, if any.
+    if (session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDeduplicateInitializers, "0") == "1") {
+#if defined(ENABLE_TRAINING)
+      // training updates the initializers in place, which would change them for every session sharing them
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, kOrtSessionOptionsConfigDeduplicateInitializers,
+                             " is not supported in training builds, as the initializers may be updated in place.");
+#endif
+      shared_initializer_store_ = environment_.GetSharedInitializerStore();
+      if (shared_initializer_store_ == nullptr) {
+        LOGS(*session_logger_, WARNING) << "The environment has no shared initializer store. "
+                                        << "Initializers will not be deduplicated.";
+      }
+    }
+
     // now that we have all the execution providers, create the session state
     session_state_ = std::make_unique<SessionState>(
         model_->MainGraph(),
@@ -1332,7 +1474,8 @@ common::Status InferenceSession::Initialize() {
         session_profiler_,
         session_options_.use_deterministic_compute,
         session_options_.enable_mem_reuse,
-        prepacked_weights_container_);
+        prepacked_weights_container_,
+        shared_initializer_store_);
 
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
     // Don't want to pollute SessionState constructor since memory profile is enabled optionally.
@@ -1408,7 +1551,14 @@ common::Status InferenceSession::Initialize() {
                                                     saving_ort_format));
 
       // now that all the transforms are done, call Resolve on the main graph. this will recurse into the subgraphs.
+      TimePoint resolve_tp;
+      if (session_profiler_.IsEnabled()) {
+        resolve_tp = session_profiler_.Start();
+      }
       ORT_RETURN_IF_ERROR_SESSIONID_(graph.Resolve());
+      if (session_profiler_.IsEnabled()) {
+        session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "graph_resolve", resolve_tp);
+      }
 
       // Currently only the CUDA EP is considered.
       // If the CUDA EP is part of the providers list for this session AND
@@ -1515,6 +1665,23 @@ common::Status InferenceSession::Initialize() {
         model_->MainGraph().DomainToVersionMap(), model_->MainGraph().Name(), model_->MetaData(),
         telemetry_.event_name_, execution_providers_.GetIds(), model_has_fp16_inputs);
     LOGS(*session_logger_, INFO) << "Session successfully initialized.";
+
+    size_t shared_prepacked_weights = 0;
+    size_t shared_prepacked_weight_bytes = 0;
+    AccumulateUsedSharedPrePackedWeights(*session_state_, shared_prepacked_weights, shared_prepacked_weight_bytes);
+    if (shared_prepacked_weights > 0) {
+      LOGS(*session_logger_, INFO) << shared_prepacked_weights << " pre-packed weights ("
+                                   << shared_prepacked_weight_bytes << " bytes) are shared with other sessions "
+                                   << "through the pre-packed weights container.";
+    }
+
+    if (shared_initializer_store_ != nullptr) {
+      const auto stats = shared_initializer_store_->GetStats();
+      LOGS(*session_logger_, INFO) << "Shared initializer store holds " << stats.num_tensors << " tensors ("
+                                   << stats.bytes_stored << " bytes). " << stats.num_deduplicated
+                                   << " initializers (" << stats.bytes_deduplicated
+                                   << " bytes) were deduplicated so far.";
+    }
   }
   ORT_CATCH(const NotImplementedException& ex) {
     ORT_HANDLE_EXCEPTION([&]() {
@@ -1879,6 +2046,22 @@ Status InferenceSession::Run(const RunOptions& run_options,
   Status retval = Status::OK();
   const Env& env = Env::Default();
 
+  // The deadline counts from the call, so that the time spent waiting for the session is included.
+  auto deadline = CancellationToken::Clock::time_point::max();
+  const std::string timeout_ms_string =
+      run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigTimeoutMs, "0");
+  int64_t timeout_ms = 0;
+  if (!TryParseStringWithClassicLocale(timeout_ms_string, timeout_ms) || timeout_ms < 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ", kOrtRunOptionsConfigTimeoutMs, ": ",
+                           timeout_ms_string);
+  }
+  if (timeout_ms > 0) {
+    deadline = CancellationToken::Clock::now() + std::chrono::milliseconds(timeout_ms);
+  }
+  // Make the cancellation of the run visible to the executors and kernels running on this thread.
+  CancellationToken cancellation(run_options.terminate, deadline);
+  CancellationToken::Scope cancellation_scope(&cancellation);
+
   // Increment/decrement concurrent_num_runs_ and control
   // session threads spinning as configured. Do nothing for graph replay except the counter.
   const bool control_spinning = use_per_session_threads_ &&
@@ -2158,6 +2341,17 @@ void InferenceSession::StartProfiling(const logging::Logger* logger_ptr) {
 std::string InferenceSession::EndProfiling() {
   if (is_model_loaded_) {
     if (session_profiler_.IsEnabled()) {
+      if (intra_op_thread_pool_share_) {
+        // totals of the loops the session ran on the global intra-op threadpool since it was created
+        const auto stats = GetIntraOpThreadPoolStats();
+        session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "intra_op_thread_pool_share",
+                                                session_profiler_.Start(),
+                                                {{"loops", std::to_string(stats.loops)},
+                                                 {"chunks", std::to_string(stats.chunks)},
+                                                 {"yields", std::to_string(stats.yields)},
+                                                 {"queue_time_us", std::to_string(stats.queue_time_ns / 1000)},
+                                                 {"cpu_time_us", std::to_string(stats.cpu_time_ns / 1000)}});
+      }
       return session_profiler_.EndProfiling();
     } else {
       LOGS(*session_logger_, VERBOSE) << "Profiler is disabled.";
@@ -419,6 +419,16 @@ class InferenceSession {
    */
   const ProviderOptionsMap& GetAllProviderOptions() const;
 
+  /*
+   * Get the counters of the parallel loops this session ran on the global intra-op threadpool.
+   * They are all zero when the session does not use the global threadpools.
+   * Outside of this method, the totals are only logged at INFO level when the session is destroyed, and recorded as
+   * the "intra_op_thread_pool_share" event when the session profile is written.
+   */
+  concurrency::ThreadPoolShareStats GetIntraOpThreadPoolStats() const {
+    return concurrency::ThreadPool::GetShareStats(intra_op_thread_pool_share_.get());
+  }
+
   /**
    * Start profiling on this inference session. This simply turns on profiling events to be
    * recorded. A corresponding EndProfiling has to follow to write profiling data to a file.
@@ -692,6 +702,13 @@ class InferenceSession {
   onnxruntime::concurrency::ThreadPool* intra_op_thread_pool_from_env_{};
   onnxruntime::concurrency::ThreadPool* inter_op_thread_pool_from_env_{};
 
+  // View of the global intra-op threadpool applying the thread quota and priority of this session.
+  // intra_op_thread_pool_from_env_ points to it when it is set.
+  std::unique_ptr<onnxruntime::concurrency::ThreadPool> intra_op_thread_pool_share_;
+
+  // Error in the thread quota or priority session config entries, found by the constructor and returned by Initialize.
+  Status thread_pool_options_status_;
+
   // External threadpools.
   onnxruntime::concurrency::ThreadPool* external_intra_op_thread_pool_{};
   onnxruntime::concurrency::ThreadPool* external_inter_op_thread_pool_{};
@@ -803,6 +820,9 @@ class InferenceSession {
   // the cache is valid until any session reliant on it is still in scope.
   PrepackedWeightsContainer* prepacked_weights_container_ = nullptr;
 
+  // Store of the environment the constant initializers are shared through, if the session deduplicates them.
+  SharedInitializerStore* shared_initializer_store_ = nullptr;
+
   // Cache the EP instance if the user has configured the EP to capture a graph
   // for the model and all the necessary criteria for graph capture has been met.
   // At Run() time, if this member is not nullptr and the captured graph is ready
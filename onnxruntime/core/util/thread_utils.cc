@@ -22,7 +22,22 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   if (options.affinity_vec_len != 0) {
     to.affinity.assign(options.affinity_vec, options.affinity_vec + options.affinity_vec_len);
   }
-  if (options.thread_pool_size <= 0) {  // default
+  if (options.numa_node >= 0) {
+    const auto numa_nodes = Env::Default().GetNumaNodeProcessors();
+    ORT_ENFORCE(static_cast<size_t>(options.numa_node) < numa_nodes.size() &&
+                    !numa_nodes[options.numa_node].empty(),
+                "NUMA node ", options.numa_node, " is not available on this machine. Number of nodes found: ",
+                numa_nodes.size());
+    const auto& node_cpus = numa_nodes[options.numa_node];
+    if (options.thread_pool_size <= 0) {
+      options.thread_pool_size = static_cast<int>(node_cpus.size());
+      if (options.thread_pool_size == 1)
+        return nullptr;
+    }
+    // Every thread gets a processor of the node so that the pool never steals work across nodes,
+    // and memory first touched by the pool threads stays local to the node.
+    to.affinity = GetNumaNodeAffinity(node_cpus, static_cast<size_t>(options.thread_pool_size));
+  } else if (options.thread_pool_size <= 0) {  // default
     cpu_list = Env::Default().GetThreadAffinityMasks();
     if (cpu_list.empty() || cpu_list.size() == 1)
       return nullptr;
@@ -37,6 +52,8 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   to.custom_thread_creation_options = options.custom_thread_creation_options;
   to.custom_join_thread_fn = options.custom_join_thread_fn;
   to.dynamic_block_base_ = options.dynamic_block_base_;
+  to.adaptive_spinning = options.adaptive_spinning;
+  to.collect_worker_stats = options.collect_worker_stats;
   if (to.custom_create_thread_fn) {
     ORT_ENFORCE(to.custom_join_thread_fn, "custom join thread function not set");
   }
@@ -18,6 +18,10 @@ struct OrtThreadPoolParams {
   bool auto_set_affinity = false;
   //If it is true, the thread pool will spin a while after the queue became empty.
   bool allow_spinning = true;
+  //If it is true, the duration of the spin is tuned per thread from the observed gaps between pieces of work.
+  bool adaptive_spinning = false;
+  //If it is true, the threads count the tasks they run and time how long they run, spin and block.
+  bool collect_worker_stats = false;
   //It it is non-negative, thread pool will split a task by a decreasing block size
   //of remaining_of_total_iterations / (num_of_threads * dynamic_block_base_)
   int dynamic_block_base_ = 0;
@@ -29,6 +33,10 @@ struct OrtThreadPoolParams {
   size_t affinity_vec_len = 0;
   const ORTCHAR_T* name = nullptr;
 
+  // If it is non-negative, the threads are bound to the logical processors of this NUMA node.
+  // When thread_pool_size is 0, the pool gets one thread per logical processor of the node.
+  int numa_node = -1;
+
   // Set or unset denormal as zero
   bool set_denormal_as_zero = false;
 
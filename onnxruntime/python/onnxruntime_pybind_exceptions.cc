@@ -35,6 +35,7 @@ void RegisterExceptions(pybind11::module& m) {
   pybind11::register_exception<NotImplemented>(m, "NotImplemented");
   pybind11::register_exception<InvalidGraph>(m, "InvalidGraph");
   pybind11::register_exception<EPFail>(m, "EPFail");
+  pybind11::register_exception<DeadlineExceeded>(m, "DeadlineExceeded");
 }
 
 void OrtPybindThrowIfError(onnxruntime::common::Status status) {
@@ -61,6 +62,8 @@ void OrtPybindThrowIfError(onnxruntime::common::Status status) {
         throw InvalidGraph(std::move(msg));
       case onnxruntime::common::StatusCode::EP_FAIL:
         throw EPFail(std::move(msg));
+      case onnxruntime::common::StatusCode::DEADLINE_EXCEEDED:
+        throw DeadlineExceeded(std::move(msg));
       default:
         throw std::runtime_error(std::move(msg));
     }
@@ -306,6 +306,41 @@ py::object AddTensorAsPyObj(const OrtValue& val, const DataTransferManager* data
   return obj;
 }
 
+// Wraps a CPU tensor into a numpy array that shares the tensor buffer instead of copying it.
+// A copy of the OrtValue is held by a capsule set as the base object of the array, so the buffer
+// stays alive for as long as the array does, regardless of the lifetime of the session.
+// Returns an empty object if the tensor cannot be shared: it lives on another device, it holds strings,
+// or it does not own its buffer (it aliases a feed or memory owned by the session).
+py::object GetBorrowedPyObjFromTensor(const OrtValue& val) {
+  const Tensor& rtensor = val.Get<Tensor>();
+  if (rtensor.Location().device.Type() != OrtDevice::CPU || rtensor.IsDataTypeString() ||
+      !rtensor.OwnsBuffer() || rtensor.SizeInBytes() == 0) {
+    return py::object();
+  }
+
+  const TensorShape& shape = rtensor.Shape();
+  std::vector<npy_intp> npy_dims;
+  npy_dims.reserve(shape.NumDimensions());
+  for (size_t n = 0; n < shape.NumDimensions(); ++n) {
+    npy_dims.push_back(shape[n]);
+  }
+  const int numpy_type = OnnxRuntimeTensorToNumpyType(rtensor.DataType());
+
+  py::capsule owner(new OrtValue(val), [](void* p) { delete reinterpret_cast<OrtValue*>(p); });
+  PyObject* array = PyArray_SimpleNewFromData(static_cast<int>(npy_dims.size()), npy_dims.data(), numpy_type,
+                                              const_cast<void*>(rtensor.DataRaw()));
+  if (array == nullptr) {
+    throw py::error_already_set();
+  }
+  py::object obj = py::reinterpret_steal<py::object>(array);
+
+  // PyArray_SetBaseObject steals the reference to the capsule, even when it fails.
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(array), owner.release().ptr()) != 0) {
+    throw py::error_already_set();
+  }
+  return obj;
+}
+
 static std::unique_ptr<onnxruntime::IExecutionProvider> LoadExecutionProvider(
     const std::string& ep_shared_lib_path,
     const ProviderOptions& provider_options = {},
@@ -1505,13 +1540,23 @@ including arg name, arg type (contains both type and shape).)pbdoc")
                }
              }
 
+             const auto& session_state = sess->GetSessionHandle()->GetSessionState();
+             const auto& initializers = session_state.GetInitializedTensors();
+
              std::vector<py::object> rfetch;
              rfetch.reserve(fetches.size());
              size_t pos = 0;
              for (auto fet : fetches) {
                if (fet.IsAllocated()) {
                  if (fet.IsTensor()) {
-                   rfetch.push_back(AddTensorAsPyObj(fet, nullptr, nullptr));
+                   // CPU outputs are handed over to numpy without a copy unless they are graph initializers,
+                   // which must not be mutated through the returned array.
+                   int ort_value_idx;
+                   const bool is_initializer =
+                       session_state.GetOrtValueNameIdxMap().GetIdx(output_names[pos], ort_value_idx).IsOK() &&
+                       initializers.count(ort_value_idx) > 0;
+                   py::object obj = is_initializer ? py::object() : GetBorrowedPyObjFromTensor(fet);
+                   rfetch.push_back(obj ? std::move(obj) : AddTensorAsPyObj(fet, nullptr, nullptr));
                  } else if (fet.IsSparseTensor()) {
                    rfetch.push_back(GetPyObjectFromSparseTensor(pos, fet, nullptr));
                  } else {
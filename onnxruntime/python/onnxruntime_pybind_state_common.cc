@@ -39,8 +39,6 @@ onnxruntime::ROCMExecutionProviderExternalAllocatorInfo external_allocator_info{
 onnxruntime::ArenaExtendStrategy arena_extend_strategy = onnxruntime::ArenaExtendStrategy::kNextPowerOfTwo;
 #endif
 
-#ifdef ENABLE_TRAINING
-
 void DlpackCapsuleDestructor(PyObject* data) {
   DLManagedTensor* dlmanaged_tensor = reinterpret_cast<DLManagedTensor*>(PyCapsule_GetPointer(data, "dltensor"));
   if (dlmanaged_tensor) {
@@ -72,8 +70,6 @@ OrtValue FromDlpack(PyObject* dlpack_tensor, const bool is_bool_tensor) {
   return ort_value;
 }
 
-#endif
-
 #if !defined(DISABLE_SPARSE_TENSORS)
 std::unique_ptr<OrtValue> PySparseTensor::AsOrtValue() const {
   if (instance_) {
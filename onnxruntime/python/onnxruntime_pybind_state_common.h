@@ -10,9 +10,7 @@
 #include "core/framework/session_options.h"
 #include "core/session/environment.h"
 #include "core/session/inference_session.h"
-#ifdef ENABLE_TRAINING
 #include "core/dlpack/dlpack_converter.h"
-#endif
 
 #include "onnxruntime_pybind.h"  // must use this for the include of <pybind11/pybind11.h>
 
@@ -462,8 +460,6 @@ bool CheckIfTensor(const std::vector<const NodeArg*>& def_list,
                    const std::string& name,
                    /*out*/ ONNX_NAMESPACE::TypeProto& type_proto);
 
-#ifdef ENABLE_TRAINING
-
 // Allocate a new Capsule object, which takes the ownership of OrtValue.
 // Caller is responsible for releasing.
 // This function calls OrtValueToDlpack(...).
@@ -476,8 +472,6 @@ OrtValue FromDlpack(PyObject* dlpack_tensor, const bool is_bool_tensor);
 // Destructor for Capsule object holding a DLPack structure.
 void DlpackCapsuleDestructor(PyObject* data);
 
-#endif
-
 }  // namespace python
 
 std::shared_ptr<IExecutionProviderFactory> CreateExecutionProviderFactory_Tensorrt(const OrtTensorRTProviderOptions* params);
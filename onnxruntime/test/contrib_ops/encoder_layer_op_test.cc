@@ -0,0 +1,203 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "core/util/math.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+struct EncoderLayerWeights {
+  std::vector<float> qkv_weight, qkv_bias;
+  std::vector<float> dense_weight, dense_bias, attention_gamma, attention_beta;
+  std::vector<float> ffn_weight1, ffn_bias1, ffn_weight2, ffn_bias2, ffn_gamma, ffn_beta;
+};
+
+std::vector<float> Uniform(RandomValueGenerator& random, const std::vector<int64_t>& dims, float min, float max) {
+  return random.Uniform<float>(dims, min, max);
+}
+
+EncoderLayerWeights MakeWeights(RandomValueGenerator& random, int64_t hidden_size, int64_t intermediate_size) {
+  const float weight_scale = 1.0f / std::sqrt(static_cast<float>(hidden_size));
+  EncoderLayerWeights w;
+  w.qkv_weight = Uniform(random, {hidden_size, 3 * hidden_size}, -weight_scale, weight_scale);
+  w.qkv_bias = Uniform(random, {3 * hidden_size}, -0.1f, 0.1f);
+  w.dense_weight = Uniform(random, {hidden_size, hidden_size}, -weight_scale, weight_scale);
+  w.dense_bias = Uniform(random, {hidden_size}, -0.1f, 0.1f);
+  w.attention_gamma = Uniform(random, {hidden_size}, 0.5f, 1.5f);
+  w.attention_beta = Uniform(random, {hidden_size}, -0.1f, 0.1f);
+  w.ffn_weight1 = Uniform(random, {hidden_size, intermediate_size}, -weight_scale, weight_scale);
+  w.ffn_bias1 = Uniform(random, {intermediate_size}, -0.1f, 0.1f);
+  w.ffn_weight2 = Uniform(random, {intermediate_size, hidden_size}, -weight_scale, weight_scale);
+  w.ffn_bias2 = Uniform(random, {hidden_size}, -0.1f, 0.1f);
+  w.ffn_gamma = Uniform(random, {hidden_size}, 0.5f, 1.5f);
+  w.ffn_beta = Uniform(random, {hidden_size}, -0.1f, 0.1f);
+  return w;
+}
+
+// C(M, N) = A(M, K) x B(K, N) + bias(N)
+std::vector<float> ReferenceMatMul(const std::vector<float>& A, const std::vector<float>& B, const float* bias,
+                                   int64_t M, int64_t K, int64_t N) {
+  std::vector<float> C(M * N);
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      float sum = bias != nullptr ? bias[n] : 0.0f;
+      for (int64_t k = 0; k < K; ++k) {
+        sum += A[m * K + k] * B[k * N + n];
+      }
+      C[m * N + n] = sum;
+    }
+  }
+  return C;
+}
+
+// LayerNorm(x + skip) of every row, in place in x.
+void ReferenceSkipLayerNorm(std::vector<float>& x, const std::vector<float>& skip, const std::vector<float>& gamma,
+                            const std::vector<float>& beta, int64_t hidden_size, float epsilon) {
+  const int64_t rows = static_cast<int64_t>(x.size()) / hidden_size;
+  for (int64_t row = 0; row < rows; ++row) {
+    float* p = x.data() + row * hidden_size;
+    double mean = 0.0, mean_square = 0.0;
+    for (int64_t h = 0; h < hidden_size; ++h) {
+      p[h] += skip[row * hidden_size + h];
+      mean += p[h];
+      mean_square += p[h] * p[h];
+    }
+    mean /= hidden_size;
+    const double stddev = std::sqrt(mean_square / hidden_size - mean * mean + epsilon);
+    for (int64_t h = 0; h < hidden_size; ++h) {
+      p[h] = static_cast<float>((p[h] - mean) / stddev) * gamma[h] + beta[h];
+    }
+  }
+}
+
+// The unfused layer, with a right padded mask given by the valid length of every sequence.
+std::vector<float> ReferenceEncoderLayer(const std::vector<float>& input, const EncoderLayerWeights& w,
+                                         const std::vector<int32_t>& mask_index, bool fast_gelu,
+                                         int64_t batch_size, int64_t sequence_length, int64_t hidden_size,
+                                         int64_t num_heads, int64_t intermediate_size, float epsilon) {
+  const int64_t rows = batch_size * sequence_length;
+  const int64_t head_size = hidden_size / num_heads;
+  const std::vector<float> qkv = ReferenceMatMul(input, w.qkv_weight, w.qkv_bias.data(), rows, hidden_size,
+                                                 3 * hidden_size);
+
+  std::vector<float> attention(rows * hidden_size, 0.0f);
+  std::vector<float> probs(sequence_length);
+  for (int64_t b = 0; b < batch_size; ++b) {
+    const int64_t valid_length = mask_index.empty() ? sequence_length : mask_index[b];
+    for (int64_t n = 0; n < num_heads; ++n) {
+      for (int64_t s = 0; s < sequence_length; ++s) {
+        const float* q = qkv.data() + (b * sequence_length + s) * 3 * hidden_size + n * head_size;
+        float max_score = -INFINITY;
+        for (int64_t t = 0; t < valid_length; ++t) {
+          const float* k = qkv.data() + (b * sequence_length + t) * 3 * hidden_size + hidden_size + n * head_size;
+          float score = 0.0f;
+          for (int64_t h = 0; h < head_size; ++h) {
+            score += q[h] * k[h];
+          }
+          probs[t] = score / std::sqrt(static_cast<float>(head_size));
+          max_score = std::max(max_score, probs[t]);
+        }
+        float sum = 0.0f;
+        for (int64_t t = 0; t < valid_length; ++t) {
+          probs[t] = std::exp(probs[t] - max_score);
+          sum += probs[t];
+        }
+        float* out = attention.data() + (b * sequence_length + s) * hidden_size + n * head_size;
+        for (int64_t t = 0; t < valid_length; ++t) {
+          const float* v = qkv.data() + (b * sequence_length + t) * 3 * hidden_size + 2 * hidden_size + n * head_size;
+          for (int64_t h = 0; h < head_size; ++h) {
+            out[h] += probs[t] / sum * v[h];
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<float> hidden = ReferenceMatMul(attention, w.dense_weight, w.dense_bias.data(), rows, hidden_size,
+                                              hidden_size);
+  ReferenceSkipLayerNorm(hidden, input, w.attention_gamma, w.attention_beta, hidden_size, epsilon);
+
+  std::vector<float> ffn = ReferenceMatMul(hidden, w.ffn_weight1, w.ffn_bias1.data(), rows, hidden_size,
+                                           intermediate_size);
+  for (auto& value : ffn) {
+    value = fast_gelu
+                ? 0.5f * value * (1.0f + std::tanh(0.7978845608f * (value + 0.044715f * value * value * value)))
+                : 0.5f * value * (1.0f + std::erf(value * static_cast<float>(M_SQRT1_2)));
+  }
+
+  std::vector<float> output = ReferenceMatMul(ffn, w.ffn_weight2, w.ffn_bias2.data(), rows, intermediate_size,
+                                              hidden_size);
+  ReferenceSkipLayerNorm(output, hidden, w.ffn_gamma, w.ffn_beta, hidden_size, epsilon);
+  return output;
+}
+
+void RunEncoderLayerTest(int64_t batch_size, int64_t sequence_length, int64_t hidden_size, int64_t num_heads,
+                         int64_t intermediate_size, const std::vector<int32_t>& mask_index, bool fast_gelu,
+                         bool weights_are_initializers) {
+  constexpr float epsilon = 1e-5f;
+  RandomValueGenerator random{};
+  const std::vector<float> input =
+      Uniform(random, {batch_size, sequence_length, hidden_size}, -1.0f, 1.0f);
+  const EncoderLayerWeights w = MakeWeights(random, hidden_size, intermediate_size);
+  const std::vector<float> output = ReferenceEncoderLayer(input, w, mask_index, fast_gelu, batch_size,
+                                                          sequence_length, hidden_size, num_heads,
+                                                          intermediate_size, epsilon);
+
+  OpTester test("EncoderLayer", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("num_heads", num_heads);
+  test.AddAttribute<float>("attention_epsilon", epsilon);
+  test.AddAttribute<float>("ffn_epsilon", epsilon);
+  if (fast_gelu) {
+    test.AddAttribute<std::string>("activation", "fast_gelu");
+  }
+
+  const bool init = weights_are_initializers;
+  test.AddInput<float>("input", {batch_size, sequence_length, hidden_size}, input);
+  test.AddInput<float>("qkv_weight", {hidden_size, 3 * hidden_size}, w.qkv_weight, init);
+  test.AddInput<float>("qkv_bias", {3 * hidden_size}, w.qkv_bias);
+  if (mask_index.empty()) {
+    test.AddOptionalInputEdge<int32_t>();
+  } else {
+    test.AddInput<int32_t>("mask_index", {batch_size}, mask_index);
+  }
+  test.AddInput<float>("dense_weight", {hidden_size, hidden_size}, w.dense_weight, init);
+  test.AddInput<float>("dense_bias", {hidden_size}, w.dense_bias);
+  test.AddInput<float>("attention_gamma", {hidden_size}, w.attention_gamma);
+  test.AddInput<float>("attention_beta", {hidden_size}, w.attention_beta);
+  test.AddInput<float>("ffn_weight1", {hidden_size, intermediate_size}, w.ffn_weight1, init);
+  test.AddInput<float>("ffn_bias1", {intermediate_size}, w.ffn_bias1);
+  test.AddInput<float>("ffn_weight2", {intermediate_size, hidden_size}, w.ffn_weight2, init);
+  test.AddInput<float>("ffn_bias2", {hidden_size}, w.ffn_bias2);
+  test.AddInput<float>("ffn_gamma", {hidden_size}, w.ffn_gamma);
+  test.AddInput<float>("ffn_beta", {hidden_size}, w.ffn_beta);
+  test.AddOutput<float>("output", {batch_size, sequence_length, hidden_size}, output);
+  test.SetOutputAbsErr("output", 1e-3f);
+  test.Run();
+}
+
+}  // namespace
+
+// Too few rows for a block per thread, so unless the test runs single threaded each stage is run over all the rows.
+TEST(EncoderLayerOpTest, Gelu) {
+  RunEncoderLayerTest(2, 5, 16, 2, 64, {}, false, false);
+}
+
+TEST(EncoderLayerOpTest, FastGeluWithMaskIndex) {
+  RunEncoderLayerTest(3, 7, 16, 4, 32, {7, 3, 5}, true, false);
+}
+
+// Enough rows for several blocks, with the weights pre-packed.
+TEST(EncoderLayerOpTest, PrePackedWeightsMultipleBlocks) {
+  RunEncoderLayerTest(4, 128, 64, 4, 256, {128, 100, 64, 1}, false, true);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+// (X + B) * Sigmoid(X + B) with B broadcast across the rows of X
+TEST(FusedElementwiseOpTest, BroadcastSwish) {
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Add", "Sigmoid", "Mul"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, -1,
+                                                     2, -1, -1,
+                                                     2, 3, -1});
+
+  const std::vector<float> X = {-2.0f, -1.0f, 0.0f,
+                                1.0f, 2.0f, 3.0f};
+  const std::vector<float> B = {0.5f, -0.5f, 1.5f};
+  std::vector<float> Y(X.size());
+  for (size_t i = 0; i < X.size(); ++i) {
+    const float sum = X[i] + B[i % B.size()];
+    Y[i] = sum / (1.0f + std::exp(-sum));
+  }
+
+  test.AddInput<float>("X", {2, 3}, X);
+  test.AddInput<float>("B", {3}, B);
+  test.AddOutput<float>("Y", {2, 3}, Y);
+  test.Run();
+}
+
+// Where(C, Sqrt(X), Pow(X, E)) with the condition broadcast across the columns and a scalar exponent
+TEST(FusedElementwiseOpTest, WhereWithBroadcastCondition) {
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Sqrt", "Pow", "Where"});
+  test.AddAttribute("operands", std::vector<int64_t>{1, -1, -1,
+                                                     1, 2, -1,
+                                                     0, 3, 4});
+
+  test.AddInput<bool>("C", {2, 1}, {true, false});
+  test.AddInput<float>("X", {2, 3}, {1.0f, 4.0f, 9.0f,
+                                     1.0f, 2.0f, 3.0f});
+  test.AddInput<float>("E", {}, {2.0f}, true);
+  test.AddOutput<float>("Y", {2, 3}, {1.0f, 2.0f, 3.0f,
+                                      1.0f, 4.0f, 9.0f});
+  test.Run();
+}
+
+// Rows longer than a block, with one input broadcast along the rows and one along the columns.
+TEST(FusedElementwiseOpTest, MultipleBlocksPerRow) {
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Sub", "Mul", "Relu"});
+  test.AddAttribute("operands", std::vector<int64_t>{0, 1, -1,
+                                                     3, 2, -1,
+                                                     4, -1, -1});
+
+  constexpr int64_t rows = 3;
+  constexpr int64_t cols = 1300;
+  std::vector<float> X(rows * cols);
+  std::vector<float> mean(rows);
+  std::vector<float> scale(cols);
+  std::vector<float> Y(rows * cols);
+  for (int64_t c = 0; c < cols; ++c) {
+    scale[c] = static_cast<float>(c % 7) - 3.0f;
+  }
+  for (int64_t r = 0; r < rows; ++r) {
+    mean[r] = static_cast<float>(r) * 0.25f;
+    for (int64_t c = 0; c < cols; ++c) {
+      X[r * cols + c] = static_cast<float>((r * cols + c) % 11) * 0.1f;
+      Y[r * cols + c] = std::max(0.0f, (X[r * cols + c] - mean[r]) * scale[c]);
+    }
+  }
+
+  test.AddInput<float>("X", {rows, cols}, X);
+  test.AddInput<float>("mean", {rows, 1}, mean);
+  test.AddInput<float>("scale", {cols}, scale);
+  test.AddOutput<float>("Y", {rows, cols}, Y);
+  test.Run();
+}
+
+TEST(FusedElementwiseOpTest, InvalidOperand) {
+  OpTester test("FusedElementwise", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("ops", std::vector<std::string>{"Neg", "Abs"});
+  // the first instruction can not use its own result
+  test.AddAttribute("operands", std::vector<int64_t>{1, -1, -1,
+                                                     1, -1, -1});
+
+  test.AddInput<float>("X", {2}, {1.0f, -2.0f});
+  test.AddOutput<float>("Y", {2}, {1.0f, 2.0f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "Invalid operand 1 for instruction 0 of FusedElementwise.");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include "core/util/math.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+// Small integer values, so the distances are exact in float and ties are broken the same way as the reference.
+std::vector<float> MakeIntegerData(int64_t rows, int64_t cols, int64_t seed) {
+  std::vector<float> data(rows * cols);
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    data[i] = static_cast<float>((i * 31 + seed * 17 + (i / cols) * 7) % 9) - 4.0f;
+  }
+  return data;
+}
+
+// Brute force k nearest neighbors of scores where lower is better, ties broken by the lower index.
+void ReferenceNearestNeighbors(const std::vector<float>& scores, int64_t M, int64_t N, int64_t k,
+                               std::vector<float>& values, std::vector<int64_t>& indices) {
+  values.clear();
+  indices.clear();
+  std::vector<int64_t> order(N);
+  for (int64_t q = 0; q < M; ++q) {
+    const float* row = scores.data() + q * N;
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [row](int64_t a, int64_t b) { return row[a] < row[b]; });
+    for (int64_t r = 0; r < k; ++r) {
+      values.push_back(row[order[r]]);
+      indices.push_back(order[r]);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(NearestNeighborsOpTest, SqEuclideanMultipleBlocks) {
+  constexpr int64_t M = 3, N = 3000, D = 64, k = 5;
+  const std::vector<float> Q = MakeIntegerData(M, D, 1);
+  const std::vector<float> X = MakeIntegerData(N, D, 2);
+
+  std::vector<float> distances(M * N);
+  for (int64_t q = 0; q < M; ++q) {
+    for (int64_t j = 0; j < N; ++j) {
+      float sum = 0.0f;
+      for (int64_t d = 0; d < D; ++d) {
+        const float diff = Q[q * D + d] - X[j * D + d];
+        sum += diff * diff;
+      }
+      distances[q * N + j] = sum;
+    }
+  }
+  std::vector<float> values;
+  std::vector<int64_t> indices;
+  ReferenceNearestNeighbors(distances, M, N, k, values, indices);
+
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", k);
+  test.AddInput<float>("Q", {M, D}, Q);
+  test.AddInput<float>("X", {N, D}, X);
+  test.AddOutput<float>("Values", {M, k}, values);
+  test.AddOutput<int64_t>("Indices", {M, k}, indices);
+  test.Run();
+}
+
+TEST(NearestNeighborsOpTest, EuclideanFloat16) {
+  constexpr int64_t M = 4, N = 200, D = 8, k = 3;
+  const std::vector<float> Q = MakeIntegerData(M, D, 3);
+  const std::vector<float> X = MakeIntegerData(N, D, 4);
+
+  std::vector<float> distances(M * N);
+  for (int64_t q = 0; q < M; ++q) {
+    for (int64_t j = 0; j < N; ++j) {
+      float sum = 0.0f;
+      for (int64_t d = 0; d < D; ++d) {
+        const float diff = Q[q * D + d] - X[j * D + d];
+        sum += diff * diff;
+      }
+      distances[q * N + j] = sum;
+    }
+  }
+  std::vector<float> values;
+  std::vector<int64_t> indices;
+  ReferenceNearestNeighbors(distances, M, N, k, values, indices);
+  std::transform(values.begin(), values.end(), values.begin(), [](float v) { return std::sqrt(v); });
+
+  std::vector<MLFloat16> X_fp16(X.size());
+  std::transform(X.begin(), X.end(), X_fp16.begin(), [](float v) { return MLFloat16(math::floatToHalf(v)); });
+
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", k);
+  test.AddAttribute<std::string>("metric", "euclidean");
+  test.AddInput<float>("Q", {M, D}, Q);
+  test.AddInput<MLFloat16>("X", {N, D}, X_fp16);
+  test.AddOutput<float>("Values", {M, k}, values);
+  test.AddOutput<int64_t>("Indices", {M, k}, indices);
+  test.Run();
+}
+
+TEST(NearestNeighborsOpTest, InnerProductInt8) {
+  constexpr int64_t M = 2, N = 2000, D = 32, k = 4;
+  const std::vector<float> Q = MakeIntegerData(M, D, 5);
+  const std::vector<float> X = MakeIntegerData(N, D, 6);
+
+  std::vector<int8_t> X_int8(X.size());
+  std::transform(X.begin(), X.end(), X_int8.begin(), [](float v) { return static_cast<int8_t>(v); });
+  std::vector<float> X_scale(N);
+  for (int64_t j = 0; j < N; ++j) {
+    X_scale[j] = j % 2 == 0 ? 0.5f : 0.25f;
+  }
+
+  // the similarities are negated, so that the reference keeps the highest ones
+  std::vector<float> scores(M * N);
+  for (int64_t q = 0; q < M; ++q) {
+    for (int64_t j = 0; j < N; ++j) {
+      float sum = 0.0f;
+      for (int64_t d = 0; d < D; ++d) {
+        sum += Q[q * D + d] * X[j * D + d] * X_scale[j];
+      }
+      scores[q * N + j] = -sum;
+    }
+  }
+  std::vector<float> values;
+  std::vector<int64_t> indices;
+  ReferenceNearestNeighbors(scores, M, N, k, values, indices);
+  std::transform(values.begin(), values.end(), values.begin(), [](float v) { return -v; });
+
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", k);
+  test.AddAttribute<std::string>("metric", "inner_product");
+  test.AddInput<float>("Q", {M, D}, Q);
+  test.AddInput<int8_t>("X", {N, D}, X_int8);
+  test.AddInput<float>("X_scale", {N}, X_scale);
+  test.AddOutput<float>("Values", {M, k}, values);
+  test.AddOutput<int64_t>("Indices", {M, k}, indices);
+  test.Run();
+}
+
+TEST(NearestNeighborsOpTest, Cosine) {
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", 2);
+  test.AddAttribute<std::string>("metric", "cosine");
+  test.AddInput<float>("Q", {2, 2}, {1.0f, 0.0f,
+                                     0.0f, 2.0f});
+  test.AddInput<float>("X", {4, 2}, {2.0f, 0.0f,
+                                     1.0f, 1.0f,
+                                     0.0f, -3.0f,
+                                     0.0f, 1.0f});
+  test.AddOutput<float>("Values", {2, 2}, {1.0f, 0.70710678f,
+                                           1.0f, 0.70710678f});
+  test.AddOutput<int64_t>("Indices", {2, 2}, {0, 1,
+                                              3, 1});
+  test.Run();
+}
+
+TEST(NearestNeighborsOpTest, Int8WithoutScale) {
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", 1);
+  test.AddInput<float>("Q", {1, 2}, {1.0f, 2.0f});
+  test.AddInput<int8_t>("X", {2, 2}, {1, 2, 3, 4});
+  test.AddOutput<float>("Values", {1, 1}, {0.0f});
+  test.AddOutput<int64_t>("Indices", {1, 1}, {0});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "X_scale is required for an int8 X");
+}
+
+TEST(NearestNeighborsOpTest, KLargerThanDatabase) {
+  OpTester test("NearestNeighbors", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("k", 3);
+  test.AddInput<float>("Q", {1, 2}, {1.0f, 2.0f});
+  test.AddInput<float>("X", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f});
+  test.AddOutput<float>("Values", {1, 3}, {0.0f, 0.0f, 0.0f});
+  test.AddOutput<int64_t>("Indices", {1, 3}, {0, 0, 0});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "is larger than the number of rows in X");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
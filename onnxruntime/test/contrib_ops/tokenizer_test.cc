@@ -677,6 +677,49 @@ TEST(ContribOpTest, TokenizerWithSeparators_MixCharCommonPrefixC) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }  // namespace test
 
+TEST(ContribOpTest, TokenizerWithSeparators_SingleCharSeparatorsNC) {
+  // Single character separators split the strings in one pass
+  std::vector<std::string> separators = {u8" ", u8",", u8"\\."};
+
+  OpTester test("Tokenizer", opset_ver, domain);
+  InitTestAttr(test, false, separators, 2);
+
+  std::vector<int64_t> dims{2, 2};
+  std::vector<std::string> input{u8"ab cd,e", u8"Аб.中文 x", u8"", u8",,ab,,"};
+  test.AddInput<std::string>("T", dims, input);
+
+  std::vector<int64_t> output_dims(dims);
+  output_dims.push_back(int64_t(2));
+  std::vector<std::string> output{
+      u8"ab", u8"cd",
+      u8"Аб", u8"中文",
+      padval, padval,
+      u8"ab", padval};
+
+  test.AddOutput<std::string>("Y", output_dims, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
+TEST(ContribOpTest, TokenizerWithSeparators_AnchoredSeparatorC) {
+  // The anchored separator matches the tokens produced by the first separator
+  // although it does not match the input strings
+  std::vector<std::string> separators = {u8";", u8"^b"};
+
+  OpTester test("Tokenizer", opset_ver, domain);
+  InitTestAttr(test, false, separators, 1);
+
+  std::vector<int64_t> dims{2};
+  std::vector<std::string> input{u8"a;b", u8"b;c"};
+  test.AddInput<std::string>("T", dims, input);
+
+  std::vector<int64_t> output_dims(dims);
+  output_dims.push_back(int64_t(1));
+  std::vector<std::string> output{u8"a", u8"c"};
+
+  test.AddOutput<std::string>("Y", output_dims, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 TEST(ContribOpTest, TokenizerExpression_RegEx) {
   OpTester test("Tokenizer", opset_ver, domain);
   const std::string tokenexp(u8"a.");
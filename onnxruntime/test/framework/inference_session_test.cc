@@ -6,10 +6,12 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <cstdio>
 #include <functional>
 #include <iterator>
 #include <thread>
 #include <fstream>
+#include <sstream>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include "core/common/denormal.h"
@@ -22,6 +24,7 @@
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/framework/bfc_arena.h"
 #include "core/graph/graph_viewer.h"
@@ -673,6 +676,41 @@ TEST(InferenceSessionTests, CheckRunProfilerWithSessionOptions) {
 #endif
 }
 
+TEST(InferenceSessionTests, CheckSessionInitializationProfilerEvents) {
+  SessionOptions so;
+
+  so.session_logid = "CheckSessionInitializationProfilerEvents";
+  so.enable_profiling = true;
+  so.profile_file_prefix = ORT_TSTR("onnxprofile_initialization_test");
+
+  InferenceSession session_object(so, GetEnvironment());
+  ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session_object.Initialize());
+  std::string profile_file = session_object.EndProfiling();
+
+  std::string profile_contents;
+  {
+    std::ifstream profile(profile_file);
+    ASSERT_TRUE(profile);
+    std::stringstream contents;
+    contents << profile.rdbuf();
+    profile_contents = contents.str();
+  }
+  ASSERT_EQ(std::remove(profile_file.c_str()), 0);
+
+  // each phase of the session creation is recorded separately
+  std::vector<std::string> phases{"model_loading_uri", "level1_graph_optimization", "graph_partitioning",
+                                  "graph_optimization", "graph_resolve", "initializers_loading", "kernels_creation",
+                                  "session_initialization"};
+#ifndef ENABLE_TRAINING
+  // session state finalization only pre-packs weights in inference builds
+  phases.push_back("prepacking");
+#endif
+  for (const auto& phase : phases) {
+    EXPECT_NE(profile_contents.find("\"" + phase + "\""), std::string::npos) << phase;
+  }
+}
+
 TEST(InferenceSessionTests, CheckRunProfilerWithSessionOptions2) {
   SessionOptions so;
 
@@ -2943,5 +2981,172 @@ TEST(InferenceSessionTests, InterThreadPoolWithDenormalAsZero) {
   VerifyThreadPoolWithDenormalAsZero(session2.GetInterOpThreadPoolToUse(), false);
 }
 
+TEST(InferenceSessionTests, InvalidIntraOpThreadQuotaOrPriority) {
+  auto logging_manager = std::make_unique<logging::LoggingManager>(
+      std::unique_ptr<ISink>(new CLogSink()), logging::Severity::kVERBOSE, false,
+      LoggingManager::InstanceType::Temporal);
+
+  std::unique_ptr<Environment> env;
+  OrtThreadingOptions tp_options;
+  ASSERT_STATUS_OK(Environment::Create(std::move(logging_manager), env, &tp_options,
+                                       true /*create_global_thread_pools*/));
+
+  const std::vector<std::pair<const char*, const char*>> invalid_entries{
+      {kOrtSessionOptionsConfigIntraOpThreadQuota, "-1"},
+      {kOrtSessionOptionsConfigIntraOpThreadQuota, "two"},
+      {kOrtSessionOptionsConfigIntraOpThreadQuota, "2 threads"},
+      {kOrtSessionOptionsConfigIntraOpPriority, "throughput"}};
+  for (const auto& entry : invalid_entries) {
+    SessionOptions so;
+    so.use_per_session_threads = false;
+    so.session_logid = "InvalidIntraOpThreadQuotaOrPriority";
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(entry.first, entry.second));
+
+    InferenceSessionTestGlobalThreadPools session_object{so, *env};
+    ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+    auto status = session_object.Initialize();
+    ASSERT_EQ(status.Code(), common::INVALID_ARGUMENT) << entry.first << "=" << entry.second;
+    ASSERT_TRUE(status.ErrorMessage().find(entry.first) != std::string::npos) << status.ErrorMessage();
+  }
+}
+
+// The then/else branches of an If node and the body of a Loop node each hold their own copy of the same weights.
+// With session.deduplicate_initializers they are stored once.
+static std::string CreateModelWithDuplicatedSubgraphInitializers(const std::vector<float>& weights) {
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(static_cast<int64_t>(weights.size()));
+  TypeProto bool_scalar;
+  bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_scalar.mutable_tensor_type()->mutable_shape();
+  TypeProto int64_scalar;
+  int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  int64_scalar.mutable_tensor_type()->mutable_shape();
+
+  auto add_weights = [&weights](Graph& graph) -> NodeArg& {
+    TensorProto tensor;
+    tensor.set_name("weights");
+    tensor.set_data_type(TensorProto_DataType_FLOAT);
+    tensor.add_dims(static_cast<int64_t>(weights.size()));
+    tensor.set_raw_data(weights.data(), weights.size() * sizeof(float));
+    graph.AddInitializedTensor(tensor);
+    return graph.GetOrCreateNodeArg("weights", nullptr);
+  };
+
+  // x (outer scope) op weights
+  auto create_if_branch = [&](const std::string& op_type) {
+    Model model("if_branch", true, DefaultLoggingManager().DefaultLogger());
+    auto& graph = model.MainGraph();
+    auto& x = graph.GetOrCreateNodeArg("x", &float_tensor);
+    graph.AddOuterScopeNodeArg("x");
+    auto& out = graph.GetOrCreateNodeArg("if_branch_out", &float_tensor);
+    graph.AddNode("if_branch_op", op_type, "", {&x, &add_weights(graph)}, {&out});
+    graph.SetOutputs({&out});
+    EXPECT_STATUS_OK(graph.Resolve());
+    return graph.ToGraphProto();
+  };
+
+  // state * weights for every iteration
+  auto create_loop_body = [&]() {
+    Model model("loop_body", true, DefaultLoggingManager().DefaultLogger());
+    auto& graph = model.MainGraph();
+    auto& iter_num = graph.GetOrCreateNodeArg("iter_num", &int64_scalar);
+    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+    auto& state_in = graph.GetOrCreateNodeArg("state_in", &float_tensor);
+    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+    auto& state_out = graph.GetOrCreateNodeArg("state_out", &float_tensor);
+    graph.AddNode("cond_identity", "Identity", "", {&cond_in}, {&cond_out});
+    graph.AddNode("state_mul", "Mul", "", {&state_in, &add_weights(graph)}, {&state_out});
+    graph.SetInputs({&iter_num, &cond_in, &state_in});
+    graph.SetOutputs({&cond_out, &state_out});
+    EXPECT_STATUS_OK(graph.Resolve());
+    return graph.ToGraphProto();
+  };
+
+  Model model("main_graph", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 13}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  auto& x = graph.GetOrCreateNodeArg("x", &float_tensor);
+  auto& cond = graph.GetOrCreateNodeArg("cond", &bool_scalar);
+  auto& trip_count = graph.GetOrCreateNodeArg("trip_count", &int64_scalar);
+  auto& if_out = graph.GetOrCreateNodeArg("if_out", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("y", &float_tensor);
+
+  auto& if_node = graph.AddNode("if", "If", "", {&cond}, {&if_out});
+  if_node.AddAttribute("then_branch", create_if_branch("Add"));
+  if_node.AddAttribute("else_branch", create_if_branch("Sub"));
+
+  auto& loop_node = graph.AddNode("loop", "Loop", "", {&trip_count, &cond, &if_out}, {&y});
+  loop_node.AddAttribute("body", create_loop_body());
+
+  graph.SetInputs({&x, &cond, &trip_count});
+  graph.SetOutputs({&y});
+  EXPECT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+TEST(InferenceSessionTests, DeduplicateSubgraphInitializers) {
+  // 2 KB of weights, above SharedInitializerStore::kMinBytesToShare. the values are specific to this test, so the
+  // weights are not already in the store of the test environment.
+  constexpr size_t num_weights = 512;
+  std::vector<float> weights(num_weights);
+  for (size_t i = 0; i < num_weights; ++i) {
+    weights[i] = 1.5f + static_cast<float>(i) / 1024.f;
+  }
+  const std::string model_data = CreateModelWithDuplicatedSubgraphInitializers(weights);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.DeduplicateSubgraphInitializers";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDeduplicateInitializers, "1"));
+
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+
+#if defined(ENABLE_TRAINING)
+  // training may update the initializers in place, so they can't be shared
+  auto status = session_object.Initialize();
+  ASSERT_EQ(status.Code(), common::INVALID_ARGUMENT) << status.ErrorMessage();
+#else
+  SharedInitializerStore* store = GetEnvironment().GetSharedInitializerStore();
+  ASSERT_NE(store, nullptr);
+  const SharedInitializerStoreStats before = store->GetStats();
+
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  // the first of the 3 copies is added to the store, and the other 2 are served by it
+  const SharedInitializerStoreStats after = store->GetStats();
+  EXPECT_EQ(after.num_tensors, before.num_tensors + 1);
+  EXPECT_EQ(after.bytes_stored, before.bytes_stored + num_weights * sizeof(float));
+  EXPECT_EQ(after.num_deduplicated, before.num_deduplicated + 2);
+  EXPECT_EQ(after.bytes_deduplicated, before.bytes_deduplicated + 2 * num_weights * sizeof(float));
+
+  // the shared weights produce the same results: y = (x + weights) * weights * weights
+  std::vector<float> x_values(num_weights, 0.5f);
+  std::vector<float> expected_y(num_weights);
+  for (size_t i = 0; i < num_weights; ++i) {
+    expected_y[i] = (x_values[i] + weights[i]) * weights[i] * weights[i];
+  }
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  OrtValue x, cond, trip_count;
+  CreateMLValue<float>(allocator, {static_cast<int64_t>(num_weights)}, x_values, &x);
+  CreateMLValue<bool>(allocator, {}, {true}, &cond);
+  CreateMLValue<int64_t>(allocator, {}, {2}, &trip_count);
+  NameMLValMap feeds{{"x", x}, {"cond", cond}, {"trip_count", trip_count}};
+
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session_object.Run(RunOptions{}, feeds, std::vector<std::string>{"y"}, &fetches));
+  ASSERT_EQ(fetches.size(), 1u);
+  const auto y = fetches[0].Get<Tensor>().DataAsSpan<float>();
+  ASSERT_EQ(y.size(), num_weights);
+  for (size_t i = 0; i < num_weights; ++i) {
+    EXPECT_FLOAT_EQ(y[i], expected_y[i]);
+  }
+#endif
+}
+
 }  // namespace test
 }  // namespace onnxruntime
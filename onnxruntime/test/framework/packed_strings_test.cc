@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/packed_strings.h"
+
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(PackedStringsTest, AppendAndCopyTo) {
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  PackedStrings strings(allocator);
+  EXPECT_TRUE(strings.Empty());
+  EXPECT_EQ(strings.TotalBytes(), 0U);
+
+  // enough strings and bytes to grow both buffers a few times
+  std::vector<std::string> expected;
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < 500; ++i) {
+    std::string str(i % 40, static_cast<char>('a' + i % 26));
+    total_bytes += str.size();
+    if (i % 2 == 0) {
+      strings.Append(str);
+    } else {
+      strings.Append(str.size() + 8, [&str](char* dest) { return str.copy(dest, str.size()); });
+    }
+    expected.push_back(std::move(str));
+  }
+
+  ASSERT_EQ(strings.Size(), expected.size());
+  EXPECT_EQ(strings.TotalBytes(), total_bytes);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(strings[i], expected[i]);
+  }
+
+  std::vector<std::string> output(strings.Size());
+  strings.CopyTo(output.data());
+  EXPECT_EQ(output, expected);
+}
+
+TEST(PackedStringsTest, ReserveAndClear) {
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  PackedStrings strings(allocator);
+  strings.Append("first");
+  strings.Reserve(100, 1000);
+  EXPECT_EQ(strings[0], "first");
+
+  strings.Clear();
+  EXPECT_TRUE(strings.Empty());
+
+  strings.Append("");
+  strings.Append("second");
+  ASSERT_EQ(strings.Size(), 2U);
+  EXPECT_EQ(strings[0], "");
+  EXPECT_EQ(strings[1], "second");
+  EXPECT_EQ(strings.TotalBytes(), 6U);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -10,6 +10,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/bfc_arena.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_initializer_store.h"
 #include "core/graph/graph_utils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -333,11 +334,11 @@ class PrePackingTestOpKernel : public OpKernel {
   BufferUniquePtr weight_packed_;
 };
 
-static void CreateSimpleGraph(Graph& graph) {
+static void CreateSimpleGraph(Graph& graph, int64_t initializer_size = 1) {
   // node creation and placement
   TypeProto type;
   type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
-  type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(initializer_size);
 
   std::vector<onnxruntime::NodeArg*> inputs;
   onnxruntime::NodeArg input_0_arg("node_0_input_0", &type);
@@ -353,8 +354,10 @@ static void CreateSimpleGraph(Graph& graph) {
 
   // add an initializer
   ONNX_NAMESPACE::TensorProto tensor;
-  tensor.add_dims(1);
-  tensor.add_float_data(1.0f);
+  tensor.add_dims(initializer_size);
+  for (int64_t i = 0; i < initializer_size; ++i) {
+    tensor.add_float_data(1.0f);
+  }
   tensor.set_data_type(TensorProto_DataType_FLOAT);
   tensor.set_name("node_0_input_1");
   graph.AddInitializedTensor(tensor);
@@ -531,6 +534,64 @@ TEST_P(SessionStatePrepackingTest, PrePackingTest) {
   ASSERT_EQ(const_initialized_tensors.size(), size_t(test_param.test_prepacking ? 0 : 1));
 }
 
+// The session states of subgraphs use the deterministic compute and memory reuse settings of the session.
+TEST(SessionStateTest, SubgraphInheritsSessionSettings) {
+  OrtThreadPoolParams to;
+  auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
+  ONNX_OPERATOR_SCHEMA(PrePackingTest)
+      .SetDoc("Faking Node for PrePacking")
+      .Input(0, "Input_0", "input 0", "tensor(float)")
+      .Input(1, "Input_1", "input 1", "tensor(float)")
+      .Output(0, "output_0", "docstr for output_0.", "tensor(float)");
+
+  ExecutionProviders execution_providers;
+  auto cpu_execution_provider = std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo(false));
+  ASSERT_STATUS_OK(execution_providers.Add(kCpuExecutionProvider, std::move(cpu_execution_provider)));
+
+  DataTransferManager dtm;
+  profiling::Profiler profiler;
+
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[kOnnxDomain] = 11;
+  Model model("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+              DefaultLoggingManager().DefaultLogger());
+  CreateGraphWithSubgraph(model.MainGraph());
+  PlaceAllNodesToCPUEP(model.MainGraph());
+
+  KernelRegistryManager kernel_registry_manager;
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+  std::shared_ptr<KernelRegistry> kernel_registry = std::make_shared<KernelRegistry>();
+  auto kernel_def = KernelDefBuilder().SetName("PrePackingTest").Provider(kCpuExecutionProvider).SinceVersion(1).Build();
+  ASSERT_STATUS_OK(kernel_registry->Register(
+      KernelCreateInfo(std::move(kernel_def),
+                       [](FuncManager&, const OpKernelInfo& info, std::unique_ptr<OpKernel>& out) -> Status { out = std::make_unique<PrePackingTestOpKernel>(info); return Status::OK(); })));
+  kernel_registry_manager.RegisterKernelRegistry(kernel_registry);
+
+  // The opposite of the defaults, so that a subgraph session state created with the defaults is detected
+  SessionState session_state(model.MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                             DefaultLoggingManager().DefaultLogger(), profiler,
+                             true,   /*use_deterministic_compute*/
+                             false); /*enable_mem_reuse*/
+
+  SessionOptions sess_options;
+  ASSERT_STATUS_OK(session_state.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                      kernel_registry_manager,
+                                                      sess_options));
+
+  size_t num_subgraphs = 0;
+  for (const auto& node_entry : session_state.GetSubgraphSessionStateMap()) {
+    for (const auto& subgraph_entry : node_entry.second) {
+      const SessionState& subgraph_session_state = *subgraph_entry.second;
+      ASSERT_TRUE(subgraph_session_state.GetUseDeterministicCompute()) << subgraph_entry.first;
+      ASSERT_FALSE(subgraph_session_state.GetEnableMemoryReuse()) << subgraph_entry.first;
+      ++num_subgraphs;
+    }
+  }
+  // then_branch and else_branch of the If node
+  ASSERT_EQ(num_subgraphs, size_t(2));
+}
+
 TEST(SessionStateTest, SharedInitalizersWithPrePackingTest) {
   OrtThreadPoolParams to;
   auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
@@ -741,6 +802,7 @@ TEST(SessionStateTest, SharedInitalizersWithPrePackingTest) {
     // Hence, assert that it wasn't a "cached" pre-packed weight (i.e.) pre-packed weight
     // from another instance of the same op_type consuming the same constant initializer.
     ASSERT_EQ(session_state_1.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(0));
+    ASSERT_EQ(session_state_1.GetUsedSharedPrePackedWeightBytes(), static_cast<size_t>(0));
 
     // Second session/model
     Model model_2("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
@@ -773,6 +835,151 @@ TEST(SessionStateTest, SharedInitalizersWithPrePackingTest) {
     // from another instance of the same op_type consuming the same constant initializer.
     // Assert this.
     ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(1));
+    // The 8 byte buffer the test kernel packed is not held by the second session
+    ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightBytes(), static_cast<size_t>(8));
+  }
+}
+
+TEST(SessionStateTest, DeduplicatedInitializersTest) {
+  OrtThreadPoolParams to;
+  auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
+  ONNX_OPERATOR_SCHEMA(PrePackingTest)
+      .SetDoc("Faking Node for PrePacking")
+      .Input(0, "Input_0", "input 0", "tensor(float)")
+      .Input(1, "Input_1", "input 1", "tensor(float)")
+      .Output(0, "output_0", "docstr for output_0.", "tensor(float)");
+
+  ExecutionProviders execution_providers;
+  auto cpu_execution_provider = std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo(false));
+  ASSERT_STATUS_OK(execution_providers.Add(kCpuExecutionProvider, std::move(cpu_execution_provider)));
+
+  DataTransferManager dtm;
+  profiling::Profiler profiler;
+
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[kOnnxDomain] = 11;
+
+  KernelRegistryManager kernel_registry_manager;
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+  std::shared_ptr<KernelRegistry> kernel_registry = std::make_shared<KernelRegistry>();
+  auto kernel_def = KernelDefBuilder().SetName("PrePackingTest").Provider(kCpuExecutionProvider).SinceVersion(1).Build();
+  ASSERT_STATUS_OK(kernel_registry->Register(
+      KernelCreateInfo(std::move(kernel_def),
+                       [](FuncManager&, const OpKernelInfo& info, std::unique_ptr<OpKernel>& out) -> Status { out = std::make_unique<PrePackingTestOpKernel>(info); return Status::OK(); })));
+  kernel_registry_manager.RegisterKernelRegistry(kernel_registry);
+
+  // 4 KB of weights, large enough to be shared
+  constexpr int64_t initializer_size = 1024;
+  constexpr size_t initializer_bytes = initializer_size * sizeof(float);
+
+  auto create_model = [&domain_to_version]() {
+    auto model = std::make_unique<Model>("graph_main", false, ModelMetaData(), PathString(),
+                                         IOnnxRuntimeOpSchemaRegistryList(), domain_to_version,
+                                         std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                                         DefaultLoggingManager().DefaultLogger());
+    CreateSimpleGraph(model->MainGraph(), initializer_size);
+    PlaceAllNodesToCPUEP(model->MainGraph());
+    return model;
+  };
+
+  // Part 1: Pre-packing disabled = both sessions hold the same copy of the initializer
+  {
+    SessionOptions sess_options;
+    sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "1";
+
+    SharedInitializerStore store;
+    {
+      auto model_1 = create_model();
+      SessionState session_state_1(model_1->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                   DefaultLoggingManager().DefaultLogger(), profiler, false, true, nullptr, &store);
+      ASSERT_STATUS_OK(session_state_1.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                            kernel_registry_manager, sess_options));
+
+      auto model_2 = create_model();
+      SessionState session_state_2(model_2->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                   DefaultLoggingManager().DefaultLogger(), profiler, false, true, nullptr, &store);
+      ASSERT_STATUS_OK(session_state_2.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                            kernel_registry_manager, sess_options));
+
+      const auto& initializers_1 = session_state_1.GetConstantInitializedTensors();
+      const auto& initializers_2 = session_state_2.GetConstantInitializedTensors();
+      ASSERT_EQ(initializers_1.size(), size_t(1));
+      ASSERT_EQ(initializers_2.size(), size_t(1));
+      const Tensor& tensor_1 = initializers_1.begin()->second.Get<Tensor>();
+      const Tensor& tensor_2 = initializers_2.begin()->second.Get<Tensor>();
+      ASSERT_EQ(tensor_1.DataRaw(), tensor_2.DataRaw());
+      ASSERT_TRUE(store.Contains(tensor_1));
+
+      const auto stats = store.GetStats();
+      ASSERT_EQ(stats.num_tensors, size_t(1));
+      ASSERT_EQ(stats.bytes_stored, initializer_bytes);
+      ASSERT_EQ(stats.num_deduplicated, size_t(1));
+      ASSERT_EQ(stats.bytes_deduplicated, initializer_bytes);
+    }
+
+    // The tensor is released with the last session using it
+    ASSERT_EQ(store.GetStats().num_tensors, size_t(0));
+  }
+
+  // Part 2: Pre-packing enabled with a container supplied by the user = the second session uses the pre-packed weight
+  // of the first one, and the initializer is released once it is pre-packed
+  {
+    SessionOptions sess_options;
+    sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+
+    SharedInitializerStore store;
+    PrepackedWeightsContainer prepacked_weights_container;
+
+    auto model_1 = create_model();
+    SessionState session_state_1(model_1->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                 DefaultLoggingManager().DefaultLogger(), profiler, false, true,
+                                 &prepacked_weights_container, &store);
+    ASSERT_STATUS_OK(session_state_1.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                          kernel_registry_manager, sess_options));
+    ASSERT_EQ(session_state_1.GetNumberOfPrepacksCounter(), size_t(1));
+    ASSERT_EQ(session_state_1.GetUsedSharedPrePackedWeightCounter(), size_t(0));
+
+    auto model_2 = create_model();
+    SessionState session_state_2(model_2->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                 DefaultLoggingManager().DefaultLogger(), profiler, false, true,
+                                 &prepacked_weights_container, &store);
+    ASSERT_STATUS_OK(session_state_2.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                          kernel_registry_manager, sess_options));
+    ASSERT_EQ(session_state_2.GetNumberOfPrepacksCounter(), size_t(1));
+    ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), size_t(1));
+
+    ASSERT_EQ(session_state_1.GetConstantInitializedTensors().size(), size_t(0));
+    ASSERT_EQ(session_state_2.GetConstantInitializedTensors().size(), size_t(0));
+    ASSERT_EQ(store.GetStats().num_tensors, size_t(0));
+    ASSERT_EQ(prepacked_weights_container.GetNumberOfElements(), size_t(1));
+  }
+
+  // Part 3: Pre-packing enabled without a container = each session keeps its own pre-packed weight, so nothing
+  // outlives the sessions
+  {
+    SessionOptions sess_options;
+    sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+
+    SharedInitializerStore store;
+
+    auto model_1 = create_model();
+    SessionState session_state_1(model_1->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                 DefaultLoggingManager().DefaultLogger(), profiler, false, true, nullptr, &store);
+    ASSERT_STATUS_OK(session_state_1.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                          kernel_registry_manager, sess_options));
+    ASSERT_EQ(session_state_1.GetNumberOfPrepacksCounter(), size_t(1));
+
+    auto model_2 = create_model();
+    SessionState session_state_2(model_2->MainGraph(), execution_providers, true, tp.get(), nullptr, dtm,
+                                 DefaultLoggingManager().DefaultLogger(), profiler, false, true, nullptr, &store);
+    ASSERT_STATUS_OK(session_state_2.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                          kernel_registry_manager, sess_options));
+    ASSERT_EQ(session_state_2.GetNumberOfPrepacksCounter(), size_t(1));
+    ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), size_t(0));
+
+    ASSERT_EQ(session_state_1.GetConstantInitializedTensors().size(), size_t(0));
+    ASSERT_EQ(session_state_2.GetConstantInitializedTensors().size(), size_t(0));
+    ASSERT_EQ(store.GetStats().num_tensors, size_t(0));
   }
 }
 
@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <functional>
+#include <numeric>
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "core/graph/model.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
+
+using namespace ONNX_NAMESPACE;
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+// An input of the tested node. Unless it is an initializer, it is the output of a Reshape of a flat graph input of
+// any size that is declared with `declared_shape`, so the input of the node is static while the shape it has at run
+// time is given by the target shape fed to the Reshape. Running with `run_shape` checks that the kernel falls back to
+// computing its state when the shapes differ from the static ones.
+struct NodeInput {
+  std::vector<int64_t> declared_shape;
+  std::vector<int64_t> run_shape;
+  bool is_initializer = false;
+};
+
+int64_t Size(const std::vector<int64_t>& shape) {
+  return std::accumulate(shape.begin(), shape.end(), int64_t{1}, std::multiplies<int64_t>());
+}
+
+std::vector<float> MakeData(int64_t size) {
+  std::vector<float> data(static_cast<size_t>(size));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(static_cast<int64_t>((i * 7) % 11) - 5) / 4.0f;
+  }
+  return data;
+}
+
+std::string BuildModel(const std::string& op_type, const NodeAttributes& attributes,
+                       const std::vector<NodeInput>& inputs) {
+  Model model("StaticShapeKernels", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 17}}, {}, DefaultLoggingManager().DefaultLogger());
+  Graph& graph = model.MainGraph();
+
+  auto make_type = [](TensorProto_DataType elem_type, const std::vector<int64_t>& shape) {
+    TypeProto type;
+    type.mutable_tensor_type()->set_elem_type(elem_type);
+    auto* shape_proto = type.mutable_tensor_type()->mutable_shape();
+    for (auto dim : shape) {
+      shape_proto->add_dim()->set_dim_value(dim);
+    }
+    return type;
+  };
+
+  std::vector<NodeArg*> node_inputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto& input = inputs[i];
+    const auto index = std::to_string(i);
+    const auto declared_type = make_type(TensorProto_DataType_FLOAT, input.declared_shape);
+
+    if (input.is_initializer) {
+      TensorProto initializer;
+      initializer.set_name("W" + index);
+      initializer.set_data_type(TensorProto_DataType_FLOAT);
+      for (auto dim : input.declared_shape) {
+        initializer.add_dims(dim);
+      }
+      for (float value : MakeData(Size(input.declared_shape))) {
+        initializer.add_float_data(value);
+      }
+      graph.AddInitializedTensor(initializer);
+      node_inputs.push_back(&graph.GetOrCreateNodeArg("W" + index, &declared_type));
+      continue;
+    }
+
+    TypeProto flat_type;
+    flat_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    flat_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N" + index);
+    const auto shape_type = make_type(TensorProto_DataType_INT64,
+                                      {static_cast<int64_t>(input.declared_shape.size())});
+    auto& flat = graph.GetOrCreateNodeArg("X" + index, &flat_type);
+    auto& shape = graph.GetOrCreateNodeArg("shape" + index, &shape_type);
+    auto& reshaped = graph.GetOrCreateNodeArg("reshaped" + index, &declared_type);
+    graph.AddNode("reshape" + index, "Reshape", "", {&flat, &shape}, {&reshaped});
+    node_inputs.push_back(&reshaped);
+  }
+
+  TypeProto output_type;
+  output_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  auto& output = graph.GetOrCreateNodeArg("Y", &output_type);
+  graph.AddNode("node", op_type, "", node_inputs, {&output}, &attributes);
+
+  EXPECT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+// Runs the model with the inputs reshaped to their declared shapes and then to their run time shapes, and returns the
+// outputs of both runs.
+std::vector<OrtValue> RunModel(const std::string& model_data, const std::vector<NodeInput>& inputs,
+                               bool static_shape_kernels, size_t& num_static_shape_kernels) {
+  SessionOptions so;
+  so.enable_mem_pattern = false;
+  so.config_options.configurations[kOrtSessionOptionsConfigStaticShapeKernels] = static_shape_kernels ? "1" : "0";
+
+  InferenceSessionWrapper session(so, GetEnvironment());
+  std::stringstream model_stream(model_data);
+  EXPECT_STATUS_OK(session.Load(model_stream));
+  EXPECT_STATUS_OK(session.Initialize());
+  num_static_shape_kernels = session.GetSessionState().GetNumberOfStaticShapeKernels();
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<OrtValue> outputs;
+  for (bool use_run_shapes : {false, true}) {
+    NameMLValMap feeds;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const auto& input = inputs[i];
+      if (input.is_initializer) {
+        continue;
+      }
+
+      const auto index = std::to_string(i);
+      const auto& shape = use_run_shapes ? input.run_shape : input.declared_shape;
+      OrtValue flat_value;
+      CreateMLValue<float>(allocator, {Size(shape)}, MakeData(Size(shape)), &flat_value);
+      OrtValue shape_value;
+      CreateMLValue<int64_t>(allocator, {static_cast<int64_t>(shape.size())}, shape, &shape_value);
+      feeds.emplace("X" + index, flat_value);
+      feeds.emplace("shape" + index, shape_value);
+    }
+
+    std::vector<OrtValue> fetches;
+    EXPECT_STATUS_OK(session.Run(RunOptions{}, feeds, {"Y"}, &fetches));
+    outputs.push_back(fetches.at(0));
+  }
+  return outputs;
+}
+
+// Checks that the node precomputes its state and that the outputs match those computed without the precomputed
+// state, both for the declared shapes and for the different shapes the inputs have at run time.
+void TestStaticShapeKernel(const std::string& op_type, const NodeAttributes& attributes,
+                           const std::vector<NodeInput>& inputs) {
+  const std::string model_data = BuildModel(op_type, attributes, inputs);
+
+  size_t num_static_shape_kernels = 0;
+  const auto expected = RunModel(model_data, inputs, false, num_static_shape_kernels);
+  EXPECT_EQ(num_static_shape_kernels, 0u);
+
+  const auto actual = RunModel(model_data, inputs, true, num_static_shape_kernels);
+  EXPECT_GT(num_static_shape_kernels, 0u) << op_type << " did not precompute its state";
+
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    const auto& actual_tensor = actual[i].Get<Tensor>();
+    const auto& expected_tensor = expected[i].Get<Tensor>();
+    EXPECT_EQ(actual_tensor.Shape(), expected_tensor.Shape()) << (i == 0 ? "declared shapes" : "run time shapes");
+    EXPECT_THAT(actual_tensor.DataAsSpan<float>(), ::testing::ContainerEq(expected_tensor.DataAsSpan<float>()))
+        << (i == 0 ? "declared shapes" : "run time shapes");
+  }
+}
+
+NodeAttributes MakeAttributes(const std::vector<AttributeProto>& attribute_protos) {
+  NodeAttributes attributes;
+  for (const auto& attribute : attribute_protos) {
+    attributes[attribute.name()] = attribute;
+  }
+  return attributes;
+}
+
+AttributeProto MakeIntAttribute(const std::string& name, int64_t value) {
+  AttributeProto attribute;
+  attribute.set_name(name);
+  attribute.set_type(AttributeProto_AttributeType_INT);
+  attribute.set_i(value);
+  return attribute;
+}
+
+}  // namespace
+
+TEST(StaticShapeKernelsTest, Gemm) {
+  TestStaticShapeKernel("Gemm", {}, {{{4, 3}, {2, 5}}, {{3, 4}, {5, 3}}});
+}
+
+TEST(StaticShapeKernelsTest, GemmTransposedWithBias) {
+  TestStaticShapeKernel("Gemm", MakeAttributes({MakeIntAttribute("transB", 1)}),
+                        {{{4, 3}, {6, 3}}, {{5, 3}, {5, 3}, true}, {{5}, {5}, true}});
+}
+
+TEST(StaticShapeKernelsTest, Softmax) {
+  TestStaticShapeKernel("Softmax", MakeAttributes({MakeIntAttribute("axis", 1)}), {{{2, 3, 4}, {3, 2, 5}}});
+}
+
+TEST(StaticShapeKernelsTest, LayerNormalization) {
+  TestStaticShapeKernel("LayerNormalization", MakeAttributes({MakeIntAttribute("axis", -1)}),
+                        {{{2, 3, 4}, {3, 5, 4}}, {{4}, {4}, true}, {{4}, {4}, true}});
+}
+
+TEST(StaticShapeKernelsTest, LayerNormalizationOuterAxis) {
+  TestStaticShapeKernel("LayerNormalization", MakeAttributes({MakeIntAttribute("axis", 1)}),
+                        {{{2, 3, 2}, {4, 3, 2}}, {{3, 2}, {3, 2}, true}});
+}
+
+TEST(StaticShapeKernelsTest, Conv) {
+  TestStaticShapeKernel("Conv", {}, {{{1, 1, 4, 6}, {1, 1, 5, 7}}, {{2, 1, 3, 3}, {2, 1, 3, 3}, true}});
+}
+
+}  // namespace test
+}  // namespace onnxruntime
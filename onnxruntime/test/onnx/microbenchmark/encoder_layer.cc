@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "common.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <core/framework/tensor.h>
+#include <core/graph/model.h>
+#include <core/session/inference_session.h>
+#include <core/session/ort_env.h>
+
+using namespace onnxruntime;
+
+extern OrtEnv* env;
+
+namespace {
+
+// One BERT-base sized post-LayerNorm encoder layer, as left behind by the Attention, SkipLayerNorm and BiasGelu
+// fusions.
+constexpr int64_t kHiddenSize = 768;
+constexpr int64_t kNumHeads = 12;
+constexpr int64_t kIntermediateSize = 3072;
+
+std::string BuildEncoderLayerModel(const logging::Logger& logger) {
+  std::unordered_map<std::string, int> domain_to_version{{kOnnxDomain, 13}, {kMSDomain, 1}};
+  Model model("encoder_layer", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, {}, logger);
+  Graph& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto input_type;
+  input_type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  auto* input_shape = input_type.mutable_tensor_type()->mutable_shape();
+  input_shape->add_dim()->set_dim_param("batch_size");
+  input_shape->add_dim()->set_dim_param("sequence_length");
+  input_shape->add_dim()->set_dim_value(kHiddenSize);
+
+  ONNX_NAMESPACE::TypeProto float_type;
+  float_type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+  int initializer_count = 0;
+  auto add_initializer = [&](const std::vector<int64_t>& dims, float low, float high) -> NodeArg* {
+    ONNX_NAMESPACE::TensorProto tensor;
+    tensor.set_name("W" + std::to_string(initializer_count++));
+    tensor.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    size_t size = 1;
+    for (auto dim : dims) {
+      tensor.add_dims(dim);
+      size *= static_cast<size_t>(dim);
+    }
+    float* data = GenerateArrayWithRandomValue<float>(size, low, high);
+    tensor.set_raw_data(data, size * sizeof(float));
+    aligned_free(data);
+    graph.AddInitializedTensor(tensor);
+    return &graph.GetOrCreateNodeArg(tensor.name(), nullptr);
+  };
+  auto intermediate = [&](const char* name) { return &graph.GetOrCreateNodeArg(name, &float_type); };
+
+  NodeArg* input = &graph.GetOrCreateNodeArg("input", &input_type);
+  NodeArg* output = &graph.GetOrCreateNodeArg("output", &input_type);
+
+  graph.AddNode("attention", "Attention", "",
+                {input, add_initializer({kHiddenSize, 3 * kHiddenSize}, -0.05f, 0.05f),
+                 add_initializer({3 * kHiddenSize}, -0.1f, 0.1f)},
+                {intermediate("attention_out")}, nullptr, kMSDomain)
+      .AddAttribute("num_heads", kNumHeads);
+  graph.AddNode("dense", "MatMul", "",
+                {intermediate("attention_out"), add_initializer({kHiddenSize, kHiddenSize}, -0.05f, 0.05f)},
+                {intermediate("dense_out")});
+  graph.AddNode("attention_norm", "SkipLayerNormalization", "",
+                {intermediate("dense_out"), input, add_initializer({kHiddenSize}, 0.5f, 1.5f),
+                 add_initializer({kHiddenSize}, -0.1f, 0.1f), add_initializer({kHiddenSize}, -0.1f, 0.1f)},
+                {intermediate("hidden")}, nullptr, kMSDomain);
+  graph.AddNode("ffn1", "MatMul", "",
+                {intermediate("hidden"), add_initializer({kHiddenSize, kIntermediateSize}, -0.05f, 0.05f)},
+                {intermediate("ffn1_out")});
+  graph.AddNode("gelu", "BiasGelu", "",
+                {intermediate("ffn1_out"), add_initializer({kIntermediateSize}, -0.1f, 0.1f)},
+                {intermediate("gelu_out")}, nullptr, kMSDomain);
+  graph.AddNode("ffn2", "MatMul", "",
+                {intermediate("gelu_out"), add_initializer({kIntermediateSize, kHiddenSize}, -0.02f, 0.02f)},
+                {intermediate("ffn2_out")});
+  graph.AddNode("ffn_norm", "SkipLayerNormalization", "",
+                {intermediate("ffn2_out"), intermediate("hidden"), add_initializer({kHiddenSize}, 0.5f, 1.5f),
+                 add_initializer({kHiddenSize}, -0.1f, 0.1f), add_initializer({kHiddenSize}, -0.1f, 0.1f)},
+                {output}, nullptr, kMSDomain);
+
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+}  // namespace
+
+// Runs the layer with the EncoderLayer fusion enabled (fused = 1) or disabled (fused = 0), on batch_size *
+// sequence_length rows with the default intra-op thread pool.
+static void BM_EncoderLayer(benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  const int64_t sequence_length = state.range(1);
+  const bool fused = state.range(2) != 0;
+
+  auto logger = env->GetLoggingManager()->CreateLogger("encoder_layer");
+  const std::string model_data = BuildEncoderLayerModel(*logger);
+
+  SessionOptions so;
+  InferenceSession session(so, env->GetEnvironment());
+  auto status = session.Load(model_data.data(), static_cast<int>(model_data.size()));
+  if (status.IsOK() && !fused) {
+    status = session.FilterEnabledOptimizers({"EncoderLayerFusion"});
+  }
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  const size_t input_size = static_cast<size_t>(batch_size * sequence_length * kHiddenSize);
+  float* input_data = GenerateArrayWithRandomValue<float>(input_size, -1.0f, 1.0f);
+  OrtValue input;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape({batch_size, sequence_length, kHiddenSize}),
+                       input_data, OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator), input);
+  NameMLValMap feeds{{"input", input}};
+  const std::vector<std::string> output_names{"output"};
+
+  for (auto _ : state) {
+    std::vector<OrtValue> fetches;
+    status = session.Run(RunOptions{}, feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+  aligned_free(input_data);
+}
+
+// Few rows, where the threads would each get a block of one or a few rows, up to enough rows for blocks of the size
+// the kernel aims for.
+BENCHMARK(BM_EncoderLayer)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1, 8, 0})
+    ->Args({1, 8, 1})
+    ->Args({1, 32, 0})
+    ->Args({1, 32, 1})
+    ->Args({1, 128, 0})
+    ->Args({1, 128, 1})
+    ->Args({8, 128, 0})
+    ->Args({8, 128, 1})
+    ->Args({32, 128, 0})
+    ->Args({32, 128, 1});
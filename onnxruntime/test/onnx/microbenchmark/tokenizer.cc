@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/graph/constants.h>
+#include <core/graph/model.h>
+#include <core/session/onnxruntime_c_api.h>
+#include <core/session/ort_env.h>
+#include <onnx/defs/attr_proto_util.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace onnxruntime;
+
+extern OrtEnv* env;
+extern const OrtApi* g_ort;
+
+#define ORT_BREAK_ON_ERROR(expr)                                \
+  do {                                                          \
+    OrtStatus* onnx_status = (expr);                            \
+    if (onnx_status != NULL) {                                  \
+      state.SkipWithError(g_ort->GetErrorMessage(onnx_status)); \
+      g_ort->ReleaseStatus(onnx_status);                        \
+      return;                                                   \
+    }                                                           \
+  } while (0);
+
+namespace {
+
+// A model with a single Tokenizer node that splits a [rows] string tensor on the separators
+std::string CreateTokenizerModel(const std::vector<std::string>& separators, const logging::Logger& logger) {
+  Model model("tokenizer", false, logger);
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto string_tensor;
+  string_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_STRING);
+  auto& input_arg = graph.GetOrCreateNodeArg("text", &string_tensor);
+  auto& output_arg = graph.GetOrCreateNodeArg("tokens", &string_tensor);
+
+  NodeAttributes attributes;
+  attributes["mark"] = ONNX_NAMESPACE::MakeAttribute("mark", int64_t{0});
+  attributes["pad_value"] = ONNX_NAMESPACE::MakeAttribute("pad_value", std::string("#"));
+  attributes["mincharnum"] = ONNX_NAMESPACE::MakeAttribute("mincharnum", int64_t{1});
+  attributes["separators"] = ONNX_NAMESPACE::MakeAttribute("separators", separators);
+  graph.AddNode("tokenizer", "Tokenizer", "", {&input_arg}, {&output_arg}, &attributes, kMSDomain);
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+// rows documents of words_per_row words, separated by a space or a comma and a space
+std::vector<std::string> CreateDocuments(size_t rows, size_t words_per_row) {
+  static const char* const words[] = {"the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+                                      u8"быстрая", u8"лиса", u8"狐狸", "tokenizer", "a"};
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<size_t> word_dist(0, sizeof(words) / sizeof(words[0]) - 1);
+  std::uniform_int_distribution<int> comma_dist(0, 7);
+
+  std::vector<std::string> documents(rows);
+  for (auto& doc : documents) {
+    for (size_t i = 0; i < words_per_row; ++i) {
+      if (i > 0) {
+        doc += comma_dist(gen) == 0 ? ", " : " ";
+      }
+      doc += words[word_dist(gen)];
+    }
+  }
+  return documents;
+}
+
+void RunTokenizer(benchmark::State& state, const std::vector<std::string>& separators) {
+  const size_t rows = static_cast<size_t>(state.range(0));
+  const size_t words_per_row = static_cast<size_t>(state.range(1));
+
+  auto logger = env->GetLoggingManager()->CreateLogger("tokenizer_benchmark");
+  const std::string model_data = CreateTokenizerModel(separators, *logger);
+
+  OrtSessionOptions* session_options;
+  ORT_BREAK_ON_ERROR(g_ort->CreateSessionOptions(&session_options));
+  OrtSession* session;
+  ORT_BREAK_ON_ERROR(g_ort->CreateSessionFromArray(env, model_data.data(), model_data.size(), session_options,
+                                                   &session));
+
+  const std::vector<std::string> documents = CreateDocuments(rows, words_per_row);
+  std::vector<const char*> document_ptrs;
+  for (const auto& doc : documents) {
+    document_ptrs.push_back(doc.c_str());
+  }
+
+  OrtAllocator* allocator;
+  ORT_BREAK_ON_ERROR(g_ort->GetAllocatorWithDefaultOptions(&allocator));
+  const int64_t shape[] = {static_cast<int64_t>(rows)};
+  OrtValue* input;
+  ORT_BREAK_ON_ERROR(g_ort->CreateTensorAsOrtValue(allocator, shape, 1, ONNX_TENSOR_ELEMENT_DATA_TYPE_STRING,
+                                                   &input));
+  ORT_BREAK_ON_ERROR(g_ort->FillStringTensor(input, document_ptrs.data(), document_ptrs.size()));
+
+  const char* input_names[] = {"text"};
+  const char* output_names[] = {"tokens"};
+  for (auto _ : state) {
+    OrtValue* output = nullptr;
+    ORT_BREAK_ON_ERROR(g_ort->Run(session, nullptr, input_names, &input, 1, output_names, 1, &output));
+    g_ort->ReleaseValue(output);
+  }
+
+  g_ort->ReleaseValue(input);
+  g_ort->ReleaseSession(session);
+  g_ort->ReleaseSessionOptions(session_options);
+}
+
+}  // namespace
+
+// single character separators, split in one pass over the text
+static void BM_TokenizerCharSeparators(benchmark::State& state) {
+  RunTokenizer(state, {" ", ","});
+}
+
+// regular expression separators
+static void BM_TokenizerRegexSeparators(benchmark::State& state) {
+  RunTokenizer(state, {", ", " +", "fox|dog"});
+}
+
+// {rows, words per row}: many short documents and few long documents
+BENCHMARK(BM_TokenizerCharSeparators)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1000, 8})
+    ->Args({10000, 8})
+    ->Args({16, 2000})
+    ->Args({64, 20000});
+
+BENCHMARK(BM_TokenizerRegexSeparators)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1000, 8})
+    ->Args({10000, 8})
+    ->Args({16, 2000})
+    ->Args({64, 20000});
@@ -36,7 +36,9 @@
 #include "core/optimizer/div_mul_fusion.h"
 #include "core/optimizer/dropout_elimination.h"
 #include "core/optimizer/dynamic_quantize_matmul_fusion.h"
+#include "core/optimizer/elementwise_fusion.h"
 #include "core/optimizer/embed_layer_norm_fusion.h"
+#include "core/optimizer/encoder_layer_fusion.h"
 #include "core/optimizer/expand_elimination.h"
 #include "core/optimizer/fast_gelu_fusion.h"
 #include "core/optimizer/gather_to_split_fusion.h"
@@ -57,6 +59,7 @@
 #include "core/optimizer/matmul_integer_to_float.h"
 #include "core/optimizer/matmul_scale_fusion.h"
 #include "core/optimizer/matmul_transpose_fusion.h"
+#include "core/optimizer/nearest_neighbors_fusion.h"
 #include "core/optimizer/noop_elimination.h"
 #include "core/optimizer/not_where_fusion.h"
 #include "core/optimizer/propagate_cast_ops.h"
@@ -5780,5 +5783,302 @@ TEST_F(GraphTransformationTests, GatherToSplitFusion_Invalid) {
   }
 }
 
+TEST_F(GraphTransformationTests, ElementwiseFusion) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 3, 8}, -3.0f, 3.0f);
+    auto* condition_arg = builder.MakeInputBool({2, 3, 1});
+    auto* bias_arg = builder.MakeInitializer<float>({8}, -1.0f, 1.0f);
+    auto* divisor_arg = builder.MakeScalarInitializer<float>(1.41421356f);
+    auto* add_out = builder.MakeIntermediate();
+    auto* sigmoid_out = builder.MakeIntermediate();
+    auto* mul_out = builder.MakeIntermediate();
+    auto* div_out = builder.MakeIntermediate();
+    auto* erf_out = builder.MakeIntermediate();
+    auto* where_out = builder.MakeOutput();
+    auto* abs_out = builder.MakeOutput();
+    auto* neg_out = builder.MakeIntermediate();
+    auto* relu_out = builder.MakeOutput();
+
+    // the output of Add is used twice, and the output of Mul by Div and Where
+    builder.AddNode("Add", {input_arg, bias_arg}, {add_out});
+    builder.AddNode("Sigmoid", {add_out}, {sigmoid_out});
+    builder.AddNode("Mul", {add_out, sigmoid_out}, {mul_out});
+    builder.AddNode("Div", {mul_out, divisor_arg}, {div_out});
+    builder.AddNode("Erf", {div_out}, {erf_out});
+    builder.AddNode("Where", {condition_arg, erf_out, mul_out}, {where_out});
+
+    // Abs is not fused as its output is a graph output
+    builder.AddNode("Abs", {input_arg}, {abs_out});
+    builder.AddNode("Neg", {abs_out}, {neg_out});
+    builder.AddNode("Relu", {neg_out}, {relu_out});
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.FusedElementwise"], 2);
+    EXPECT_EQ(op_to_count["Add"], 0);
+    EXPECT_EQ(op_to_count["Sigmoid"], 0);
+    EXPECT_EQ(op_to_count["Mul"], 0);
+    EXPECT_EQ(op_to_count["Div"], 0);
+    EXPECT_EQ(op_to_count["Erf"], 0);
+    EXPECT_EQ(op_to_count["Where"], 0);
+    EXPECT_EQ(op_to_count["Abs"], 1);
+    EXPECT_EQ(op_to_count["Neg"], 0);
+    EXPECT_EQ(op_to_count["Relu"], 0);
+  };
+
+  TransformerTester(build_test_case,
+                    check_graph,
+                    TransformerLevel::Level1,
+                    TransformerLevel::Level2,
+                    13 /*opset_version*/,
+                    1e-6 /*per_sample_tolerance*/,
+                    1e-6 /*relative_per_sample_tolerance*/,
+                    std::make_unique<ElementwiseFusion>());
+}
+
+// The fused kernel uses the same routine as the standalone kernel of every operator, so fusing must not change a
+// single bit of the result. The rows span several blocks and end in a partial vector for the MLAS routines.
+TEST_F(GraphTransformationTests, ElementwiseFusionIsBitExact) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({3, 1301}, -4.0f, 4.0f);
+    auto* bias_arg = builder.MakeInput<float>({1301}, -1.0f, 1.0f);
+    auto* condition_arg = builder.MakeInputBool({3, 1});
+    auto* one_arg = builder.MakeScalarInitializer<float>(1.0f);
+    auto* three_arg = builder.MakeScalarInitializer<float>(3.0f);
+    auto* sub_out = builder.MakeIntermediate();
+    auto* exp_out = builder.MakeIntermediate();
+    auto* exp_plus_one_out = builder.MakeIntermediate();
+    auto* reciprocal_out = builder.MakeIntermediate();
+    auto* sigmoid_out = builder.MakeIntermediate();
+    auto* pow_out = builder.MakeIntermediate();
+    auto* erf_out = builder.MakeIntermediate();
+    auto* cube_out = builder.MakeIntermediate();
+    auto* abs_out = builder.MakeIntermediate();
+    auto* sqrt_out = builder.MakeIntermediate();
+    auto* neg_out = builder.MakeIntermediate();
+    auto* tanh_out = builder.MakeIntermediate();
+    auto* relu_out = builder.MakeIntermediate();
+    auto* relu_plus_one_out = builder.MakeIntermediate();
+    auto* mul_out = builder.MakeIntermediate();
+    auto* add_out = builder.MakeIntermediate();
+    auto* div_out = builder.MakeIntermediate();
+    auto* where_out = builder.MakeOutput();
+
+    builder.AddNode("Sub", {input_arg, bias_arg}, {sub_out});
+    builder.AddNode("Exp", {sub_out}, {exp_out});
+    builder.AddNode("Add", {exp_out, one_arg}, {exp_plus_one_out});
+    builder.AddNode("Reciprocal", {exp_plus_one_out}, {reciprocal_out});
+    builder.AddNode("Sigmoid", {sub_out}, {sigmoid_out});
+    builder.AddNode("Pow", {reciprocal_out, sigmoid_out}, {pow_out});
+    builder.AddNode("Erf", {sub_out}, {erf_out});
+    builder.AddNode("Pow", {sub_out, three_arg}, {cube_out});
+    builder.AddNode("Abs", {cube_out}, {abs_out});
+    builder.AddNode("Sqrt", {abs_out}, {sqrt_out});
+    builder.AddNode("Neg", {sqrt_out}, {neg_out});
+    builder.AddNode("Tanh", {neg_out}, {tanh_out});
+    builder.AddNode("Relu", {sub_out}, {relu_out});
+    builder.AddNode("Add", {relu_out, one_arg}, {relu_plus_one_out});
+    builder.AddNode("Mul", {pow_out, erf_out}, {mul_out});
+    builder.AddNode("Add", {mul_out, tanh_out}, {add_out});
+    builder.AddNode("Div", {add_out, relu_plus_one_out}, {div_out});
+    builder.AddNode("Where", {condition_arg, div_out, sub_out}, {where_out});
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.FusedElementwise"], 1);
+    EXPECT_EQ(session.GetGraph().NumberOfNodes(), 1);
+  };
+
+  TransformerTester(build_test_case,
+                    check_graph,
+                    TransformerLevel::Level1,
+                    TransformerLevel::Level2,
+                    13 /*opset_version*/,
+                    0.0 /*per_sample_tolerance*/,
+                    0.0 /*relative_per_sample_tolerance*/,
+                    std::make_unique<ElementwiseFusion>());
+}
+
+TEST_F(GraphTransformationTests, NearestNeighborsFusion) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* query_arg = builder.MakeInput<float>({4, 16}, -1.0f, 1.0f);
+    auto* database_arg = builder.MakeInitializer<float>({300, 16}, -1.0f, 1.0f);
+    auto* k_arg = builder.Make1DInitializer<int64_t>({5});
+    auto* cdist_out = builder.MakeIntermediate();
+    auto* values_out = builder.MakeOutput();
+    auto* indices_out = builder.MakeOutput();
+    auto* farthest_cdist_out = builder.MakeIntermediate();
+    auto* farthest_values_out = builder.MakeOutput();
+    auto* farthest_indices_out = builder.MakeOutput();
+
+    builder.AddNode("CDist", {query_arg, database_arg}, {cdist_out}, kMSDomain)
+        .AddAttribute("metric", "euclidean");
+    builder.AddNode("TopK", {cdist_out, k_arg}, {values_out, indices_out})
+        .AddAttribute("largest", static_cast<int64_t>(0));
+
+    // TopK of the farthest rows is not fused
+    builder.AddNode("CDist", {query_arg, database_arg}, {farthest_cdist_out}, kMSDomain)
+        .AddAttribute("metric", "sqeuclidean");
+    builder.AddNode("TopK", {farthest_cdist_out, k_arg}, {farthest_values_out, farthest_indices_out});
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NearestNeighbors"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.CDist"], 1);
+    EXPECT_EQ(op_to_count["TopK"], 1);
+  };
+
+  TransformerTester(build_test_case,
+                    check_graph,
+                    TransformerLevel::Level1,
+                    TransformerLevel::Level2,
+                    13 /*opset_version*/,
+                    1e-5 /*per_sample_tolerance*/,
+                    1e-5 /*relative_per_sample_tolerance*/,
+                    std::make_unique<NearestNeighborsFusion>());
+}
+
+TEST_F(GraphTransformationTests, EncoderLayerFusion) {
+  constexpr int64_t batch_size = 2, sequence_length = 5, hidden_size = 16, intermediate_size = 64;
+
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({batch_size, sequence_length, hidden_size}, -1.0f, 1.0f);
+    auto* mask_index_arg = builder.MakeInput<int32_t>({batch_size}, {5, 3});
+
+    // Two layers, the second with FastGelu and the inputs of its SkipLayerNormalization nodes swapped.
+    NodeArg* layer_input = input_arg;
+    for (int layer = 0; layer < 2; ++layer) {
+      auto* attention_out = builder.MakeIntermediate();
+      auto* dense_out = builder.MakeIntermediate();
+      auto* hidden_out = builder.MakeIntermediate();
+      auto* ffn1_out = builder.MakeIntermediate();
+      auto* gelu_out = builder.MakeIntermediate();
+      auto* ffn2_out = builder.MakeIntermediate();
+      auto* layer_out = layer == 0 ? builder.MakeIntermediate() : builder.MakeOutput();
+
+      builder.AddNode("Attention",
+                      {layer_input,
+                       builder.MakeInitializer<float>({hidden_size, 3 * hidden_size}, -0.25f, 0.25f),
+                       builder.MakeInitializer<float>({3 * hidden_size}, -0.1f, 0.1f),
+                       mask_index_arg},
+                      {attention_out}, kMSDomain)
+          .AddAttribute("num_heads", static_cast<int64_t>(2));
+      builder.AddNode("MatMul", {attention_out, builder.MakeInitializer<float>({hidden_size, hidden_size}, -0.25f, 0.25f)},
+                      {dense_out});
+
+      auto* gamma1 = builder.MakeInitializer<float>({hidden_size}, 0.5f, 1.5f);
+      auto* beta1 = builder.MakeInitializer<float>({hidden_size}, -0.1f, 0.1f);
+      auto* bias1 = builder.MakeInitializer<float>({hidden_size}, -0.1f, 0.1f);
+      builder.AddNode("SkipLayerNormalization",
+                      layer == 0 ? std::vector<NodeArg*>{dense_out, layer_input, gamma1, beta1, bias1}
+                                 : std::vector<NodeArg*>{layer_input, dense_out, gamma1, beta1, bias1},
+                      {hidden_out}, kMSDomain)
+          .AddAttribute("epsilon", 1e-5f);
+
+      builder.AddNode("MatMul", {hidden_out, builder.MakeInitializer<float>({hidden_size, intermediate_size}, -0.25f, 0.25f)},
+                      {ffn1_out});
+      builder.AddNode(layer == 0 ? "BiasGelu" : "FastGelu",
+                      {ffn1_out, builder.MakeInitializer<float>({intermediate_size}, -0.1f, 0.1f)},
+                      {gelu_out}, kMSDomain);
+      builder.AddNode("MatMul", {gelu_out, builder.MakeInitializer<float>({intermediate_size, hidden_size}, -0.125f, 0.125f)},
+                      {ffn2_out});
+
+      auto* gamma2 = builder.MakeInitializer<float>({hidden_size}, 0.5f, 1.5f);
+      auto* beta2 = builder.MakeInitializer<float>({hidden_size}, -0.1f, 0.1f);
+      auto* bias2 = builder.MakeInitializer<float>({hidden_size}, -0.1f, 0.1f);
+      builder.AddNode("SkipLayerNormalization",
+                      layer == 0 ? std::vector<NodeArg*>{ffn2_out, hidden_out, gamma2, beta2, bias2}
+                                 : std::vector<NodeArg*>{hidden_out, ffn2_out, gamma2, beta2, bias2},
+                      {layer_out}, kMSDomain)
+          .AddAttribute("epsilon", 1e-5f);
+
+      layer_input = layer_out;
+    }
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.EncoderLayer"], 2);
+    EXPECT_EQ(op_to_count["com.microsoft.Attention"], 0);
+    EXPECT_EQ(op_to_count["com.microsoft.SkipLayerNormalization"], 0);
+    EXPECT_EQ(op_to_count["MatMul"], 0);
+  };
+
+  TransformerTester(build_test_case,
+                    check_graph,
+                    TransformerLevel::Level1,
+                    TransformerLevel::Level2,
+                    13 /*opset_version*/,
+                    1e-4 /*per_sample_tolerance*/,
+                    1e-4 /*relative_per_sample_tolerance*/,
+                    std::make_unique<EncoderLayerFusion>());
+}
+
+// Attention allows the hidden size of its input to differ from the hidden size of Q, K and V, which EncoderLayer
+// does not, so a layer whose output projection maps back to the input hidden size is left unfused.
+TEST_F(GraphTransformationTests, EncoderLayerFusionDifferentInputHiddenSize) {
+  constexpr int64_t batch_size = 2, sequence_length = 5, input_hidden_size = 24, hidden_size = 16,
+                    intermediate_size = 64;
+
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({batch_size, sequence_length, input_hidden_size}, -1.0f, 1.0f);
+    auto* attention_out = builder.MakeIntermediate();
+    auto* dense_out = builder.MakeIntermediate();
+    auto* hidden_out = builder.MakeIntermediate();
+    auto* ffn1_out = builder.MakeIntermediate();
+    auto* gelu_out = builder.MakeIntermediate();
+    auto* ffn2_out = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+
+    builder.AddNode("Attention",
+                    {input_arg,
+                     builder.MakeInitializer<float>({input_hidden_size, 3 * hidden_size}, -0.25f, 0.25f),
+                     builder.MakeInitializer<float>({3 * hidden_size}, -0.1f, 0.1f)},
+                    {attention_out}, kMSDomain)
+        .AddAttribute("num_heads", static_cast<int64_t>(2));
+    builder.AddNode("MatMul",
+                    {attention_out, builder.MakeInitializer<float>({hidden_size, input_hidden_size}, -0.25f, 0.25f)},
+                    {dense_out});
+    builder.AddNode("SkipLayerNormalization",
+                    {dense_out, input_arg,
+                     builder.MakeInitializer<float>({input_hidden_size}, 0.5f, 1.5f),
+                     builder.MakeInitializer<float>({input_hidden_size}, -0.1f, 0.1f)},
+                    {hidden_out}, kMSDomain);
+    builder.AddNode("MatMul",
+                    {hidden_out, builder.MakeInitializer<float>({input_hidden_size, intermediate_size}, -0.25f, 0.25f)},
+                    {ffn1_out});
+    builder.AddNode("BiasGelu", {ffn1_out, builder.MakeInitializer<float>({intermediate_size}, -0.1f, 0.1f)},
+                    {gelu_out}, kMSDomain);
+    builder.AddNode("MatMul",
+                    {gelu_out, builder.MakeInitializer<float>({intermediate_size, input_hidden_size}, -0.125f, 0.125f)},
+                    {ffn2_out});
+    builder.AddNode("SkipLayerNormalization",
+                    {ffn2_out, hidden_out,
+                     builder.MakeInitializer<float>({input_hidden_size}, 0.5f, 1.5f),
+                     builder.MakeInitializer<float>({input_hidden_size}, -0.1f, 0.1f)},
+                    {output_arg}, kMSDomain);
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.EncoderLayer"], 0);
+    EXPECT_EQ(op_to_count["com.microsoft.Attention"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.SkipLayerNormalization"], 2);
+    EXPECT_EQ(op_to_count["MatMul"], 3);
+  };
+
+  TransformerTester(build_test_case,
+                    check_graph,
+                    TransformerLevel::Level1,
+                    TransformerLevel::Level2,
+                    13 /*opset_version*/,
+                    0.0 /*per_sample_tolerance*/,
+                    0.0 /*relative_per_sample_tolerance*/,
+                    std::make_unique<EncoderLayerFusion>());
+}
+
 }  // namespace test
 }  // namespace onnxruntime
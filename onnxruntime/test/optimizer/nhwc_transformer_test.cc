@@ -8,6 +8,8 @@
 #include "graph_transform_test_builder.h"
 
 #include "core/graph/graph.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "test/util/include/asserts.h"
 
 namespace onnxruntime {
 namespace test {
@@ -500,6 +502,279 @@ TEST(NhwcTransformerTests, ConvMixTensorRanks) {
                     TransformerLevel::Level3);
 }
 
+// Runs float nodes in NHWC, which is opt-in.
+static void EnableNhwcFloatLayout(SessionOptions& session_options) {
+  ASSERT_STATUS_OK(session_options.config_options.AddConfigEntry(kOrtSessionOptionsConfigNhwcFloatLayout, "1"));
+}
+
+TEST(NhwcTransformerTests, FloatConv) {
+  auto test_case = [&](const std::vector<int64_t>& input_shape, const std::vector<int64_t>& weights_shape,
+                       int64_t group) {
+    auto build_test_case = [&](ModelTestBuilder& builder) {
+      auto* input_arg = builder.MakeInput<float>(input_shape, -1.0f, 1.0f);
+      auto* output_arg = builder.MakeOutput();
+      auto* weight_arg = builder.MakeInitializer<float>(weights_shape, -0.5f, 0.5f);
+      auto* bias_arg = builder.MakeInitializer<float>({weights_shape[0]}, -0.5f, 0.5f);
+
+      Node& conv_node = builder.AddNode("Conv", {input_arg, weight_arg, bias_arg}, {output_arg});
+      conv_node.AddAttribute("group", group);
+      conv_node.AddAttribute("strides", std::vector<int64_t>(input_shape.size() - 2, 2));
+      conv_node.AddAttribute("auto_pad", std::string("SAME_UPPER"));
+    };
+
+    auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+      auto op_to_count = CountOpsInGraph(session.GetGraph());
+      EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 1);
+      EXPECT_EQ(op_to_count["Conv"], 0);
+      EXPECT_EQ(op_to_count["com.microsoft.nchwc.ReorderInput"], 0);
+      EXPECT_EQ(op_to_count["Transpose"], 2);
+    };
+
+    TransformerTester(build_test_case,
+                      check_nhwc_graph,
+                      TransformerLevel::Level2,
+                      TransformerLevel::Level3,
+                      12, 1e-4, 1e-4, nullptr, EnableNhwcFloatLayout);
+  };
+
+  // Regular, grouped and depthwise 1D/2D/3D convolutions.
+  test_case({1, 12, 37}, {32, 12, 5}, 1);
+  test_case({1, 23, 13, 13}, {30, 23, 3, 3}, 1);
+  test_case({1, 24, 13, 13}, {30, 8, 3, 3}, 3);
+  test_case({1, 24, 13, 13}, {24, 1, 3, 3}, 24);
+  test_case({1, 22, 11, 13, 15}, {30, 22, 5, 3, 3}, 1);
+}
+
+TEST(NhwcTransformerTests, FloatConvBlock) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 16, 17, 17}, -1.0f, 1.0f);
+    auto* conv1_output_arg = builder.MakeIntermediate();
+    auto* relu_output_arg = builder.MakeIntermediate();
+    auto* maxpool_output_arg = builder.MakeIntermediate();
+    auto* conv2_output_arg = builder.MakeIntermediate();
+    auto* avgpool_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+
+    auto* conv1_weight_arg = builder.MakeInitializer<float>({32, 16, 3, 3}, -0.5f, 0.5f);
+    Node& conv1_node = builder.AddConvNode(input_arg, conv1_weight_arg, conv1_output_arg);
+    conv1_node.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+    builder.AddNode("Relu", {conv1_output_arg}, {relu_output_arg});
+
+    Node& maxpool_node = builder.AddNode("MaxPool", {relu_output_arg}, {maxpool_output_arg});
+    maxpool_node.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+    maxpool_node.AddAttribute("strides", std::vector<int64_t>{2, 2});
+    maxpool_node.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+
+    // Pointwise convolution.
+    auto* conv2_weight_arg = builder.MakeInitializer<float>({24, 32, 1, 1}, -0.5f, 0.5f);
+    builder.AddConvNode(maxpool_output_arg, conv2_weight_arg, conv2_output_arg);
+
+    Node& avgpool_node = builder.AddNode("AveragePool", {conv2_output_arg}, {avgpool_output_arg});
+    avgpool_node.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+    avgpool_node.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+    avgpool_node.AddAttribute("ceil_mode", static_cast<int64_t>(1));
+    avgpool_node.AddAttribute("strides", std::vector<int64_t>{2, 2});
+
+    builder.AddNode("GlobalAveragePool", {avgpool_output_arg}, {output_arg});
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcFusedConv"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcMaxPool"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcAveragePool"], 1);
+    EXPECT_EQ(op_to_count["ReduceMean"], 1);
+    EXPECT_EQ(op_to_count["Transpose"], 2);
+  };
+
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3,
+                    12, 1e-4, 1e-4, nullptr, EnableNhwcFloatLayout);
+}
+
+TEST(NhwcTransformerTests, FloatConvBatchNormalization) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 8, 11, 11}, -1.0f, 1.0f);
+    auto* conv_output_arg = builder.MakeIntermediate();
+    auto* relu_output_arg = builder.MakeIntermediate();
+    auto* bn_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+
+    auto* conv1_weight_arg = builder.MakeInitializer<float>({16, 8, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(input_arg, conv1_weight_arg, conv_output_arg);
+    builder.AddNode("Relu", {conv_output_arg}, {relu_output_arg});
+
+    // The activation between the convolution and BatchNormalization prevents folding it into the convolution.
+    auto* scale_arg = builder.MakeInitializer<float>({16}, 0.5f, 1.5f);
+    auto* b_arg = builder.MakeInitializer<float>({16}, -0.5f, 0.5f);
+    auto* mean_arg = builder.MakeInitializer<float>({16}, -0.5f, 0.5f);
+    auto* var_arg = builder.MakeInitializer<float>({16}, 0.5f, 1.5f);
+    builder.AddNode("BatchNormalization", {relu_output_arg, scale_arg, b_arg, mean_arg, var_arg}, {bn_output_arg});
+
+    auto* conv2_weight_arg = builder.MakeInitializer<float>({8, 16, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(bn_output_arg, conv2_weight_arg, output_arg);
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcFusedConv"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 1);
+    EXPECT_EQ(op_to_count["BatchNormalization"], 0);
+    EXPECT_EQ(op_to_count["Transpose"], 2);
+  };
+
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3,
+                    12, 1e-4, 1e-4, nullptr, EnableNhwcFloatLayout);
+}
+
+TEST(NhwcTransformerTests, FloatConvPadConcat) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 8, 9, 9}, -1.0f, 1.0f);
+    auto* conv1_output_arg = builder.MakeIntermediate();
+    auto* pad_output_arg = builder.MakeIntermediate();
+    auto* conv2_output_arg = builder.MakeIntermediate();
+    auto* conv3_output_arg = builder.MakeIntermediate();
+    auto* concat_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+
+    auto* conv1_weight_arg = builder.MakeInitializer<float>({8, 8, 1, 1}, -0.5f, 0.5f);
+    builder.AddConvNode(input_arg, conv1_weight_arg, conv1_output_arg);
+
+    auto* pads_arg = builder.Make1DInitializer<int64_t>({0, 0, 1, 1, 0, 0, 1, 1});
+    builder.AddNode("Pad", {conv1_output_arg, pads_arg}, {pad_output_arg});
+
+    auto* conv2_weight_arg = builder.MakeInitializer<float>({8, 8, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(pad_output_arg, conv2_weight_arg, conv2_output_arg);
+    auto* conv3_weight_arg = builder.MakeInitializer<float>({4, 8, 1, 1}, -0.5f, 0.5f);
+    builder.AddConvNode(conv1_output_arg, conv3_weight_arg, conv3_output_arg);
+
+    Node& concat_node = builder.AddNode("Concat", {conv2_output_arg, conv3_output_arg}, {concat_output_arg});
+    concat_node.AddAttribute("axis", static_cast<int64_t>(1));
+
+    auto* conv4_weight_arg = builder.MakeInitializer<float>({6, 12, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(concat_output_arg, conv4_weight_arg, output_arg);
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 4);
+    EXPECT_EQ(op_to_count["Transpose"], 2);
+  };
+
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3,
+                    12, 1e-4, 1e-4, nullptr, EnableNhwcFloatLayout);
+}
+
+TEST(NhwcTransformerTests, FloatConvNotEnabled) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 8, 9, 9}, -1.0f, 1.0f);
+    auto* output_arg = builder.MakeOutput();
+    auto* weight_arg = builder.MakeInitializer<float>({8, 8, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(input_arg, weight_arg, output_arg);
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 0);
+    EXPECT_EQ(op_to_count["Transpose"], 0);
+  };
+
+  // Float models keep their layout unless NHWC is requested.
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3,
+                    12, 1e-4, 1e-4);
+}
+
+TEST(NhwcTransformerTests, ConvDequantizeFloatPoolsNotEnabled) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<uint8_t>({1, 16, 17, 17}, 0, 31);
+    auto* conv_output_arg = builder.MakeIntermediate();
+    auto* dq_output_arg = builder.MakeIntermediate();
+    auto* maxpool_output_arg = builder.MakeIntermediate();
+    auto* avgpool_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+    auto* conv_weight_arg = NhwcMakeInitializer<uint8_t>(builder, {16, 16, 3, 3});
+
+    builder.AddQLinearConvNode<uint8_t>(input_arg, .01f, 135,
+                                        conv_weight_arg, .02f, 126,
+                                        conv_output_arg, .37f, 131);
+    builder.AddDequantizeLinearNode<uint8_t>(conv_output_arg, .37f, 131, dq_output_arg);
+
+    Node& maxpool_node = builder.AddNode("MaxPool", {dq_output_arg}, {maxpool_output_arg});
+    maxpool_node.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+    Node& avgpool_node = builder.AddNode("AveragePool", {maxpool_output_arg}, {avgpool_output_arg});
+    avgpool_node.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+    builder.AddNode("GlobalAveragePool", {avgpool_output_arg}, {output_arg});
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.QLinearConv"], 1);
+    EXPECT_EQ(op_to_count["MaxPool"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcMaxPool"], 0);
+    EXPECT_EQ(op_to_count["AveragePool"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcAveragePool"], 0);
+    EXPECT_EQ(op_to_count["GlobalAveragePool"], 1);
+    EXPECT_EQ(op_to_count["ReduceMean"], 0);
+    EXPECT_EQ(op_to_count["Transpose"], 2);
+  };
+
+  // The transpose after the QLinearConv stops at the float pooling nodes unless the float NHWC layout is requested.
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3);
+}
+
+TEST(NhwcTransformerTests, FloatConvResize) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 8, 9, 9}, -1.0f, 1.0f);
+    auto* conv1_output_arg = builder.MakeIntermediate();
+    auto* resize_output_arg = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+
+    auto* conv1_weight_arg = builder.MakeInitializer<float>({8, 8, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(input_arg, conv1_weight_arg, conv1_output_arg);
+
+    auto* roi_arg = builder.MakeInitializer<float>({0}, {});
+    auto* scales_arg = builder.MakeInitializer<float>({4}, {1.0f, 1.0f, 2.0f, 2.0f});
+    builder.AddNode("Resize", {conv1_output_arg, roi_arg, scales_arg}, {resize_output_arg});
+
+    auto* conv2_weight_arg = builder.MakeInitializer<float>({4, 8, 3, 3}, -0.5f, 0.5f);
+    builder.AddConvNode(resize_output_arg, conv2_weight_arg, output_arg);
+  };
+
+  auto check_nhwc_graph = [&](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["com.microsoft.NhwcConv"], 2);
+    EXPECT_EQ(op_to_count["Resize"], 1);
+#if !defined(USE_CUDA) && !defined(USE_ROCM)
+    // The Resize handler moves the transposes between the convolutions past the Resize, where they cancel out.
+    EXPECT_EQ(op_to_count["Transpose"], 2);
+#else
+    // The Resize handler is not available with CUDA or ROCm, so the Resize stays NCHW between two transposes.
+    EXPECT_EQ(op_to_count["Transpose"], 4);
+#endif
+  };
+
+  TransformerTester(build_test_case,
+                    check_nhwc_graph,
+                    TransformerLevel::Level2,
+                    TransformerLevel::Level3,
+                    12, 1e-4, 1e-4, nullptr, EnableNhwcFloatLayout);
+}
+
 #endif  // DISABLE_CONTRIB_OPS
 
 }  // namespace test
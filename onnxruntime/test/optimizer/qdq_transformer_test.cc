@@ -6,6 +6,7 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/mlas/inc/mlas.h"
 #include "core/optimizer/qdq_transformer/qdq_final_cleanup.h"
+#include "core/optimizer/qlinear_elementwise_chain_fusion.h"
 #include "core/optimizer/qdq_transformer/selectors_actions/qdq_selectors.h"
 #include "core/optimizer/qdq_transformer/selectors_actions/qdq_selector_action_transformer.h"
 #include "core/optimizer/qdq_transformer/selectors_actions/shared/utils.h"
@@ -2620,5 +2621,81 @@ TEST(QDQTransformerTests, QDQFinalCleanupTransformer_GraphInputToOutput) {
   test_case(false);
 }
 
+template <typename T>
+void QLinearElementwiseChainFusionTests() {
+  const T zp = static_cast<T>(std::is_same<T, int8_t>::value ? -3 : 131);
+
+  auto test_case = [&](const std::vector<int64_t>& input_shape, bool intermediate_output) {
+    auto build_test_case = [&](ModelTestBuilder& builder) {
+      auto* input_arg = builder.MakeInput<T>(input_shape, std::numeric_limits<T>::min(),
+                                             std::numeric_limits<T>::max());
+      auto* add_output = builder.MakeIntermediate();
+      auto* leakyrelu_output = intermediate_output ? builder.MakeOutput() : builder.MakeIntermediate();
+      auto* mul_output = builder.MakeIntermediate();
+      auto* output_arg = builder.MakeOutput();
+
+      auto add_binary_node = [&](const std::string& op_type, NodeArg* a, float a_scale, T a_zp,
+                                 NodeArg* b, float b_scale, T b_zp, NodeArg* c, float c_scale, T c_zp) {
+        builder.AddNode(op_type,
+                        {a, builder.MakeScalarInitializer<float>(a_scale), builder.MakeScalarInitializer<T>(a_zp),
+                         b, builder.MakeScalarInitializer<float>(b_scale), builder.MakeScalarInitializer<T>(b_zp),
+                         builder.MakeScalarInitializer<float>(c_scale), builder.MakeScalarInitializer<T>(c_zp)},
+                        {c}, kMSDomain);
+      };
+      auto add_activation_node = [&](const std::string& op_type, NodeArg* x, float x_scale, T x_zp,
+                                     NodeArg* y, float y_scale, T y_zp) -> Node& {
+        return builder.AddNode(op_type,
+                               {x, builder.MakeScalarInitializer<float>(x_scale),
+                                builder.MakeScalarInitializer<T>(x_zp),
+                                builder.MakeScalarInitializer<float>(y_scale),
+                                builder.MakeScalarInitializer<T>(y_zp)},
+                               {y}, kMSDomain);
+      };
+
+      // the constant operand is B of the QLinearAdd and A of the QLinearMul
+      auto* add_operand = builder.MakeScalarInitializer<T>(static_cast<T>(zp + 17));
+      add_binary_node("QLinearAdd", input_arg, .02f, zp, add_operand, .03f, zp, add_output, .025f, zp);
+      Node& leakyrelu_node = add_activation_node("QLinearLeakyRelu", add_output, .025f, zp,
+                                                 leakyrelu_output, .015f, zp);
+      leakyrelu_node.AddAttribute("alpha", 0.2f);
+      auto* mul_operand = builder.MakeScalarInitializer<T>(static_cast<T>(zp - 40));
+      add_binary_node("QLinearMul", mul_operand, .01f, zp, leakyrelu_output, .015f, zp, mul_output, .02f, zp);
+      add_activation_node("QLinearSigmoid", mul_output, .02f, zp, output_arg, 1.f / 256, zp);
+    };
+
+    auto check_graph = [&](InferenceSessionWrapper& session) {
+      auto op_to_count = CountOpsInGraph(session.GetGraph());
+      // an intermediate graph output splits the chain in two
+      EXPECT_EQ(op_to_count["com.microsoft.QLinearElementwiseChain"], intermediate_output ? 2 : 1);
+      EXPECT_EQ(op_to_count["com.microsoft.QLinearAdd"], 0);
+      EXPECT_EQ(op_to_count["com.microsoft.QLinearLeakyRelu"], 0);
+      EXPECT_EQ(op_to_count["com.microsoft.QLinearMul"], 0);
+      EXPECT_EQ(op_to_count["com.microsoft.QLinearSigmoid"], 0);
+    };
+
+    // the fused chain must produce exactly the values of the unfused operators
+    TransformerTester(build_test_case,
+                      check_graph,
+                      TransformerLevel::Level1,
+                      TransformerLevel::Level2,
+                      12 /*opset_version*/,
+                      0.0 /*per_sample_tolerance*/,
+                      0.0 /*relative_per_sample_tolerance*/,
+                      std::make_unique<QLinearElementwiseChainFusion>());
+  };
+
+  test_case({1, 12, 37}, false);
+  test_case({1, 23, 13, 13}, false);
+  test_case({1, 23, 13, 13}, true);
+}
+
+TEST(QDQTransformerTests, QLinearElementwiseChainFusion_U8) {
+  QLinearElementwiseChainFusionTests<uint8_t>();
+}
+
+TEST(QDQTransformerTests, QLinearElementwiseChainFusion_S8) {
+  QLinearElementwiseChainFusionTests<int8_t>();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -59,6 +59,36 @@ TEST(RuleBasedGraphTransformerTest, TestCompatibleProviders) {
   ASSERT_TRUE(dummy_rule1_ptr->IsRewriteRuleInvoked());
 }
 
+TEST(RuleBasedGraphTransformerTest, TestUnchangedTransformersAreNotRerun) {
+  auto model_uri = ORT_TSTR("testdata/transform/fusion/fuse-conv-bn-mul-add-unsqueeze.onnx");
+
+  std::shared_ptr<Model> model;
+  ASSERT_STATUS_OK(Model::Load(model_uri, model, nullptr, DefaultLoggingManager().DefaultLogger()));
+  Graph& graph = model->MainGraph();
+
+  auto unchanged_before = std::make_unique<CountingGraphTransformer>("UnchangedBefore", 0);
+  auto modifying = std::make_unique<CountingGraphTransformer>("Modifying", 2);
+  auto unchanged_after = std::make_unique<CountingGraphTransformer>("UnchangedAfter", 0);
+  const auto* unchanged_before_ptr = unchanged_before.get();
+  const auto* modifying_ptr = modifying.get();
+  const auto* unchanged_after_ptr = unchanged_after.get();
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::move(unchanged_before), TransformerLevel::Level2));
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::move(modifying), TransformerLevel::Level2));
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::move(unchanged_after), TransformerLevel::Level2));
+
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2,
+                                                              DefaultLoggingManager().DefaultLogger()));
+
+  // 'Modifying' changes the graph in steps 0 and 1 and is unchanged in step 2.
+  // 'UnchangedBefore' runs before each of those modifications is visible to it, i.e. in steps 0, 1 and 2.
+  // 'UnchangedAfter' sees every modification right after it happens and has nothing to do in step 2.
+  EXPECT_EQ(modifying_ptr->NumInvocations(), 3);
+  EXPECT_EQ(unchanged_before_ptr->NumInvocations(), 3);
+  EXPECT_EQ(unchanged_after_ptr->NumInvocations(), 2);
+}
+
 TEST(RuleBasedGraphTransformerTest, TestSettingStepsInGraphTransformerManager) {
   // steps provided at object construction time
   onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
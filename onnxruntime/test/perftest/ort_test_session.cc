@@ -488,9 +488,8 @@ select from 'TF8', 'TF16', 'UINT8', 'FLOAT', 'ITENSOR'. \n)");
 #endif
   } else if (provider_name == onnxruntime::kXnnpackExecutionProvider) {
 #ifdef USE_XNNPACK
-    session_options.AddConfigEntry(kOrtSessionOptionsConfigAllowIntraOpSpinning, "0");
-    session_options.AppendExecutionProvider(
-        "XNNPACK", {{"intra_op_num_threads", std::to_string(performance_test_config.run_config.intra_op_num_threads)}});
+    // xnnpack kernels run on the session intra-op thread pool, so intra_op_num_threads applies to them as well
+    session_options.AppendExecutionProvider("XNNPACK", {});
 #else
     ORT_THROW("Xnnpack is not supported in this build\n");
 #endif
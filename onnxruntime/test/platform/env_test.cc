@@ -4,6 +4,7 @@
 #include "core/platform/env.h"
 
 #include <fstream>
+#include <unordered_set>
 
 #include "gtest/gtest.h"
 
@@ -33,5 +34,55 @@ TEST(PlatformEnvTest, DirectoryCreationAndDeletion) {
   ASSERT_FALSE(env.FolderExists(root_dir));
 }
 
+TEST(PlatformEnvTest, NumaNodeProcessors) {
+  const auto& env = Env::Default();
+  const auto numa_nodes = env.GetNumaNodeProcessors();
+
+  // every logical processor belongs to at most one node
+  std::unordered_set<size_t> seen;
+  for (const auto& node_cpus : numa_nodes) {
+    for (size_t cpu : node_cpus) {
+      ASSERT_TRUE(seen.insert(cpu).second) << "processor " << cpu << " is listed by more than one NUMA node";
+    }
+  }
+}
+
+TEST(PlatformEnvTest, ParseSysfsList) {
+  using Ids = std::vector<size_t>;
+  EXPECT_EQ(ParseSysfsList("0"), Ids({0}));
+  EXPECT_EQ(ParseSysfsList("0-3"), Ids({0, 1, 2, 3}));
+  EXPECT_EQ(ParseSysfsList("0-3,8,10-11"), Ids({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseSysfsList("4,2"), Ids({4, 2}));
+  EXPECT_EQ(ParseSysfsList("12-12\n"), Ids({12}));
+
+  EXPECT_TRUE(ParseSysfsList("").empty());
+  EXPECT_TRUE(ParseSysfsList("\n").empty());
+  EXPECT_TRUE(ParseSysfsList(",,").empty());
+}
+
+TEST(PlatformEnvTest, ParseSysfsListSkipsMalformedRanges) {
+  using Ids = std::vector<size_t>;
+  EXPECT_TRUE(ParseSysfsList("a").empty());
+  EXPECT_TRUE(ParseSysfsList("-3").empty());
+  EXPECT_EQ(ParseSysfsList("1-,2"), Ids({2}));
+  EXPECT_EQ(ParseSysfsList("3-x,5"), Ids({5}));
+  EXPECT_EQ(ParseSysfsList("5-2,7"), Ids({7}));
+  EXPECT_EQ(ParseSysfsList("1-2-3,4"), Ids({4}));
+  EXPECT_EQ(ParseSysfsList("0,,1"), Ids({0, 1}));
+  EXPECT_EQ(ParseSysfsList("99999999999999999999999,1"), Ids({1}));
+  EXPECT_EQ(ParseSysfsList("0-99999999999,1"), Ids({1}));
+}
+
+TEST(PlatformEnvTest, NumaNodeAffinity) {
+  using Ids = std::vector<size_t>;
+  const Ids node_cpus{4, 5, 6, 7};
+  EXPECT_EQ(GetNumaNodeAffinity(node_cpus, 2), Ids({4, 5}));
+  EXPECT_EQ(GetNumaNodeAffinity(node_cpus, 4), node_cpus);
+  // threads beyond the size of the node wrap around to its first processors and never leave the node
+  EXPECT_EQ(GetNumaNodeAffinity(node_cpus, 6), Ids({4, 5, 6, 7, 4, 5}));
+  EXPECT_EQ(GetNumaNodeAffinity(ParseSysfsList("8,10-11"), 5), Ids({8, 10, 11, 8, 10}));
+  EXPECT_TRUE(GetNumaNodeAffinity(node_cpus, 0).empty());
+}
+
 }  // namespace test
 }  // namespace onnxruntime
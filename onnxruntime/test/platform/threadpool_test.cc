@@ -2,13 +2,18 @@
 // Licensed under the MIT License.
 
 #include "core/platform/threadpool.h"
+#include "core/common/cancellation_token.h"
 #include "core/platform/EigenNonBlockingThreadPool.h"
 #include "core/platform/ort_mutex.h"
 
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <memory>
 #include <functional>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -70,6 +75,21 @@ void TestParallelFor(const std::string& name, int num_threads, int num_tasks) {
   ValidateTestData(*test_data);
 }
 
+void TestCostParallelFor(const std::string& name, int num_threads, int num_tasks, double cost_per_task,
+                         bool mock_hybrid) {
+  auto test_data = CreateTestData(num_tasks);
+  CreateThreadPoolAndTest(
+      name, num_threads, [&](ThreadPool* tp) {
+        ThreadPool::TryParallelFor(tp, num_tasks, cost_per_task, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; i++) {
+            IncrementElement(*test_data, i);
+          }
+        });
+      },
+      0, mock_hybrid);
+  ValidateTestData(*test_data);
+}
+
 void TestBatchParallelFor(const std::string& name, int num_threads, int num_tasks, int batch_size) {
   auto test_data = CreateTestData(num_tasks);
 
@@ -411,6 +431,18 @@ TEST(ThreadPoolTest, TestConcurrentParallelFor_4Thread_4Conc_1MTasks_dynamic_blo
   TestConcurrentParallelFor("TestConcurrentParallelFor_4Thread_4Conc_1MTasks_dynamic_block_base_128", 4, 4, 1000000, 128, true);
 }
 
+TEST(ThreadPoolTest, TestConcurrentParallelFor_4Thread_4Conc_1MTasks_hybrid) {
+  TestConcurrentParallelFor("TestConcurrentParallelFor_4Thread_4Conc_1MTasks_hybrid", 4, 4, 1000000, 0, true);
+}
+
+TEST(ThreadPoolTest, TestCostParallelFor_4Thread_100KTasks_hybrid) {
+  TestCostParallelFor("TestCostParallelFor_4Thread_100KTasks_hybrid", 4, 100000, 1000.0, true);
+}
+
+TEST(ThreadPoolTest, TestCostParallelFor_4Thread_100KTasks) {
+  TestCostParallelFor("TestCostParallelFor_4Thread_100KTasks", 4, 100000, 1000.0, false);
+}
+
 TEST(ThreadPoolTest, TestBurstScheduling_0Tasks) {
   TestBurstScheduling("TestBurstScheduling_0Tasks", 0);
 }
@@ -505,6 +537,218 @@ TEST(ThreadPoolTest, TestStagedMultiLoopSections_4Thread_100Loop) {
   TestStagedMultiLoopSections("TestStagedMultiLoopSections_4Thread_100Loop", 4, 100);
 }
 
+TEST(ThreadPoolTest, TestSharedPoolThreadQuota) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 8, true);
+  auto tp_3_threads = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 3, true);
+  ThreadPool quota_view(tp.get(), 3, ThreadPoolPriority::LatencyCritical);
+  ThreadPool unlimited_view(tp.get(), 0, ThreadPoolPriority::LatencyCritical);
+  ASSERT_EQ(ThreadPool::DegreeOfParallelism(&quota_view), ThreadPool::DegreeOfParallelism(tp_3_threads.get()));
+  ASSERT_EQ(ThreadPool::DegreeOfParallelism(&unlimited_view), ThreadPool::DegreeOfParallelism(tp.get()));
+
+  auto test_data = CreateTestData(100);
+  ThreadPool::TrySimpleParallelFor(&quota_view, 100, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+  ValidateTestData(*test_data);
+}
+
+TEST(ThreadPoolTest, TestSharedPoolBatchYieldsToLatencyCritical) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  ThreadPool latency_view(tp.get(), 0, ThreadPoolPriority::LatencyCritical);
+  ThreadPool batch_view(tp.get(), 0, ThreadPoolPriority::Batch);
+
+  // Keep a latency critical loop running until the batch loop is done.
+  std::atomic<bool> latency_started{false};
+  std::atomic<bool> batch_done{false};
+  std::thread latency_thread([&]() {
+    ThreadPool::TrySimpleParallelFor(&latency_view, 2, [&](std::ptrdiff_t) {
+      latency_started = true;
+      while (!batch_done) {
+        std::this_thread::yield();
+      }
+    });
+  });
+  while (!latency_started) {
+    std::this_thread::yield();
+  }
+
+  // The helper threads of the batch loop yield before claiming any chunk, so the calling thread runs all of them.
+  constexpr int num_tasks = 100;
+  std::vector<std::thread::id> thread_ids(num_tasks);
+  ThreadPool::TrySimpleParallelFor(&batch_view, num_tasks, [&](std::ptrdiff_t i) {
+    thread_ids[i] = std::this_thread::get_id();
+  });
+  batch_done = true;
+  latency_thread.join();
+
+  const auto caller_id = std::this_thread::get_id();
+  ASSERT_TRUE(std::all_of(thread_ids.cbegin(), thread_ids.cend(), [&](std::thread::id id) { return id == caller_id; }));
+  ASSERT_EQ(ThreadPool::GetShareStats(&batch_view).chunks, static_cast<uint64_t>(num_tasks));
+
+  // Without latency critical work the batch loop uses the whole pool again.
+  auto test_data = CreateTestData(num_tasks);
+  ThreadPool::TrySimpleParallelFor(&batch_view, num_tasks, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+  ValidateTestData(*test_data);
+}
+
+TEST(ThreadPoolTest, TestSharedPoolStats) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  ThreadPool view(tp.get(), 2, ThreadPoolPriority::LatencyCritical);
+
+  auto test_data = CreateTestData(50);
+  for (int run = 0; run < 3; ++run) {
+    ThreadPool::TrySimpleParallelFor(&view, 50, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+  }
+  ValidateTestData(*test_data, 3);
+
+  const auto stats = ThreadPool::GetShareStats(&view);
+  ASSERT_EQ(stats.loops, 3u);
+  ASSERT_EQ(stats.chunks, 150u);
+  ASSERT_EQ(stats.yields, 0u);
+
+  // Only views of a shared pool have counters.
+  ASSERT_EQ(ThreadPool::GetShareStats(tp.get()).loops, 0u);
+  ASSERT_EQ(ThreadPool::GetShareStats(nullptr).loops, 0u);
+}
+
+TEST(ThreadPoolTest, TestWorkerStats) {
+  onnxruntime::ThreadOptions thread_options;
+  thread_options.collect_worker_stats = true;
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), thread_options, nullptr, 4, true);
+
+  // Tasks scheduled from outside the pool run on the workers, unlike the iterations of a loop which the calling
+  // thread may run on its own.
+  constexpr int num_tasks = 10;
+  std::atomic<int> count{0};
+  onnxruntime::Barrier b(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    ThreadPool::Schedule(tp.get(), [&]() {
+      ++count;
+      b.Notify();
+    });
+  }
+  b.Wait();
+  ASSERT_EQ(count, num_tasks);
+
+  // A worker counts a task after running it, so the last counts may lag behind the barrier.
+  auto total_tasks = [&]() {
+    uint64_t tasks = 0;
+    for (const auto& worker : ThreadPool::GetWorkerStats(tp.get())) {
+      tasks += worker.tasks;
+    }
+    return tasks;
+  };
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (total_tasks() < num_tasks && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(ThreadPool::GetWorkerStats(tp.get()).size(), 3u);
+  ASSERT_EQ(total_tasks(), static_cast<uint64_t>(num_tasks));
+
+  // Without collect_worker_stats or adaptive spinning the workers keep no counters.
+  auto tp_no_stats = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  onnxruntime::Barrier b_no_stats(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    ThreadPool::Schedule(tp_no_stats.get(), [&]() { b_no_stats.Notify(); });
+  }
+  b_no_stats.Wait();
+  for (const auto& worker : ThreadPool::GetWorkerStats(tp_no_stats.get())) {
+    ASSERT_EQ(worker.tasks, 0u);
+    ASSERT_EQ(worker.active_ns, 0u);
+  }
+
+  // A view reports the workers of the pool it shares, and a pool without workers has none.
+  ThreadPool view(tp.get(), 2, ThreadPoolPriority::LatencyCritical);
+  ASSERT_EQ(ThreadPool::GetWorkerStats(&view).size(), 3u);
+  auto tp_1_thread = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 1, true);
+  ASSERT_TRUE(ThreadPool::GetWorkerStats(tp_1_thread.get()).empty());
+  ASSERT_TRUE(ThreadPool::GetWorkerStats(nullptr).empty());
+}
+
+TEST(ThreadPoolTest, TestAdaptiveSpinning) {
+  onnxruntime::ThreadOptions thread_options;
+  thread_options.adaptive_spinning = true;
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), thread_options, nullptr, 4, true);
+
+  // Work arriving at a high rate.
+  auto test_data = CreateTestData(100);
+  for (int run = 0; run < 100; ++run) {
+    ThreadPool::TrySimpleParallelFor(tp.get(), 100, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+  }
+  ValidateTestData(*test_data, 100);
+
+  // Work arriving more rarely than the longest spin, which the workers should stop spinning for.
+  for (int run = 0; run < 10; ++run) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ThreadPool::TrySimpleParallelFor(tp.get(), 100, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+  }
+  ValidateTestData(*test_data, 110);
+
+  const auto stats = ThreadPool::GetWorkerStats(tp.get());
+  ASSERT_EQ(stats.size(), 3u);
+  uint64_t blocks = 0;
+  int64_t min_spin_limit_ns = std::numeric_limits<int64_t>::max();
+  for (const auto& worker : stats) {
+    blocks += worker.blocks;
+    min_spin_limit_ns = std::min(min_spin_limit_ns, worker.spin_limit_ns);
+    ASSERT_GT(worker.spin_limit_ns, 0);
+  }
+  ASSERT_GT(blocks, 0u);
+  ASSERT_LT(min_spin_limit_ns, 2 * 1000 * 1000);
+}
+
+TEST(ThreadPoolTest, TestCancelledLoopStops) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions{}, nullptr, 4, true);
+  // The loops cancel the run with Cancel, which unlike the terminate flag may be called while other threads check
+  // the token.
+  const bool terminate = false;
+  constexpr int num_tasks = 1000;
+  std::atomic<int> count{0};
+
+  // Without a CancellableLoopsScope the loops run to completion.
+  {
+    onnxruntime::CancellationToken token(terminate);
+    onnxruntime::CancellationToken::Scope scope(&token);
+    ThreadPool::TrySimpleParallelFor(tp.get(), num_tasks, [&](std::ptrdiff_t) {
+      token.Cancel();
+      ++count;
+    });
+    ASSERT_EQ(count, num_tasks);
+  }
+
+  // Within it, the chunks not claimed yet when the run is cancelled are skipped.
+  count = 0;
+  {
+    onnxruntime::CancellationToken token(terminate);
+    onnxruntime::CancellationToken::Scope scope(&token);
+    onnxruntime::CancellationToken::CancellableLoopsScope cancellable_loops;
+    ThreadPool::TrySimpleParallelFor(tp.get(), num_tasks, [&](std::ptrdiff_t) {
+      token.Cancel();
+      ++count;
+    });
+    ASSERT_GT(count, 0);
+    ASSERT_LT(count, num_tasks);
+    ASSERT_EQ(token.ToStatus().Code(), onnxruntime::common::FAIL);
+  }
+}
+
+TEST(ThreadPoolTest, TestCancellationDeadline) {
+  bool terminate = false;
+  onnxruntime::CancellationToken no_deadline(terminate);
+  ASSERT_FALSE(no_deadline.IsCancelled());
+
+  onnxruntime::CancellationToken expired(terminate, onnxruntime::CancellationToken::Clock::now());
+  ASSERT_TRUE(expired.IsCancelled());
+  ASSERT_EQ(expired.ToStatus().Code(), onnxruntime::common::DEADLINE_EXCEEDED);
+
+  // The token is only current within its scope.
+  ASSERT_EQ(onnxruntime::CancellationToken::Current(), nullptr);
+  {
+    onnxruntime::CancellationToken::Scope scope(&expired);
+    ASSERT_EQ(onnxruntime::CancellationToken::Current(), &expired);
+    ASSERT_EQ(onnxruntime::CancellationToken::CurrentForLoops(), nullptr);
+  }
+  ASSERT_EQ(onnxruntime::CancellationToken::Current(), nullptr);
+}
+
 #ifdef _WIN32
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
 #pragma warning(push)
@@ -9,6 +9,7 @@
 #include "core/common/logging/logging.h"
 #include "core/framework/session_state.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_run_options_config_keys.h"
 
 #include "test/providers/provider_test_utils.h"
 #include "test/util/include/default_providers.h"
@@ -475,77 +476,78 @@ TEST(Loop, ZeroIterations) {
           {});
 }
 
-TEST(Loop, InfiniteLoopTermination) {
-  auto create_subgraph = [](const RunOptions&) {
-    Model model("Infinite Loop subgraph", false, DefaultLoggingManager().DefaultLogger());
-    auto& graph = model.MainGraph();
+// Loop body which never changes cond_in, so the loop only stops when the run is cancelled.
+static const ONNX_NAMESPACE::GraphProto CreateInfiniteLoopSubgraph(const RunOptions&) {
+  Model model("Infinite Loop subgraph", false, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
 
-    std::vector<NodeArg*> inputs;
-    std::vector<NodeArg*> outputs;
+  std::vector<NodeArg*> inputs;
+  std::vector<NodeArg*> outputs;
 
-    /* Never change cond_in so loop is infinite
-            Inputs: iter_num, cond_in, loop carried state variables.
+  /* Never change cond_in so loop is infinite
+          Inputs: iter_num, cond_in, loop carried state variables.
 
-         iter_num_in    cond_in     [outer_scope_0]
-           (unused)        |                |
-                       [Identity]      [Identity]
-                           |               |
-                        cond_out     loop_var_0_out
-    */
+       iter_num_in    cond_in     [outer_scope_0]
+         (unused)        |                |
+                     [Identity]      [Identity]
+                         |               |
+                      cond_out     loop_var_0_out
+  */
 
-    // graph inputs types.
-    TypeProto int64_scalar;
-    int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
-    int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  // graph inputs types.
+  TypeProto int64_scalar;
+  int64_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+  int64_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
 
-    TypeProto bool_scalar;
-    bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
-    bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  TypeProto bool_scalar;
+  bool_scalar.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_scalar.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
 
-    TypeProto float_tensor;
-    float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
-    float_tensor.mutable_tensor_type()->mutable_shape()->add_dim();
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim();
 
-    // graph inputs
-    auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
-    auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
+  // graph inputs
+  auto& iter_num_in = graph.GetOrCreateNodeArg("iter_num_in", &int64_scalar);
+  auto& cond_in = graph.GetOrCreateNodeArg("cond_in", &bool_scalar);
 
-    // outer scope value. need type but not shape.
-    auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
+  // outer scope value. need type but not shape.
+  auto& outer_scope_0 = graph.GetOrCreateNodeArg("outer_scope_0", &float_tensor);
 
-    // add so that we don't end up with it being considered a graph input
-    graph.AddOuterScopeNodeArg("outer_scope_0");
+  // add so that we don't end up with it being considered a graph input
+  graph.AddOuterScopeNodeArg("outer_scope_0");
 
-    // graph outputs
-    auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
-    auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_tensor);
+  // graph outputs
+  auto& cond_out = graph.GetOrCreateNodeArg("cond_out", &bool_scalar);
+  auto& loop_var_0_out = graph.GetOrCreateNodeArg("loop_var_0_out", &float_tensor);
 
-    // cond_in -> cond_out
-    {
-      inputs = {&cond_in};
-      outputs = {&cond_out};
+  // cond_in -> cond_out
+  {
+    inputs = {&cond_in};
+    outputs = {&cond_out};
 
-      graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", inputs, outputs);
-    }
+    graph.AddNode("cond_in_identity", "Identity", "Forward cond_in to cond_out", inputs, outputs);
+  }
 
-    // outer_scope_0 -> loop_var_0_out
-    {
-      inputs = {&outer_scope_0};
-      outputs = {&loop_var_0_out};
+  // outer_scope_0 -> loop_var_0_out
+  {
+    inputs = {&outer_scope_0};
+    outputs = {&loop_var_0_out};
 
-      graph.AddNode("loop_var_out", "Identity", "Forward outer_scope_0 to loop_var_0_out", inputs, outputs);
-    }
+    graph.AddNode("loop_var_out", "Identity", "Forward outer_scope_0 to loop_var_0_out", inputs, outputs);
+  }
 
-    graph.SetInputs({&iter_num_in, &cond_in, &outer_scope_0});
-    graph.SetOutputs({&cond_out, &loop_var_0_out});
+  graph.SetInputs({&iter_num_in, &cond_in, &outer_scope_0});
+  graph.SetOutputs({&cond_out, &loop_var_0_out});
 
-    auto status = graph.Resolve();
-    EXPECT_EQ(status, Status::OK());
+  auto status = graph.Resolve();
+  EXPECT_EQ(status, Status::OK());
 
-    return graph.ToGraphProto();
-  };
+  return graph.ToGraphProto();
+}
 
-  LoopOpTester test{{}, create_subgraph};
+TEST(Loop, InfiniteLoopTermination) {
+  LoopOpTester test{{}, CreateInfiniteLoopSubgraph};
 
   test.AddInput<int64_t>("M", {1}, {INT64_MAX});
   test.AddInput<bool>("cond", {1}, {true});
@@ -579,6 +581,25 @@ TEST(Loop, InfiniteLoopTermination) {
   terminator_thread.join();
 }
 
+TEST(Loop, InfiniteLoopDeadline) {
+  LoopOpTester test{{}, CreateInfiniteLoopSubgraph};
+
+  test.AddInput<int64_t>("M", {1}, {INT64_MAX});
+  test.AddInput<bool>("cond", {1}, {true});
+  test.AddInput<float>("fake", {1}, {0.f});
+  test.AddInput<float>("outer_scope_0", {1}, {kOuterNodeAddValue});
+
+  test.AddOutput<float>("loop_var_0_final", {1}, {0.f});
+  test.AddOutput<int64_t>("outer_scope_0_out", {1}, {int64_t(kOuterNodeAddValue)});
+
+  OrtRunOptions session_run_options;
+  session_run_options.run_tag = "Loop.InfiniteLoopDeadline";
+  ASSERT_STATUS_OK(session_run_options.config_options.AddConfigEntry(kOrtRunOptionsConfigTimeoutMs, "100"));
+
+  test.Run(OpTester::ExpectResult::kExpectFailure, "Exiting due to the run exceeding its deadline",
+           {kTensorrtExecutionProvider, kOpenVINOExecutionProvider}, &session_run_options);  // Disable TensorRT on unsupported data type BOOL
+}
+
 // Add basic test to trigger types override logic in Graph::InferAndVerifySubgraphTypes as well as
 // type/shape inferencing for subgraph to flow the type/shape info through
 // subgraph.PerformTypeAndShapeInferencing(options).
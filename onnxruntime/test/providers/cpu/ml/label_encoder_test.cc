@@ -189,5 +189,59 @@ TEST(LabelEncoder, Int64ToInt64Opset2) {
   test.Run();
 }
 
+TEST(LabelEncoder, FloatToInt64DuplicateAndSignedZeroKeysOpset2) {
+  std::vector<std::int64_t> dims{4};
+
+  // the last value of a duplicated key is used, and -0.0f matches the key 0.0f
+  std::vector<float> input{1.5f, -0.0f, 0.0f, 2.5f};
+  std::vector<std::int64_t> output{3, 7, 7, -1};
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  const std::vector<float> keys{1.5f, 0.0f, 1.5f};
+  const std::vector<std::int64_t> values{2, 7, 3};
+
+  test.AddAttribute("keys_floats", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute("default_int64", (std::int64_t)-1);
+
+  test.AddInput<float>("X", dims, input);
+  test.AddOutput<std::int64_t>("Y", dims, output);
+
+  test.Run();
+}
+
+TEST(LabelEncoder, StringToInt64ManyKeysOpset2) {
+  // enough keys and input to grow the lookup table several times and split the lookups across threads
+  constexpr std::int64_t num_keys = 1000;
+  constexpr std::int64_t num_inputs = 20000;
+
+  std::vector<std::string> keys;
+  std::vector<std::int64_t> values;
+  for (std::int64_t i = 0; i < num_keys; ++i) {
+    keys.push_back("key_" + std::to_string(i));
+    values.push_back(i * 3);
+  }
+
+  std::vector<std::string> input;
+  std::vector<std::int64_t> output;
+  for (std::int64_t i = 0; i < num_inputs; ++i) {
+    const std::int64_t key = (i * 7) % (num_keys + 100);
+    input.push_back("key_" + std::to_string(key));
+    output.push_back(key < num_keys ? key * 3 : -1);
+  }
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  test.AddAttribute("keys_strings", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute("default_int64", (std::int64_t)-1);
+
+  test.AddInput<std::string>("X", {num_inputs}, input);
+  test.AddOutput<std::int64_t>("Y", {num_inputs}, output);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -84,4 +84,24 @@ TEST_F(WriteScores, single_score_transform_none_add_second_class) {
       EXPECT_FLOAT_EQ(1 - v2[0], output_data[0]);
     }
   }
-}
\ No newline at end of file
+}
+TEST_F(WriteScores, batched_logistic_add_second_class_keeps_small_probabilities) {
+  // the probability of the losing class is logistic(-score), which 1 - logistic(score) rounds to a fraction of it
+  const std::vector<float> raw_scores{15.f, -15.f, 0.5f};
+  for (bool have_space_for_second_class : {false, true}) {
+    std::vector<float> scores(raw_scores.size() * 2);
+    for (size_t i = 0; i < raw_scores.size(); ++i) {
+      scores[have_space_for_second_class ? i * 2 : i] = raw_scores[i];
+    }
+
+    batched_update_scores_inplace(gsl::make_span(scores), static_cast<int64_t>(raw_scores.size()), 1,
+                                  POST_EVAL_TRANSFORM::LOGISTIC, 2, have_space_for_second_class, nullptr);
+
+    for (size_t i = 0; i < raw_scores.size(); ++i) {
+      const float expected_negative = ComputeLogistic(-raw_scores[i]);
+      const float expected_positive = ComputeLogistic(raw_scores[i]);
+      EXPECT_NEAR(scores[i * 2], expected_negative, expected_negative * 1e-2f);
+      EXPECT_NEAR(scores[i * 2 + 1], expected_positive, expected_positive * 1e-2f);
+    }
+  }
+}
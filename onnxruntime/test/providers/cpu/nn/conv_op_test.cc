@@ -4,7 +4,9 @@
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/framework/test_utils.h"
+#include "test/util/include/asserts.h"
 
 using namespace std;
 namespace onnxruntime {
@@ -30,7 +32,8 @@ void TestConvOp(const ConvOpAndTestAttributes& attributes,
                 bool weight_is_initializer = false,
                 OpTester::ExpectResult expect_result = OpTester::ExpectResult::kExpectSuccess,
                 const std::string& err_str = "",
-                int opset = 7) {
+                int opset = 7,
+                bool static_shape_kernels = false) {
   OpTester test("Conv", opset);
   test.AddAttribute("group", attributes.group);
   test.AddAttribute("kernel_shape", attributes.kernel_shape);
@@ -63,7 +66,13 @@ void TestConvOp(const ConvOpAndTestAttributes& attributes,
   // Disable TensorRT because weight as input is not supported
   excluded_providers.insert(kTensorrtExecutionProvider);
 
-  test.Run(expect_result, err_str, excluded_providers);
+  if (static_shape_kernels) {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigStaticShapeKernels, "1"));
+    test.Run(so, expect_result, err_str, excluded_providers);
+  } else {
+    test.Run(expect_result, err_str, excluded_providers);
+  }
 }
 
 }  // namespace
@@ -191,6 +200,10 @@ TEST(ConvTest, Conv1D_Bias) {
 
   // CoreML EP requires weight to be an initializer
   TestConvOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape, true);
+
+  // with the convolution prepared for the static shapes at session initialization
+  TestConvOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape, true,
+             OpTester::ExpectResult::kExpectSuccess, "", 7, true);
 }
 
 // Conv47
@@ -726,6 +739,10 @@ TEST(ConvTest, Conv_AutoPad_with_non_default_strides) {
 
   // Test with weight as initializer
   TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape, true);
+
+  // Test with the convolution prepared for the static shapes at session initialization
+  TestConvOp(attrs, {X, W}, {X_shape, W_shape}, expected_vals, Y_shape, true,
+             OpTester::ExpectResult::kExpectSuccess, "", 7, true);
 }
 
 #ifdef USE_CUDA
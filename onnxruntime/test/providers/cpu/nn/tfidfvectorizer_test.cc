@@ -690,6 +690,31 @@ TEST(TfIdfVectorizerTest, String_TFIDFWeights_onlyBigrams_Skip5_2rows) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+// n-grams sharing a prefix with shorter n-grams, input items that are not in the pool, and rows that are processed
+// independently.
+TEST(TfIdfVectorizerTest, Int64_TF_UniBiAndTrigrams_SharedPrefix_3rows) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  // s=0, Min=1, Max=3, weights empty, int64
+  InitTestAttr(test, "TF", 1, 3, 0,
+               {0, 3, 7},
+               {0, 1, 2, 3, 4, 5},  // 6 output indexes
+               {},
+               {1, 2, 3,     // 1-grams
+                1, 2, 2, 3,  // bi-grams
+                1, 2, 3},    // tri-grams
+               {});
+
+  test.AddInput<int64_t>("T", {3, 3}, {1, 2, 3,
+                                       3, 2, 1,
+                                       1, 2, 9});
+
+  test.AddOutput<float>("Y", {3, 6}, {1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                                      1.f, 1.f, 1.f, 0.f, 0.f, 0.f,
+                                      1.f, 1.f, 0.f, 1.f, 0.f, 0.f});
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 // This test runs the inference 100 times to test the improvement
 // It enables profiling while running inference multiple times.
 // So we can manually inspect the profiling output
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <random>
 #include <string>
 
@@ -120,6 +121,78 @@ TEST(XnnpackEP, TestAllocatorSharing) {
       << "EPs do not have the same default allocator";
 }
 
+// test the packed Conv weights of a model loaded by multiple sessions are shared when share_packed_weights is set
+TEST(XnnpackEP, TestPackedWeightsSharing) {
+  const ORTCHAR_T* ort_model_path = ORT_MODEL_FOLDER "nhwc_conv_clip_relu.onnx";
+  XnnpackExecutionProviderInfo info(ProviderOptions{{"share_packed_weights", "1"}});
+
+  auto init_session = [&](InferenceSessionWrapper& session, std::shared_ptr<XnnpackExecutionProvider>& ep) {
+    ep = std::make_shared<XnnpackExecutionProvider>(info);
+    ASSERT_STATUS_OK(session.RegisterExecutionProvider(ep));
+    ASSERT_STATUS_OK(session.Load(ort_model_path));
+    ASSERT_STATUS_OK(session.Initialize());
+  };
+
+  SessionOptions so;
+  InferenceSessionWrapper session1(so, GetEnvironment());
+  InferenceSessionWrapper session2(so, GetEnvironment());
+  std::shared_ptr<XnnpackExecutionProvider> ep1;
+  std::shared_ptr<XnnpackExecutionProvider> ep2;
+  init_session(session1, ep1);
+  init_session(session2, ep2);
+
+  ASSERT_EQ(ep1->GetWeightsCache().get(), ep2->GetWeightsCache().get());
+
+  AllocatorStats stats1;
+  AllocatorStats stats2;
+  ep1->GetWeightsSharingStats(stats1);
+  ep2->GetWeightsSharingStats(stats2);
+
+  // the Conv weights of the second session were found in the cache
+  ASSERT_EQ(stats1.bytes_saved_by_sharing, 0);
+  ASSERT_GT(stats2.bytes_saved_by_sharing, 0);
+  ASSERT_LE(stats2.bytes_saved_by_sharing, stats2.bytes_in_use);
+
+  // both sessions should still produce the same results
+  RandomValueGenerator generator;
+  TensorShape input_shape_x{1, 16, 16, 192};
+  std::vector<float> input_x = generator.Uniform<float>(input_shape_x.GetDims(), -128, 128);
+
+  OrtValue ml_value_x;
+  CreateMLValue<float>(input_shape_x.GetDims(), input_x.data(), OrtMemoryInfo(), &ml_value_x);
+
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("model_input", ml_value_x));
+
+  std::vector<std::string> output_names{"push_transpose_out_45"};
+  std::vector<OrtValue> fetches1;
+  std::vector<OrtValue> fetches2;
+  ASSERT_STATUS_OK(session1.Run(feeds, output_names, &fetches1));
+  ASSERT_STATUS_OK(session2.Run(feeds, output_names, &fetches2));
+
+  const auto& output1 = fetches1[0].Get<Tensor>();
+  const auto& output2 = fetches2[0].Get<Tensor>();
+  ASSERT_EQ(output1.Shape(), output2.Shape());
+  auto span1 = output1.DataAsSpan<float>();
+  auto span2 = output2.DataAsSpan<float>();
+  ASSERT_TRUE(std::equal(span1.begin(), span1.end(), span2.begin()));
+
+  // the cache was finalized by the first run. a session created afterwards still finds its weights in it.
+  InferenceSessionWrapper session3(so, GetEnvironment());
+  std::shared_ptr<XnnpackExecutionProvider> ep3;
+  init_session(session3, ep3);
+
+  AllocatorStats stats3;
+  ep3->GetWeightsSharingStats(stats3);
+  ASSERT_EQ(stats3.bytes_saved_by_sharing, stats2.bytes_saved_by_sharing);
+  ASSERT_EQ(stats3.bytes_in_use, stats2.bytes_in_use);
+
+  std::vector<OrtValue> fetches3;
+  ASSERT_STATUS_OK(session3.Run(feeds, output_names, &fetches3));
+  auto span3 = fetches3[0].Get<Tensor>().DataAsSpan<float>();
+  ASSERT_TRUE(std::equal(span1.begin(), span1.end(), span3.begin()));
+}
+
 TEST(XnnpackEP, TestAddEpUsingPublicApi) {
   {
     // C++ API test
@@ -163,10 +236,29 @@ TEST(XnnpackEP, TestAddEpUsingPublicApi) {
   }
 }
 
+TEST(XnnpackEP, TestProviderOptions) {
+  XnnpackExecutionProviderInfo info(ProviderOptions{{"enable_float_matmul_and_binary_ops", "0"},
+                                                    {"share_packed_weights", "1"}});
+  EXPECT_FALSE(info.enable_float_matmul_and_binary_ops);
+  EXPECT_TRUE(info.share_packed_weights);
+
+  XnnpackExecutionProviderInfo default_info(ProviderOptions{});
+  EXPECT_TRUE(default_info.enable_float_matmul_and_binary_ops);
+  EXPECT_FALSE(default_info.share_packed_weights);
+
+  EXPECT_THROW(XnnpackExecutionProviderInfo(ProviderOptions{{"enable_float_matmul_and_binary_ops", "yes"}}),
+               OnnxRuntimeException);
+
+  // xnnpack runs on the session intra-op thread pool, so its own thread count is rejected
+  EXPECT_THROW(XnnpackExecutionProviderInfo(ProviderOptions{{"intra_op_num_threads", "4"}}),
+               OnnxRuntimeException);
+}
+
 static void RunModelTest(
     const GetQDQTestCaseFn& build_test_case,
     const char* test_description,
-    const EPVerificationParams& params = EPVerificationParams()) {
+    const EPVerificationParams& params = EPVerificationParams(),
+    const ProviderOptions& provider_options = {}) {
   onnxruntime::Model model(test_description, false, DefaultLoggingManager().DefaultLogger());
   Graph& graph = model.MainGraph();
   ModelTestBuilder helper(graph);
@@ -178,10 +270,13 @@ static void RunModelTest(
   std::string model_data;
   model.ToProto().SerializeToString(&model_data);
   RunAndVerifyOutputsWithEP(model_data, "XnnpackEP.TestQDQModel",
-                            DefaultXnnpackExecutionProvider(),
+                            std::make_unique<XnnpackExecutionProvider>(
+                                XnnpackExecutionProviderInfo(provider_options)),
                             helper.feeds_, params);
 }
 
+static const ProviderOptions kDisableFloatMatMulAndBinaryOps{{"enable_float_matmul_and_binary_ops", "0"}};
+
 static void RunModelTestWithPath(const ORTCHAR_T* ort_model_path, const char* graph_name, float scale_factor = 1.0f) {
   std::function<void(const Graph&)> verify = [](const Graph& graph) -> void {
     ASSERT_EQ(graph.NumberOfNodes(), 5) << "Transpose*2 + dq +q +qlinearconv "
@@ -362,6 +457,121 @@ TEST(XnnpackEP, TestQDQSoftMax_axisLast) {
                "xnnpack_qdq_test_graph_softmax",
                {ExpectedEPNodeAssignment::All});
 }
+TEST(XnnpackEP, TestMatMul) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 3, 4}, -1.f, 1.f);
+    auto* weight_arg = builder.MakeInitializer<float>({4, 5}, -1.f, 1.f);
+    auto* output_arg = builder.MakeOutput();
+    builder.AddNode("MatMul", {input_arg, weight_arg}, {output_arg});
+  };
+  RunModelTest(modelBuilder, "xnnpack_test_graph_matmul",
+               {
+                   ExpectedEPNodeAssignment::All,
+                   1e-4f /* fp32_abs_err */,
+               });
+
+  // float MatMul can be left to the CPU EP
+  RunModelTest(modelBuilder, "xnnpack_test_graph_matmul",
+               {
+                   ExpectedEPNodeAssignment::None,
+                   1e-4f /* fp32_abs_err */,
+               },
+               kDisableFloatMatMulAndBinaryOps);
+}
+
+TEST(XnnpackEP, TestQDQMatMul) {
+  RunModelTest(BuildQDQMatMulTestCase({2, 2} /* input1_shape */,
+                                      {2, 3} /* input2_shape */),
+               "xnnpack_qdq_test_graph_matmul",
+               {
+                   ExpectedEPNodeAssignment::Some,
+                   1e-1f /* fp32_abs_err */,
+               });
+}
+
+TEST(XnnpackEP, TestGemm) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 4}, -1.f, 1.f);
+    auto* weight_arg = builder.MakeInitializer<float>({5, 4}, -1.f, 1.f);
+    auto* bias_arg = builder.MakeInitializer<float>({5}, -1.f, 1.f);
+    auto* output_arg = builder.MakeOutput();
+    Node& gemm_node = builder.AddNode("Gemm", {input_arg, weight_arg, bias_arg}, {output_arg});
+    gemm_node.AddAttribute("transB", static_cast<int64_t>(1));
+  };
+  RunModelTest(modelBuilder, "xnnpack_test_graph_gemm",
+               {
+                   ExpectedEPNodeAssignment::All,
+                   1e-4f /* fp32_abs_err */,
+               });
+}
+
+TEST(XnnpackEP, TestBinaryElementwiseWithBroadcast) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input1_arg = builder.MakeInput<float>({2, 3, 4}, -1.f, 1.f);
+    auto* input2_arg = builder.MakeInput<float>({3, 1}, -1.f, 1.f);
+    auto* bias_arg = builder.MakeInitializer<float>({4}, 1.f, 2.f);
+    auto* add_output = builder.MakeIntermediate();
+    auto* mul_output = builder.MakeIntermediate();
+    auto* sub_output = builder.MakeIntermediate();
+    auto* output_arg = builder.MakeOutput();
+    builder.AddNode("Add", {input1_arg, input2_arg}, {add_output});
+    builder.AddNode("Mul", {add_output, bias_arg}, {mul_output});
+    builder.AddNode("Sub", {mul_output, input2_arg}, {sub_output});
+    builder.AddNode("Div", {sub_output, bias_arg}, {output_arg});
+  };
+  RunModelTest(modelBuilder, "xnnpack_test_graph_binary_elementwise",
+               {
+                   ExpectedEPNodeAssignment::All,
+                   1e-5f /* fp32_abs_err */,
+               });
+
+  RunModelTest(modelBuilder, "xnnpack_test_graph_binary_elementwise",
+               {
+                   ExpectedEPNodeAssignment::None,
+                   1e-5f /* fp32_abs_err */,
+               },
+               kDisableFloatMatMulAndBinaryOps);
+}
+
+TEST(XnnpackEP, TestTranspose) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 3, 4}, -1.f, 1.f);
+    auto* output_arg = builder.MakeOutput();
+    Node& transpose_node = builder.AddNode("Transpose", {input_arg}, {output_arg});
+    transpose_node.AddAttribute("perm", std::vector<int64_t>{2, 0, 1});
+  };
+  RunModelTest(modelBuilder, "xnnpack_test_graph_transpose",
+               {ExpectedEPNodeAssignment::All});
+}
+
+TEST(XnnpackEP, TestConcat) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input1_arg = builder.MakeInput<float>({2, 3, 4}, -1.f, 1.f);
+    auto* input2_arg = builder.MakeInput<float>({2, 5, 4}, -1.f, 1.f);
+    auto* output_arg = builder.MakeOutput();
+    Node& concat_node = builder.AddNode("Concat", {input1_arg, input2_arg}, {output_arg});
+    concat_node.AddAttribute("axis", static_cast<int64_t>(1));
+  };
+  RunModelTest(modelBuilder, "xnnpack_test_graph_concat",
+               {ExpectedEPNodeAssignment::All});
+}
+
+TEST(XnnpackEP, TestResize) {
+  auto modelBuilder = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({1, 3, 4, 6}, -1.f, 1.f);
+    auto* roi_arg = builder.MakeInitializer<float>({0}, {});
+    auto* scales_arg = builder.Make1DInitializer<float>({1.f, 1.f, 2.f, 1.5f});
+    auto* output_arg = builder.MakeOutput();
+    Node& resize_node = builder.AddNode("Resize", {input_arg, roi_arg, scales_arg}, {output_arg});
+    resize_node.AddAttribute("mode", "linear");
+  };
+  // the layout transformer wraps the NHWC Resize in Transpose nodes, and scales is converted to NHWC
+  RunModelTest(modelBuilder, "xnnpack_test_graph_resize",
+               {
+                   ExpectedEPNodeAssignment::Some,
+                   1e-5f /* fp32_abs_err */,
+               });
+}
 #endif
 
 }  // namespace test
@@ -15,6 +15,7 @@ from helper import get_name
 
 import onnxruntime as onnxrt
 from onnxruntime.capi.onnxruntime_pybind11_state import Fail, OrtValueVector, RunOptions
+from onnxruntime.capi.onnxruntime_pybind11_state import OrtValue as C_OrtValue
 
 # handle change from python 3.8 and on where loading a dll from the current directory needs to be explicitly allowed.
 if platform.system() == "Windows" and sys.version_info.major >= 3 and sys.version_info.minor >= 8:
@@ -425,6 +426,21 @@ class TestInferenceSession(unittest.TestCase):
         rescontiguous = sess.run([output_name], {input_name: xcontiguous})
         np.testing.assert_allclose(output_expected, rescontiguous[0], rtol=1e-05, atol=1e-08)
 
+    def testRunModelOutputsAreNotCopied(self):
+        sess = onnxrt.InferenceSession(get_name("mul_1.onnx"), providers=["CPUExecutionProvider"])
+        x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        res = sess.run(["Y"], {"X": x})
+        # The output borrows the buffer of the OrtValue produced by the session.
+        self.assertFalse(res[0].flags.owndata)
+        self.assertIsNotNone(res[0].base)
+        # The buffer must remain valid after the session is released.
+        del sess
+        gc.collect()
+        output_expected = np.array([[1.0, 4.0], [9.0, 16.0], [25.0, 36.0]], dtype=np.float32)
+        np.testing.assert_allclose(output_expected, res[0], rtol=1e-05, atol=1e-08)
+        res[0][0, 0] = 2.0
+        self.assertEqual(res[0][0, 0], 2.0)
+
     def testRunModelMultipleThreads(self):
         # Skip this test for a "pure" DML onnxruntime python wheel.
         # We keep this test enabled for instances where both DML and CUDA EPs are available
@@ -1007,6 +1023,25 @@ class TestInferenceSession(unittest.TestCase):
             # The constructed OrtValue should still be valid after being used in a session
             self.assertTrue(np.array_equal(ortvalue2.numpy(), numpy_arr_input))
 
+    def testOrtValueDlpack(self):
+        numpy_arr_input = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]], dtype=np.float32)
+        ortvalue = onnxrt.OrtValue.ortvalue_from_numpy(numpy_arr_input)
+        c_ortvalue = ortvalue._get_c_value()
+        self.assertEqual(c_ortvalue.__dlpack_device__(), (1, 0))  # kDLCPU
+
+        # the DLPack structure shares the buffer of the OrtValue it was created from
+        c_ortvalue2 = C_OrtValue.from_dlpack(c_ortvalue.to_dlpack())
+        self.assertEqual(c_ortvalue2.data_ptr(), c_ortvalue.data_ptr())
+        self.assertTrue(np.array_equal(c_ortvalue2.numpy(), numpy_arr_input))
+
+        sess = onnxrt.InferenceSession(get_name("mul_1.onnx"), providers=["CPUExecutionProvider"])
+        res = sess.run(["Y"], {"X": onnxrt.OrtValue(c_ortvalue2)})
+        self.assertTrue(np.array_equal(res[0], numpy_arr_input * numpy_arr_input))
+
+        if hasattr(np, "from_dlpack"):
+            # numpy consumes the OrtValue through the __dlpack__ protocol
+            self.assertTrue(np.array_equal(np.from_dlpack(c_ortvalue), numpy_arr_input))
+
     def testOrtValue_ghIssue9799(self):
         if "CUDAExecutionProvider" in onnxrt.get_available_providers():
             session = onnxrt.InferenceSession(
@@ -1352,6 +1352,12 @@ void RegisterTrainingOpSchemas() {
           "    Computation is aligned with Huggingface AdamW.",
           AttributeProto::INT,
           static_cast<int64_t>(0))
+      .Attr(
+          "max_norm",
+          "If positive, gradients are scaled so that their global L2 norm is at most max_norm before they are "
+          "applied, as InplaceClipGradNorm does. The gradients themselves are not modified.",
+          AttributeProto::FLOAT,
+          0.f)
       .TypeConstraint(
           "T1",
           {"tensor(float)"},
@@ -1370,7 +1376,7 @@ void RegisterTrainingOpSchemas() {
           "Constrain gradients' types.")
       .TypeConstraint(
           "S_MOMENT",
-          {"seq(tensor(float16))", "seq(tensor(float))", "seq(tensor(double))"},
+          {"seq(tensor(float16))", "seq(tensor(float))", "seq(tensor(double))", "seq(tensor(bfloat16))"},
           "Constrain momentums' types.")
       .TypeConstraint(
           "T_BOOL",
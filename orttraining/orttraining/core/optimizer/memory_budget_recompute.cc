@@ -0,0 +1,320 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "orttraining/core/optimizer/memory_budget_recompute.h"
+
+#include <deque>
+#include <sstream>
+
+#include "core/framework/data_types.h"
+#include "core/framework/session_options.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_utils.h"
+#include "orttraining/core/graph/recompute_graph_utils.h"
+
+namespace onnxruntime {
+
+namespace {
+
+// Approximate work per output element of the operators that are cheap enough to recompute.
+int64_t RecomputeCostPerElement(const Node& node) {
+  static const InlinedHashMap<std::string_view, int64_t> costs{
+      {"Add", 1}, {"Sub", 1}, {"Mul", 1}, {"Div", 1}, {"Neg", 1}, {"Where", 1}, {"Cast", 1}, {"Relu", 1},
+      {"LeakyRelu", 1}, {"Sqrt", 2}, {"Sigmoid", 4}, {"Tanh", 4}, {"Erf", 4}, {"Gelu", 8}, {"FastGelu", 8},
+      {"BiasGelu", 8}, {"LayerNormalization", 8}, {"SimplifiedLayerNormalization", 6}};
+
+  if (node.Domain() != kOnnxDomain && node.Domain() != kMSDomain) {
+    return 0;
+  }
+
+  auto it = costs.find(node.OpType());
+  return it == costs.end() ? 0 : it->second;
+}
+
+// Number of elements of a value, with symbolic dimensions counted as 1. Returns -1 if the rank is unknown.
+int64_t NumElements(const NodeArg& arg) {
+  const auto* shape = arg.Shape();
+  if (shape == nullptr) {
+    return -1;
+  }
+
+  int64_t size = 1;
+  for (const auto& dim : shape->dim()) {
+    if (utils::HasDimValue(dim)) {
+      size *= dim.dim_value();
+    }
+  }
+  return size;
+}
+
+// Size of a tensor value in bytes, or -1 if it is unknown.
+int64_t SizeInBytes(const NodeArg& arg) {
+  const auto* type = arg.TypeAsProto();
+  const int64_t num_elements = NumElements(arg);
+  if (type == nullptr || !utils::HasTensorType(*type) || !utils::HasElemType(type->tensor_type()) ||
+      num_elements < 0) {
+    return -1;
+  }
+
+  const auto* tensor_type = DataTypeImpl::TensorTypeFromONNXEnum(type->tensor_type().elem_type());
+  return num_elements * static_cast<int64_t>(tensor_type->GetElementType()->Size());
+}
+
+constexpr double kBytesPerMB = 1024.0 * 1024.0;
+
+}  // namespace
+
+Status MemoryBudgetRecompute::ApplyImpl(Graph& graph, bool& modified, int /*graph_level*/,
+                                        const logging::Logger& logger) const {
+  // The forward pass is everything the losses depend on. Without a loss gradient this is not a training graph.
+  std::vector<const Node*> loss_nodes;
+  for (const NodeArg* output : graph.GetOutputs()) {
+    const Node* producer = graph.GetProducerNode(output->Name());
+    if (producer != nullptr && graph.IsInitializedTensor(output->Name() + "_grad")) {
+      loss_nodes.push_back(producer);
+    }
+  }
+
+  if (loss_nodes.empty()) {
+    return Status::OK();
+  }
+
+  InlinedHashSet<NodeIndex> forward_nodes;
+  std::deque<const Node*> queue(loss_nodes.begin(), loss_nodes.end());
+  for (const Node* node : loss_nodes) {
+    forward_nodes.insert(node->Index());
+  }
+  while (!queue.empty()) {
+    const Node* node = queue.front();
+    queue.pop_front();
+    for (auto it = node->InputNodesBegin(); it != node->InputNodesEnd(); ++it) {
+      if (forward_nodes.insert(it->Index()).second) {
+        queue.push_back(&*it);
+      }
+    }
+  }
+
+  auto is_backward_consumer = [&forward_nodes](const Node& consumer) {
+    return forward_nodes.count(consumer.Index()) == 0;
+  };
+
+  // The activations are the forward values the backward pass reads, which stay alive from the forward pass on.
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+  InlinedHashMap<std::string, int64_t> stashed;
+  int64_t stashed_bytes = 0;
+  bool all_sizes_known = true;
+  for (auto node_index : node_topology_list) {
+    const Node* node = graph.GetNode(node_index);
+    if (node == nullptr || forward_nodes.count(node_index) == 0) {
+      continue;
+    }
+
+    for (auto edge = node->OutputEdgesBegin(); edge != node->OutputEdgesEnd(); ++edge) {
+      if (!is_backward_consumer(edge->GetNode())) {
+        continue;
+      }
+
+      const NodeArg* output = node->OutputDefs()[edge->GetSrcArgIndex()];
+      if (stashed.count(output->Name()) == 0) {
+        const int64_t size = SizeInBytes(*output);
+        all_sizes_known = all_sizes_known && size >= 0;
+        stashed[output->Name()] = std::max<int64_t>(size, 0);
+        stashed_bytes += std::max<int64_t>(size, 0);
+      }
+    }
+  }
+
+  const int64_t initial_stashed_bytes = stashed_bytes;
+  if (!all_sizes_known) {
+    LOGS(logger, WARNING) << "MemoryBudgetRecompute: the size of some activations is unknown, "
+                          << "they are not included in the estimate.";
+  }
+
+  if (stashed_bytes <= memory_budget_bytes_) {
+    LOGS(logger, INFO) << "MemoryBudgetRecompute: activations take " << stashed_bytes / kBytesPerMB
+                       << " MB, within the budget of " << memory_budget_bytes_ / kBytesPerMB << " MB.";
+    return Status::OK();
+  }
+
+  // Collect the forward nodes that can be recomputed, with their recompute cost.
+  const auto& compatible_providers = GetCompatibleExecutionProviders();
+  InlinedHashMap<NodeIndex, int64_t> candidates;
+  for (auto node_index : node_topology_list) {
+    const Node* node = graph.GetNode(node_index);
+    if (node == nullptr || forward_nodes.count(node_index) == 0) {
+      continue;
+    }
+
+    const int64_t cost_per_element = RecomputeCostPerElement(*node);
+    if (cost_per_element == 0 || !graph_utils::IsSupportedProvider(*node, compatible_providers) ||
+        graph.NodeProducesGraphOutput(*node) || node->ContainsSubgraph()) {
+      continue;
+    }
+
+    bool eligible = true;
+    int64_t num_elements = 0;
+    for (const NodeArg* output : node->OutputDefs()) {
+      if (!output->Exists()) {
+        continue;
+      }
+      const int64_t size = SizeInBytes(*output);
+      eligible = eligible && size >= 0 &&
+                 graph.GetNodeArg(graph_utils::RecomputeName(output->Name())) == nullptr;
+      num_elements += std::max<int64_t>(NumElements(*output), 0);
+    }
+
+    // the outputs must not feed a subgraph, as only explicit inputs are rewired
+    for (auto edge = node->OutputEdgesBegin(); edge != node->OutputEdgesEnd() && eligible; ++edge) {
+      eligible = static_cast<size_t>(edge->GetDstArgIndex()) < edge->GetNode().InputDefs().size();
+    }
+
+    for (const NodeArg* input : node->InputDefs()) {
+      eligible = eligible && (!input->Exists() || SizeInBytes(*input) >= 0);
+    }
+
+    if (eligible) {
+      candidates[node_index] = std::max<int64_t>(cost_per_element * num_elements, 1);
+    }
+  }
+
+  // Greedily recompute the node that frees the most activation memory per unit of work. Recomputing a node frees its
+  // stashed outputs, but its inputs have to be stashed instead, unless they are initializers, graph inputs or the
+  // outputs of other recomputed nodes.
+  InlinedHashSet<NodeIndex> selected;
+  int64_t recompute_cost = 0;
+  while (stashed_bytes > memory_budget_bytes_) {
+    NodeIndex best_node = 0;
+    int64_t best_net = 0;
+    double best_ratio = 0.0;
+    for (const auto& candidate : candidates) {
+      if (selected.count(candidate.first) != 0) {
+        continue;
+      }
+
+      const Node& node = *graph.GetNode(candidate.first);
+      int64_t net = 0;
+      for (const NodeArg* output : node.OutputDefs()) {
+        auto it = stashed.find(output->Name());
+        if (it != stashed.end()) {
+          net += it->second;
+        }
+      }
+
+      InlinedHashSet<std::string_view> new_inputs;
+      for (const NodeArg* input : node.InputDefs()) {
+        const Node* producer = input->Exists() ? graph.GetProducerNode(input->Name()) : nullptr;
+        if (producer != nullptr && selected.count(producer->Index()) == 0 && stashed.count(input->Name()) == 0 &&
+            new_inputs.insert(input->Name()).second) {
+          net -= SizeInBytes(*input);
+        }
+      }
+
+      const double ratio = static_cast<double>(net) / static_cast<double>(candidate.second);
+      if (net > 0 && ratio > best_ratio) {
+        best_node = candidate.first;
+        best_net = net;
+        best_ratio = ratio;
+      }
+    }
+
+    if (best_net == 0) {
+      break;
+    }
+
+    const Node& node = *graph.GetNode(best_node);
+    for (const NodeArg* output : node.OutputDefs()) {
+      stashed.erase(output->Name());
+    }
+    for (const NodeArg* input : node.InputDefs()) {
+      const Node* producer = input->Exists() ? graph.GetProducerNode(input->Name()) : nullptr;
+      if (producer != nullptr && selected.count(producer->Index()) == 0) {
+        stashed.emplace(input->Name(), SizeInBytes(*input));
+      }
+    }
+
+    selected.insert(best_node);
+    stashed_bytes -= best_net;
+    recompute_cost += candidates[best_node];
+  }
+
+  // Add the recompute nodes in topological order, so that a recompute node can read the output of another one, and
+  // move the backward consumers of the recomputed values onto them.
+  for (auto node_index : node_topology_list) {
+    if (selected.count(node_index) == 0) {
+      continue;
+    }
+
+    Node& node = *graph.GetNode(node_index);
+    std::vector<NodeArg*> recompute_inputs;
+    for (NodeArg* input : node.MutableInputDefs()) {
+      const Node* producer = input->Exists() ? graph.GetProducerNode(input->Name()) : nullptr;
+      if (producer != nullptr && selected.count(producer->Index()) != 0) {
+        recompute_inputs.push_back(&graph.GetOrCreateNodeArg(graph_utils::RecomputeName(input->Name()),
+                                                             input->TypeAsProto()));
+      } else {
+        recompute_inputs.push_back(input);
+      }
+    }
+
+    std::vector<NodeArg*> recompute_outputs;
+    for (NodeArg* output : node.MutableOutputDefs()) {
+      recompute_outputs.push_back(output->Exists()
+                                      ? &graph.GetOrCreateNodeArg(graph_utils::RecomputeName(output->Name()),
+                                                                  output->TypeAsProto())
+                                      : output);
+    }
+
+    Node& recompute_node = graph.AddNode(node.Name() + "_recompute",
+                                         node.OpType(),
+                                         "Recompute of " + node.Name(),
+                                         recompute_inputs,
+                                         recompute_outputs,
+                                         &node.GetAttributes(),
+                                         node.Domain());
+    recompute_node.SetExecutionProviderType(node.GetExecutionProviderType());
+    recompute_node.SetPriority(static_cast<int>(ExecutionPriority::LOCAL_LOW));
+
+    for (size_t i = 0; i < recompute_inputs.size(); ++i) {
+      if (recompute_inputs[i] != node.InputDefs()[i]) {
+        graph.AddConsumerNode(recompute_inputs[i]->Name(), &recompute_node);
+      }
+    }
+    for (NodeArg* output : recompute_outputs) {
+      if (output->Exists()) {
+        graph.UpdateProducerNode(output->Name(), recompute_node.Index());
+      }
+    }
+
+    for (int output_idx = 0; output_idx < static_cast<int>(node.OutputDefs().size()); ++output_idx) {
+      for (const auto& edge : graph_utils::GraphEdge::GetNodeOutputEdges(node, output_idx)) {
+        Node& consumer = *graph.GetNode(edge.dst_node);
+        if (!is_backward_consumer(consumer)) {
+          continue;
+        }
+
+        graph.RemoveEdge(edge.src_node, edge.dst_node, edge.src_arg_index, edge.dst_arg_index);
+        graph.RemoveConsumerNode(edge.arg_name, &consumer);
+        graph.AddEdge(recompute_node.Index(), edge.dst_node, output_idx, edge.dst_arg_index);
+        graph.AddConsumerNode(recompute_outputs[output_idx]->Name(), &consumer);
+      }
+    }
+
+    modified = true;
+  }
+
+  std::ostringstream report;
+  report << "MemoryBudgetRecompute: recomputing " << selected.size() << " nodes reduces the activations from "
+         << initial_stashed_bytes / kBytesPerMB << " MB to " << stashed_bytes / kBytesPerMB << " MB (budget "
+         << memory_budget_bytes_ / kBytesPerMB << " MB), for about " << recompute_cost
+         << " extra element operations per step.";
+  if (stashed_bytes <= memory_budget_bytes_) {
+    LOGS(logger, INFO) << report.str();
+  } else {
+    LOGS(logger, WARNING) << report.str() << " The budget can not be met by recomputation.";
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
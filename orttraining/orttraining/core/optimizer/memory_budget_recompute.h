@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class MemoryBudgetRecompute
+
+Reduces the forward activations a training graph keeps alive until the backward pass, by recomputing cheap ones
+right before the backward nodes that use them.
+
+The graph must contain both passes, as built by the gradient graph builder: the losses are the graph outputs that
+have a "<loss>_grad" initializer, the forward nodes are the ancestors of the losses and every other node is a
+backward node. An activation is a forward node output consumed by a backward node.
+
+Element-wise operators, the Gelu variants and LayerNormalization are candidates. A candidate is recomputed when that
+frees more activation memory than the inputs it newly keeps alive, preferring the largest saving per unit of
+recompute work, until the activations fit in the budget. The recompute nodes produce "<output>_recompute", as the
+gradient builders expect, and run with a low priority so they execute as late as possible.
+
+Sizes are estimated from the static shapes. Symbolic dimensions count as 1, so free dimension overrides should be
+set to get estimates in actual bytes.
+*/
+class MemoryBudgetRecompute : public GraphTransformer {
+ public:
+  MemoryBudgetRecompute(int64_t memory_budget_bytes,
+                        const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("MemoryBudgetRecompute", compatible_execution_providers),
+        memory_budget_bytes_(memory_budget_bytes) {}
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+
+  bool ShouldOnlyApplyOnce() const override { return true; }
+
+ private:
+  int64_t memory_budget_bytes_;
+};
+
+}  // namespace onnxruntime
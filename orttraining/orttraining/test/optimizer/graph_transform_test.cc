@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/graph/model.h"
 
 #include "test/framework/test_utils.h"
@@ -18,16 +19,19 @@
 #include "orttraining/core/optimizer/concat_replacement.h"
 #include "orttraining/core/optimizer/batchnorm_replacement.h"
 #include "orttraining/core/optimizer/localized_recompute.h"
+#include "orttraining/core/optimizer/memory_budget_recompute.h"
 #include "test/optimizer/graph_transform_test_builder.h"
 #include "test/optimizer/graph_transform_test_fixture.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
 #include "orttraining/test/optimizer/horizontal_parallel_test_utils.h"
 #include "orttraining/core/session/training_session.h"
 #include "orttraining/core/optimizer/loss_rewriter.h"
 #include "orttraining/core/optimizer/bias_softmax_dropout_fusion.h"
 #include "orttraining/core/optimizer/sce_loss_grad_bias_fusion.h"
 
+#include <algorithm>
 #include <random>
 
 using namespace std;
@@ -868,6 +872,210 @@ TEST_F(GraphTransformationTests, BiasGeluRecomputeTest) {
   }
 }
 
+// Builds loss = ReduceSum(Relu(X + B) * W) and its backward pass, which reads the 64KB activations of Add and Relu.
+void BuildMemoryBudgetRecomputeGraph(Graph& graph) {
+  // 64x256 float activations take 64KB each
+  TypeProto activation_type;
+  activation_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  activation_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(64);
+  activation_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(256);
+  TypeProto weight_type;
+  weight_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  weight_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(256);
+  TypeProto scalar_type;
+  scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  scalar_type.mutable_tensor_type()->mutable_shape();
+
+  auto& x = graph.GetOrCreateNodeArg("X", &activation_type);
+  auto& b = graph.GetOrCreateNodeArg("B", &weight_type);
+  auto& w = graph.GetOrCreateNodeArg("W", &weight_type);
+  auto& a = graph.GetOrCreateNodeArg("a", &activation_type);
+  auto& r = graph.GetOrCreateNodeArg("r", &activation_type);
+  auto& y = graph.GetOrCreateNodeArg("y", &activation_type);
+  auto& loss = graph.GetOrCreateNodeArg("loss", &scalar_type);
+  auto& loss_grad = graph.GetOrCreateNodeArg("loss_grad", &scalar_type);
+  auto& y_grad = graph.GetOrCreateNodeArg("y_grad", &activation_type);
+  auto& r_grad = graph.GetOrCreateNodeArg("r_grad", &activation_type);
+  auto& a_grad = graph.GetOrCreateNodeArg("a_grad", &activation_type);
+  auto& x_grad = graph.GetOrCreateNodeArg("X_grad", &activation_type);
+  auto& w_grad = graph.GetOrCreateNodeArg("W_grad", &activation_type);
+
+  // forward: loss = ReduceSum(Relu(X + B) * W)
+  graph.AddNode("add", "Add", "", {&x, &b}, {&a});
+  graph.AddNode("relu", "Relu", "", {&a}, {&r});
+  graph.AddNode("mul", "Mul", "", {&r, &w}, {&y});
+  graph.AddNode("reduce", "ReduceSum", "", {&y}, {&loss}).AddAttribute("keepdims", static_cast<int64_t>(0));
+
+  // backward, reading the activations a and r
+  TensorProto loss_grad_initializer;
+  loss_grad_initializer.set_name("loss_grad");
+  loss_grad_initializer.set_data_type(TensorProto_DataType_FLOAT);
+  loss_grad_initializer.add_float_data(1.0f);
+  graph.AddInitializedTensor(loss_grad_initializer);
+  // the gradient of the sum, broadcast to the shape of y
+  TensorProto y_grad_initializer;
+  y_grad_initializer.set_name("y_grad");
+  y_grad_initializer.set_data_type(TensorProto_DataType_FLOAT);
+  y_grad_initializer.add_dims(64);
+  y_grad_initializer.add_dims(256);
+  for (int i = 0; i < 64 * 256; ++i) {
+    y_grad_initializer.add_float_data(1.0f);
+  }
+  graph.AddInitializedTensor(y_grad_initializer);
+  graph.AddNode("mul_grad_r", "Mul", "", {&y_grad, &w}, {&r_grad});
+  graph.AddNode("relu_grad", "ReluGrad", "", {&r_grad, &r}, {&a_grad}, nullptr, kMSDomain);
+  graph.AddNode("mul_grad_w", "Mul", "", {&loss_grad, &r}, {&w_grad});
+  graph.AddNode("add_grad", "Mul", "", {&a_grad, &a}, {&x_grad});
+  graph.SetOutputs({&loss, &x_grad, &w_grad});
+  ASSERT_STATUS_OK(graph.Resolve());
+}
+
+TEST_F(GraphTransformationTests, MemoryBudgetRecompute) {
+  Model model("MemoryBudgetRecompute", true, ModelMetaData(), PathString(),
+              IOnnxRuntimeOpSchemaRegistryList(), {{"", 12}, {"com.microsoft", 1}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+  ASSERT_NO_FATAL_FAILURE(BuildMemoryBudgetRecomputeGraph(graph));
+
+  // the activations fit in the budget
+  {
+    onnxruntime::GraphTransformerManager graph_transformation_mgr{1};
+    ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::make_unique<MemoryBudgetRecompute>(1024 * 1024),
+                                                       TransformerLevel::Level2));
+    ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2, *logger_));
+    std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+    ASSERT_EQ(op_to_count["Add"], 1);
+    ASSERT_EQ(op_to_count["Relu"], 1);
+  }
+
+  // nothing may be kept, so both Add and Relu are recomputed, the Relu from the recomputed Add
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{1};
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::make_unique<MemoryBudgetRecompute>(0),
+                                                     TransformerLevel::Level2));
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level2, *logger_));
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  ASSERT_EQ(op_to_count["Add"], 2);
+  ASSERT_EQ(op_to_count["Relu"], 2);
+  ASSERT_EQ(op_to_count["Mul"], 4);
+
+  const Node* relu_recompute = graph.GetProducerNode("r_recompute");
+  ASSERT_NE(relu_recompute, nullptr);
+  EXPECT_EQ(relu_recompute->InputDefs()[0]->Name(), "a_recompute");
+  EXPECT_EQ(relu_recompute->Priority(), static_cast<int>(ExecutionPriority::LOCAL_LOW));
+
+  for (auto& node : graph.Nodes()) {
+    if (node.Name() == "relu_grad" || node.Name() == "mul_grad_w") {
+      EXPECT_EQ(node.InputDefs()[1]->Name(), "r_recompute");
+    } else if (node.Name() == "add_grad") {
+      EXPECT_EQ(node.InputDefs()[1]->Name(), "a_recompute");
+    } else if (node.Name() == "relu" || node.Name() == "mul") {
+      // the forward pass still reads the original values
+      EXPECT_EQ(node.InputDefs()[0]->Name(), node.Name() == "relu" ? "a" : "r");
+    }
+  }
+}
+
+// Runs the graph in sessions with and without a budget, and checks that the recompute nodes run after the forward
+// pass and do not change the results.
+TEST_F(GraphTransformationTests, MemoryBudgetRecomputeExecutionOrder) {
+  Model model("MemoryBudgetRecompute", true, ModelMetaData(), PathString(),
+              IOnnxRuntimeOpSchemaRegistryList(), {{"", 12}, {"com.microsoft", 1}}, {}, *logger_);
+  ASSERT_NO_FATAL_FAILURE(BuildMemoryBudgetRecomputeGraph(model.MainGraph()));
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  auto allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<float> x_data(64 * 256);
+  std::vector<float> b_data(256);
+  std::vector<float> w_data(256);
+  for (size_t i = 0; i < x_data.size(); ++i) {
+    x_data[i] = static_cast<float>(static_cast<int>(i % 13) - 6) / 8.0f;
+  }
+  for (size_t i = 0; i < b_data.size(); ++i) {
+    b_data[i] = static_cast<float>(static_cast<int>(i % 5) - 2) / 4.0f;
+    w_data[i] = static_cast<float>(static_cast<int>(i % 7) - 3) / 2.0f;
+  }
+  OrtValue x_value, b_value, w_value;
+  CreateMLValue<float>(allocator, {64, 256}, x_data, &x_value);
+  CreateMLValue<float>(allocator, {256}, b_data, &b_value);
+  CreateMLValue<float>(allocator, {256}, w_data, &w_value);
+  const NameMLValMap feeds{{"X", x_value}, {"B", b_value}, {"W", w_value}};
+  const std::vector<std::string> output_names{"loss", "X_grad", "W_grad"};
+
+  auto run_model = [&](const std::string& memory_budget_mb, std::vector<std::string>& executed_nodes,
+                       std::vector<OrtValue>& fetches) {
+    SessionOptions so;
+    so.graph_optimization_level = TransformerLevel::Level2;
+    if (!memory_budget_mb.empty()) {
+      so.config_options.configurations[kOrtSessionOptionsConfigActivationMemoryBudgetMB] = memory_budget_mb;
+    }
+
+    InferenceSessionWrapper session{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session.Load(model_data.data(), static_cast<int>(model_data.size())));
+    ASSERT_STATUS_OK(session.Initialize());
+    if (!memory_budget_mb.empty()) {
+      EXPECT_EQ(session.GetSessionOptions().execution_order, ExecutionOrder::PRIORITY_BASED);
+    }
+
+    const auto& session_state = session.GetSessionState();
+    for (const auto& step : session_state.GetExecutionPlan()->execution_plan) {
+      executed_nodes.push_back(session_state.GetGraphViewer().GetNode(step.node_index)->Name());
+    }
+
+    ASSERT_STATUS_OK(session.Run(RunOptions{}, feeds, output_names, &fetches));
+  };
+
+  std::vector<std::string> expected_nodes;
+  std::vector<OrtValue> expected_fetches;
+  ASSERT_NO_FATAL_FAILURE(run_model("", expected_nodes, expected_fetches));
+
+  // nothing may be kept, so both Add and Relu are recomputed
+  std::vector<std::string> executed_nodes;
+  std::vector<OrtValue> fetches;
+  ASSERT_NO_FATAL_FAILURE(run_model("0", executed_nodes, fetches));
+
+  const auto position = [&executed_nodes](const std::string& name) {
+    return std::find(executed_nodes.begin(), executed_nodes.end(), name) - executed_nodes.begin();
+  };
+  ASSERT_EQ(executed_nodes.size(), expected_nodes.size() + 2);
+  ASSERT_LT(position("add_recompute"), static_cast<ptrdiff_t>(executed_nodes.size()));
+  ASSERT_LT(position("relu_recompute"), static_cast<ptrdiff_t>(executed_nodes.size()));
+
+  // the recompute nodes run once the forward pass is done, right before the backward nodes that read them
+  EXPECT_GT(position("add_recompute"), position("reduce"));
+  EXPECT_GT(position("relu_recompute"), position("add_recompute"));
+  EXPECT_GT(position("add_recompute"), position("mul_grad_r"));
+  EXPECT_LT(position("relu_recompute"), position("relu_grad"));
+  EXPECT_LT(position("relu_recompute"), position("mul_grad_w"));
+
+  ASSERT_EQ(fetches.size(), expected_fetches.size());
+  for (size_t i = 0; i < fetches.size(); ++i) {
+    const auto actual = fetches[i].Get<Tensor>().DataAsSpan<float>();
+    const auto expected = expected_fetches[i].Get<Tensor>().DataAsSpan<float>();
+    ASSERT_EQ(actual.size(), expected.size()) << output_names[i];
+    for (size_t j = 0; j < actual.size(); ++j) {
+      EXPECT_EQ(actual[j], expected[j]) << output_names[i] << "[" << j << "]";
+    }
+  }
+}
+
+TEST_F(GraphTransformationTests, MemoryBudgetRecomputeInvalidBudget) {
+  Model model("MemoryBudgetRecompute", true, ModelMetaData(), PathString(),
+              IOnnxRuntimeOpSchemaRegistryList(), {{"", 12}, {"com.microsoft", 1}}, {}, *logger_);
+  ASSERT_NO_FATAL_FAILURE(BuildMemoryBudgetRecomputeGraph(model.MainGraph()));
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  for (const char* memory_budget_mb : {"-1", "512MB", "abc"}) {
+    SessionOptions so;
+    so.config_options.configurations[kOrtSessionOptionsConfigActivationMemoryBudgetMB] = memory_budget_mb;
+    InferenceSessionWrapper session{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session.Load(model_data.data(), static_cast<int>(model_data.size())));
+    const auto status = session.Initialize();
+    EXPECT_EQ(status.Code(), common::INVALID_ARGUMENT) << memory_budget_mb << ": " << status.ErrorMessage();
+  }
+}
+
 TEST_F(GraphTransformationTests, SoftmaxCrossEntropyLossInternalFusionWithoutCast) {
   Model model("SoftmaxCrossEntropyLossInternalFusion", true, ModelMetaData(), PathString(),
               IOnnxRuntimeOpSchemaRegistryList(), {{"", 12}, {"com.microsoft", 1}}, {}, *logger_);
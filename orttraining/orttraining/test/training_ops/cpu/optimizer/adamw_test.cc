@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+namespace optimizer {
+namespace {
+
+// Torch AdamW (mode 0) reference for a single step, with the gradients scaled by clip_coefficient.
+void TorchAdamWReferenceStep(float lr, int64_t step, float alpha, float beta, float epsilon, float weight_decay,
+                             float clip_coefficient, std::vector<float>& weight, const std::vector<float>& gradient,
+                             std::vector<float>& momentum_1, std::vector<float>& momentum_2) {
+  const float alpha_correction = 1.f - static_cast<float>(std::pow(alpha, step));
+  const float beta_correction = 1.f - static_cast<float>(std::pow(beta, step));
+  for (size_t i = 0; i < weight.size(); ++i) {
+    const float g = gradient[i] * clip_coefficient;
+    weight[i] -= weight[i] * lr * weight_decay;
+    momentum_1[i] = alpha * momentum_1[i] + (1.f - alpha) * g;
+    momentum_2[i] = beta * momentum_2[i] + (1.f - beta) * g * g;
+    const float denom = std::sqrt(momentum_2[i] / beta_correction) + epsilon;
+    weight[i] -= (lr * momentum_1[i]) / (alpha_correction * denom);
+  }
+}
+
+std::vector<float> MakeValues(size_t size, float scale, size_t seed) {
+  std::vector<float> values(size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = scale * (static_cast<float>((i * 37 + seed * 11) % 17) - 8.f) / 8.f;
+  }
+  return values;
+}
+
+// Tensors larger than one chunk and smaller ones, with the gradients clipped to a global norm.
+TEST(AdamWTest, AdamWMaxNormMultipleChunks_CPU) {
+  const float lr = 1e-3f, alpha = 0.9f, beta = 0.999f, epsilon = 1e-8f, weight_decay = 1e-2f, max_norm = 1.f;
+  const int64_t step = 3;
+  const std::vector<VectorInt64> shapes = {{100, 200}, {7}, {3, 5}};
+
+  SeqTensors<float> weights, gradients, momentums_1, momentums_2;
+  SeqTensors<float> updated_weights, updated_momentums_1, updated_momentums_2;
+  std::vector<std::vector<float>> all_gradients;
+  double sum_squares = 0.0;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const size_t size = static_cast<size_t>(shapes[i][0] * (shapes[i].size() > 1 ? shapes[i][1] : 1));
+    all_gradients.push_back(MakeValues(size, 0.5f, i + 1));
+    for (float g : all_gradients.back()) {
+      sum_squares += static_cast<double>(g) * g;
+    }
+  }
+  const float clip_coefficient = std::min(max_norm / (static_cast<float>(std::sqrt(sum_squares)) + 1e-6f), 1.f);
+  ASSERT_LT(clip_coefficient, 1.f);
+
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const size_t size = all_gradients[i].size();
+    std::vector<float> weight = MakeValues(size, 1.f, i + 7);
+    std::vector<float> momentum_1 = MakeValues(size, 0.01f, i + 13);
+    std::vector<float> momentum_2(size, 1e-4f);
+    weights.AddTensor(shapes[i], weight);
+    gradients.AddTensor(shapes[i], all_gradients[i]);
+    momentums_1.AddTensor(shapes[i], momentum_1);
+    momentums_2.AddTensor(shapes[i], momentum_2);
+
+    TorchAdamWReferenceStep(lr, step, alpha, beta, epsilon, weight_decay, clip_coefficient,
+                            weight, all_gradients[i], momentum_1, momentum_2);
+    updated_weights.AddTensor(shapes[i], weight);
+    updated_momentums_1.AddTensor(shapes[i], momentum_1);
+    updated_momentums_2.AddTensor(shapes[i], momentum_2);
+  }
+
+  OpTester test("AdamWOptimizer", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("alpha", alpha);
+  test.AddAttribute("beta", beta);
+  test.AddAttribute("epsilon", epsilon);
+  test.AddAttribute("weight_decay", weight_decay);
+  test.AddAttribute("max_norm", max_norm);
+  test.AddInput<float>("lr", {}, {lr});
+  test.AddInput<int64_t>("step", {}, {step});
+  test.AddSeqInput("weights", weights);
+  test.AddSeqInput("gradients", gradients);
+  test.AddSeqInput("momentums_1", momentums_1);
+  test.AddSeqInput("momentums_2", momentums_2);
+  test.AddOutput<int64_t>("updated_flag", {}, {1});
+  test.AddSeqOutput("updated_weights", updated_weights, 1e-5f, 1e-6f);
+  test.AddSeqOutput("updated_momentums_1", updated_momentums_1, 1e-5f, 1e-7f);
+  test.AddSeqOutput("updated_momentums_2", updated_momentums_2, 1e-5f, 1e-9f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+// The momentums are stored as bfloat16. Their values are exactly representable, so the updated weights match the
+// float reference.
+TEST(AdamWTest, AdamWBFloat16Momentums_CPU) {
+  const float lr = 1e-3f, alpha = 0.9f, beta = 0.999f, epsilon = 1e-8f, weight_decay = 1e-2f;
+  const int64_t step = 1;
+  const VectorInt64 shape = {4, 3};
+
+  std::vector<float> weight = MakeValues(12, 1.f, 1);
+  const std::vector<float> gradient = MakeValues(12, 0.25f, 2);
+  std::vector<float> momentum_1(12, 0.0625f);
+  std::vector<float> momentum_2(12, 0.00390625f);
+
+  SeqTensors<float> weights, gradients, updated_weights;
+  SeqTensors<BFloat16> momentums_1, momentums_2;
+  weights.AddTensor(shape, weight);
+  gradients.AddTensor(shape, gradient);
+  momentums_1.AddTensor(shape, std::vector<BFloat16>(momentum_1.begin(), momentum_1.end()));
+  momentums_2.AddTensor(shape, std::vector<BFloat16>(momentum_2.begin(), momentum_2.end()));
+
+  TorchAdamWReferenceStep(lr, step, alpha, beta, epsilon, weight_decay, 1.f, weight, gradient,
+                          momentum_1, momentum_2);
+  updated_weights.AddTensor(shape, weight);
+
+  OpTester test("AdamWOptimizer", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("alpha", alpha);
+  test.AddAttribute("beta", beta);
+  test.AddAttribute("epsilon", epsilon);
+  test.AddAttribute("weight_decay", weight_decay);
+  test.AddInput<float>("lr", {}, {lr});
+  test.AddInput<int64_t>("step", {}, {step});
+  test.AddSeqInput("weights", weights);
+  test.AddSeqInput("gradients", gradients);
+  test.AddSeqInput("momentums_1", momentums_1);
+  test.AddSeqInput("momentums_2", momentums_2);
+  test.AddOutput<int64_t>("updated_flag", {}, {1});
+  test.AddSeqOutput("updated_weights", updated_weights, 1e-5f, 1e-6f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+}  // namespace
+}  // namespace optimizer
+}  // namespace test
+}  // namespace onnxruntime
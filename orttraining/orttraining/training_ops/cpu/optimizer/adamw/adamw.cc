@@ -2,11 +2,18 @@
 // Licensed under the MIT License.
 
 #include "orttraining/training_ops/cpu/optimizer/adamw/adamw.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
 #include "core/framework/op_kernel.h"
 #include "core/platform/threadpool.h"
 #include "core/providers/common.h"
 #include "core/providers/cpu/math/element_wise_ops.h"
 #include "core/providers/cpu/tensor/utils.h"
+#include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -30,6 +37,11 @@ Status AdamWOptimizerBase::PrepareForCompute(OpKernelContext* ctx, AdamWOptimize
   ORT_RETURN_IF_NOT(num_of_gradients == num_of_momentums_1, "Number of gradients and momentums_1 mismatch.");
   ORT_RETURN_IF_NOT(num_of_momentums_1 == num_of_momentums_2, "Number of momentums_1 and momentums_2 mismatch.");
 
+  // Momentums are float, or bfloat16 to halve the memory they take. Both momentums use the same type.
+  ORT_RETURN_IF_NOT(prepare.momentums_1->DataType() == prepare.momentums_2->DataType(),
+                    "Types of momentums_1 and momentums_2 mismatch.");
+  prepare.bfloat16_momentums = prepare.momentums_1->DataType() == DataTypeImpl::GetType<BFloat16>();
+
   prepare.grouped_tensor_sizes.resize(prepare.num_of_weights);
   prepare.grouped_tensor_pointers.resize(prepare.num_of_weights);
 
@@ -58,8 +70,8 @@ Status AdamWOptimizerBase::PrepareForCompute(OpKernelContext* ctx, AdamWOptimize
           prepare.grouped_tensor_pointers[i] = {
               const_cast<float*>(weight_tensor.Data<float>()),
               const_cast<float*>(gradient_tensor.Data<float>()),
-              const_cast<float*>(momentum_1_tensor.Data<float>()),
-              const_cast<float*>(momentum_2_tensor.Data<float>())};
+              const_cast<void*>(momentum_1_tensor.DataRaw()),
+              const_cast<void*>(momentum_2_tensor.DataRaw())};
         }
       });
 
@@ -113,49 +125,156 @@ ONNX_OPERATOR_KERNEL_EX(
         .TypeConstraint("S_MOMENT", DataTypeImpl::AllFixedSizeSequenceTensorTypes()),
     AdamWOptimizer<float>);
 
-template <typename T>
-Status AdamWOptimizer<T>::AdamWComputeMode0(Tensor& weight, Tensor& gradient, Tensor& momentums_1, Tensor& momentums_2,
-                                            float lr, float alpha_correction, float beta_correction) const {
-  // Perform weight decay.
-  MakeEigenArrayMap<T>(weight) = MakeEigenArrayMap<T>(weight) - (MakeEigenArrayMap<T>(weight) * lr * weight_decay_);
+namespace {
 
-  // Compute exponentially-averaged historical gradient.
-  MakeEigenArrayMap<T>(momentums_1) = alpha_ * MakeEigenArrayMap<T>(momentums_1) +
-                                      (1.f - alpha_) * MakeEigenArrayMap<T>(gradient);
+// The weights of all the tensors are updated in chunks of at most this many elements, so one parallel loop spreads
+// thousands of small tensors as well as a few large ones across the thread pool.
+constexpr int64_t kChunkSize = 8192;
 
-  // Compute exponentially-averaged historical squared gradient.
-  MakeEigenArrayMap<T>(momentums_2) = beta_ * MakeEigenArrayMap<T>(momentums_2) +
-                                      (1.f - beta_) * MakeEigenArrayMap<T>(gradient) * MakeEigenArrayMap<T>(gradient);
+// Same epsilon as InplaceClipGradNorm.
+constexpr float kClipNormEpsilon = 0.000001f;
 
-  // Compute the new weight.
-  auto denom = (MakeEigenArrayMap<T>(momentums_2) / beta_correction).sqrt() + epsilon_;
-  MakeEigenArrayMap<T>(weight) = MakeEigenArrayMap<T>(weight) -
-                                 (lr * MakeEigenArrayMap<T>(momentums_1)) / (alpha_correction * denom);
+struct Chunk {
+  size_t tensor_index;
+  int64_t offset;
+  int64_t size;
+};
 
-  return Status::OK();
+std::vector<Chunk> SplitIntoChunks(const std::vector<int>& tensor_sizes) {
+  std::vector<Chunk> chunks;
+  for (size_t i = 0; i < tensor_sizes.size(); ++i) {
+    for (int64_t offset = 0; offset < tensor_sizes[i]; offset += kChunkSize) {
+      chunks.push_back({i, offset, std::min<int64_t>(kChunkSize, tensor_sizes[i] - offset)});
+    }
+  }
+  return chunks;
 }
 
-template <typename T>
-Status AdamWOptimizer<T>::AdamWComputeMode1(Tensor& weight, Tensor& gradient, Tensor& momentums_1, Tensor& momentums_2,
-                                            float lr, float lr_corrected) const {
-  // Compute exponentially-averaged historical gradient.
-  MakeEigenArrayMap<T>(momentums_1) = alpha_ * MakeEigenArrayMap<T>(momentums_1) +
-                                      (1.f - alpha_) * MakeEigenArrayMap<T>(gradient);
+TensorOpCost ChunkCost(const std::vector<Chunk>& chunks, int64_t total_size, size_t momentum_size) {
+  const double average_size = chunks.empty() ? 0.0 : static_cast<double>(total_size) / chunks.size();
+  return TensorOpCost{average_size * (2 * sizeof(float) + 2 * momentum_size),
+                      average_size * (sizeof(float) + 2 * momentum_size),
+                      average_size * 24};
+}
 
-  // Compute exponentially-averaged historical squared gradient.
-  MakeEigenArrayMap<T>(momentums_2) = beta_ * MakeEigenArrayMap<T>(momentums_2) +
-                                      (1.f - beta_) * MakeEigenArrayMap<T>(gradient) * MakeEigenArrayMap<T>(gradient);
+// Rounds to the nearest bfloat16 rather than truncating, so the small updates of the second momentum are not
+// systematically lost.
+inline BFloat16 RoundToBFloat16(float value) {
+  if (std::isnan(value)) {
+    return BFloat16(value);
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t rounding_bias = ((bits >> 16) & 1) + UINT32_C(0x7FFF);
+  return BFloat16(static_cast<uint16_t>((bits + rounding_bias) >> 16), BFloat16::FromBits());
+}
+
+struct AdamWStep {
+  int64_t adam_mode;
+  float alpha;
+  float beta;
+  float epsilon;
+  float weight_decay;
+  float lr;
+  float lr_corrected;
+  float alpha_correction;
+  float beta_correction;
+  float clip_coefficient;
+};
+
+// Applies the update to one chunk with Eigen array expressions. The chunk is small enough to stay in cache across
+// the few passes Eigen makes over it. The gradient clipping is folded in as a scale of the gradient, which is left
+// unchanged. The operations are evaluated in the same order as the per-tensor update this replaced.
+template <typename TMomentum>
+void AdamWUpdateChunk(const AdamWStep& step, float* weight, const float* gradient,
+                      TMomentum* momentum_1, TMomentum* momentum_2, int64_t size);
+
+template <>
+void AdamWUpdateChunk<float>(const AdamWStep& step, float* weight, const float* gradient,
+                             float* momentum_1, float* momentum_2, int64_t size) {
+  EigenVectorArrayMap<float> w(weight, size);
+  EigenVectorArrayMap<float> m(momentum_1, size);
+  EigenVectorArrayMap<float> v(momentum_2, size);
+  const auto g = ConstEigenVectorArrayMap<float>(gradient, size) * step.clip_coefficient;
+
+  m = step.alpha * m + (1.f - step.alpha) * g;
+  v = step.beta * v + (1.f - step.beta) * g * g;
+
+  if (step.adam_mode == 0) {
+    // Weight decay is applied before the weight is updated.
+    w = w - (w * step.lr * step.weight_decay);
+    w = w - (step.lr * m) / (step.alpha_correction * ((v / step.beta_correction).sqrt() + step.epsilon));
+  } else {
+    // Weight decay is applied after the weight is updated.
+    w = w - (step.lr_corrected * m / (v.sqrt() + step.epsilon));
+    w = w - (step.lr * step.weight_decay * w);
+  }
+}
 
-  auto denom = MakeEigenArrayMap<T>(momentums_2).sqrt() + epsilon_;
-  MakeEigenArrayMap<T>(weight) = MakeEigenArrayMap<T>(weight) -
-                                 (lr_corrected * MakeEigenArrayMap<T>(momentums_1) / denom);
+// bfloat16 momentums are widened into small float blocks, updated as float and rounded back.
+template <>
+void AdamWUpdateChunk<BFloat16>(const AdamWStep& step, float* weight, const float* gradient,
+                                BFloat16* momentum_1, BFloat16* momentum_2, int64_t size) {
+  constexpr int64_t kBlockSize = 512;
+  float m[kBlockSize];
+  float v[kBlockSize];
+  for (int64_t offset = 0; offset < size; offset += kBlockSize) {
+    const int64_t block_size = std::min(kBlockSize, size - offset);
+    for (int64_t i = 0; i < block_size; ++i) {
+      m[i] = momentum_1[offset + i].ToFloat();
+      v[i] = momentum_2[offset + i].ToFloat();
+    }
 
-  // Perform weight decay.
-  MakeEigenArrayMap<T>(weight) = MakeEigenArrayMap<T>(weight) - (lr * weight_decay_ * MakeEigenArrayMap<T>(weight));
+    AdamWUpdateChunk<float>(step, weight + offset, gradient + offset, m, v, block_size);
 
-  return Status::OK();
+    for (int64_t i = 0; i < block_size; ++i) {
+      momentum_1[offset + i] = RoundToBFloat16(m[i]);
+      momentum_2[offset + i] = RoundToBFloat16(v[i]);
+    }
+  }
 }
 
+template <typename TMomentum>
+void AdamWUpdate(const AdamWStep& step, const AdamWOptimizerBase::Prepare& p, const std::vector<Chunk>& chunks,
+                 const TensorOpCost& cost, concurrency::ThreadPool* tp) {
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(chunks.size()), cost,
+      [&step, &p, &chunks](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t c = begin; c != end; ++c) {
+          const Chunk& chunk = chunks[c];
+          const auto& pointers = p.grouped_tensor_pointers[chunk.tensor_index];
+          AdamWUpdateChunk<TMomentum>(step,
+                                      static_cast<float*>(pointers[0]) + chunk.offset,
+                                      static_cast<const float*>(pointers[1]) + chunk.offset,
+                                      static_cast<TMomentum*>(pointers[2]) + chunk.offset,
+                                      static_cast<TMomentum*>(pointers[3]) + chunk.offset,
+                                      chunk.size);
+        }
+      });
+}
+
+// Global L2 norm of all the gradients. Each chunk is reduced in parallel and the partial sums are added in order,
+// so the result does not depend on the number of threads.
+float ComputeGradientNorm(const AdamWOptimizerBase::Prepare& p, const std::vector<Chunk>& chunks,
+                          concurrency::ThreadPool* tp) {
+  std::vector<double> partial_sums(chunks.size());
+  const double average_size = static_cast<double>(kChunkSize);
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(chunks.size()),
+      TensorOpCost{average_size * sizeof(float), sizeof(double), average_size * 2},
+      [&p, &chunks, &partial_sums](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t c = begin; c != end; ++c) {
+          const Chunk& chunk = chunks[c];
+          const float* gradient = static_cast<const float*>(p.grouped_tensor_pointers[chunk.tensor_index][1]);
+          partial_sums[c] = ConstEigenVectorMap<float>(gradient + chunk.offset, chunk.size).squaredNorm();
+        }
+      });
+
+  return static_cast<float>(std::sqrt(std::accumulate(partial_sums.begin(), partial_sums.end(), 0.0)));
+}
+
+}  // namespace
+
 template <typename T>
 Status AdamWOptimizer<T>::CopyInputTensorToOutputTensor(const Tensor& source_tensor, Tensor& dest_tensor) const {
   CopyCpuTensor(&source_tensor, &dest_tensor);
@@ -195,21 +314,24 @@ Status AdamWOptimizer<T>::Compute(OpKernelContext* ctx) const {
     //         bias correction is applied on learning rate, then use lr_corrected for subsequent computations.
     //         weight decay is applied after weight is updated.
 
-    for (size_t weight_index = 0; weight_index < p.num_of_weights; ++weight_index) {
-      Tensor& weight = const_cast<Tensor&>(p.weights->Get(weight_index));
-      Tensor& gradient = const_cast<Tensor&>(p.gradients->Get(weight_index));
-      Tensor& momentums_1 = const_cast<Tensor&>(p.momentums_1->Get(weight_index));
-      Tensor& momentums_2 = const_cast<Tensor&>(p.momentums_2->Get(weight_index));
-
-      if (adam_mode_ == 0) {
-        ORT_RETURN_IF_ERROR(
-            AdamWComputeMode0(weight, gradient, momentums_1, momentums_2, lr, alpha_correction, beta_correction));
-      } else if (adam_mode_ == 1) {
-        ORT_RETURN_IF_ERROR(
-            AdamWComputeMode1(weight, gradient, momentums_1, momentums_2, lr, lr_corrected));
-      } else {
-        ORT_THROW("Unsupported Adamw optimizer mode.");
-      }
+    const std::vector<Chunk> chunks = SplitIntoChunks(p.grouped_tensor_sizes);
+    auto* tp = ctx->GetOperatorThreadPool();
+
+    AdamWStep adamw_step{adam_mode_, alpha_, beta_, epsilon_, weight_decay_, lr, lr_corrected,
+                         alpha_correction, beta_correction, 1.f};
+    if (max_norm_ > 0.f) {
+      const float total_norm = ComputeGradientNorm(p, chunks, tp);
+      adamw_step.clip_coefficient = std::min(max_norm_ / (total_norm + kClipNormEpsilon), 1.f);
+    }
+
+    const int64_t total_size = std::accumulate(p.grouped_tensor_sizes.begin(), p.grouped_tensor_sizes.end(),
+                                               static_cast<int64_t>(0));
+    if (p.bfloat16_momentums) {
+      AdamWUpdate<BFloat16>(adamw_step, p, chunks, ChunkCost(chunks, total_size, sizeof(BFloat16)), tp);
+    } else {
+      ORT_RETURN_IF_NOT(p.momentums_1->DataType() == DataTypeImpl::GetType<float>(),
+                        "AdamWOptimizer: momentums must be float or bfloat16.");
+      AdamWUpdate<float>(adamw_step, p, chunks, ChunkCost(chunks, total_size, sizeof(float)), tp);
     }
 
     *updated_flag_ptr = 1;
@@ -22,6 +22,7 @@ class AdamWOptimizerBase {
     const TensorSeq* momentums_2;
 
     size_t num_of_weights;
+    bool bfloat16_momentums;  // momentums are stored as bfloat16, and weights and gradients as float
     std::vector<int> grouped_tensor_sizes;
     std::vector<std::vector<void*>> grouped_tensor_pointers;
 
@@ -40,9 +41,11 @@ class AdamWOptimizerBase {
     info.GetAttrOrDefault("weight_decay", &weight_decay_, 0.f);
     info.GetAttrOrDefault("adam_mode", &adam_mode_, static_cast<int64_t>(0));
     info.GetAttrOrDefault("correct_bias", &correct_bias_, static_cast<int64_t>(1));
+    info.GetAttrOrDefault("max_norm", &max_norm_, 0.f);
 
     ORT_ENFORCE(adam_mode_ == 0 || adam_mode_ == 1, "The value of adam_mode is invalid.");
     ORT_ENFORCE(correct_bias_ == 0 || correct_bias_ == 1, "The value of correct_bias is invalid.");
+    ORT_ENFORCE(max_norm_ >= 0.f, "The value of max_norm is invalid.");
 
     // To have torch adamw equivalence, correct_bias must be 1 for adam_mode=0.
     ORT_ENFORCE(adam_mode_ != 0 || correct_bias_ == 1, "The correct_bias should be 1 for adam_mode = 0.");
@@ -63,6 +66,9 @@ class AdamWOptimizerBase {
   float weight_decay_;
   int64_t adam_mode_{0};
   int64_t correct_bias_{0};
+
+  // Gradients are clipped to this global L2 norm before they are applied, 0 disables the clipping.
+  float max_norm_{0.f};
 };
 
 }  // namespace contrib
@@ -42,6 +42,7 @@ Status AdamWOptimizer::CopyInputTensorToOutputTensor(const Tensor& source_tensor
 Status AdamWOptimizer::ComputeInternal(OpKernelContext* ctx) const {
   AdamWOptimizerBase::Prepare p;
   ORT_RETURN_IF_ERROR(PrepareForCompute(ctx, p));
+  ORT_RETURN_IF(p.bfloat16_momentums, "AdamWOptimizer on CUDA does not support bfloat16 momentums.");
 
   int64_t* updated_flag_ptr = p.updated_flag->template MutableData<int64_t>();
 
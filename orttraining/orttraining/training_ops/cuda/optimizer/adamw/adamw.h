@@ -15,6 +15,7 @@ namespace cuda {
 class AdamWOptimizer final : public CudaKernel, public contrib::AdamWOptimizerBase {
  public:
   AdamWOptimizer(const OpKernelInfo& info) : CudaKernel(info), contrib::AdamWOptimizerBase(info) {
+    ORT_ENFORCE(max_norm_ == 0.f, "AdamWOptimizer on CUDA does not support max_norm, use InplaceClipGradNorm.");
   }
 
   Status ComputeInternal(OpKernelContext* context) const override;